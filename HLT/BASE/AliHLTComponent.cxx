@@ -112,7 +112,9 @@ AliHLTComponent::AliHLTComponent()
   fEventModulo(-1),
   fSchema(),
   fUseSchema(0),
-  fSchemaUpdated(0)
+  fSchemaUpdated(0),
+  fOutputSizeRatio(0.),
+  fOutputSizeMax(0)
 {
   // see header file for class documentation
   // or
@@ -289,6 +291,9 @@ int AliHLTComponent::Init(const AliHLTAnalysisEnvironment* comenv, void* environ
 	  // -disable-component-stat
 	} else if (argument.CompareTo("-disable-component-stat")==0) {
 	  fFlags|=kDisableComponentStat;
+	  // -output-size-hint
+	} else if (argument.CompareTo("-output-size-hint")==0) {
+	  EnableOutputSizeHint();
 	} else {
 	  pArguments[iNofChildArgs++]=argv[i];
 	}
@@ -2294,6 +2299,10 @@ int AliHLTComponent::ProcessEvent( const AliHLTComponentEventData& evtData,
     size=0;
   }
 
+  if (iResult>=0 && !bSkipDataProcessing && IsDataEvent() && (fFlags&kOutputSizeHint)!=0) {
+    UpdateOutputSizeHint(evtData, blocks, size);
+  }
+
   // reset the internal EventData struct
   FillEventData(fCurrentEventData);
 
@@ -2331,6 +2340,50 @@ int AliHLTComponent::ProcessEvent( const AliHLTComponentEventData& evtData,
   return iResult;
 }
 
+void AliHLTComponent::EnableOutputSizeHint(bool enable)
+{
+  // see header file for function documentation
+  if (enable) fFlags|=kOutputSizeHint;
+  else fFlags&=~kOutputSizeHint;
+  fOutputSizeRatio=0.;
+  fOutputSizeMax=0;
+}
+
+void AliHLTComponent::UpdateOutputSizeHint(const AliHLTComponentEventData& evtData,
+					   const AliHLTComponentBlockData* blocks,
+					   AliHLTUInt32_t outputSize)
+{
+  // see header file for function documentation
+  AliHLTUInt64_t inputSize=0;
+  for (unsigned i=0; blocks && i<evtData.fBlockCnt; i++) {
+    inputSize+=blocks[i].fSize;
+  }
+
+  // decaying maxima: a single large event raises the hint immediately,
+  // it is forgotten slowly over the following events
+  const double decay=1.-1./16;
+  fOutputSizeMax=TMath::Max(outputSize, AliHLTUInt32_t(decay*fOutputSizeMax));
+  // the ratio of small inputs is dominated by fixed size output
+  if (inputSize>=kOutputSizeHintMinInput) {
+    double ratio=double(outputSize)/inputSize;
+    fOutputSizeRatio=TMath::Max(ratio, decay*fOutputSizeRatio);
+  }
+}
+
+AliHLTUInt32_t AliHLTComponent::GetOutputSizeHint(AliHLTUInt32_t inputSize) const
+{
+  // see header file for function documentation
+  if ((fFlags&kOutputSizeHint)==0 || fOutputSizeMax==0) return 0;
+  double hint=fOutputSizeMax;
+  if (inputSize>0 && fOutputSizeRatio>0.) {
+    hint=TMath::Min(fOutputSizeRatio*inputSize, double(kOutputSizeHintMaxFactor)*fOutputSizeMax);
+  }
+  // safety margin of 1/8 on top of the learned size
+  hint*=1.125;
+  if (hint>kMaxUInt) return kMaxUInt;
+  return AliHLTUInt32_t(hint);
+}
+
 int  AliHLTComponent::AddComponentStatistics(AliHLTComponentBlockDataList& blocks, 
 					     AliHLTUInt8_t* buffer,
 					     AliHLTUInt32_t bufferSize,
@@ -2931,10 +2984,13 @@ int AliHLTComponent::LoggingVarargs(AliHLTComponentLogSeverity severity,
   // without problems. But at this point we face the problem with virtual members which
   // are not necessarily const.
   AliHLTComponent* nonconst=const_cast<AliHLTComponent*>(this);
-  AliHLTLogging::SetLogString(this, ", %p", "%s (%s_pfmt_): ", 
-			      fChainId[0]!=0?fChainId.c_str():nonconst->GetComponentID(),
-			      nonconst->GetComponentID());
-  iResult=SendMessage(severity, originClass, originFunc, file, line, AliHLTLogging::BuildLogString(NULL, args, true /*append*/));
+  {
+    AliHLTLoggingLock lock;
+    AliHLTLogging::SetLogString(this, ", %p", "%s (%s_pfmt_): ", 
+				fChainId[0]!=0?fChainId.c_str():nonconst->GetComponentID(),
+				nonconst->GetComponentID());
+    iResult=SendMessage(severity, originClass, originFunc, file, line, AliHLTLogging::BuildLogString(NULL, args, true /*append*/));
+  }
   va_end(args);
 
   return iResult;
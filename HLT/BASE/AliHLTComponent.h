@@ -391,6 +391,9 @@ typedef vector<AliHLTMemoryFile*>         AliHLTMemoryFilePList;
  *      This option reduces the event processing rate by processing only n'th event
  *      based on the modulo number <i>number</i>. The scale down should be about
  *      1/<i>number</i>, where <i>number</i> is a positive integer.
+ * \li -output-size-hint     <br>
+ *      learn the output buffer size from the processed events, see
+ *      GetOutputSizeHint
  *
  * @ingroup alihlt_component
  * @section alihltcomponent-members Class members
@@ -590,6 +593,30 @@ class AliHLTComponent : public AliHLTLogging {
    */
   virtual void GetOutputDataSize( unsigned long& constBase, double& inputMultiplier ) = 0;
 
+  /**
+   * Get a hint for the output buffer size learned from previous events.
+   * The framework keeps a slowly decaying maximum of the output/input
+   * ratio and of the absolute output size of the processed data events.
+   * The hint is used in addition to the static estimate from
+   * GetOutputDataSize in order to avoid repeated -ENOSPC retries for
+   * components with strongly varying output.
+   *
+   * The hint is opt-in, see EnableOutputSizeHint and the argument
+   * -output-size-hint. The ratio is learned only from events with at least
+   * kOutputSizeHintMinInput byte of input, small events with fixed size
+   * output (headers, triggers) would give huge ratios. The ratio based hint
+   * is limited to kOutputSizeHintMaxFactor times the learned output size.
+   * @param inputSize   total size of the input blocks of the coming event
+   * @return size hint in byte, 0 if disabled or no data event has been
+   *         processed yet
+   */
+  AliHLTUInt32_t GetOutputSizeHint(AliHLTUInt32_t inputSize) const;
+
+  /** minimal input size in byte for learning the output/input ratio */
+  static const AliHLTUInt32_t kOutputSizeHintMinInput=4096;
+  /** limit of the ratio based hint in units of the learned output size */
+  static const int kOutputSizeHintMaxFactor=4;
+
   /**
    * Get a list of OCDB object description.
    * The list of objects is provided in a TMap
@@ -887,6 +914,10 @@ class AliHLTComponent : public AliHLTLogging {
 
     /** active stopwatch guard */
     static AliHLTStopwatchGuard* fgpCurrent;                                //!transient
+#ifdef _OPENMP
+    // each thread of the concurrent task processing keeps its own guard chain
+#pragma omp threadprivate(fgpCurrent)
+#endif
   };
 
   /**
@@ -939,6 +970,24 @@ class AliHLTComponent : public AliHLTLogging {
 
  protected:
 
+  /**
+   * Enable the output buffer size hint learned from the processed data
+   * events, see GetOutputSizeHint. Also enabled by the argument
+   * -output-size-hint.
+   */
+  void EnableOutputSizeHint(bool enable=true);
+
+  /**
+   * Update the learned output size hint after a processed data event,
+   * called by ProcessEvent if the hint is enabled.
+   * @param evtData      event data of the processed event
+   * @param blocks       input blocks
+   * @param outputSize   size of the produced output
+   */
+  void UpdateOutputSizeHint(const AliHLTComponentEventData& evtData,
+			    const AliHLTComponentBlockData* blocks,
+			    AliHLTUInt32_t outputSize);
+
   /** Get the schema map and get/set the use flag
   */
   TList* GetSchema() {return &fSchema;}
@@ -1811,7 +1860,8 @@ class AliHLTComponent : public AliHLTLogging {
 
   enum {
     kRequireSteeringBlocks = 0x1,
-    kDisableComponentStat = 0x2
+    kDisableComponentStat = 0x2,
+    kOutputSizeHint = 0x4
   };
 
   /** The global component handler instance */
@@ -1922,6 +1972,11 @@ class AliHLTComponent : public AliHLTLogging {
   /// signal a change in the schema list
   Bool_t fSchemaUpdated;                                           //! transient
 
+  /// decaying maximum of the output/input size ratio
+  double fOutputSizeRatio;                                         //! transient
+  /// decaying maximum of the output size
+  AliHLTUInt32_t fOutputSizeMax;                                   //! transient
+
   ClassDef(AliHLTComponent, 0)
 };
 #endif
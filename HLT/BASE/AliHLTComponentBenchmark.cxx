@@ -20,7 +20,7 @@
 #include "AliHLTComponentBenchmark.h"
 
 AliHLTComponentBenchmark::AliHLTComponentBenchmark( const char *Name )
-  :fComponentName(Name),fNTimers(0),fNEvents(0), fTotalInput(0),fTotalOutput(0), fStatistics()
+  :fComponentName(Name),fNTimers(0),fNEvents(0), fTotalInput(0),fTotalOutput(0), fNRetries(0), fNReallocations(0), fStatistics()
 {
   // !
   Reset();
@@ -32,6 +32,8 @@ void AliHLTComponentBenchmark::Reset()
   fNEvents = 0;
   fTotalInput = 0;
   fTotalOutput = 0;
+  fNRetries = 0;
+  fNReallocations = 0;
   for( int i=0; i<10; i++ ){
     fTimers[i].Reset();
     fTotalRealTime[i] = 0;
@@ -108,6 +110,9 @@ const char *AliHLTComponentBenchmark::GetStatistics()
 
   fStatistics = Form("%s, %ld events: in %.1f Kb, out %.1f Kb, ratio %.1f", 
 		     fComponentName.Data(), fNEvents, fTotalInput/fNEvents/1024, fTotalOutput/fNEvents/1024, ratio);
+  if( fNRetries>0 || fNReallocations>0 ){
+    fStatistics+=Form(", %ld retries, %ld reallocations", fNRetries, fNReallocations);
+  }
   
   if( fNTimers<=0 ) return fStatistics.Data();
   float hz = ( fTotalRealTime[0] > 0 ) ?fNEvents/fTotalRealTime[0] : 0;
@@ -34,6 +34,12 @@ class AliHLTComponentBenchmark
   void Stop( Int_t i );
   void AddInput( Double_t x );
   void AddOutput( Double_t x );
+  /// processing repeated because of too small output buffer
+  void AddRetry() { fNRetries++; }
+  /// new memory allocated for the output buffer
+  void AddReallocation() { fNReallocations++; }
+  ULong_t GetNRetries() const { return fNRetries; }
+  ULong_t GetNReallocations() const { return fNReallocations; }
   const char *GetStatistics();
   /**
   *
@@ -59,6 +65,8 @@ class AliHLTComponentBenchmark
   Double_t fTotalCPUTime[10]; // total CPU time
   Double_t fTotalInput; // total input size
   Double_t fTotalOutput; // total output size
+  ULong_t fNRetries; // N repeated processing calls
+  ULong_t fNReallocations; // N buffer reallocations
   TString fStatistics;// string with statistics
 };
 
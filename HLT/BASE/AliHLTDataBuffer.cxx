@@ -939,10 +939,13 @@ AliHLTDataBuffer::AliHLTRawPage::AliHLTRawPage(AliHLTUInt32_t pagesize)
   , fPtr(static_cast<AliHLTUInt8_t*>(malloc(pagesize)))
   , fFreeBuffers()
   , fUsedBuffers()
+  , fArena(fgArenaMode)
+  , fArenaTop(0)
 {
   // constructor
   if (fPtr) {
-    fFreeBuffers.push_back(new AliHLTRawBuffer(fSize, fPtr));
+    // the arena is managed by the top offset, no free list
+    if (!fArena) fFreeBuffers.push_back(new AliHLTRawBuffer(fSize, fPtr));
   } else {
     fSize=0;
   }
@@ -974,6 +977,14 @@ AliHLTDataBuffer::AliHLTRawPage::~AliHLTRawPage()
 AliHLTDataBuffer::AliHLTRawBuffer* AliHLTDataBuffer::AliHLTRawPage::Alloc(AliHLTUInt32_t size)
 {
   /// alloc a buffer of specified size
+  if (fArena) {
+    if (fPtr==NULL || fSize-fArenaTop<size) return NULL;
+    AliHLTRawBuffer* thisbuffer=new AliHLTRawBuffer(size, fPtr+fArenaTop);
+    if (!thisbuffer) return NULL;
+    fArenaTop+=size;
+    fUsedBuffers.push_back(thisbuffer);
+    return thisbuffer;
+  }
   if (fFreeBuffers.size()==0) return NULL;
   
   for (AliHLTRawBufferPList::iterator iter=fFreeBuffers.begin();
@@ -1003,6 +1014,17 @@ int AliHLTDataBuffer::AliHLTRawPage::Free(AliHLTRawBuffer* pBuffer)
 {
   /// free a buffer and merge consecutive free buffers
   int iResult=0;
+  if (fArena) {
+    for (AliHLTRawBufferPList::iterator iter=fUsedBuffers.begin();
+	 iter!=fUsedBuffers.end(); iter++) {
+      if ((*iter)!=pBuffer) continue;
+      fUsedBuffers.erase(iter);
+      delete pBuffer;
+      RewindArena();
+      return 0;
+    }
+    return 1;
+  }
   for (AliHLTRawBufferPList::iterator iter=fUsedBuffers.begin();
        iter!=fUsedBuffers.end() && iResult>=0;
        iter++) {
@@ -1104,7 +1126,11 @@ int AliHLTDataBuffer::AliHLTRawPage::SetSize(const AliHLTDataBuffer::AliHLTRawBu
 	return -ENOSPC;
       }
       AliHLTDataBuffer::AliHLTRawBuffer* freespace=(*iter)->Split(size);
-      if (freespace) {
+      if (freespace && fArena) {
+	// the space is available again if the buffer is at the top
+	delete freespace;
+	RewindArena();
+      } else if (freespace) {
 	fUsedBuffers.push_back(freespace);
 	Free(freespace);
       } else {
@@ -1131,9 +1157,21 @@ bool AliHLTDataBuffer::AliHLTRawPage::HasBuffer(const AliHLTDataBuffer::AliHLTRa
   return false;
 }
 
+void AliHLTDataBuffer::AliHLTRawPage::RewindArena()
+{
+  /// set the arena top to the end of the last used buffer
+  fArenaTop=0;
+  for (AliHLTRawBufferPList::const_iterator iter=fUsedBuffers.begin();
+       iter!=fUsedBuffers.end(); iter++) {
+    AliHLTUInt32_t end=(*iter)->GetPointer()-fPtr+(*iter)->GetTotalSize();
+    if (end>fArenaTop) fArenaTop=end;
+  }
+}
+
 AliHLTUInt32_t AliHLTDataBuffer::AliHLTRawPage::Capacity() const 
 {
   /// get max available contiguous buffer
+  if (fArena) return fSize-fArenaTop;
   AliHLTUInt32_t capacity=0;
   for (unsigned i=0; i<fFreeBuffers.size(); i++) {
     if (fFreeBuffers[i]->GetTotalSize()>capacity) 
@@ -1157,6 +1195,7 @@ void AliHLTDataBuffer::AliHLTRawPage::Print(const char* option)
   cout << "************* AliHLTRawPage status ***********" << endl;
   cout << "  instance " << this << endl;
   printf("  buffer %p  size %d", fPtr, fSize);
+  if (fArena) printf("  arena top %d", fArenaTop);
   cout << "  used buffers: " << fUsedBuffers.size() << endl;
   AliHLTRawBufferPList::iterator iter=fUsedBuffers.begin();
   for (; iter!=fUsedBuffers.end(); iter++) {
@@ -1174,6 +1213,10 @@ vector<AliHLTDataBuffer::AliHLTRawPage*> AliHLTDataBuffer::AliHLTRawPage::fgGlob
 
 AliHLTUInt32_t AliHLTDataBuffer::AliHLTRawPage::fgGlobalPageSize=30*1024*1024;
 
+bool AliHLTDataBuffer::AliHLTRawPage::fgArenaMode=false;
+
+AliHLTUInt32_t AliHLTDataBuffer::AliHLTRawPage::fgNofAllocations=0;
+
 unsigned int AliHLTDataBuffer::GetMaxBufferSize()
 {
 	return(30 * AliHLTRawPage::GetGlobalPageSize()); //Use a max data size of 30 * GlobalPageSize, as this is the maximum AliHLTRawPage::GlobalAlloc will allocate
@@ -1208,6 +1251,7 @@ AliHLTDataBuffer::AliHLTRawBuffer* AliHLTDataBuffer::AliHLTRawPage::GlobalAlloc(
       log.Logging(kHLTLogError, "AliHLTDataBuffer::AliHLTRawPage::GlobalAlloc", "data buffer handling", "can not create raw page");
       return NULL;
     }
+    fgNofAllocations++;
 
     // check is there is at least one unused page which can be replaced by the newly created one
     for (page=fgGlobalPages.begin(); page!=fgGlobalPages.end(); page++) {
@@ -241,6 +241,23 @@ class AliHLTDataBuffer : public TObject, public AliHLTLogging
    */
   static int SetGlobalEventCount(AliHLTUInt32_t eventCount) {fgEventCount=eventCount; return 0;}
 
+  /**
+   * Switch to arena allocation for pages created from now on.
+   * Buffers are allocated consecutively from the top of the page and
+   * the page is rewound when the buffers at the top are released, i.e.
+   * at the latest when all buffers of the event have been released. The
+   * segments of a chain are at the same location in every event as long
+   * as the output sizes do not change.
+   */
+  static void SetArenaAllocation(bool bArena) {AliHLTRawPage::SetArenaMode(bArena);}
+
+  /**
+   * Number of raw pages created so far.
+   * A new page is created if the request does not fit into the existing
+   * pages, the counter is used for the reallocation statistics.
+   */
+  static AliHLTUInt32_t GetNofPageAllocations() {return AliHLTRawPage::GetNofAllocations();}
+
   /**
    * @class AliHLTDataSegment
    * @brief  Descriptor of a data segment within the buffer.
@@ -403,7 +420,7 @@ class AliHLTDataBuffer : public TObject, public AliHLTLogging
   class AliHLTRawPage : public AliHLTLogging {
   public:
     /** standard constructor */
-  AliHLTRawPage() : fSize(0), fPtr(NULL), fFreeBuffers(), fUsedBuffers() {}
+  AliHLTRawPage() : fSize(0), fPtr(NULL), fFreeBuffers(), fUsedBuffers(), fArena(false), fArenaTop(0) {}
     /** constructor */
     AliHLTRawPage(AliHLTUInt32_t pagesize);
     /** destructor */
@@ -420,6 +437,11 @@ class AliHLTDataBuffer : public TObject, public AliHLTLogging
     static AliHLTUInt32_t GetGlobalPageSize() {return fgGlobalPageSize;}
     /** find next page after prev, or first page */
     static AliHLTRawPage* NextPage(const AliHLTRawPage* prev=NULL);
+    /** arena allocation for pages created from now on */
+    static void SetArenaMode(bool bArena) {fgArenaMode=bArena;}
+    static bool GetArenaMode() {return fgArenaMode;}
+    /** number of pages created by GlobalAlloc */
+    static AliHLTUInt32_t GetNofAllocations() {return fgNofAllocations;}
 
     /** alloc a buffer of specified size */
     AliHLTRawBuffer* Alloc(AliHLTUInt32_t size);
@@ -434,6 +456,7 @@ class AliHLTDataBuffer : public TObject, public AliHLTLogging
     AliHLTUInt32_t Capacity() const;
     bool IsUsed() const {return fUsedBuffers.size()>0;}
     bool IsFragmented() const {return (fFreeBuffers.size()+fUsedBuffers.size())>1;}
+    bool IsArena() const {return fArena;}
 
     /**
      * Print page information
@@ -450,6 +473,13 @@ class AliHLTDataBuffer : public TObject, public AliHLTLogging
     static vector<AliHLTDataBuffer::AliHLTRawPage*> fgGlobalPages; //! transient
     /// pages size of global pages
     static AliHLTUInt32_t fgGlobalPageSize;                        //! transient
+    /// arena allocation for new pages
+    static bool fgArenaMode;                                       //! transient
+    /// number of pages created
+    static AliHLTUInt32_t fgNofAllocations;                        //! transient
+
+    /** set the arena top to the end of the last used buffer */
+    void RewindArena();
 
     /** page size */
     AliHLTUInt32_t fSize;                                          // see above
@@ -460,6 +490,10 @@ class AliHLTDataBuffer : public TObject, public AliHLTLogging
     AliHLTRawBufferPList fFreeBuffers;                             //! transient
     /** list of used buffers */
     AliHLTRawBufferPList fUsedBuffers;                             //! transient
+    /** buffers are allocated consecutively from the arena top */
+    bool fArena;                                                   //! transient
+    /** offset of the first free byte in arena mode */
+    AliHLTUInt32_t fArenaTop;                                      //! transient
   };
 
   /**
@@ -86,6 +86,11 @@ int AliHLTDataDeflaterHuffman::AddParameterDefinition(const char* name, unsigned
     HLTError("mismatch in bitlengt: can not use decoder %s of length %d for encoding of %d bits", pHuffman->GetName(), pHuffman->GetMaxBits(), bitLength);
     return -EPERM;
   }
+  // the flat code table is used for encoding, fall back to the bitset
+  // codes if the table can not be built
+  if (!pHuffman->HasCodingTables() && pHuffman->InitCodingTables()<0) {
+    HLTWarning("can not build coding tables for decoder %s, using slow encoding", pHuffman->GetName());
+  }
 
   fReferenceLength.push_back(refLength>0?refLength:bitLength);
   fHuffmanCoders.push_back(pHuffman);
@@ -141,8 +146,17 @@ bool AliHLTDataDeflaterHuffman::OutputParameterBits( int memberId, AliHLTUInt64_
 
   fParameterClusterCount[memberId]++;
 
+  const AliHLTHuffman* coder=fHuffmanCoders[memberId];
+  const AliHLTUInt64_t codeValue=(value>coder->GetMaxValue())?coder->GetMaxValue():value;
+  if (coder->HasCodingTables() && !DoStatistics()) {
+    AliHLTUInt64_t code=0;
+    AliHLTUInt32_t codeLength=0;
+    if (!coder->EncodeTable(codeValue, code, codeLength)) return false;
+    return OutputBits(code, codeLength);
+  }
+
   AliHLTUInt64_t length = 0;
-  const std::bitset<64>& v=fHuffmanCoders[memberId]->Encode((value>fHuffmanCoders[memberId]->GetMaxValue())?fHuffmanCoders[memberId]->GetMaxValue():value, length);
+  const std::bitset<64>& v=coder->Encode(codeValue, length);
   //cout << fHuffmanCoders[memberId]->GetName() << " value " << value << ": code lenght " << length << " " << v << endl;
   if (DoStatistics()) {
     float weight=0.0;
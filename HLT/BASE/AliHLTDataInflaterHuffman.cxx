@@ -101,6 +101,11 @@ int AliHLTDataInflaterHuffman::InitDecoders(TList* decoderlist)
     }
     fHuffmanCoderList->Add(pObj);
     coder->InitMaxCodeLength();
+    // the lookup table resolves codes up to the index length in one step,
+    // the table size is bounded by the default index length
+    if (!coder->HasCodingTables() && coder->InitCodingTables()<0) {
+      HLTWarning("can not build coding tables for decoder %s, using tree search", coder->GetName());
+    }
   }
 
   return fHuffmanCoderList->GetEntries();
@@ -135,11 +140,17 @@ bool AliHLTDataInflaterHuffman::NextValue(AliHLTUInt64_t& value, AliHLTUInt32_t&
     fInputLength+=inputLength;
   }
   AliHLTUInt32_t codeLength=0;
-  if (!fHuffmanCoders[fCurrentParameter]->DecodeMSB(fInput, value, length, codeLength)) return false;
+  const AliHLTHuffman* coder=fHuffmanCoders[fCurrentParameter];
+  if (coder->HasCodingTables()) {
+    if (!coder->DecodeTableMSB(fInput, value, codeLength)) return false;
+    length=coder->GetMaxBits();
+  } else {
+    if (!coder->DecodeMSB(fInput, value, length, codeLength)) return false;
+  }
   HLTDebug("  code 0x%08x  length %d  value %d", fInput>>(64-codeLength), codeLength, value);
   if (fInputLength<codeLength) {
     HLTError("huffman decoder '%s' pretends to have %d bit(s) decoded, but only %d available",
-	     fHuffmanCoders[fCurrentParameter]->GetName(), codeLength, fInputLength);
+	     coder->GetName(), codeLength, fInputLength);
     return false;
   }
   fInput<<=codeLength;
@@ -37,6 +37,9 @@ public:
    * bits is always required for the Huffman decoder. Internal buffering
    * is implemented to avoid repetitive backward seek in the input stream
    * after decoding of a symbol when the length is known.
+   * Codes are resolved by the lookup table of the Huffman instance if
+   * available, the tree is only searched for codes longer than the table
+   * index.
    *
    * overloaded from AliHLTDataInflater
    */
@@ -57,7 +57,10 @@ class AliHLTErrorGuard : public AliHLTLogging {
   {
     va_list args;
     va_start(args, dummy);
-    fMessage=AliHLTLogging::BuildLogString(NULL, args );
+    {
+      AliHLTLoggingLock lock;
+      fMessage=AliHLTLogging::BuildLogString(NULL, args );
+    }
     va_end(args);
   }
 
@@ -27,6 +27,7 @@
 #include <set>
 #include <bitset>
 #include <algorithm>
+#include <cerrno>
 
 AliHLTHuffmanNode::AliHLTHuffmanNode() 
 	: TObject()
@@ -229,6 +230,9 @@ AliHLTHuffman::AliHLTHuffman()
 	, fMaxCodeLength(0)
 	, fDecodingNodes()
 	, fDecodingTopNode(NULL)
+	, fEncodingTable()
+	, fDecodingTable()
+	, fDecodingTableBits(0)
 {
         /// nop
 }
@@ -244,6 +248,9 @@ AliHLTHuffman::AliHLTHuffman(const AliHLTHuffman& other)
 	, fMaxCodeLength(other.fMaxCodeLength)
 	, fDecodingNodes()
 	, fDecodingTopNode(NULL)
+	, fEncodingTable()
+	, fDecodingTable()
+	, fDecodingTableBits(0)
 {
         /// nop
 }
@@ -258,6 +265,9 @@ AliHLTHuffman::AliHLTHuffman(const char* name, UInt_t maxBits)
 	, fMaxCodeLength(0)
 	, fDecodingNodes()
 	, fDecodingTopNode(NULL)
+	, fEncodingTable()
+	, fDecodingTable()
+	, fDecodingTableBits(0)
  {
         /// standard constructor
 	for (AliHLTUInt64_t i = 0; i <= fMaxValue; i++) {
@@ -475,6 +485,9 @@ Bool_t AliHLTHuffman::GenerateHuffmanTree() {
 	fHuffTopNode = *nodeCollection.begin();
 	fHuffTopNode->AssignCode(fReverseCode);
 	InitMaxCodeLength();
+	fEncodingTable.clear();
+	fDecodingTable.clear();
+	fDecodingTableBits = 0;
 	return kTRUE;
 }
 
@@ -515,6 +528,9 @@ AliHLTHuffman& AliHLTHuffman::operator =(const AliHLTHuffman& other) {
 	fNodes = other.fNodes;
 	fHuffTopNode = NULL;
 	fMaxCodeLength = 0;
+	fEncodingTable.clear();
+	fDecodingTable.clear();
+	fDecodingTableBits = 0;
 	return *this;
 }
 
@@ -562,6 +578,61 @@ UInt_t AliHLTHuffman::InitMaxCodeLength()
   return fMaxCodeLength;
 }
 
+int AliHLTHuffman::InitCodingTables(UInt_t lookupBits)
+{
+  // build the flat encoding table and the decoding lookup table
+  // the lookup table is only available for the reverse code which is decoded
+  // from the MSB, all codes with length up to lookupBits are resolved by one
+  // table access
+  fEncodingTable.clear();
+  fDecodingTable.clear();
+  fDecodingTableBits=0;
+  if (!fHuffTopNode) {
+    HLTError("huffman table '%s' not yet generated", GetName());
+    return -ENODEV;
+  }
+  if (lookupBits>16) lookupBits=16;
+  InitMaxCodeLength();
+  // no need for a table index longer than the longest code
+  if (lookupBits>fMaxCodeLength) lookupBits=fMaxCodeLength;
+  if (fMaxCodeLength>64) {
+    HLTError("huffman table '%s': code length %d exceeds 64 bit", GetName(), fMaxCodeLength);
+    return -EFBIG;
+  }
+
+  fEncodingTable.resize(fNodes.size());
+  for (AliHLTUInt64_t v=0; v<fNodes.size(); v++) {
+    const std::bitset<64>& bits=fNodes[v].GetBinaryCode();
+    AliHLTUInt32_t length=fNodes[v].GetBinaryCodeLength();
+    AliHLTUInt64_t code=0;
+    for (AliHLTUInt32_t i=0; i<length; i++) {
+      if (bits[i]) code|=((AliHLTUInt64_t)1)<<i;
+    }
+    fEncodingTable[v].fCode=code;
+    fEncodingTable[v].fLength=length;
+  }
+
+  if (!fReverseCode || lookupBits==0) return 0;
+
+  AliHuffmanLookupEntry empty;
+  empty.fValue=0;
+  empty.fLength=0;
+  fDecodingTable.assign(((size_t)1)<<lookupBits, empty);
+  for (AliHLTUInt64_t v=0; v<fEncodingTable.size(); v++) {
+    AliHLTUInt32_t length=fEncodingTable[v].fLength;
+    if (length==0 || length>lookupBits) continue;
+    // all indices starting with the code pattern decode to this value
+    AliHLTUInt64_t first=fEncodingTable[v].fCode<<(lookupBits-length);
+    AliHLTUInt64_t count=((AliHLTUInt64_t)1)<<(lookupBits-length);
+    for (AliHLTUInt64_t i=first; i<first+count; i++) {
+      fDecodingTable[i].fValue=v;
+      fDecodingTable[i].fLength=length;
+    }
+  }
+  fDecodingTableBits=lookupBits;
+  return 0;
+}
+
 int AliHLTHuffman::EnableDecodingMap()
 {
   // build decoder nodes from node tree
@@ -267,6 +267,38 @@ public:
         Bool_t FastDecodeMSB(std::bitset<64> bits, AliHLTUInt64_t& value,
 			     AliHLTUInt32_t& length, AliHLTUInt32_t& codeLength) const;
 
+	/// Build the flat encoding table and the decoding lookup table from the
+	/// huffman codes. The decoding table is indexed by the first lookupBits
+	/// bits of the input. Must be called before the table functions are used,
+	/// the tables are not modified afterwards and can be shared among threads
+	int InitCodingTables(UInt_t lookupBits=kDefaultLookupBits);
+	/// Check if the coding tables have been built
+	bool HasCodingTables() const {return !fEncodingTable.empty();}
+
+	/// Return huffman code for a value from the encoding table
+	/// the code is right aligned, the MSB is the first bit in the stream
+	bool EncodeTable(const AliHLTUInt64_t v, AliHLTUInt64_t& code, AliHLTUInt32_t& codeLength) const {
+	  if (v>=fEncodingTable.size()) {codeLength=0; return false;}
+	  code=fEncodingTable[v].fCode;
+	  codeLength=fEncodingTable[v].fLength;
+	  return codeLength>0;
+	}
+
+	/// Return value for bit pattern, MSB first, using the lookup table
+	/// codes longer than the table index fall back to the tree search
+	Bool_t DecodeTableMSB(AliHLTUInt64_t bits, AliHLTUInt64_t& value, AliHLTUInt32_t& codeLength) const {
+	  if (fDecodingTableBits>0) {
+	    const AliHuffmanLookupEntry& entry=fDecodingTable[bits>>(64-fDecodingTableBits)];
+	    if (entry.fLength>0) {
+	      value=entry.fValue;
+	      codeLength=entry.fLength;
+	      return kTRUE;
+	    }
+	  }
+	  AliHLTUInt32_t length=0;
+	  return DecodeMSB(bits, value, length, codeLength);
+	}
+
 	/// Add a new training value (with optional weight) to the training sample
 	Bool_t AddTrainingValue(const AliHLTUInt64_t value,
 			const Float_t weight = 1.);
@@ -293,6 +325,22 @@ public:
 
         int EnableDecodingMap();
 
+        /// entry of the flat encoding table
+        struct AliHuffmanCode {
+          AliHLTUInt64_t fCode;   // code, right aligned
+          AliHLTUInt32_t fLength; // code length
+        };
+
+        /// entry of the decoding lookup table, fLength=0 if the code is
+        /// longer than the table index
+        struct AliHuffmanLookupEntry {
+          AliHLTUInt64_t fValue;  // value
+          AliHLTUInt32_t fLength; // code length
+        };
+
+        /// default number of bits of the decoding table index, 2^10 entries
+        static const UInt_t kDefaultLookupBits=10;
+
 private:
         AliHuffmanDecodingNode* BuildDecodingNode(AliHLTHuffmanNode* node, vector<AliHuffmanDecodingNode>& decodingnodes) const;
 
@@ -304,6 +352,9 @@ private:
 	UInt_t fMaxCodeLength; //! maximum code length
 	std::vector<AliHuffmanDecodingNode> fDecodingNodes; //! array of reduced nodes
 	AliHuffmanDecodingNode* fDecodingTopNode; //! top node of reduced nodes
+	std::vector<AliHuffmanCode> fEncodingTable; //! flat encoding table
+	std::vector<AliHuffmanLookupEntry> fDecodingTable; //! decoding lookup table
+	UInt_t fDecodingTableBits; //! number of index bits of the decoding table
 
 ClassDef(AliHLTHuffman, 4)
 };
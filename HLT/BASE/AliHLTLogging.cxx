@@ -30,6 +30,9 @@
 #include <string>
 #include <sstream>
 #include <iostream>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using std::cout;
 using std::cerr;
@@ -38,6 +41,39 @@ using std::endl;
 /** ROOT macro for the implementation of ROOT specific class methods */
 ClassImp(AliHLTLogging);
 
+#ifdef _OPENMP
+namespace {
+  /// nestable lock of the log string buffers, created on first use to be
+  /// available for messages during the static initialization
+  omp_nest_lock_t* GetLoggingLock()
+  {
+    struct AliHLTLoggingNestLock {
+      AliHLTLoggingNestLock() : fLock() {omp_init_nest_lock(&fLock);}
+      ~AliHLTLoggingNestLock() {omp_destroy_nest_lock(&fLock);}
+      omp_nest_lock_t fLock;
+    };
+    static AliHLTLoggingNestLock lock;
+    return &lock.fLock;
+  }
+}
+#endif
+
+AliHLTLoggingLock::AliHLTLoggingLock()
+{
+  // see header file for class documentation
+#ifdef _OPENMP
+  omp_set_nest_lock(GetLoggingLock());
+#endif
+}
+
+AliHLTLoggingLock::~AliHLTLoggingLock()
+{
+  // see header file for class documentation
+#ifdef _OPENMP
+  omp_unset_nest_lock(GetLoggingLock());
+#endif
+}
+
 AliHLTLogging::AliHLTLogging()
   :
   fLocalLogFilter(fgLocalLogDefault),
@@ -330,6 +366,8 @@ int AliHLTLogging::Logging(AliHLTComponentLogSeverity severity,
   if (iResult>0) {
     va_list args;
     va_start(args, format);
+    {
+    AliHLTLoggingLock lock;
     if (fgLoggingFunc) {
       iResult = (*fgLoggingFunc)(NULL/*fParam*/, severity, origin, keyword, AliHLTLogging::BuildLogString(format, args ));
     } else {
@@ -338,6 +376,7 @@ int AliHLTLogging::Logging(AliHLTComponentLogSeverity severity,
       else
         iResult=Message(NULL/*fParam*/, severity, origin, keyword, AliHLTLogging::BuildLogString(format, args ));
     }
+    }
     va_end(args);
   }
   return iResult;
@@ -353,7 +392,12 @@ int AliHLTLogging::LoggingVarargs(AliHLTComponentLogSeverity severity,
   va_list args;
   va_start(args, line);
 
-  iResult=SendMessage(severity, originClass, originFunc, file, line, AliHLTLogging::BuildLogString(NULL, args ));
+  // the log string buffer is global, concurrently processed tasks
+  // must not interleave
+  {
+    AliHLTLoggingLock lock;
+    iResult=SendMessage(severity, originClass, originFunc, file, line, AliHLTLogging::BuildLogString(NULL, args ));
+  }
   va_end(args);
 
   return iResult;
@@ -397,5 +397,24 @@ class AliHLTKeyword {
   AliHLTLogging* fpParent;                                         //! transient
   const char* fpOriginal;                                          //! transient
 };
+
+/* the class AliHLTLoggingLock is a scoped lock of the global log string
+ * buffers for the concurrent task processing (AliHLTSystem option threads=n).
+ * It is held while a message is formatted and emitted. The lock is nestable:
+ * a message emitted by the same thread while the lock is held (message
+ * handler, error in SendMessage, AliHLTErrorGuard) does not block. Without
+ * OpenMP the lock is a no-op.
+ */
+class AliHLTLoggingLock {
+ public:
+  AliHLTLoggingLock();
+  ~AliHLTLoggingLock();
+
+ private:
+  /// copy constructor prohibited
+  AliHLTLoggingLock(const AliHLTLoggingLock&);
+  /// assignment operator prohibited
+  AliHLTLoggingLock& operator=(const AliHLTLoggingLock&);
+};
 #endif
 
@@ -46,6 +46,7 @@
 #include <TList.h>
 //#include <TSystem.h>
 #include <TROOT.h>
+#include <RVersion.h>
 //#include <TInterpreter.h>
 
 /** HLT default component libraries */
@@ -96,6 +97,8 @@ AliHLTSystem::AliHLTSystem(AliHLTComponentLogSeverity loglevel, const char* name
   , fECSParams()
   , fUseHLTOUTComponentTypeGlobal(true)
   , fDetMask(0)
+  , fNofThreads(1)
+  , fTaskLevels()
 {
   // see header file for class documentation
   // or
@@ -365,7 +368,9 @@ int AliHLTSystem::Run(Int_t iNofEvents, int bStop, AliHLTTriggerMask_t trgMask,
   SetStatusFlags(kRunning);
   if (fEventCount>=0 || (iResult=InitTasks())>=0) {
     if (fEventCount>=0 || (iResult=StartTasks())>=0) {
-      if (fEventCount==0) {
+      if (fEventCount==0 && fNofThreads<=1) {
+	// the stopwatches are shared among the components and can not be
+	// used with concurrent task processing
 	InitBenchmarking(fStopwatches);
       } else {
 	// Matthias Oct 11 2008 this is a bug
@@ -587,6 +592,9 @@ int AliHLTSystem::StartTasks()
   if (iResult<0) {
     HLTError("can not start task list, error %d", iResult);
   } else {
+    if (fNofThreads>1) {
+      HLTInfo("processing %d task level(s) with %d threads", BuildTaskLevels(), fNofThreads);
+    }
     SetStatusFlags(kStarted);
     fEventCount=0;
     fGoodEvents=0;
@@ -604,6 +612,9 @@ int AliHLTSystem::ProcessTasks(Int_t eventNo, AliHLTTriggerMask_t trgMask,
   // see header file for class documentation
   int iResult=0;
   HLTDebug("processing event no %d", eventNo);
+  if (fNofThreads>1 && fTaskLevels.size()>0) {
+    iResult=ProcessTaskLevels(eventNo, trgMask, timestamp, eventtype, participatingDetectors);
+  } else {
   TObjLink *lnk=fTaskList.FirstLink();
   while (lnk) {
     TObject* obj=lnk->GetObject();
@@ -621,6 +632,7 @@ int AliHLTSystem::ProcessTasks(Int_t eventNo, AliHLTTriggerMask_t trgMask,
     }
     lnk = lnk->Next();
   }
+  }
 
   if (iResult>=0) {
     HLTImportant("Event %d successfully finished (%d)", eventNo, iResult);
@@ -632,6 +644,65 @@ int AliHLTSystem::ProcessTasks(Int_t eventNo, AliHLTTriggerMask_t trgMask,
   return iResult;
 }
 
+int AliHLTSystem::BuildTaskLevels()
+{
+  // see header file for class documentation
+  fTaskLevels.clear();
+  vector<AliHLTTask*> tasks;
+  vector<unsigned> levels;
+  TObjLink *lnk=fTaskList.FirstLink();
+  for (; lnk!=NULL; lnk=lnk->Next()) {
+    AliHLTTask* pTask=dynamic_cast<AliHLTTask*>(lnk->GetObject());
+    if (!pTask) continue;
+    // the task list is ordered, all dependencies of a task are
+    // already in the list of processed tasks
+    unsigned level=0;
+    for (unsigned i=0; i<tasks.size(); i++) {
+      if (levels[i]<level) continue;
+      if (pTask->FindDependency(tasks[i]->GetName())==NULL) continue;
+      level=levels[i]+1;
+    }
+    tasks.push_back(pTask);
+    levels.push_back(level);
+    if (fTaskLevels.size()<=level) fTaskLevels.resize(level+1);
+    fTaskLevels[level].push_back(pTask);
+  }
+  return fTaskLevels.size();
+}
+
+int AliHLTSystem::ProcessTaskLevels(Int_t eventNo, AliHLTTriggerMask_t trgMask,
+				    AliHLTUInt32_t timestamp, AliHLTUInt32_t eventtype,
+				    AliHLTUInt32_t participatingDetectors)
+{
+  // see header file for class documentation
+  int iResult=0;
+  for (unsigned level=0; level<fTaskLevels.size(); level++) {
+    vector<AliHLTTask*>& tasks=fTaskLevels[level];
+    int nofTasks=tasks.size();
+    int iLevelResult=0;
+    // all tasks of the level are processed or skipped, the error of a task
+    // is propagated to the following levels
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(fNofThreads) schedule(dynamic,1) if(nofTasks > 1)
+#endif
+    for (int i=0; i<nofTasks; i++) {
+      if (iResult>=0) {
+	int iTaskResult=tasks[i]->ProcessTask(eventNo, eventtype, trgMask, timestamp, participatingDetectors);
+	if (iTaskResult<0) {
+#ifdef _OPENMP
+#pragma omp critical(AliHLTSystemProcessTaskLevels)
+#endif
+	  if (iLevelResult>=0) iLevelResult=iTaskResult;
+	}
+      } else {
+	tasks[i]->SubscribeSourcesAndSkip();
+      }
+    }
+    if (iResult>=0) iResult=iLevelResult;
+  }
+  return iResult;
+}
+
 int AliHLTSystem::StopTasks()
 {
   // see header file for class documentation
@@ -661,6 +732,7 @@ int AliHLTSystem::StopTasks()
     lnk = lnk->Next();
   }
   PrintBenchmarking(fStopwatches, 1 /*clean*/);
+  fTaskLevels.clear();
   if (fEventCount!=fGoodEvents) {
     HLTError("%d out of %d event(s) failed", fEventCount-fGoodEvents, fEventCount);
   }
@@ -1285,6 +1357,22 @@ int AliHLTSystem::ScanOptions(const char* options)
 	  // HLTOUTComponent type 'global' where the data generation is steered from global
 	  // flags
 	  fUseHLTOUTComponentTypeGlobal=token.CompareTo("hltout-mode=split")!=0;
+	} else if (token.BeginsWith("threads=")) {
+	  TString param=token.ReplaceAll("threads=", "");
+	  if (param.IsDigit()) {
+#ifdef _OPENMP
+	    SetNofThreads(param.Atoi());
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,6,0)
+	    if (fNofThreads>1) ROOT::EnableThreadSafety();
+#endif
+#else
+	    HLTWarning("built without OpenMP support, ignoring option \'threads=\'");
+#endif
+	  } else {
+	    HLTWarning("wrong parameter for option \'threads=\', number expected");
+	  }
+	} else if (token.CompareTo("arena-allocation")==0) {
+	  AliHLTDataBuffer::SetArenaAllocation(true);
 	} else if (token.BeginsWith("lib") && token.EndsWith(".so")) {
 	  libs+=token;
 	  libs+=" ";
@@ -1668,9 +1756,12 @@ int AliHLTSystem::LoggingVarargs(AliHLTComponentLogSeverity severity,
   va_list args;
   va_start(args, line);
 
-  if (!fName.IsNull())
-    AliHLTLogging::SetLogString(this, " (%p)", "%s_pfmt_: ", fName.Data());
-  iResult=SendMessage(severity, originClass, originFunc, file, line, AliHLTLogging::BuildLogString(NULL, args, !fName.IsNull() /*append if non empty*/));
+  {
+    AliHLTLoggingLock lock;
+    if (!fName.IsNull())
+      AliHLTLogging::SetLogString(this, " (%p)", "%s_pfmt_: ", fName.Data());
+    iResult=SendMessage(severity, originClass, originFunc, file, line, AliHLTLogging::BuildLogString(NULL, args, !fName.IsNull() /*append if non empty*/));
+  }
   va_end(args);
 
   return iResult;
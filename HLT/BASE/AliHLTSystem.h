@@ -73,6 +73,7 @@
  *
  */
 
+#include <vector>
 #include "AliHLTLogging.h"
 #include <TList.h>
 #include <TString.h>
@@ -289,6 +290,30 @@ class AliHLTSystem : public AliHLTLogging {
 		   AliHLTUInt32_t timestamp, AliHLTUInt32_t eventtype,
 		   AliHLTUInt32_t participatingDetectors = 0);
 
+  /**
+   * Set the number of threads for concurrent task processing.
+   * With more than one thread, tasks which do not depend on each other
+   * are processed concurrently, see @ref ProcessTaskLevels. All components
+   * of the chain must be re-entrant, i.e. must not share global state.
+   * The default is 1, serial processing in the order of the task list.
+   *
+   * Protected by the framework: the data buffers of the tasks and the
+   * global raw pages (AliHLTTask buffer lock), the log string buffers
+   * (AliHLTLoggingLock) and the stopwatch guard chain (thread private).
+   * Not protected, touched from the worker threads by components and
+   * therefore not allowed in concurrently processed tasks:
+   * - OCDB access during event processing (AliCDBManager, AliHLTMisc
+   *   instance, e.g. reconfiguration events)
+   * - gRandom, gGeoManager, gDirectory and ROOT file I/O
+   * - static or singleton members of the component classes, and the
+   *   component handler and global logging settings (log filters,
+   *   logging function), which may only be changed outside of Run
+   */
+  void SetNofThreads(int nofThreads) {fNofThreads=nofThreads>0?nofThreads:1;}
+
+  /// get the number of threads for the task processing
+  int GetNofThreads() const {return fNofThreads;}
+
   /**
    * Stop task list.
    * The @ref AliHLTTask::EndRun method is called for each task, the components
@@ -536,6 +561,12 @@ class AliHLTSystem : public AliHLTLogging {
    * \li libmode=<i>static,dynamic(default)</i>
    *     libraries are persistent if loaded in mode <i>static</i>, i.e. they
    *     can't be unloaded
+   * \li threads=<i>n</i>
+   *     number of threads for concurrent processing of independent tasks,
+   *     requires OpenMP and re-entrant components, see SetNofThreads
+   * \li arena-allocation
+   *     output buffers are allocated from a per-event arena in the raw
+   *     pages, see AliHLTDataBuffer::SetArenaAllocation
    */
   int ScanOptions(const char* options);
 
@@ -639,6 +670,24 @@ class AliHLTSystem : public AliHLTLogging {
    */
   int BuildTaskList(AliHLTConfiguration* pConf);
 
+  /**
+   * Group the tasks by dependency level.
+   * Level 0 contains all tasks without dependencies, a task of level n
+   * depends at least on one task of level n-1 and on no task of level >= n.
+   * @return number of levels
+   */
+  int BuildTaskLevels();
+
+  /**
+   * Process the tasks level by level, the tasks of one level are processed
+   * concurrently by fNofThreads threads. Data buffer access of the tasks is
+   * serialized in AliHLTTask.
+   * @return neg error code if one of the tasks failed
+   */
+  int ProcessTaskLevels(Int_t eventNo, AliHLTTriggerMask_t trgMask,
+			AliHLTUInt32_t timestamp, AliHLTUInt32_t eventtype,
+			AliHLTUInt32_t participatingDetectors);
+
   /**
    * Set status flags.
    */
@@ -721,6 +770,12 @@ class AliHLTSystem : public AliHLTLogging {
   /// detector mask
   UInt_t fDetMask;                                                 //!transient
 
+  /// number of threads for the task processing
+  int fNofThreads;                                                 //!transient
+
+  /// tasks grouped by dependency level, tasks of one level are independent
+  std::vector<std::vector<AliHLTTask*> > fTaskLevels;              //!transient
+
   ClassDef(AliHLTSystem, 0);
 };
 
@@ -31,12 +31,49 @@
 #include "AliHLTConfigurationHandler.h"
 #include "AliHLTComponent.h"
 #include "AliHLTComponentHandler.h"
+#include "AliHLTComponentBenchmark.h"
 #include "AliHLTBaseVGRPAccess.h"
 #include "TList.h"
 #include "AliHLTErrorGuard.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using std::cout;
 
+namespace {
+  /**
+   * Scoped lock for the data buffer access of concurrently processed tasks,
+   * see AliHLTSystem::ProcessTaskLevels. The consumer tasks of one source
+   * subscribe and release concurrently, and the raw buffer pages are global.
+   * The lock is nestable since releasing a forwarded block releases the
+   * block in the original source task.
+   */
+  class AliHLTTaskBufferLock {
+  public:
+#ifdef _OPENMP
+    AliHLTTaskBufferLock() {omp_set_nest_lock(&fgLock.fLock);}
+    ~AliHLTTaskBufferLock() {omp_unset_nest_lock(&fgLock.fLock);}
+#else
+    AliHLTTaskBufferLock() {}
+#endif
+  private:
+    AliHLTTaskBufferLock(const AliHLTTaskBufferLock&);
+    AliHLTTaskBufferLock& operator=(const AliHLTTaskBufferLock&);
+#ifdef _OPENMP
+    struct AliHLTNestLock {
+      AliHLTNestLock() : fLock() {omp_init_nest_lock(&fLock);}
+      ~AliHLTNestLock() {omp_destroy_nest_lock(&fLock);}
+      omp_nest_lock_t fLock;
+    };
+    static AliHLTNestLock fgLock;
+#endif
+  };
+#ifdef _OPENMP
+  AliHLTTaskBufferLock::AliHLTNestLock AliHLTTaskBufferLock::fgLock;
+#endif
+}
+
 /** ROOT macro for the implementation of ROOT specific class methods */
 ClassImp(AliHLTTask)
 
@@ -47,7 +84,8 @@ AliHLTTask::AliHLTTask()
   fpDataBuffer(NULL),
   fListTargets(),
   fListDependencies(),
-  fBlockDataArray()
+  fBlockDataArray(),
+  fpBenchmark(NULL)
 {
   // see header file for class documentation
   // or
@@ -63,7 +101,8 @@ AliHLTTask::AliHLTTask(AliHLTConfiguration* pConf)
   fpDataBuffer(NULL),
   fListTargets(),
   fListDependencies(),
-  fBlockDataArray()
+  fBlockDataArray(),
+  fpBenchmark(NULL)
 {
   // see header file for function documentation
 }
@@ -88,6 +127,8 @@ AliHLTTask::~AliHLTTask()
 
   if (fpComponent) delete fpComponent;
   fpComponent=NULL;
+  if (fpBenchmark) delete fpBenchmark;
+  fpBenchmark=NULL;
 }
 
 int AliHLTTask::Init(AliHLTConfiguration* pConf, AliHLTComponentHandler* pCH)
@@ -420,6 +461,10 @@ int AliHLTTask::StartRun()
 	  iResult=-ENOMEM;
 	}
       }
+      if (iResult>=0) {
+	if (fpBenchmark) delete fpBenchmark;
+	fpBenchmark=new AliHLTComponentBenchmark(GetName());
+      }
     }
     if (iResult>=0) {
       // send the SOR event
@@ -444,6 +489,13 @@ int AliHLTTask::EndRun()
     fpDataBuffer=NULL;
     delete pBuffer;
   }
+  if (fpBenchmark) {
+    if (fpBenchmark->GetNRetries()>0 || fpBenchmark->GetNReallocations()>0) {
+      HLTBenchmark("%s", fpBenchmark->GetStatistics());
+    }
+    delete fpBenchmark;
+    fpBenchmark=NULL;
+  }
   return iResult;
 }
 
@@ -455,7 +507,10 @@ int AliHLTTask::ProcessTask(Int_t eventNo, AliHLTUInt32_t eventType, AliHLTTrigg
   AliHLTComponent* pComponent=GetComponent();
   if (pComponent && fpDataBuffer) {
     HLTDebug("Processing task %s (%p) fpDataBuffer %p", GetName(), this, fpDataBuffer);
-    fpDataBuffer->Reset();
+    {
+      AliHLTTaskBufferLock lock;
+      fpDataBuffer->Reset();
+    }
     int iSourceDataBlock=0;
     int iInputDataVolume=0;
 
@@ -556,8 +611,17 @@ int AliHLTTask::ProcessTask(Int_t eventNo, AliHLTUInt32_t eventType, AliHLTTrigg
 	fInputMultiplier=0;
       }
       iOutputDataSize=(long unsigned int)(fInputMultiplier*iInputDataVolume) + iConstBase;
+      // the size learned from previous events overrides a too small estimate
+      if (pComponent->GetComponentType()!=AliHLTComponent::kSink) {
+	long unsigned int iHint=pComponent->GetOutputSizeHint(iInputDataVolume);
+	if (iHint>iOutputDataSize) iOutputDataSize=iHint;
+      }
       //HLTDebug("task %s: reqired output size %d", GetName(), iOutputDataSize);
       }
+      if (iNofTrial>0 && iOutputDataSize<=iLastOutputDataSize) {
+	// the estimate did not change, double the buffer for the next attempt
+	iOutputDataSize=2*(long unsigned int)iLastOutputDataSize;
+      }
       if (fpDataBuffer->GetMaxBufferSize() < iOutputDataSize) {
 
         //If the estimated buffer size exceeds the maximum buffer size of AliHLTRawBuffer, decrease the buffer size.
@@ -569,9 +633,19 @@ int AliHLTTask::ProcessTask(Int_t eventNo, AliHLTUInt32_t eventType, AliHLTTrigg
 	// dont process again if the buffer size is the same
 	if (iLastOutputDataSize>=iOutputDataSize) break;
 	HLTImportant("processing event %d again with buffer size %d", eventNo, iOutputDataSize);
+	if (fpBenchmark) fpBenchmark->AddRetry();
       }
       AliHLTUInt8_t* pTgtBuffer=NULL;
-      if (iOutputDataSize>0) pTgtBuffer=fpDataBuffer->GetTargetBuffer(iOutputDataSize);
+      AliHLTUInt32_t iNofPageAllocations=0;
+      if (iOutputDataSize>0) {
+	AliHLTTaskBufferLock lock;
+	iNofPageAllocations=AliHLTDataBuffer::GetNofPageAllocations();
+	pTgtBuffer=fpDataBuffer->GetTargetBuffer(iOutputDataSize);
+	iNofPageAllocations=AliHLTDataBuffer::GetNofPageAllocations()-iNofPageAllocations;
+      }
+      if (fpBenchmark && iNofPageAllocations>0) {
+	fpBenchmark->AddReallocation();
+      }
       //HLTDebug("provided raw buffer %p", pTgtBuffer);
       AliHLTComponentEventData evtData;
       AliHLTComponent::FillEventData(evtData);
@@ -638,6 +712,11 @@ int AliHLTTask::ProcessTask(Int_t eventNo, AliHLTUInt32_t eventType, AliHLTTrigg
 	evtData.fBlockCnt=fBlockDataArray.size();
 	iResult=pComponent->ProcessEvent(evtData, &fBlockDataArray[0], trigData, pTgtBuffer, size, outputBlockCnt, outputBlocks, edd);
 	HLTDebug("component %s ProcessEvent finnished (%d): size=%d blocks=%d", pComponent->GetComponentID(), iResult, size, outputBlockCnt);
+	if (fpBenchmark && iResult>=0) {
+	  fpBenchmark->StartNewEvent();
+	  fpBenchmark->AddInput(iInputDataVolume);
+	  fpBenchmark->AddOutput(size);
+	}
 
 	// EventDoneData is for the moment ignored in AliHLTSystem
 	if (edd) {
@@ -727,6 +806,7 @@ int AliHLTTask::ProcessTask(Int_t eventNo, AliHLTUInt32_t eventType, AliHLTTrigg
 	      if (iblock==fBlockDataArray.size()) segments.push_back(outputBlocks[oblock]);
 	    }
 	    if (pTgtBuffer && segments.size()>0) {
+	      AliHLTTaskBufferLock lock;
 	      iResult=fpDataBuffer->SetSegments(pTgtBuffer, &segments[0], segments.size());
 	    }
 	  } else {
@@ -736,6 +816,7 @@ int AliHLTTask::ProcessTask(Int_t eventNo, AliHLTUInt32_t eventType, AliHLTTrigg
 	  }
 	  delete [] outputBlocks; outputBlocks=NULL; outputBlockCnt=0;
 	} else {
+	  AliHLTTaskBufferLock lock;
 	  fpDataBuffer->Reset();
 	}
 	if (fListTargets.First()!=NULL) {
@@ -759,7 +840,7 @@ int AliHLTTask::ProcessTask(Int_t eventNo, AliHLTUInt32_t eventType, AliHLTTrigg
 	HLTFatal("no target buffer available");
 	iResult=-EFAULT;
       }
-    } while (iResult==-ENOSPC && iNofTrial++<1);
+    } while (iResult==-ENOSPC && ++iNofTrial<fgkMaxProcessingTrials);
     }
 
     if (CheckFilter(kHLTLogDebug)) Print("proc");
@@ -802,7 +883,10 @@ int AliHLTTask::SubscribeSourcesAndSkip()
   AliHLTTaskPList subscribedTaskList;
 
   // cleanup the data buffer
-  if (fpDataBuffer) fpDataBuffer->Reset();
+  if (fpDataBuffer) {
+    AliHLTTaskBufferLock lock;
+    fpDataBuffer->Reset();
+  }
 
   // subscribe to all source tasks
   fBlockDataArray.clear();
@@ -851,6 +935,7 @@ int AliHLTTask::GetNofMatchingDataBlocks(const AliHLTTask* pConsumerTask) const
   int iResult=0;
   if (pConsumerTask) {
     if (fpDataBuffer) {
+      AliHLTTaskBufferLock lock;
       iResult=fpDataBuffer->FindMatchingDataBlocks(pConsumerTask->GetComponent(), NULL);
     } else {
       HLTFatal("internal data buffer missing");
@@ -891,6 +976,7 @@ int AliHLTTask::Subscribe(const AliHLTTask* pConsumerTask, AliHLTComponentBlockD
   int iResult=0;
   if (pConsumerTask) {
     if (fpDataBuffer) {
+      AliHLTTaskBufferLock lock;
       iResult=fpDataBuffer->Subscribe(pConsumerTask->GetComponent(), blockDescList);
     } else {
       HLTFatal("internal data buffer missing");
@@ -908,6 +994,7 @@ int AliHLTTask::Release(AliHLTComponentBlockData* pBlockDesc, const AliHLTTask*
   int iResult=0;
   if (pConsumerTask && pBlockDesc) {
     if (fpDataBuffer) {
+      AliHLTTaskBufferLock lock;
       iResult=fpDataBuffer->Release(pBlockDesc, pConsumerTask->GetComponent(), this);
     } else {
       HLTFatal("internal data buffer missing");
@@ -1002,8 +1089,11 @@ int AliHLTTask::LoggingVarargs(AliHLTComponentLogSeverity severity,
   va_list args;
   va_start(args, line);
 
-  AliHLTLogging::SetLogString(this, " (%p)", "%s_pfmt_: ", GetName());
-  iResult=SendMessage(severity, originClass, originFunc, file, line, AliHLTLogging::BuildLogString(NULL, args, true /*append*/));
+  {
+    AliHLTLoggingLock lock;
+    AliHLTLogging::SetLogString(this, " (%p)", "%s_pfmt_: ", GetName());
+    iResult=SendMessage(severity, originClass, originFunc, file, line, AliHLTLogging::BuildLogString(NULL, args, true /*append*/));
+  }
   va_end(args);
 
   return iResult;
@@ -25,6 +25,7 @@ using std::vector;
 struct AliHLTComponentBlockData;
 class AliHLTComponent;
 class AliHLTComponentHandler;
+class AliHLTComponentBenchmark;
 class AliHLTConfiguration;
 class AliHLTTask;
 
@@ -342,6 +343,16 @@ class AliHLTTask : public TObject, public AliHLTLogging {
    */
   vector<AliHLTComponentBlockData> fBlockDataArray;               //! transient
 
+  /**
+   * Output buffer statistics, processing retries because of too small
+   * buffer and allocation of new buffer pages.
+   * Created in @ref StartRun, printed and deleted in @ref EndRun.
+   */
+  AliHLTComponentBenchmark* fpBenchmark;                          //! transient
+
+  /** maximum number of processing attempts if component returns -ENOSPC */
+  static const int fgkMaxProcessingTrials=4;
+
   ClassDef(AliHLTTask, 0);
 };
 
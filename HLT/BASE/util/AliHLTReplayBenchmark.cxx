@@ -0,0 +1,582 @@
+// $Id$
+
+//**************************************************************************
+//* This file is property of and copyright by the ALICE HLT Project        *
+//* ALICE Experiment at CERN, All rights reserved.                         *
+//*                                                                        *
+//* Primary Authors:                                                       *
+//*                  for The ALICE HLT Project.                            *
+//*                                                                        *
+//* Permission to use, copy, modify and distribute this software and its   *
+//* documentation strictly for non-commercial purposes is hereby granted   *
+//* without fee, provided that the above copyright notice appears in all   *
+//* copies and that both the copyright notice and this permission notice   *
+//* appear in the supporting documentation. The authors make no claims     *
+//* about the suitability of this software for any purpose. It is          *
+//* provided "as is" without express or implied warranty.                  *
+//**************************************************************************
+
+/** @file   AliHLTReplayBenchmark.cxx
+    @brief  Standalone benchmark of one HLT component on recorded input
+*/
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#if defined(__linux__)
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include "AliHLTReplayBenchmark.h"
+#include "AliHLTComponent.h"
+#include "AliHLTComponentHandler.h"
+#include "AliHLTSystem.h"
+#include "AliHLTOUT.h"
+#include "AliRawReader.h"
+#include "TFile.h"
+#include "TNtupleD.h"
+#include "TNamed.h"
+#include "TObjArray.h"
+#include "TObjString.h"
+#include "TMath.h"
+
+using std::cout;
+using std::endl;
+
+/** ROOT macro for the implementation of ROOT specific class methods */
+ClassImp(AliHLTReplayBenchmark)
+
+namespace {
+  // the measurement struct as ntuple, same order as the members
+  const char* gkReplayVariables="event:repetition:realtime:cputime:input:output:trials:heap:cachemisses:instructions:cycles";
+
+  double ClockTime(clockid_t clock)
+  {
+    // time in us
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec*1e6 + ts.tv_nsec*1e-3;
+  }
+
+  double HeapInUse()
+  {
+    // allocated heap memory, 0 if not available
+#if defined(__GLIBC__)
+    struct mallinfo info=mallinfo();
+    return (double)(unsigned)info.uordblks + (double)(unsigned)info.hblkhd;
+#else
+    return 0.;
+#endif
+  }
+}
+
+AliHLTReplayBenchmark::AliHLTReplayBenchmark()
+  : AliHLTLogging()
+  , fpComponentHandler(NULL)
+  , fpComponent(NULL)
+  , fTitle()
+  , fEvents()
+  , fOutputBuffer()
+  , fMeasurements()
+  , fEventCount(0)
+{
+  // see header file for class documentation
+  for (int i=0; i<3; i++) fCounterFds[i]=-1;
+}
+
+AliHLTReplayBenchmark::~AliHLTReplayBenchmark()
+{
+  // see header file for class documentation
+  if (fpComponent) {
+    SendRunEvent(gkAliEventTypeEndOfRun);
+    fpComponent->Deinit();
+    delete fpComponent;
+  }
+  fpComponent=NULL;
+  if (fpComponentHandler) delete fpComponentHandler;
+  fpComponentHandler=NULL;
+  CloseCounters();
+}
+
+int AliHLTReplayBenchmark::SetComponent(const char* componentId, const char* arguments, const char* libraries)
+{
+  // see header file for class documentation
+  if (!componentId) return -EINVAL;
+  int iResult=0;
+  if (!fpComponentHandler) {
+    fpComponentHandler=new AliHLTComponentHandler;
+    AliHLTAnalysisEnvironment env;
+    memset(&env, 0, sizeof(AliHLTAnalysisEnvironment));
+    env.fStructSize=sizeof(AliHLTAnalysisEnvironment);
+    env.fAllocMemoryFunc=AliHLTSystem::AllocMemory;
+    env.fGetEventDoneDataFunc=AliHLTSystem::AllocEventDoneData;
+    fpComponentHandler->SetEnvironment(&env);
+  }
+  if (libraries) {
+    TString libs=libraries;
+    TObjArray* pTokens=libs.Tokenize(" ");
+    for (int i=0; pTokens && i<pTokens->GetEntriesFast() && iResult>=0; i++) {
+      iResult=fpComponentHandler->LoadLibrary(((TObjString*)pTokens->At(i))->GetString().Data());
+    }
+    delete pTokens;
+    if (iResult<0) return iResult;
+  }
+
+  TString args=arguments;
+  TObjArray* pTokens=args.Tokenize(" ");
+  std::vector<const char*> argv;
+  for (int i=0; pTokens && i<pTokens->GetEntriesFast(); i++) {
+    argv.push_back(((TObjString*)pTokens->At(i))->GetString().Data());
+  }
+  if (fpComponent) {
+    fpComponent->Deinit();
+    delete fpComponent;
+    fpComponent=NULL;
+  }
+  iResult=fpComponentHandler->CreateComponent(componentId, NULL, argv.size(), argv.size()>0?&argv[0]:NULL, fpComponent);
+  delete pTokens;
+  if (iResult<0 || !fpComponent) {
+    HLTError("can not create component %s with arguments '%s'", componentId, arguments);
+    return iResult<0?iResult:-ENOENT;
+  }
+  fTitle.Form("%s %s", componentId, arguments);
+  fEventCount=0;
+  return SendRunEvent(gkAliEventTypeStartOfRun);
+}
+
+int AliHLTReplayBenchmark::AddEvent(AliHLTOUT* pHLTOUT, AliHLTComponentDataType dt, AliHLTUInt32_t spec)
+{
+  // see header file for class documentation
+  if (!pHLTOUT) return -EINVAL;
+  AliHLTReplayEvent event;
+  for (int iResult=pHLTOUT->SelectFirstDataBlock(dt, spec);
+       iResult>=0;
+       iResult=pHLTOUT->SelectNextDataBlock()) {
+    AliHLTReplayBlock block;
+    pHLTOUT->GetDataBlockDescription(block.fDataType, block.fSpecification);
+    const AliHLTUInt8_t* pBuffer=NULL;
+    AliHLTUInt32_t size=0;
+    if (pHLTOUT->GetDataBuffer(pBuffer, size)<0) continue;
+    block.fOffset=event.fBuffer.size();
+    block.fSize=size;
+    event.fBuffer.insert(event.fBuffer.end(), pBuffer, pBuffer+size);
+    event.fBlocks.push_back(block);
+    pHLTOUT->ReleaseDataBuffer(pBuffer);
+  }
+  fEvents.push_back(event);
+  return event.fBlocks.size();
+}
+
+int AliHLTReplayBenchmark::AddEventsFromRawData(const char* input, AliHLTComponentDataType dt, AliHLTUInt32_t spec, int maxEvents)
+{
+  // see header file for class documentation
+  if (!input) return -EINVAL;
+  int nEvents=0;
+  TString name=input;
+  if (name.EndsWith("Digits.root")) {
+    // HLT digit file from simulation
+    for (; maxEvents<0 || nEvents<maxEvents; nEvents++) {
+      AliHLTOUT* pHLTOUT=AliHLTOUT::New(input, nEvents);
+      if (!pHLTOUT) break;
+      int iResult=pHLTOUT->Init();
+      if (iResult>=0) AddEvent(pHLTOUT, dt, spec);
+      AliHLTOUT::Delete(pHLTOUT);
+      if (iResult<0) break;
+    }
+    return nEvents;
+  }
+
+  AliRawReader* pRawReader=AliRawReader::Create(input);
+  if (!pRawReader) {
+    HLTError("can not open raw data %s", input);
+    return -ENOENT;
+  }
+  while ((maxEvents<0 || nEvents<maxEvents) && pRawReader->NextEvent()) {
+    AliHLTOUT* pHLTOUT=AliHLTOUT::New(pRawReader);
+    if (!pHLTOUT) break;
+    if (pHLTOUT->Init()>=0) {
+      AddEvent(pHLTOUT, dt, spec);
+      nEvents++;
+    }
+    AliHLTOUT::Delete(pHLTOUT);
+  }
+  delete pRawReader;
+  return nEvents;
+}
+
+int AliHLTReplayBenchmark::AddBlockFromFile(const char* filename, AliHLTComponentDataType dt, AliHLTUInt32_t spec, int event)
+{
+  // see header file for class documentation
+  std::ifstream input(filename, std::ios::binary);
+  if (!input.good()) {
+    HLTError("can not open file %s", filename);
+    return -ENOENT;
+  }
+  input.seekg(0, std::ios::end);
+  AliHLTUInt32_t size=input.tellg();
+  input.seekg(0, std::ios::beg);
+
+  if (event<0 || event>=(int)fEvents.size()) {
+    fEvents.push_back(AliHLTReplayEvent());
+    event=fEvents.size()-1;
+  }
+  AliHLTReplayEvent& target=fEvents[event];
+  AliHLTReplayBlock block;
+  block.fDataType=dt;
+  block.fSpecification=spec;
+  block.fOffset=target.fBuffer.size();
+  block.fSize=size;
+  target.fBuffer.resize(block.fOffset+size);
+  if (size>0) input.read(reinterpret_cast<char*>(&target.fBuffer[block.fOffset]), size);
+  target.fBlocks.push_back(block);
+  return event;
+}
+
+int AliHLTReplayBenchmark::Run(int nRepetitions, int nWarmup)
+{
+  // see header file for class documentation
+  if (!fpComponent) {
+    HLTError("no component, call SetComponent first");
+    return -ENODEV;
+  }
+  if (fEvents.size()==0) {
+    HLTWarning("no input events");
+    return 0;
+  }
+  OpenCounters();
+  int iResult=0;
+  for (int rep=-nWarmup; rep<nRepetitions && iResult>=0; rep++) {
+    for (unsigned event=0; event<fEvents.size() && iResult>=0; event++) {
+      AliHLTReplayMeasurement measurement;
+      iResult=ProcessEvent(fEvents[event], gkAliEventTypeData, rep>=0?&measurement:NULL);
+      if (rep<0) continue;
+      measurement.fEvent=event;
+      measurement.fRepetition=rep;
+      fMeasurements.push_back(measurement);
+    }
+  }
+  CloseCounters();
+  if (iResult<0) {
+    HLTError("processing failed with error %d", iResult);
+    return iResult;
+  }
+  return fMeasurements.size();
+}
+
+int AliHLTReplayBenchmark::ProcessEvent(AliHLTReplayEvent& event, AliHLTUInt32_t eventType, AliHLTReplayMeasurement* measurement)
+{
+  // see header file for class documentation
+  std::vector<AliHLTComponentBlockData> blocks;
+  AliHLTUInt32_t inputSize=0;
+  for (unsigned i=0; i<event.fBlocks.size(); i++) {
+    AliHLTComponentBlockData bd;
+    AliHLTComponent::FillBlockData(bd);
+    bd.fPtr=event.fBuffer.size()>0?&event.fBuffer[0]:NULL;
+    bd.fOffset=event.fBlocks[i].fOffset;
+    bd.fSize=event.fBlocks[i].fSize;
+    bd.fDataType=event.fBlocks[i].fDataType;
+    bd.fSpecification=event.fBlocks[i].fSpecification;
+    blocks.push_back(bd);
+    inputSize+=bd.fSize;
+  }
+  // event type block as added by the AliHLTTask
+  AliHLTComponentBlockData eventTypeBlock;
+  AliHLTComponent::FillBlockData(eventTypeBlock);
+  eventTypeBlock.fDataType=kAliHLTDataTypeEvent;
+  eventTypeBlock.fSpecification=eventType;
+  blocks.push_back(eventTypeBlock);
+
+  AliHLTComponentEventData evtData;
+  AliHLTComponent::FillEventData(evtData);
+  evtData.fEventID=fEventCount++;
+  evtData.fEventCreation_s=static_cast<AliHLTUInt32_t>(time(NULL));
+  evtData.fBlockCnt=blocks.size();
+  AliHLTComponentTriggerData trigData;
+  AliHLTEventTriggerData evtTrigData;
+  memset(&evtTrigData, 0, sizeof(evtTrigData));
+  evtTrigData.fCommonHeaderWordCnt=gkAliHLTCommonHeaderCount;
+  trigData.fStructSize=sizeof(trigData);
+  trigData.fDataSize=sizeof(AliHLTEventTriggerData);
+  trigData.fData=&evtTrigData;
+
+  // output buffer as estimated in the AliHLTTask
+  unsigned long constBase=0;
+  double inputMultiplier=0;
+  fpComponent->GetOutputDataSize(constBase, inputMultiplier);
+  unsigned long outputSize=(unsigned long)(inputMultiplier*inputSize)+constBase;
+  unsigned long hint=fpComponent->GetOutputSizeHint(inputSize);
+  if (hint>outputSize) outputSize=hint;
+
+  int iResult=0;
+  int nofTrials=0;
+  Double_t countersStart[3]={-1., -1., -1.};
+  Double_t countersStop[3]={-1., -1., -1.};
+  double realTime=0;
+  double cpuTime=0;
+  double heapStart=HeapInUse();
+  AliHLTUInt32_t size=0;
+  do {
+    if (nofTrials>0) outputSize*=2;
+    if (fOutputBuffer.size()<outputSize) fOutputBuffer.resize(outputSize);
+    size=outputSize;
+    AliHLTUInt32_t outputBlockCnt=0;
+    AliHLTComponentBlockData* outputBlocks=NULL;
+    AliHLTComponentEventDoneData* edd=NULL;
+
+    ReadCounters(countersStart);
+    double realStart=ClockTime(CLOCK_MONOTONIC);
+    double cpuStart=ClockTime(CLOCK_PROCESS_CPUTIME_ID);
+    iResult=fpComponent->ProcessEvent(evtData, &blocks[0], trigData,
+                                      fOutputBuffer.size()>0?&fOutputBuffer[0]:NULL,
+                                      size, outputBlockCnt, outputBlocks, edd);
+    cpuTime+=ClockTime(CLOCK_PROCESS_CPUTIME_ID)-cpuStart;
+    realTime+=ClockTime(CLOCK_MONOTONIC)-realStart;
+    ReadCounters(countersStop);
+
+    delete [] outputBlocks;
+    if (edd) delete [] reinterpret_cast<char*>(edd);
+  } while (iResult==-ENOSPC && ++nofTrials<fgkMaxProcessingTrials);
+
+  if (measurement) {
+    measurement->fRealTime=realTime;
+    measurement->fCpuTime=cpuTime;
+    measurement->fInputSize=inputSize;
+    measurement->fOutputSize=iResult>=0?size:0;
+    measurement->fNofTrials=nofTrials;
+    measurement->fHeapGrowth=HeapInUse()-heapStart;
+    // the counters cover the last trial only
+    measurement->fCacheMisses=countersStart[0]<0?-1.:countersStop[0]-countersStart[0];
+    measurement->fInstructions=countersStart[1]<0?-1.:countersStop[1]-countersStart[1];
+    measurement->fCycles=countersStart[2]<0?-1.:countersStop[2]-countersStart[2];
+  }
+  return iResult;
+}
+
+int AliHLTReplayBenchmark::SendRunEvent(AliHLTUInt32_t eventType)
+{
+  // see header file for class documentation
+  AliHLTReplayEvent event;
+  AliHLTRunDesc runDesc;
+  memset(&runDesc, 0, sizeof(runDesc));
+  runDesc.fStructSize=sizeof(runDesc);
+  AliHLTReplayBlock block;
+  block.fDataType=eventType==gkAliEventTypeStartOfRun?kAliHLTDataTypeSOR:kAliHLTDataTypeEOR;
+  block.fSpecification=kAliHLTVoidDataSpec;
+  block.fOffset=0;
+  block.fSize=sizeof(runDesc);
+  event.fBuffer.resize(sizeof(runDesc));
+  memcpy(&event.fBuffer[0], &runDesc, sizeof(runDesc));
+  event.fBlocks.push_back(block);
+  return ProcessEvent(event, eventType, NULL);
+}
+
+int AliHLTReplayBenchmark::OpenCounters()
+{
+  // open cache miss, instruction and cycle counters for this process,
+  // not available without kernel support or permission
+  int nCounters=0;
+#if defined(__linux__)
+  const unsigned long long configs[3]={
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CPU_CYCLES
+  };
+  for (int i=0; i<3; i++) {
+    if (fCounterFds[i]>=0) {nCounters++; continue;}
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size=sizeof(attr);
+    attr.type=PERF_TYPE_HARDWARE;
+    attr.config=configs[i];
+    attr.exclude_kernel=1;
+    attr.exclude_hv=1;
+    attr.inherit=1;
+    fCounterFds[i]=syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fCounterFds[i]>=0) nCounters++;
+  }
+  if (nCounters==0) {
+    HLTInfo("hardware counters not available, check /proc/sys/kernel/perf_event_paranoid");
+  }
+#endif
+  return nCounters;
+}
+
+void AliHLTReplayBenchmark::CloseCounters()
+{
+  // see header file for class documentation
+  for (int i=0; i<3; i++) {
+    if (fCounterFds[i]>=0) close(fCounterFds[i]);
+    fCounterFds[i]=-1;
+  }
+}
+
+void AliHLTReplayBenchmark::ReadCounters(Double_t* values) const
+{
+  // current counter values, -1 for counters which are not open
+  for (int i=0; i<3; i++) {
+    values[i]=-1.;
+    unsigned long long count=0;
+    if (fCounterFds[i]>=0 && read(fCounterFds[i], &count, sizeof(count))==sizeof(count)) {
+      values[i]=count;
+    }
+  }
+}
+
+void AliHLTReplayBenchmark::Summarize(const AliHLTReplayMeasurementList& list, AliHLTReplaySummary& summary)
+{
+  // see header file for class documentation
+  memset(&summary, 0, sizeof(summary));
+  if (list.size()==0) return;
+  std::vector<double> times;
+  double sumTime=0, sumTime2=0, sumCpu=0, sumInput=0, sumOutput=0;
+  double sumHeap=0, sumMisses=0, sumInstructions=0, sumCycles=0;
+  int nRetries=0, nCounters=0;
+  for (unsigned i=0; i<list.size(); i++) {
+    const AliHLTReplayMeasurement& m=list[i];
+    times.push_back(m.fRealTime);
+    sumTime+=m.fRealTime;
+    sumTime2+=m.fRealTime*m.fRealTime;
+    sumCpu+=m.fCpuTime;
+    sumInput+=m.fInputSize;
+    sumOutput+=m.fOutputSize;
+    sumHeap+=m.fHeapGrowth;
+    if (m.fNofTrials>0) nRetries++;
+    if (m.fCacheMisses>=0 && m.fInstructions>=0 && m.fCycles>=0) {
+      sumMisses+=m.fCacheMisses;
+      sumInstructions+=m.fInstructions;
+      sumCycles+=m.fCycles;
+      nCounters++;
+    }
+  }
+  std::sort(times.begin(), times.end());
+  double n=list.size();
+  summary.fNofCalls=n;
+  summary.fMeanRealTime=sumTime/n;
+  summary.fRmsRealTime=TMath::Sqrt(TMath::Max(0., sumTime2/n-summary.fMeanRealTime*summary.fMeanRealTime));
+  summary.fMinRealTime=times.front();
+  summary.fMedianRealTime=times[times.size()/2];
+  summary.f90RealTime=times[(size_t)(0.90*(times.size()-1))];
+  summary.f99RealTime=times[(size_t)(0.99*(times.size()-1))];
+  summary.fMaxRealTime=times.back();
+  summary.fMeanCpuTime=sumCpu/n;
+  summary.fEventRate=sumTime>0?n/sumTime*1e6:0;
+  summary.fInputRate=sumTime>0?sumInput/sumTime:0; // byte/us = MB/s
+  summary.fOutputRatio=sumInput>0?sumOutput/sumInput:0;
+  summary.fRetryFraction=nRetries/n;
+  summary.fMeanHeapGrowth=sumHeap/n;
+  summary.fMeanCacheMisses=nCounters>0?sumMisses/nCounters:-1;
+  summary.fInstructionsPerCycle=sumCycles>0?sumInstructions/sumCycles:-1;
+}
+
+void AliHLTReplayBenchmark::Print(const char* /*option*/) const
+{
+  // see header file for class documentation
+  AliHLTReplaySummary s;
+  Summarize(fMeasurements, s);
+  cout << "AliHLTReplayBenchmark: " << fTitle << endl;
+  cout << "  input events " << fEvents.size() << ", recorded calls " << s.fNofCalls << endl;
+  cout << Form("  real time per event [us]: mean %.1f rms %.1f min %.1f median %.1f 90%% %.1f 99%% %.1f max %.1f",
+               s.fMeanRealTime, s.fRmsRealTime, s.fMinRealTime, s.fMedianRealTime, s.f90RealTime, s.f99RealTime, s.fMaxRealTime) << endl;
+  cout << Form("  cpu time per event [us]: %.1f", s.fMeanCpuTime) << endl;
+  cout << Form("  throughput: %.1f events/s, %.2f MB/s input, output/input %.3f",
+               s.fEventRate, s.fInputRate, s.fOutputRatio) << endl;
+  cout << Form("  retries: %.1f%% of the events, heap growth per event %.0f byte",
+               100*s.fRetryFraction, s.fMeanHeapGrowth) << endl;
+  if (s.fMeanCacheMisses>=0) {
+    cout << Form("  cache misses per event %.0f, instructions per cycle %.2f",
+                 s.fMeanCacheMisses, s.fInstructionsPerCycle) << endl;
+  } else {
+    cout << "  hardware counters not available" << endl;
+  }
+}
+
+int AliHLTReplayBenchmark::WriteReport(const char* filename) const
+{
+  // see header file for class documentation
+  TFile* file=TFile::Open(filename, "RECREATE");
+  if (!file || file->IsZombie()) {
+    HLTError("can not open file %s", filename);
+    delete file;
+    return -ENOENT;
+  }
+  TNtupleD* ntuple=new TNtupleD("calls", fTitle.Data(), gkReplayVariables);
+  for (unsigned i=0; i<fMeasurements.size(); i++) {
+    ntuple->Fill(const_cast<Double_t*>(&fMeasurements[i].fEvent));
+  }
+  ntuple->Write();
+  TNamed component("component", fTitle.Data());
+  component.Write();
+  file->Close();
+  delete file;
+  return fMeasurements.size();
+}
+
+int AliHLTReplayBenchmark::ReadReport(const char* filename, AliHLTReplayMeasurementList& list, TString& title)
+{
+  // see header file for class documentation
+  list.clear();
+  TFile* file=TFile::Open(filename);
+  if (!file || file->IsZombie()) {
+    delete file;
+    return -ENOENT;
+  }
+  TNtupleD* ntuple=dynamic_cast<TNtupleD*>(file->Get("calls"));
+  TNamed* component=dynamic_cast<TNamed*>(file->Get("component"));
+  if (component) title=component->GetTitle();
+  int iResult=-ENODATA;
+  if (ntuple && ntuple->GetNvar()==(int)(sizeof(AliHLTReplayMeasurement)/sizeof(Double_t))) {
+    for (Long64_t i=0; i<ntuple->GetEntries(); i++) {
+      ntuple->GetEntry(i);
+      AliHLTReplayMeasurement m;
+      memcpy(&m, ntuple->GetArgs(), sizeof(m));
+      list.push_back(m);
+    }
+    iResult=list.size();
+  }
+  file->Close();
+  delete file;
+  return iResult;
+}
+
+int AliHLTReplayBenchmark::CompareReports(const char* reference, const char* candidate)
+{
+  // see header file for class documentation
+  AliHLTReplayMeasurementList refList, candList;
+  TString refTitle, candTitle;
+  if (ReadReport(reference, refList, refTitle)<0 ||
+      ReadReport(candidate, candList, candTitle)<0) {
+    AliHLTLogging log;
+    log.LoggingVarargs(kHLTLogError, "AliHLTReplayBenchmark", "CompareReports", __FILE__, __LINE__,
+                       "can not read reports %s and %s", reference, candidate);
+    return -ENOENT;
+  }
+  AliHLTReplaySummary r, c;
+  Summarize(refList, r);
+  Summarize(candList, c);
+
+  cout << "reference: " << reference << " (" << refTitle << ")" << endl;
+  cout << "candidate: " << candidate << " (" << candTitle << ")" << endl;
+  const char* names[]={
+    "calls", "mean real time [us]", "rms real time [us]", "min real time [us]",
+    "median real time [us]", "90% real time [us]", "99% real time [us]", "max real time [us]",
+    "mean cpu time [us]", "events/s", "input MB/s", "output/input",
+    "retry fraction", "heap growth [byte]", "cache misses", "instructions/cycle"
+  };
+  const Double_t* refValues=&r.fNofCalls;
+  const Double_t* candValues=&c.fNofCalls;
+  cout << Form("%-24s %14s %14s %8s", "", "reference", "candidate", "ratio") << endl;
+  for (unsigned i=0; i<sizeof(names)/sizeof(names[0]); i++) {
+    cout << Form("%-24s %14.3f %14.3f", names[i], refValues[i], candValues[i]);
+    if (refValues[i]!=0) cout << Form(" %8.3f", candValues[i]/refValues[i]);
+    cout << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,153 @@
+//-*- Mode: C++ -*-
+// $Id$
+
+#ifndef ALIHLTREPLAYBENCHMARK_H
+#define ALIHLTREPLAYBENCHMARK_H
+//* This file is property of and copyright by the ALICE HLT Project        *
+//* ALICE Experiment at CERN, All rights reserved.                         *
+//* See cxx source for full Copyright notice                               *
+
+/** @file   AliHLTReplayBenchmark.h
+    @brief  Standalone benchmark of one HLT component on recorded input
+*/
+
+#include "AliHLTLogging.h"
+#include "AliHLTDataTypes.h"
+#include "TString.h"
+#include <vector>
+
+class AliHLTComponent;
+class AliHLTComponentHandler;
+class AliHLTOUT;
+
+/**
+ * @class AliHLTReplayBenchmark
+ * Replays recorded input blocks into a single component without a chain.
+ *
+ * The input events are read from HLTOUT (raw data or HLT digit file) or
+ * from block files written by the AliHLTFileWriter and kept in memory.
+ * All events are processed a number of times, for every call the wall
+ * and cpu time with nanosecond resolution, input and output size, the
+ * number of processing trials and the heap growth are recorded. On Linux
+ * the hardware counters for cache misses, instructions and cycles are
+ * read if the kernel gives access (perf_event_paranoid).
+ *
+ * The measurements can be written to a ROOT file, two such reports, e.g.
+ * before and after an optimization, are compared by CompareReports.
+ *
+ * Usage:
+ * <pre>
+ *   AliHLTReplayBenchmark bench;
+ *   bench.SetComponent("TPCClusterFinder32Bit", "-do-mc 0", "libAliHLTTPC.so");
+ *   bench.AddEventsFromRawData("raw.root", AliHLTComponentDataTypeInitializer("DDL_RAW ", "TPC "));
+ *   bench.Run(10, 1);
+ *   bench.Print();
+ *   bench.WriteReport("cf-optimized.root");
+ *   AliHLTReplayBenchmark::CompareReports("cf-baseline.root", "cf-optimized.root");
+ * </pre>
+ */
+class AliHLTReplayBenchmark : public AliHLTLogging {
+ public:
+  AliHLTReplayBenchmark();
+  virtual ~AliHLTReplayBenchmark();
+
+  /// measurement of one ProcessEvent call
+  struct AliHLTReplayMeasurement {
+    Double_t fEvent;        // index of the input event
+    Double_t fRepetition;   // repetition
+    Double_t fRealTime;     // wall time in us
+    Double_t fCpuTime;      // process cpu time in us
+    Double_t fInputSize;    // input volume in byte
+    Double_t fOutputSize;   // output volume in byte
+    Double_t fNofTrials;    // number of repeated calls because of too small output buffer
+    Double_t fHeapGrowth;   // heap in use after - before the call in byte
+    Double_t fCacheMisses;  // hardware cache misses, -1 if not available
+    Double_t fInstructions; // instructions, -1 if not available
+    Double_t fCycles;       // cpu cycles, -1 if not available
+  };
+  typedef std::vector<AliHLTReplayMeasurement> AliHLTReplayMeasurementList;
+
+  /// create and initialize the component, arguments as in the configuration
+  int SetComponent(const char* componentId, const char* arguments="", const char* libraries=NULL);
+
+  /// add the selected blocks of the current HLTOUT event as one input event
+  int AddEvent(AliHLTOUT* pHLTOUT, AliHLTComponentDataType dt=kAliHLTAnyDataType, AliHLTUInt32_t spec=kAliHLTVoidDataSpec);
+  /// add events from raw data or HLT digit file, the HLTOUT of each event is one input event
+  int AddEventsFromRawData(const char* input, AliHLTComponentDataType dt=kAliHLTAnyDataType,
+                           AliHLTUInt32_t spec=kAliHLTVoidDataSpec, int maxEvents=-1);
+  /// add a block from a file, e.g. written by the AliHLTFileWriter; event -1 starts a new event
+  int AddBlockFromFile(const char* filename, AliHLTComponentDataType dt, AliHLTUInt32_t spec, int event=-1);
+  int GetNumberOfEvents() const {return fEvents.size();}
+
+  /// process all events nRepetitions times after nWarmup passes which are not recorded
+  int Run(int nRepetitions=1, int nWarmup=1);
+
+  const AliHLTReplayMeasurementList& GetMeasurements() const {return fMeasurements;}
+  void Print(const char* option="") const;
+  /// write the measurements of all calls to a ROOT file
+  int WriteReport(const char* filename) const;
+  /// print the summaries of two reports side by side with the ratio candidate/reference
+  static int CompareReports(const char* reference, const char* candidate);
+
+ private:
+  AliHLTReplayBenchmark(const AliHLTReplayBenchmark&);
+  AliHLTReplayBenchmark& operator=(const AliHLTReplayBenchmark&);
+
+  /// input block, the payload is kept in the event buffer
+  struct AliHLTReplayBlock {
+    AliHLTComponentDataType fDataType;
+    AliHLTUInt32_t fSpecification;
+    AliHLTUInt32_t fOffset;
+    AliHLTUInt32_t fSize;
+  };
+  struct AliHLTReplayEvent {
+    std::vector<AliHLTReplayBlock> fBlocks;
+    std::vector<AliHLTUInt8_t> fBuffer;
+  };
+
+  /// summary quantities of a list of measurements
+  struct AliHLTReplaySummary {
+    Double_t fNofCalls;
+    Double_t fMeanRealTime;
+    Double_t fRmsRealTime;
+    Double_t fMinRealTime;
+    Double_t fMedianRealTime;
+    Double_t f90RealTime;
+    Double_t f99RealTime;
+    Double_t fMaxRealTime;
+    Double_t fMeanCpuTime;
+    Double_t fEventRate;
+    Double_t fInputRate;
+    Double_t fOutputRatio;
+    Double_t fRetryFraction;
+    Double_t fMeanHeapGrowth;
+    Double_t fMeanCacheMisses;
+    Double_t fInstructionsPerCycle;
+  };
+  static void Summarize(const AliHLTReplayMeasurementList& list, AliHLTReplaySummary& summary);
+  static int ReadReport(const char* filename, AliHLTReplayMeasurementList& list, TString& title);
+
+  /// process one event, returns result of the component
+  int ProcessEvent(AliHLTReplayEvent& event, AliHLTUInt32_t eventType, AliHLTReplayMeasurement* measurement);
+  /// send SOR or EOR to the component
+  int SendRunEvent(AliHLTUInt32_t eventType);
+
+  int OpenCounters();
+  void CloseCounters();
+  void ReadCounters(Double_t* values) const;
+
+  AliHLTComponentHandler* fpComponentHandler; //! component handler
+  AliHLTComponent* fpComponent;               //! the component
+  TString fTitle;                             //  component id and arguments
+  std::vector<AliHLTReplayEvent> fEvents;     //! the input events
+  std::vector<AliHLTUInt8_t> fOutputBuffer;   //! output buffer, reused for all calls
+  AliHLTReplayMeasurementList fMeasurements;  //! measurements of the recorded calls
+  AliHLTUInt32_t fEventCount;                 //  events sent to the component
+  int fCounterFds[3];                         //! file descriptors of the hardware counters
+
+  static const int fgkMaxProcessingTrials=4;  //! max calls for one event
+
+  ClassDef(AliHLTReplayBenchmark, 0)
+};
+
+#endif
@@ -23,6 +23,7 @@
 #pragma link C++ class AliHLTOUTPublisherComponent+;
 #pragma link C++ class AliHLTEsdCollectorComponent+;
 #pragma link C++ class AliHLTReadoutListDumpComponent+;
+#pragma link C++ class AliHLTReplayBenchmark+;
 #pragma link C++ class AliHLTDataGenerator+;
 #pragma link C++ class AliHLTBlockFilterComponent+;
 #pragma link C++ class AliHLTMonitoringRelay+;
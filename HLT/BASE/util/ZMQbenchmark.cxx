@@ -0,0 +1,233 @@
+//throughput benchmark of the ZMQ transport modes used by ZMQsink/ZMQsource:
+//one frame per block (copied or zero copy) or batches of several events.
+//Sender and receiver run in the same process, by default over inproc;
+//with ipc or tcp the kernel transport is included in the measurement.
+//
+//  ZMQbenchmark mode=batch batch=100 events=100000 blocks=10 blocksize=1000
+//  ZMQbenchmark mode=zerocopy out=PUSH@ipc:///tmp/zmqbench in=PULL>ipc:///tmp/zmqbench
+
+#include "zmq.h"
+#include "AliHLTZMQhelpers.h"
+#include "AliOptionParser.h"
+#include "TString.h"
+#include <sys/time.h>
+#include <pthread.h>
+#include <vector>
+
+using namespace AliZMQhelpers;
+
+int ProcessOptionString(TString arguments);
+void* RunReceiver(void*);
+double Now();
+
+//configuration vars
+TString fConfigIN  = "PULL>inproc://zmqbenchmark";
+TString fConfigOUT = "PUSH@inproc://zmqbenchmark";
+TString fMode = "plain";
+int fNevents = 10000;
+int fNblocks = 10;
+int fBlockSize = 1000;
+int fBatchEvents = 100;
+
+//results of the receiver
+long fRecvMessages = 0;
+long fRecvEvents = 0;
+long fRecvBlocks = 0;
+double fRecvBytes = 0;
+double fRecvTime = 0;
+
+const char* fUSAGE =
+    "ZMQbenchmark: measure ZMQ transport throughput\n"
+    "options:\n"
+    " -mode : plain (copy each block), zerocopy (attach each block), batch (several events per message)\n"
+    " -events : number of events to send\n"
+    " -blocks : number of blocks per event\n"
+    " -blocksize : size of each block in bytes\n"
+    " -batch : events per message in batch mode\n"
+    " -in : receiving socket, default PULL>inproc://zmqbenchmark\n"
+    " -out : sending socket, default PUSH@inproc://zmqbenchmark\n"
+    ;
+
+//_______________________________________________________________________________________
+int main(int argc, char** argv)
+{
+  //process args
+  int noptions = ProcessOptionString(AliOptionParser::GetFullArgString(argc,argv));
+  if (noptions<0)
+  {
+    printf("%s",fUSAGE);
+    return 1;
+  }
+
+  //bind first, inproc requires it
+  void* socketOUT = NULL;
+  void* socketIN = NULL;
+  int rc = alizmq_socket_init(socketOUT, alizmq_context(), fConfigOUT.Data(), -1, 100);
+  if (rc<0) { printf("cannot init out socket %s\n", fConfigOUT.Data()); return 1; }
+  rc = alizmq_socket_init(socketIN, alizmq_context(), fConfigIN.Data(), -1, 100);
+  if (rc<0) { printf("cannot init in socket %s\n", fConfigIN.Data()); return 1; }
+
+  pthread_t receiver;
+  pthread_create(&receiver, NULL, RunReceiver, socketIN);
+
+  //the event data, the same blocks are sent for every event
+  std::vector<char> data(fNblocks*fBlockSize, 'x');
+  std::vector<DataTopic> topics;
+  for (int i=0; i<fNblocks; i++) {
+    topics.push_back(DataTopic("BENCHMRK","TEST",i));
+  }
+
+  bool batch = fMode.EqualTo("batch");
+  bool zerocopy = fMode.EqualTo("zerocopy");
+  BatchBuffer batchBuffer;
+  long nMessages = 0;
+  double start = Now();
+  for (int iEvent=0; iEvent<fNevents; iEvent++)
+  {
+    aliZMQmsg message;
+    for (int iBlock=0; iBlock<fNblocks; iBlock++)
+    {
+      char* block = &data[iBlock*fBlockSize];
+      if (batch)
+        alizmq_batch_add(&batchBuffer, &topics[iBlock], block, fBlockSize);
+      else if (zerocopy)
+        alizmq_msg_add_nocopy(&message, &topics[iBlock], block, fBlockSize, NULL, NULL);
+      else
+        alizmq_msg_add(&message, &topics[iBlock], block, fBlockSize);
+    }
+    if (batch)
+    {
+      alizmq_batch_close_event(&batchBuffer);
+      if (batchBuffer.fNevents<(UInt_t)fBatchEvents && iEvent<fNevents-1) continue;
+      alizmq_msg_add(&message, &batchBuffer);
+    }
+    alizmq_msg_send(&message, socketOUT, 0);
+    alizmq_msg_close(&message);
+    nMessages++;
+  }
+  double sendTime = Now()-start;
+
+  //tell the receiver we are done
+  aliZMQmsg end;
+  alizmq_msg_add(&end, "BENCHEND", "");
+  alizmq_msg_send(&end, socketOUT, 0);
+  alizmq_msg_close(&end);
+  pthread_join(receiver, NULL);
+
+  double totalBytes = (double)fNevents*fNblocks*fBlockSize;
+  printf("mode %s, %i events, %i blocks of %i bytes per event\n",
+         fMode.Data(), fNevents, fNblocks, fBlockSize);
+  printf("send: %li messages in %.3f s, %.0f messages/s, %.0f events/s, %.1f MB/s\n",
+         nMessages, sendTime, nMessages/sendTime, fNevents/sendTime, totalBytes/sendTime/1e6);
+  printf("recv: %li messages, %li events, %li blocks in %.3f s, %.0f messages/s, %.0f events/s, %.1f MB/s\n",
+         fRecvMessages, fRecvEvents, fRecvBlocks, fRecvTime,
+         fRecvMessages/fRecvTime, fRecvEvents/fRecvTime, fRecvBytes/fRecvTime/1e6);
+
+  alizmq_socket_close(socketOUT);
+  alizmq_socket_close(socketIN);
+  return 0;
+}
+
+//_______________________________________________________________________________________
+void* RunReceiver(void* socket)
+{
+  //receive until the END message, count messages, events and payload
+  double start = 0;
+  bool done = false;
+  while (!done)
+  {
+    aliZMQmsg message;
+    if (alizmq_msg_recv(&message, socket, 0)<0) break;
+    if (fRecvMessages==0) start = Now();
+    for (aliZMQmsg::iterator i=message.begin(); i!=message.end(); ++i)
+    {
+      if (alizmq_msg_iter_check_id(i, "BENCHEND")==0) { done = true; break; }
+      aliZMQbatchIndex blocks;
+      if (alizmq_msg_iter_batch(i, blocks)>=0)
+      {
+        for (aliZMQbatchIndex::iterator b=blocks.begin(); b!=blocks.end(); ++b)
+        {
+          fRecvBytes += b->fSize;
+        }
+        fRecvBlocks += blocks.size();
+        if (!blocks.empty()) fRecvEvents += blocks.back().fEvent+1;
+        continue;
+      }
+      void* buffer = NULL;
+      size_t size = 0;
+      alizmq_msg_iter_data(i, buffer, size);
+      fRecvBytes += size;
+      fRecvBlocks++;
+    }
+    alizmq_msg_close(&message);
+    if (done) break;
+    fRecvMessages++;
+  }
+  fRecvTime = Now()-start;
+  //one frame per block: count events from the blocks
+  if (fRecvEvents==0 && fNblocks>0) fRecvEvents = fRecvBlocks/fNblocks;
+  return NULL;
+}
+
+//_______________________________________________________________________________________
+double Now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec*1e-6;
+}
+
+//______________________________________________________________________________
+int ProcessOptionString(TString arguments)
+{
+  //process passed options
+  aliStringVec* options = AliOptionParser::TokenizeOptionString(arguments);
+  int nOptions = 0;
+  for (aliStringVec::iterator i=options->begin(); i!=options->end(); ++i)
+  {
+    TString option = i->first;
+    TString value = i->second;
+    if ( option.EqualTo("in") )
+    {
+      fConfigIN = value;
+    }
+    else if ( option.EqualTo("out") )
+    {
+      fConfigOUT = value;
+    }
+    else if ( option.EqualTo("mode") )
+    {
+      fMode = value;
+      if (!fMode.EqualTo("plain") && !fMode.EqualTo("zerocopy") && !fMode.EqualTo("batch"))
+      {
+        nOptions=-1;
+        break;
+      }
+    }
+    else if ( option.EqualTo("events") )
+    {
+      fNevents = value.Atoi();
+    }
+    else if ( option.EqualTo("blocks") )
+    {
+      fNblocks = value.Atoi();
+    }
+    else if ( option.EqualTo("blocksize") )
+    {
+      fBlockSize = value.Atoi();
+    }
+    else if ( option.EqualTo("batch") )
+    {
+      fBatchEvents = value.Atoi();
+    }
+    else
+    {
+      nOptions=-1;
+      break;
+    }
+    nOptions++;
+  }
+  delete options; //tidy up
+
+  return nOptions;
+}
@@ -606,6 +606,31 @@ int AliHLTTPCRawSpacePointContainer::WriteSorted(AliHLTUInt8_t* outputPtr,
   return iResult;
 }
 
+int AliHLTTPCRawSpacePointContainer::WritePartition(AliHLTUInt8_t* outputPtr,
+						     AliHLTUInt32_t size,
+						     AliHLTUInt32_t offset,
+						     AliHLTUInt32_t mask,
+						     AliHLTSpacePointPropertyGrid* pGrid,
+						     AliHLTComponentBlockDataList&
+						     outputBlocks,
+						     AliHLTDataDeflater* pDeflater) const
+{
+  /// write one block with an external index grid
+  if (fWrittenClusterIds) {
+    HLTError("writing of cluster ids not supported for partition-wise writing");
+    return -EPERM;
+  }
+  AliHLTUInt8_t slice = AliHLTTPCDefinitions::GetMinSliceNr(mask);
+  AliHLTUInt8_t part  = AliHLTTPCDefinitions::GetMinPatchNr(mask);
+  AliHLTUInt32_t decoderIndex=AliHLTTPCSpacePointData::GetID(slice, part, 0);
+  std::map<AliHLTUInt32_t, AliHLTTPCRawSpacePointBlock>::const_iterator block=fBlocks.find(decoderIndex);
+  if (block==fBlocks.end()) {
+    HLTError("can not find data block of id 0x%08x", mask);
+    return -ENOENT;
+  }
+  return WriteSorted(outputPtr, size, offset, block->second.GetDecoder(), pGrid, decoderIndex, outputBlocks, pDeflater, NULL);
+}
+
 int AliHLTTPCRawSpacePointContainer::WriteSorted(AliHLTUInt8_t* outputPtr,
 						  AliHLTUInt32_t size,
 						  AliHLTUInt32_t offset,
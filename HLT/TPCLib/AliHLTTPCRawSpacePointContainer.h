@@ -116,6 +116,15 @@ class AliHLTTPCRawSpacePointContainer : public AliHLTSpacePointContainer
 		  AliHLTDataDeflater* pDeflater,
 		  const char* option) const;
 
+  /// write the clusters of one data block using an external index grid
+  /// the container is not modified, the function can be called concurrently
+  /// for different blocks with separate grids and deflaters as long as the
+  /// writing of cluster ids is not enabled
+  int WritePartition(AliHLTUInt8_t* outputPtr, AliHLTUInt32_t size, AliHLTUInt32_t offset,
+		     AliHLTUInt32_t mask, AliHLTSpacePointPropertyGrid* pGrid,
+		     vector<AliHLTComponentBlockData>&  outputBlocks,
+		     AliHLTDataDeflater* pDeflater) const;
+
   /// allocate index grid, one single point to define the dimensions
   static AliHLTSpacePointPropertyGrid* AllocateIndexGrid();
 
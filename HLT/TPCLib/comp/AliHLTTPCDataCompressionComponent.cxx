@@ -34,6 +34,8 @@
 #include "AliHLTDataDeflaterHuffman.h"
 #include "AliHLTTPCGeometry.h"
 #include "AliHLTTPCClusterMCData.h"
+#include "AliHLTTPCRawCluster.h"
+#include "AliHLTTPCClusterFlagsData.h"
 #include "AliHLTTPCClusterTransformation.h"
 #include "AliHLTErrorGuard.h"
 #include "AliCDBManager.h"
@@ -44,6 +46,9 @@
 #include "TH1F.h"
 #include "TFile.h"
 #include <memory>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 ClassImp(AliHLTTPCDataCompressionComponent)
 
@@ -60,6 +65,9 @@ AliHLTTPCDataCompressionComponent::AliHLTTPCDataCompressionComponent()
   , fTrackGrid(NULL)
   , fSpacePointGrid(NULL)
   , fpDataDeflater(NULL)
+  , fNofThreads(1)
+  , fWorkerDeflaters()
+  , fPartitionOutputs()
   , fHistoCompFactor(NULL)
   , fHistoResidualPad(NULL)
   , fHistoResidualTime(NULL)
@@ -332,10 +340,29 @@ int AliHLTTPCDataCompressionComponent::DoEvent( const AliHLTComponentEventData&
     GetBenchmarkInstance()->Start(5);
   }
 
+  // the remaining clusters are encoded in parallel if worker deflaters
+  // have been created, the association to tracks stays sequential, each
+  // partition keeps its own index grid until the encoding is done
+  const bool bParallelWrite=fWorkerDeflaters.size()>1 && fpWrittenAssociatedClusterIds==NULL;
+  unsigned nofPartitions=0;
+
   // loop over raw cluster blocks, assign to tracks and write
   // unassigned clusters
   for (pDesc=GetFirstInputBlock(AliHLTTPCDefinitions::fgkRawClustersDataType);
        pDesc!=NULL; pDesc=GetNextInputBlock()) {    
+    AliHLTSpacePointContainer::AliHLTSpacePointPropertyGrid* pGrid=fSpacePointGrid;
+    if (bParallelWrite) {
+      if (fPartitionOutputs.size()<=nofPartitions) {
+	AliHLTTPCPartitionOutput output;
+	output.fpDesc=NULL;
+	output.fpGrid=AliHLTTPCRawSpacePointContainer::AllocateIndexGrid();
+	output.fResult=0;
+	if (!output.fpGrid) {iResult=-ENOMEM; break;}
+	fPartitionOutputs.push_back(output);
+      }
+      fPartitionOutputs[nofPartitions].fpDesc=pDesc;
+      pGrid=fPartitionOutputs[nofPartitions].fpGrid;
+    }
     if (GetBenchmarkInstance()) {
       GetBenchmarkInstance()->Start(1);
       GetBenchmarkInstance()->AddInput(pDesc->fSize);
@@ -353,12 +380,12 @@ int AliHLTTPCDataCompressionComponent::DoEvent( const AliHLTComponentEventData&
 
     // add the data and populate the index grid
     fRawInputClusters->AddInputBlock(pDesc);
-    fRawInputClusters->PopulateAccessGrid(fSpacePointGrid, pDesc->fSpecification);
-    if (fVerbosity>0 && fSpacePointGrid->GetNumberOfSpacePoints()>0) {
+    fRawInputClusters->PopulateAccessGrid(pGrid, pDesc->fSpecification);
+    if (fVerbosity>0 && pGrid->GetNumberOfSpacePoints()>0) {
       HLTInfo("index grid slice %d partition %d", slice, patch);
-      fSpacePointGrid->Print();
-      for (AliHLTSpacePointContainer::AliHLTSpacePointPropertyGrid::iterator& cl=fSpacePointGrid->begin();
-	   cl!=fSpacePointGrid->end(); cl++) {
+      pGrid->Print();
+      for (AliHLTSpacePointContainer::AliHLTSpacePointPropertyGrid::iterator& cl=pGrid->begin();
+	   cl!=pGrid->end(); cl++) {
 	AliHLTUInt32_t id=cl.Data().fId;
 	float row=fRawInputClusters->GetX(id);
 	float pad=fRawInputClusters->GetY(id);
@@ -377,18 +404,27 @@ int AliHLTTPCDataCompressionComponent::DoEvent( const AliHLTComponentEventData&
       GetBenchmarkInstance()->Stop(4);
       GetBenchmarkInstance()->Start(5);
     }
-    allClusters+=fSpacePointGrid->GetNumberOfSpacePoints();
-    iResult=ProcessTrackClusters(&inputTrackArray[0], inputTrackArray.size(), fTrackGrid, trackindexmap, fSpacePointGrid, fRawInputClusters, slice, patch);
+    allClusters+=pGrid->GetNumberOfSpacePoints();
+    iResult=ProcessTrackClusters(&inputTrackArray[0], inputTrackArray.size(), fTrackGrid, trackindexmap, pGrid, fRawInputClusters, slice, patch);
     if( iResult< 0 ) break;
     int assignedInThisPartition = iResult;
     associatedClusters+=iResult;
     
-    iResult=ProcessRemainingClusters(&inputTrackArray[0], inputTrackArray.size(), fTrackGrid, trackindexmap, fSpacePointGrid, fRawInputClusters, slice, patch);
+    iResult=ProcessRemainingClusters(&inputTrackArray[0], inputTrackArray.size(), fTrackGrid, trackindexmap, pGrid, fRawInputClusters, slice, patch);
     if( iResult< 0 ) break;
     associatedClusters+=iResult;
 
-    if (fSpacePointGrid->GetNumberOfSpacePoints()>0) {
-      if (fVerbosity>0) HLTInfo("associated %d (%d) of %d clusters in slice %d partition %d", iResult+assignedInThisPartition, assignedInThisPartition, fSpacePointGrid->GetNumberOfSpacePoints(), slice, patch);
+    if (pGrid->GetNumberOfSpacePoints()>0) {
+      if (fVerbosity>0) HLTInfo("associated %d (%d) of %d clusters in slice %d partition %d", iResult+assignedInThisPartition, assignedInThisPartition, pGrid->GetNumberOfSpacePoints(), slice, patch);
+    }
+
+    if (bParallelWrite) {
+      // remaining clusters are written after the loop
+      nofPartitions++;
+      if (GetBenchmarkInstance()) {
+	GetBenchmarkInstance()->Stop(5);
+      }
+      continue;
     }
 
     // write all remaining clusters not yet assigned to tracks
@@ -400,7 +436,7 @@ int AliHLTTPCDataCompressionComponent::DoEvent( const AliHLTComponentEventData&
     if (fpWrittenAssociatedClusterIds) {
       writeoptions="write-cluster-ids";
     }
-    fRawInputClusters->SetSpacePointPropertyGrid(pDesc->fSpecification, fSpacePointGrid);
+    fRawInputClusters->SetSpacePointPropertyGrid(pDesc->fSpecification, pGrid);
     iResult=fRawInputClusters->Write(outputPtr+size, capacity-size, outputBlocks, fpDataDeflater, writeoptions);
     fRawInputClusters->SetSpacePointPropertyGrid(pDesc->fSpecification, NULL);
     if( iResult<0 ) break;
@@ -420,6 +456,20 @@ int AliHLTTPCDataCompressionComponent::DoEvent( const AliHLTComponentEventData&
 
     fSpacePointGrid->Clear();
   }
+  if (iResult>=0 && nofPartitions>0) {
+    if (GetBenchmarkInstance()) {
+      GetBenchmarkInstance()->Start(5);
+    }
+    iResult=WriteRemainingClusters(fPartitionOutputs, nofPartitions, outputPtr, size, capacity, outputBlocks);
+    if (iResult>=0) {
+      size+=iResult;
+      outputDataSize+=iResult;
+      if (GetBenchmarkInstance()) GetBenchmarkInstance()->AddOutput(iResult);
+    }
+    if (GetBenchmarkInstance()) {
+      GetBenchmarkInstance()->Stop(5);
+    }
+  }
   if (fHistoClusterRatio && allClusters>0) {
     if (fVerbosity>0) HLTInfo("associated %d of %d clusters to tracks", associatedClusters, allClusters);
     float ratio=associatedClusters; ratio/=allClusters;
@@ -798,6 +848,59 @@ int AliHLTTPCDataCompressionComponent::WriteTrackClusters(const vector<AliHLTGlo
   return size;
 }
 
+int AliHLTTPCDataCompressionComponent::WriteRemainingClusters(vector<AliHLTTPCPartitionOutput>& partitions,
+								unsigned nofPartitions,
+								AliHLTUInt8_t* outputPtr,
+								AliHLTUInt32_t offset,
+								AliHLTUInt32_t capacity,
+								AliHLTComponentBlockDataList& outputBlocks) const
+{
+  /// encode the remaining clusters of the partitions in parallel, every
+  /// partition is written to a separate buffer by the deflater of the thread,
+  /// the buffers are concatenated in the order of the input blocks
+  const AliHLTTPCRawSpacePointContainer* rawInputClusters=dynamic_cast<const AliHLTTPCRawSpacePointContainer*>(fRawInputClusters);
+  if (!rawInputClusters || nofPartitions>partitions.size()) return -EFAULT;
+  int nofThreads=fWorkerDeflaters.size();
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nofThreads) schedule(dynamic, 1) if(nofThreads > 1)
+#endif
+  for (int i=0; i<(int)nofPartitions; i++) {
+    AliHLTTPCPartitionOutput& partition=partitions[i];
+    int thread=0;
+#ifdef _OPENMP
+    thread=omp_get_thread_num();
+#endif
+    // the writer checks against twice the uncompressed size
+    AliHLTUInt32_t nofClusters=0;
+    if (partition.fpDesc->fSize>=sizeof(AliHLTTPCRawClusterData))
+      nofClusters=reinterpret_cast<const AliHLTTPCRawClusterData*>(partition.fpDesc->fPtr)->fCount;
+    AliHLTUInt32_t bufferSize=2*(partition.fpDesc->fSize+sizeof(AliHLTTPCRawClusterData))
+      +sizeof(AliHLTTPCClusterFlagsData)+(nofClusters+2)*sizeof(AliHLTUInt32_t);
+    if (partition.fBuffer.size()<bufferSize) partition.fBuffer.resize(bufferSize);
+    partition.fBlocks.clear();
+    partition.fResult=rawInputClusters->WritePartition(&partition.fBuffer[0], partition.fBuffer.size(), 0,
+						       partition.fpDesc->fSpecification, partition.fpGrid,
+						       partition.fBlocks, fWorkerDeflaters[thread]);
+  }
+
+  AliHLTUInt32_t size=0;
+  for (unsigned i=0; i<nofPartitions; i++) {
+    const AliHLTTPCPartitionOutput& partition=partitions[i];
+    if (partition.fResult<0) return partition.fResult;
+    AliHLTUInt32_t partitionSize=partition.fResult;
+    if (offset+size+partitionSize>capacity) return -ENOSPC;
+    memcpy(outputPtr+offset+size, &partition.fBuffer[0], partitionSize);
+    for (AliHLTComponentBlockDataList::const_iterator block=partition.fBlocks.begin();
+	 block!=partition.fBlocks.end(); block++) {
+      outputBlocks.push_back(*block);
+      outputBlocks.back().fOffset+=offset+size;
+    }
+    size+=partitionSize;
+  }
+  return size;
+}
+
 int AliHLTTPCDataCompressionComponent::DoInit( int argc, const char** argv )
 {
   /// inherited from AliHLTComponent: component initialisation and argument scan.
@@ -884,6 +987,13 @@ int AliHLTTPCDataCompressionComponent::DoInit( int argc, const char** argv )
   if (fDeflaterMode>0 && (iResult=InitDeflater(fDeflaterMode))<0)
     return iResult;
 
+  // parallel encoding of the remaining clusters, the statistics of the
+  // deflater can only be collected by a single instance
+  if (fNofThreads>1 && fpDataDeflater &&
+      fDeflaterMode!=kDeflaterModeHuffmanTrainer && fHistogramFile.IsNull() &&
+      (iResult=InitWorkerDeflaters(fNofThreads))<0)
+    return iResult;
+
   fpBenchmark=benchmark.release();
   fRawInputClusters=rawInputClusters.release();
   fInputClusters=inputClusters.release();
@@ -953,28 +1063,8 @@ int AliHLTTPCDataCompressionComponent::InitDeflater(int mode)
     if (!fHistogramFile.IsNull())
       deflater->EnableStatistics();
 
-    unsigned nofParameters=AliHLTTPCDefinitions::GetNumberOfClusterParameterDefinitions();
-    unsigned p=0;
-    for (; p<nofParameters; p++) {
-      const AliHLTTPCDefinitions::AliClusterParameter& parameter=AliHLTTPCDefinitions::fgkClusterParameterDefinitions[p];
-      // use the pad/time length as reference for the calculation of ratio for residuals
-      unsigned refLength=0;
-      unsigned refLengthPad=0;
-      unsigned refLengthTime=0;
-      if (parameter.fId==AliHLTTPCDefinitions::kPad)               refLengthPad=parameter.fBitLength;
-      else if (parameter.fId==AliHLTTPCDefinitions::kTime)         refLengthTime=parameter.fBitLength;
-      else if (parameter.fId==AliHLTTPCDefinitions::kResidualPad)  refLength=refLengthPad;
-      else if (parameter.fId==AliHLTTPCDefinitions::kResidualTime) refLength=refLengthTime;
-
-      if (deflater->AddParameterDefinition(parameter.fName,
-					   parameter.fBitLength,
-					   refLength)!=(int)parameter.fId) {
-	// for performance reason the parameter id is simply used as index in the array of
-	// definitions, the position must match the id
-	HLTFatal("mismatch between parameter id and position in array for parameter %s, rearrange definitions!", parameter.fName);
-	return -EFAULT;
-      }
-    }
+    if ((iResult=AddClusterParameterDefinitions(deflater.get()))<0)
+      return iResult;
     fpDataDeflater=deflater.release();
     return 0;
   }
@@ -985,19 +1075,8 @@ int AliHLTTPCDataCompressionComponent::InitDeflater(int mode)
     if (!fHistogramFile.IsNull())
       deflater->EnableStatistics();
 
-    unsigned nofParameters=AliHLTTPCDefinitions::GetNumberOfClusterParameterDefinitions();
-    unsigned p=0;
-    for (; p<nofParameters; p++) {
-      const AliHLTTPCDefinitions::AliClusterParameter& parameter=AliHLTTPCDefinitions::fgkClusterParameterDefinitions[p];
-      if (deflater->AddParameterDefinition(parameter.fName,
-					   parameter.fBitLength,
-					   parameter.fOptional)!=(int)parameter.fId) {
-	// for performance reason the parameter id is simply used as index in the array of
-	// definitions, the position must match the id
-	HLTFatal("mismatch between parameter id and position in array for parameter %s, rearrange definitions!", parameter.fName);
-	return -EFAULT;
-      }
-    }
+    if ((iResult=AddClusterParameterDefinitions(deflater.get()))<0)
+      return iResult;
     fpDataDeflater=deflater.release();
     return 0;
   }
@@ -1005,6 +1084,95 @@ int AliHLTTPCDataCompressionComponent::InitDeflater(int mode)
   return -EINVAL;
 }
 
+int AliHLTTPCDataCompressionComponent::AddClusterParameterDefinitions(AliHLTDataDeflater* pDeflater) const
+{
+  /// define the cluster parameters for the deflater
+  if (!pDeflater) return -EINVAL;
+  unsigned nofParameters=AliHLTTPCDefinitions::GetNumberOfClusterParameterDefinitions();
+  unsigned p=0;
+  for (; p<nofParameters; p++) {
+    const AliHLTTPCDefinitions::AliClusterParameter& parameter=AliHLTTPCDefinitions::fgkClusterParameterDefinitions[p];
+    int id=-1;
+    if (dynamic_cast<AliHLTDataDeflaterHuffman*>(pDeflater)) {
+      // use the pad/time length as reference for the calculation of ratio for residuals
+      unsigned refLength=0;
+      unsigned refLengthPad=0;
+      unsigned refLengthTime=0;
+      if (parameter.fId==AliHLTTPCDefinitions::kPad)               refLengthPad=parameter.fBitLength;
+      else if (parameter.fId==AliHLTTPCDefinitions::kTime)         refLengthTime=parameter.fBitLength;
+      else if (parameter.fId==AliHLTTPCDefinitions::kResidualPad)  refLength=refLengthPad;
+      else if (parameter.fId==AliHLTTPCDefinitions::kResidualTime) refLength=refLengthTime;
+
+      id=dynamic_cast<AliHLTDataDeflaterHuffman*>(pDeflater)->AddParameterDefinition(parameter.fName,
+										      parameter.fBitLength,
+										      refLength);
+    } else if (dynamic_cast<AliHLTDataDeflaterSimple*>(pDeflater)) {
+      id=dynamic_cast<AliHLTDataDeflaterSimple*>(pDeflater)->AddParameterDefinition(parameter.fName,
+										     parameter.fBitLength,
+										     parameter.fOptional);
+    }
+    if (id!=(int)parameter.fId) {
+      // for performance reason the parameter id is simply used as index in the array of
+      // definitions, the position must match the id
+      HLTFatal("mismatch between parameter id and position in array for parameter %s, rearrange definitions!", parameter.fName);
+      return -EFAULT;
+    }
+  }
+  return 0;
+}
+
+int AliHLTTPCDataCompressionComponent::InitWorkerDeflaters(int nofWorkers)
+{
+  /// create one deflater per thread for the parallel encoding of the remaining
+  /// clusters, the first one is the main deflater, the others share its
+  /// huffman tables
+  DeleteWorkerDeflaters();
+  if (nofWorkers<=1 || !fpDataDeflater) return 0;
+#ifdef _OPENMP
+  int iResult=0;
+  fWorkerDeflaters.push_back(fpDataDeflater);
+  for (int i=1; i<nofWorkers && iResult>=0; i++) {
+    AliHLTDataDeflater* pDeflater=NULL;
+    if (fDeflaterMode==kDeflaterModeHuffman) {
+      AliHLTDataDeflaterHuffman* master=dynamic_cast<AliHLTDataDeflaterHuffman*>(fpDataDeflater);
+      if (!master || !master->GetList()) {iResult=-EFAULT; break;}
+      std::auto_ptr<AliHLTDataDeflaterHuffman> deflater(new AliHLTDataDeflaterHuffman(false));
+      if (!deflater.get()) {iResult=-ENOMEM; break;}
+      if ((iResult=deflater->InitDecoders(const_cast<TList*>(master->GetList())))<0) break;
+      pDeflater=deflater.release();
+    } else if (fDeflaterMode==kDeflaterModeSimple) {
+      pDeflater=new AliHLTDataDeflaterSimple;
+      if (!pDeflater) {iResult=-ENOMEM; break;}
+    } else {
+      iResult=-EINVAL;
+      break;
+    }
+    // the instance is owned by the list from now on
+    fWorkerDeflaters.push_back(pDeflater);
+    iResult=AddClusterParameterDefinitions(pDeflater);
+  }
+  if (iResult<0) {
+    // release the deflaters created so far, the main deflater stays
+    DeleteWorkerDeflaters();
+    return iResult;
+  }
+  HLTInfo("encoding remaining clusters with %d threads", nofWorkers);
+#else
+  HLTWarning("compiled without OpenMP support, ignoring %d threads", nofWorkers);
+#endif
+  return 0;
+}
+
+void AliHLTTPCDataCompressionComponent::DeleteWorkerDeflaters()
+{
+  /// delete the worker deflaters, the first one is the main deflater and
+  /// is not owned by the list
+  for (unsigned i=1; i<fWorkerDeflaters.size(); i++) {
+    delete fWorkerDeflaters[i];
+  }
+  fWorkerDeflaters.clear();
+}
+
 int AliHLTTPCDataCompressionComponent::DoDeinit()
 {
   /// inherited from AliHLTComponent: component cleanup
@@ -1074,6 +1242,11 @@ int AliHLTTPCDataCompressionComponent::DoDeinit()
     delete fpDataDeflater;
   }
   fpDataDeflater=NULL;
+  DeleteWorkerDeflaters();
+  for (unsigned i=0; i<fPartitionOutputs.size(); i++) {
+    delete fPartitionOutputs[i].fpGrid;
+  }
+  fPartitionOutputs.clear();
 
 
   if (fTrackGrid) delete fTrackGrid; fTrackGrid=NULL;
@@ -1149,6 +1322,18 @@ int AliHLTTPCDataCompressionComponent::ScanConfigurationArgument(int argc, const
       fHuffmanTableFile=argv[i++];
       return 2;
     }
+    // -threads
+    if (argument.CompareTo("-threads")==0) {
+      if ((bMissingParam=(++i>=argc))) break;
+      TString parameter=argv[i];
+      if (parameter.IsDigit()) {
+	fNofThreads=parameter.Atoi();
+	return 2;
+      } else {
+	HLTError("invalid parameter for argument %s, expecting number instead of %s", argument.Data(), parameter.Data());
+	return -EPROTO;
+      }
+    }
     // -cluster-verification
     if (argument.CompareTo("-cluster-verification")==0) {
       if ((bMissingParam=(++i>=argc))) break;
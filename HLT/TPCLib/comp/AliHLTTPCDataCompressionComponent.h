@@ -92,6 +92,12 @@ class TH1F;
  *      2 huffman deflation (AliHLTDataDeflaterHuffman)              <br>
  * \li -histogram-file     <i> file  </i>                            <br>
  *      file to store internal histograms at the end
+ * \li -threads     <i> number  </i>                                 <br>
+ *      number of threads for the encoding of the remaining clusters, <br>
+ *      the partitions are encoded in parallel into separate buffers  <br>
+ *      which are concatenated in the order of the input blocks, the  <br>
+ *      output is identical to the single threaded encoding. Not used <br>
+ *      in huffman training mode, with histograms or MC cluster ids
  *
  * <h2>Configuration:</h2>
  * <!-- NOTE: ignore the \li. <i> and </i>: it's just doxygen formatting -->
@@ -208,11 +214,35 @@ protected:
 			 AliHLTUInt8_t* outputPtr,
 			 AliHLTUInt32_t capacity) const;
 
+  /// output of one partition in the partition-parallel encoding
+  struct AliHLTTPCPartitionOutput {
+    const AliHLTComponentBlockData* fpDesc; //! input block
+    AliHLTSpacePointContainer::AliHLTSpacePointPropertyGrid* fpGrid; //! index grid of the partition
+    vector<AliHLTUInt8_t> fBuffer; //! private output buffer
+    AliHLTComponentBlockDataList fBlocks; //! output blocks, offsets relative to fBuffer
+    int fResult; //! size written to fBuffer or error code
+  };
+
+  /// encode the remaining clusters of the partitions in parallel and
+  /// concatenate the output in the order of the partitions
+  int WriteRemainingClusters(vector<AliHLTTPCPartitionOutput>& partitions,
+			     unsigned nofPartitions,
+			     AliHLTUInt8_t* outputPtr,
+			     AliHLTUInt32_t offset,
+			     AliHLTUInt32_t capacity,
+			     AliHLTComponentBlockDataList& outputBlocks) const;
+
 private:
   AliHLTTPCDataCompressionComponent(const AliHLTTPCDataCompressionComponent&);
   AliHLTTPCDataCompressionComponent& operator=(const AliHLTTPCDataCompressionComponent&);
 
   int InitDeflater(int mode);
+  /// define the cluster parameters for a deflater instance
+  int AddClusterParameterDefinitions(AliHLTDataDeflater* pDeflater) const;
+  /// create the deflater instances for the partition-parallel encoding
+  int InitWorkerDeflaters(int nofWorkers);
+  /// delete the deflater instances of the partition-parallel encoding
+  void DeleteWorkerDeflaters();
 
   /// calculate correction factor and offset for a linear approximation of the
   /// drift time transformation, separately for A and C side
@@ -246,6 +276,13 @@ private:
   /// deflater
   AliHLTDataDeflater* fpDataDeflater; //! deflater for raw clusters
 
+  /// number of threads for the encoding of the remaining clusters
+  int fNofThreads; //! number of threads
+  /// one deflater per thread, the first one is fpDataDeflater
+  vector<AliHLTDataDeflater*> fWorkerDeflaters; //! deflaters for parallel encoding
+  /// output of the partitions, kept to reuse the buffers
+  vector<AliHLTTPCPartitionOutput> fPartitionOutputs; //! partition output
+
   /// compression factor histogram
   TH1F* fHistoCompFactor; //! histogram of compression factor
   TH1F* fHistoResidualPad; //! histogram for pad residual
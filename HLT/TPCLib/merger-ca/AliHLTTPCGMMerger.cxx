@@ -47,6 +47,10 @@
 #include "AliHLTTPCCAGPUConfig.h"
 #include "MemoryAssignmentHelpers.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #define GLOBAL_TRACKS_SPECIAL_TREATMENT
 
 AliHLTTPCGMMerger::AliHLTTPCGMMerger()
@@ -65,8 +69,10 @@ AliHLTTPCGMMerger::AliHLTTPCGMMerger()
   fClusterAngle(0),
   fBorderMemory(0),
   fBorderRangeMemory(0),
+  fNBorderMemoryThreads(0),
   fGPUTracker(NULL),
   fDebugLevel(0),
+  fNThreads(1),
   fNClusters(0)
 {
   //* constructor
@@ -80,6 +86,7 @@ AliHLTTPCGMMerger::AliHLTTPCGMMerger()
   fNextSliceInd[ mid ] = 0;
   fPrevSliceInd[ 0 ] = mid;  fNextSliceInd[ last ] = fgkNSlices / 2;
   fPrevSliceInd[ fgkNSlices/2 ] = last;
+  for ( int i = 0; i < kNTimes; i++ ) fStageTime[i] = 0;
   {
     const double kCLight = 0.000299792458;
     double constBz = fSliceParam.BzkG() * kCLight;
@@ -112,8 +119,10 @@ AliHLTTPCGMMerger::AliHLTTPCGMMerger(const AliHLTTPCGMMerger&)
   fClusterAngle(0),
   fBorderMemory(0),
   fBorderRangeMemory(0),
+  fNBorderMemoryThreads(0),
   fGPUTracker(NULL),
   fDebugLevel(0),
+  fNThreads(1),
   fNClusters(0)
 {
   //* dummy
@@ -121,6 +130,7 @@ AliHLTTPCGMMerger::AliHLTTPCGMMerger(const AliHLTTPCGMMerger&)
     fNextSliceInd[iSlice] = 0;
     fPrevSliceInd[iSlice] = 0;
   }
+  for ( int i = 0; i < kNTimes; i++ ) fStageTime[i] = 0;
   {
     const double kCLight = 0.000299792458;
     double constBz = fSliceParam.BzkG() * kCLight;
@@ -187,6 +197,7 @@ void AliHLTTPCGMMerger::ClearMemory()
   fClusterAngle = 0;
   fBorderMemory = 0;  
   fBorderRangeMemory = 0;
+  fNBorderMemoryThreads = 0;
 }
 
 
@@ -195,6 +206,33 @@ void AliHLTTPCGMMerger::SetSliceData( int index, const AliHLTTPCCASliceOutput *s
   fkSlices[index] = sliceData;
 }
 
+const char* AliHLTTPCGMMerger::StageName( int iStage )
+{
+  //* name of the merging stage, for the timing printout
+  static const char* const kNames[kNTimes] = { "Unpack Slices", "Merge Within", "Merge Slices", "Collect", "Refit" };
+  return ( iStage >= 0 && iStage < kNTimes ) ? kNames[iStage] : "";
+}
+
+int AliHLTTPCGMMerger::ThreadCount( int nTasks ) const
+{
+  //* number of threads to use for nTasks independent tasks
+  int nThreads = 1;
+#ifdef _OPENMP
+  nThreads = fNThreads ? fNThreads : omp_get_max_threads();
+#endif
+  return CAMath::Max( 1, CAMath::Min( nThreads, nTasks ) );
+}
+
+int AliHLTTPCGMMerger::ThreadNum() const
+{
+  //* index of the calling thread, selects the border memory block
+#ifdef _OPENMP
+  return omp_get_thread_num();
+#else
+  return 0;
+#endif
+}
+
 
 bool AliHLTTPCGMMerger::Reconstruct()
 {
@@ -214,49 +252,34 @@ bool AliHLTTPCGMMerger::Reconstruct()
   
   int nIter = 1;
   TStopwatch timer;
-#ifdef HLTCA_STANDALONE
-  unsigned long long int a, b, c, d, e, f, g;
-  AliHLTTPCCATracker::StandaloneQueryFreq(&g);
-#endif
   //cout<<"Merger..."<<endl;
   for( int iter=0; iter<nIter; iter++ ){
     if( !AllocateMemory() ) return 0;
-#ifdef HLTCA_STANDALONE
-	AliHLTTPCCATracker::StandaloneQueryTime(&a);
-#endif
+    timer.Start();
     UnpackSlices();
-#ifdef HLTCA_STANDALONE
-	AliHLTTPCCATracker::StandaloneQueryTime(&b);
-#endif
+    fStageTime[kTimeUnpack] = timer.RealTime();
+    timer.Start();
     MergeWithingSlices();
-#ifdef HLTCA_STANDALONE
-	AliHLTTPCCATracker::StandaloneQueryTime(&c);
-#endif
+    fStageTime[kTimeMergeWithin] = timer.RealTime();
+    timer.Start();
     MergeSlices();
-#ifdef HLTCA_STANDALONE
-	AliHLTTPCCATracker::StandaloneQueryTime(&d);
-#endif
+    fStageTime[kTimeMergeSlices] = timer.RealTime();
+    timer.Start();
     CollectMergedTracks();
-#ifdef HLTCA_STANDALONE
-	AliHLTTPCCATracker::StandaloneQueryTime(&e);
-#endif
+    fStageTime[kTimeCollect] = timer.RealTime();
+    timer.Start();
     Refit();
+    fStageTime[kTimeRefit] = timer.RealTime();
 #ifdef HLTCA_STANDALONE
-	AliHLTTPCCATracker::StandaloneQueryTime(&f);
 	if (fDebugLevel > 0)
 	{
-		printf("Merge Time:\tUnpack Slices:\t%lld us\n", (b - a) * 1000000 / g);
-		printf("\t\tMerge Within:\t%lld us\n", (c - b) * 1000000 / g);
-		printf("\t\tMerge Slices:\t%lld us\n", (d - c) * 1000000 / g);
-		printf("\t\tCollect:\t%lld us\n", (e - d) * 1000000 / g);
-		printf("\t\tRefit:\t\t%lld us\n", (f - e) * 1000000 / g);
+		for (int i = 0;i < kNTimes;i++) printf("%s%s:\t%lld us\n", i == 0 ? "Merge Time:\t" : "\t\t", StageName(i), (long long int) (fStageTime[i] * 1.e6));
 	}
 	int newTracks = 0;
 	for (int i = 0;i < fNOutputTracks;i++) if (fOutputTracks[i].OK()) newTracks++;
 	printf("Output Tracks: %d\n", newTracks);
 #endif
   }  
-  timer.Stop();  
   //cout<<"\nMerger time = "<<timer.CpuTime()*1.e3/nIter<<" ms\n"<<endl;
 
   return 1;
@@ -304,8 +327,9 @@ bool AliHLTTPCGMMerger::AllocateMemory()
 	  fClusterRowType = new UInt_t[fNClusters];
 	  fClusterAngle = new float[fNClusters];        
   }
-  fBorderMemory = new AliHLTTPCGMBorderTrack[fMaxSliceTracks*2];
-  fBorderRangeMemory = new AliHLTTPCGMBorderTrack::Range[fMaxSliceTracks*2];  
+  fNBorderMemoryThreads = ThreadCount( fgkNSlices );
+  fBorderMemory = new AliHLTTPCGMBorderTrack[fMaxSliceTracks*2*fNBorderMemoryThreads];
+  fBorderRangeMemory = new AliHLTTPCGMBorderTrack::Range[fMaxSliceTracks*2*fNBorderMemoryThreads];  
 
   return ( ( fOutputTracks!=NULL )
 	   && ( fOutputClusterIds!=NULL )
@@ -460,9 +484,11 @@ void AliHLTTPCGMMerger::MakeBorderTracks( int iSlice, int iBorder, AliHLTTPCGMBo
 
 
 void AliHLTTPCGMMerger::MergeBorderTracks ( int iSlice1, AliHLTTPCGMBorderTrack B1[],  int N1,
-					    int iSlice2, AliHLTTPCGMBorderTrack B2[],  int N2 )
+					    int iSlice2, AliHLTTPCGMBorderTrack B2[],  int N2,
+					    AliHLTTPCGMBorderTrack::Range *range )
 {
   //* merge two sets of tracks
+  //* range is scratch memory for N1+N2 entries, private to the calling thread
 
   //std::cout<<" Merge slices "<<iSlice1<<"+"<<iSlice2<<": tracks "<<N1<<"+"<<N2<<std::endl;
   int statAll=0, statMerged=0;
@@ -477,8 +503,8 @@ void AliHLTTPCGMMerger::MergeBorderTracks ( int iSlice1, AliHLTTPCGMBorderTrack
   int minNPartHits = 10;//SG!!!
   int minNTotalHits = 20;
 
-  AliHLTTPCGMBorderTrack::Range *range1 = fBorderRangeMemory;
-  AliHLTTPCGMBorderTrack::Range *range2 = fBorderRangeMemory + N1;
+  AliHLTTPCGMBorderTrack::Range *range1 = range;
+  AliHLTTPCGMBorderTrack::Range *range2 = range + N1;
 
   bool sameSlice = (iSlice1 == iSlice2);
   {
@@ -577,8 +603,15 @@ void AliHLTTPCGMMerger::MergeWithingSlices()
   float x0 = fSliceParam.RowX( 63 );  
   const float maxSin = CAMath::Sin( 60. / 180.*CAMath::Pi() );
 
+  //* slices only modify their own tracks, so they are merged in parallel
+  const int nThreads = ThreadCount( fgkNSlices );
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nThreads) schedule(dynamic, 1) if(nThreads > 1)
+#endif
   for ( int iSlice = 0; iSlice < fgkNSlices; iSlice++ ) {
 
+    AliHLTTPCGMBorderTrack *borderMemory = fBorderMemory + ThreadNum() * fMaxSliceTracks * 2;
+    AliHLTTPCGMBorderTrack::Range *rangeMemory = fBorderRangeMemory + ThreadNum() * fMaxSliceTracks * 2;
     int nBord = 0;
     for ( int itr = 0; itr < fSliceNTrackInfos[iSlice]; itr++ ) {
       AliHLTTPCGMSliceTrack &track = fSliceTrackInfos[ fSliceTrackInfoStart[iSlice] + itr ];
@@ -587,7 +620,7 @@ void AliHLTTPCGMMerger::MergeWithingSlices()
       //track.SetSliceNeighbour( -1 );
       //track.SetUsed(0);
       
-      AliHLTTPCGMBorderTrack &b = fBorderMemory[nBord];
+      AliHLTTPCGMBorderTrack &b = borderMemory[nBord];
       if( track.TransportToX( x0, fSliceParam.ConstBz(), b, maxSin) ){
 	b.SetTrackID( itr );
 	b.SetNClusters( track.NClusters() );
@@ -595,7 +628,7 @@ void AliHLTTPCGMMerger::MergeWithingSlices()
       }
     }  
 
-    MergeBorderTracks( iSlice, fBorderMemory, nBord, iSlice, fBorderMemory, nBord );
+    MergeBorderTracks( iSlice, borderMemory, nBord, iSlice, borderMemory, nBord, rangeMemory );
     
     for ( int itr = 0; itr < fSliceNTrackInfos[iSlice]; itr++ ) {
       AliHLTTPCGMSliceTrack &track = fSliceTrackInfos[ fSliceTrackInfoStart[iSlice] + itr];
@@ -631,19 +664,28 @@ void AliHLTTPCGMMerger::MergeSlices()
   //}
   //}
 
-  AliHLTTPCGMBorderTrack 
-    *bCurr = fBorderMemory,
-    *bNext = fBorderMemory + fMaxSliceTracks;
-  
+  //* The pair ( iSlice, fNextSliceInd[iSlice] ) only sets the next-neighbours of iSlice
+  //* and the previous-neighbours of the next slice. Each slice is the first and the second
+  //* member of exactly one pair, so the pairs are independent and are merged in parallel;
+  //* the result does not depend on the number of threads.
+
+  const int nThreads = ThreadCount( fgkNSlices );
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nThreads) schedule(dynamic, 1) if(nThreads > 1)
+#endif
   for ( int iSlice = 0; iSlice < fgkNSlices; iSlice++ ) {    
+    AliHLTTPCGMBorderTrack 
+      *bCurr = fBorderMemory + ThreadNum() * fMaxSliceTracks * 2,
+      *bNext = bCurr + fMaxSliceTracks;
+    AliHLTTPCGMBorderTrack::Range *range = fBorderRangeMemory + ThreadNum() * fMaxSliceTracks * 2;
     int jSlice = fNextSliceInd[iSlice];    
     int nCurr = 0, nNext = 0;
     MakeBorderTracks( iSlice, 2, bCurr, nCurr );
     MakeBorderTracks( jSlice, 3, bNext, nNext );
-    MergeBorderTracks( iSlice, bCurr, nCurr, jSlice, bNext, nNext );
+    MergeBorderTracks( iSlice, bCurr, nCurr, jSlice, bNext, nNext, range );
     MakeBorderTracks( iSlice, 0, bCurr, nCurr );
     MakeBorderTracks( jSlice, 1, bNext, nNext );
-    MergeBorderTracks( iSlice, bCurr, nCurr, jSlice, bNext, nNext );
+    MergeBorderTracks( iSlice, bCurr, nCurr, jSlice, bNext, nNext, range );
   }
 }
 
@@ -828,8 +870,10 @@ void AliHLTTPCGMMerger::Refit()
 	else
 #endif
 	{
-#ifdef HLTCA_STANDALONE
-#pragma omp parallel for
+	  //Tracks are refitted independently in place, the output order is kept
+	  const int nThreads = ThreadCount( fNOutputTracks );
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nThreads) schedule(dynamic, 16) if(nThreads > 1)
 #endif
 	  for ( int itr = 0; itr < fNOutputTracks; itr++ ) {
 
@@ -52,6 +52,12 @@ public:
 
   void SetGPUTracker(AliHLTTPCCAGPUTracker* gpu) {fGPUTracker = gpu;}
   void SetDebugLevel(int debug) {fDebugLevel = debug;}
+  void SetNThreads(int nThreads) {fNThreads = nThreads;} // default 1, 0 = all OpenMP threads
+  int NThreads() const {return(fNThreads);}
+
+  enum { kTimeUnpack = 0, kTimeMergeWithin, kTimeMergeSlices, kTimeCollect, kTimeRefit, kNTimes }; // merging stages
+  double StageTime(int iStage) const {return(fStageTime[iStage]);} // real time [s] of the stage in the last Reconstruct()
+  static const char* StageName(int iStage);
 
   float* PolinomialFieldBz() const {return((float*) fPolinomialFieldBz);}
 
@@ -72,7 +78,11 @@ private:
   void MakeBorderTracks( int iSlice, int iBorder, AliHLTTPCGMBorderTrack B[], int &nB );
 
   void MergeBorderTracks( int iSlice1, AliHLTTPCGMBorderTrack B1[],  int N1,
-			  int iSlice2, AliHLTTPCGMBorderTrack B2[],  int N2 );
+			  int iSlice2, AliHLTTPCGMBorderTrack B2[],  int N2,
+			  AliHLTTPCGMBorderTrack::Range *range );
+
+  int ThreadCount( int nTasks ) const;
+  int ThreadNum() const;
   
   static bool CompareTrackParts( const AliHLTTPCGMSliceTrack *t1, const AliHLTTPCGMSliceTrack *t2 ){
     //return (t1->X() > t2->X() );
@@ -115,11 +125,14 @@ private:
   float *fClusterZ;         // cluster Z
   UInt_t *fClusterRowType;  // cluster row type
   float *fClusterAngle;     // angle    
-  AliHLTTPCGMBorderTrack *fBorderMemory; // memory for border tracks
-  AliHLTTPCGMBorderTrack::Range *fBorderRangeMemory; // memory for border tracks
+  AliHLTTPCGMBorderTrack *fBorderMemory; // memory for border tracks, fMaxSliceTracks*2 per thread
+  AliHLTTPCGMBorderTrack::Range *fBorderRangeMemory; // memory for border tracks, fMaxSliceTracks*2 per thread
+  int fNBorderMemoryThreads; // number of per-thread border memory blocks
 
   AliHLTTPCCAGPUTracker* fGPUTracker;
   int fDebugLevel;
+  int fNThreads;            // number of threads for merging and refit, default 1, 0 = all OpenMP threads
+  double fStageTime[kNTimes]; // real time per merging stage
 
   int fNClusters;			//Total number of incoming clusters
 
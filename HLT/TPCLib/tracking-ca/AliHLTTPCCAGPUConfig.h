@@ -106,6 +106,11 @@
 #else
 //Sort start hits for GPU tracker
 #define HLTCA_GPU_SORT_STARTHITS
+
+//Vc SIMD code paths are for the CPU tracker only
+#ifdef HLTCA_CPU_VC
+#undef HLTCA_CPU_VC
+#endif
 #endif
 
 //Error Codes for GPU Tracker
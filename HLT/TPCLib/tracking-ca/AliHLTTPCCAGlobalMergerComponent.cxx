@@ -56,12 +56,12 @@ ClassImp( AliHLTTPCCAGlobalMergerComponent )
 
 
 AliHLTTPCCAGlobalMergerComponent::AliHLTTPCCAGlobalMergerComponent()
-: AliHLTProcessor(), fVersion(1), fGlobalMergerVersion0( 0 ), fGlobalMerger(0), fSolenoidBz( 0 ), fClusterErrorCorrectionY(0), fClusterErrorCorrectionZ(0), fBenchmark("GlobalMerger")
+: AliHLTProcessor(), fVersion(1), fGlobalMergerVersion0( 0 ), fGlobalMerger(0), fSolenoidBz( 0 ), fClusterErrorCorrectionY(0), fClusterErrorCorrectionZ(0), fNThreads(1), fBenchmark("GlobalMerger")
 {
   // see header file for class documentation
 }
 
-AliHLTTPCCAGlobalMergerComponent::AliHLTTPCCAGlobalMergerComponent( const AliHLTTPCCAGlobalMergerComponent & ):AliHLTProcessor(), fVersion(1), fGlobalMergerVersion0( 0 ), fGlobalMerger(0), fSolenoidBz( 0 ), fClusterErrorCorrectionY(0), fClusterErrorCorrectionZ(0), fBenchmark("GlobalMerger")
+AliHLTTPCCAGlobalMergerComponent::AliHLTTPCCAGlobalMergerComponent( const AliHLTTPCCAGlobalMergerComponent & ):AliHLTProcessor(), fVersion(1), fGlobalMergerVersion0( 0 ), fGlobalMerger(0), fSolenoidBz( 0 ), fClusterErrorCorrectionY(0), fClusterErrorCorrectionZ(0), fNThreads(1), fBenchmark("GlobalMerger")
 {
 // dummy
 }
@@ -121,6 +121,7 @@ void AliHLTTPCCAGlobalMergerComponent::SetDefaultConfiguration()
   fSolenoidBz = -5.00668;
   fClusterErrorCorrectionY = 0;
   fClusterErrorCorrectionZ = 1.1;
+  fNThreads = 1;
   fBenchmark.Reset();
   fBenchmark.SetTimer(0,"total");
   fBenchmark.SetTimer(1,"reco");    
@@ -172,6 +173,13 @@ int AliHLTTPCCAGlobalMergerComponent::ReadConfigurationString(  const char* argu
       continue;
     }
 
+    if ( argument.CompareTo( "-CPUThreads" ) == 0 ) {
+      if ( ( bMissingParam = ( ++i >= pTokens->GetEntries() ) ) ) break;
+      fNThreads = ( ( TObjString* )pTokens->At( i ) )->GetString().Atoi();
+      HLTInfo( "Number of merger threads set to: %d", fNThreads );
+      continue;
+    }
+
     HLTError( "Unknown option \"%s\"", argument.Data() );
     iResult = -EINVAL;
   }
@@ -291,6 +299,7 @@ int AliHLTTPCCAGlobalMergerComponent::Configure( const char* cdbEntry, const cha
 
   if( fVersion==0 ) fGlobalMergerVersion0->SetSliceParam( param );
   else fGlobalMerger->SetSliceParam( param );
+  fGlobalMerger->SetNThreads( fNThreads );
 
   return iResult1 ? iResult1 : ( iResult2 ? iResult2 : iResult3 );
 }
@@ -545,6 +554,12 @@ int AliHLTTPCCAGlobalMergerComponent::DoEvent( const AliHLTComponentEventData &e
     }
 
     HLTInfo( "CAGlobalMerger:: output %d tracks", fGlobalMerger->NOutputTracks() );
+    HLTInfo( "CAGlobalMerger:: stage times: %s %.3f ms, %s %.3f ms, %s %.3f ms, %s %.3f ms, %s %.3f ms",
+	     AliHLTTPCGMMerger::StageName( AliHLTTPCGMMerger::kTimeUnpack ), fGlobalMerger->StageTime( AliHLTTPCGMMerger::kTimeUnpack ) * 1.e3,
+	     AliHLTTPCGMMerger::StageName( AliHLTTPCGMMerger::kTimeMergeWithin ), fGlobalMerger->StageTime( AliHLTTPCGMMerger::kTimeMergeWithin ) * 1.e3,
+	     AliHLTTPCGMMerger::StageName( AliHLTTPCGMMerger::kTimeMergeSlices ), fGlobalMerger->StageTime( AliHLTTPCGMMerger::kTimeMergeSlices ) * 1.e3,
+	     AliHLTTPCGMMerger::StageName( AliHLTTPCGMMerger::kTimeCollect ), fGlobalMerger->StageTime( AliHLTTPCGMMerger::kTimeCollect ) * 1.e3,
+	     AliHLTTPCGMMerger::StageName( AliHLTTPCGMMerger::kTimeRefit ), fGlobalMerger->StageTime( AliHLTTPCGMMerger::kTimeRefit ) * 1.e3 );
 
     fGlobalMerger->Clear();
   }
@@ -122,6 +122,7 @@ class AliHLTTPCCAGlobalMergerComponent : public AliHLTProcessor
     double fSolenoidBz;  // magnetic field
     double fClusterErrorCorrectionY; // correction for the cluster error during pre-fit
     double fClusterErrorCorrectionZ; // correction for the cluster error during pre-fit
+    int fNThreads; // number of threads for the GM merger
     AliHLTComponentBenchmark fBenchmark;// benchmark
 
     ClassDef( AliHLTTPCCAGlobalMergerComponent, 0 )
@@ -241,6 +241,8 @@ GPUd()  inline int AliHLTTPCCAMath::AtomicExch(register GPUglobalref() int *addr
 #else
   return ::atomicExch( addr, val );
 #endif
+#elif defined(_OPENMP) && defined(__GNUC__)
+  return __sync_lock_test_and_set( addr, val );
 #else
   int old = *addr;
   *addr = val;
@@ -256,6 +258,8 @@ GPUd()  inline int AliHLTTPCCAMath::AtomicAdd (register GPUglobalref() int *addr
 #else
   return ::atomicAdd( addr, val );
 #endif
+#elif defined(_OPENMP) && defined(__GNUC__)
+  return __sync_fetch_and_add( addr, val );
 #else
   int old = *addr;
   *addr += val;
@@ -271,6 +275,10 @@ GPUd()  inline int AliHLTTPCCAMath::AtomicMax (register GPUglobalref() int *addr
 #else
   return ::atomicMax( addr, val );
 #endif
+#elif defined(_OPENMP) && defined(__GNUC__)
+  int old;
+  while ( ( old = *addr ) < val && __sync_val_compare_and_swap( addr, old, val ) != old ) {}
+  return old;
 #else
   int old = *addr;
   if ( *addr < val ) *addr = val;
@@ -286,6 +294,10 @@ GPUd()  inline int AliHLTTPCCAMath::AtomicMin (register GPUglobalref() int *addr
 #else
   return ::atomicMin( addr, val );
 #endif
+#elif defined(_OPENMP) && defined(__GNUC__)
+  int old;
+  while ( ( old = *addr ) > val && __sync_val_compare_and_swap( addr, old, val ) != old ) {}
+  return old;
 #else
   int old = *addr;
   if ( *addr > val ) *addr = val;
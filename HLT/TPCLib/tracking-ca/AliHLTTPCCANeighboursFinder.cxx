@@ -29,6 +29,33 @@
 #include "AliHLTTPCCADisplay.h"
 #endif //DRAW
 
+#ifdef HLTCA_CPU_VC
+#include "Vc/Vc"
+
+typedef Vc::Memory<Vc::float_v, ALIHLTTPCCANEIGHBOURS_FINDER_MAX_NNEIGHUP> AliHLTTPCCANeighboursFinderVcArray;
+
+static inline void AliHLTTPCCANeighboursFinderClosestVc( const AliHLTTPCCANeighboursFinderVcArray &yUp, const AliHLTTPCCANeighboursFinderVcArray &zUp, int nUp,
+                                                          float y, float z, int iDn, float &bestD, int &bestDn, int &bestUp )
+{
+  //SIMD version of the loop over the up-neighbour candidates for one down-neighbour:
+  //the distances to Vc::float_v::Size candidates are computed at once, and the first candidate
+  //with the smallest distance is kept, so the result is identical to the scalar loop.
+  //Padding entries of yUp / zUp must be set to a large value.
+  const int nVectors = ( nUp + Vc::float_v::Size - 1 ) / Vc::float_v::Size;
+  for ( int iV = 0; iV < nVectors; iV++ ) {
+    const Vc::float_v dy = Vc::float_v( y ) - yUp.vector( iV );
+    const Vc::float_v dz = Vc::float_v( z ) - zUp.vector( iV );
+    const Vc::float_v d = dy * dy + dz * dz;
+    const float dMin = d.min();
+    if ( dMin < bestD ) {
+      bestD = dMin;
+      bestDn = iDn;
+      bestUp = iV * Vc::float_v::Size + ( d == dMin ).firstOne();
+    }
+  }
+}
+#endif //HLTCA_CPU_VC
+
 GPUdi() void AliHLTTPCCANeighboursFinder::Thread
 ( int /*nBlocks*/, int nThreads, int iBlock, int iThread, int iSync,
   GPUsharedref() MEM_LOCAL(AliHLTTPCCASharedMemory) &s, GPUconstant() MEM_CONSTANT(AliHLTTPCCATracker) &tracker )
@@ -212,6 +239,16 @@ GPUdi() void AliHLTTPCCANeighboursFinder::Thread
           int bestDn = -1, bestUp = -1;
           float bestD = 1.e10;
 
+#ifdef HLTCA_CPU_VC
+          const bool useVc = AliHLTTPCCATracker::UseVc();
+          AliHLTTPCCANeighboursFinderVcArray yUpVc, zUpVc;
+          if ( useVc ) for ( unsigned int iUp = 0; iUp < yUpVc.vectorsCount() * Vc::float_v::Size; iUp++ ) {
+            const bool valid = ( int ) iUp < nNeighUp;
+            yUpVc[iUp] = valid ? yzUp[iUp].x : 1.e10f;
+            zUpVc[iUp] = valid ? yzUp[iUp].y : 1.e10f;
+          }
+#endif //HLTCA_CPU_VC
+
           do {
             AliHLTTPCCAHit h;
             int i = areaDn.GetNext( tracker, rowDn, tracker.Data(), &h );
@@ -220,6 +257,10 @@ GPUdi() void AliHLTTPCCANeighboursFinder::Thread
             nNeighDn++;
             float2 yzdn = CAMath::MakeFloat2( s.fUpDx * ( h.Y() - y ), s.fUpDx * ( h.Z() - z ) );
 
+#ifdef HLTCA_CPU_VC
+            if ( useVc ) AliHLTTPCCANeighboursFinderClosestVc( yUpVc, zUpVc, nNeighUp, yzdn.x, yzdn.y, i, bestD, bestDn, bestUp );
+            else
+#endif //HLTCA_CPU_VC
             for ( int iUp = 0; iUp < nNeighUp; iUp++ ) {
 #if defined(HLTCA_GPUCODE) & kMaxN > ALIHLTTPCCANEIGHBOURS_FINDER_MAX_NNEIGHUP & ALIHLTTPCCANEIGHBOURS_FINDER_MAX_NNEIGHUP > 0
 			  float2 yzup = iUp >= ALIHLTTPCCANEIGHBOURS_FINDER_MAX_NNEIGHUP ? yzUp2[iUp - ALIHLTTPCCANEIGHBOURS_FINDER_MAX_NNEIGHUP] : yzUp[iUp];
@@ -104,6 +104,23 @@ GPUg() void AliHLTTPCCAProcess( int nBlocks, int nThreads, AliHLTTPCCATracker &t
   }
 }
 
+template<class TProcess>
+GPUg() void AliHLTTPCCAProcessCPUThreads( int nBlocks, int nThreads, AliHLTTPCCATracker &tracker, int nCPUThreads )
+{
+  //Same as AliHLTTPCCAProcess, but distributes the blocks dynamically over nCPUThreads OpenMP threads.
+  //Only to be used for processes whose blocks are independent (no inter-block synchronisation)
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nCPUThreads) schedule(dynamic, 1) if(nCPUThreads > 1)
+#endif
+  for ( int iB = 0; iB < nBlocks; iB++ ) {
+    typename TProcess::AliHLTTPCCASharedMemory smem;
+    for ( int iS = 0; iS <= TProcess::NThreadSyncPoints(); iS++ )
+      for ( int iT = 0; iT < nThreads; iT++ ) {
+        TProcess::Thread( nBlocks, nThreads, iB, iT, iS, smem, tracker  );
+      }
+  }
+}
+
 template<typename TProcess>
 GPUg() void AliHLTTPCCAProcess1( int nBlocks, int nThreads, AliHLTTPCCATracker &tracker )
 {
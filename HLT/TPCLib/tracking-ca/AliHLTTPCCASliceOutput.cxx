@@ -43,15 +43,24 @@ void AliHLTTPCCASliceOutput::Allocate(AliHLTTPCCASliceOutput* &ptrOutput, int nT
 
 	if (outputControl->fOutputPtr)
 	{
-		if (outputControl->fOutputMaxSize < memsize)
+		//Slices may be processed by several CPU threads concurrently, the common output buffer is shared among them
+#ifdef _OPENMP
+#pragma omp critical(AliHLTTPCCASliceOutputAllocate)
+#endif
 		{
-			outputControl->fEndOfSpace = 1;
-			ptrOutput = NULL;
-			return;
+			if (outputControl->fOutputMaxSize < memsize)
+			{
+				outputControl->fEndOfSpace = 1;
+				ptrOutput = NULL;
+			}
+			else
+			{
+				ptrOutput = (AliHLTTPCCASliceOutput*) outputControl->fOutputPtr;
+				outputControl->fOutputPtr += memsize;
+				outputControl->fOutputMaxSize -= memsize;
+			}
 		}
-		ptrOutput = (AliHLTTPCCASliceOutput*) outputControl->fOutputPtr;
-		outputControl->fOutputPtr += memsize;
-		outputControl->fOutputMaxSize -= memsize;
+		if (ptrOutput == NULL) return;
 	}
 	else
 	{
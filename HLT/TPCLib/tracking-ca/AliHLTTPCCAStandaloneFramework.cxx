@@ -58,6 +58,9 @@ fTracker(1)
   }
   for ( int i = 0;i < fgkNSlices;i++) fSliceOutput[i] = NULL;
   fTracker.SetOutputControl(&fOutputControl);
+#ifdef HLTCA_STANDALONE
+  fMerger.SetNThreads(0); //all OpenMP threads as the slice tracker
+#endif
 }
 
 AliHLTTPCCAStandaloneFramework::AliHLTTPCCAStandaloneFramework( const AliHLTTPCCAStandaloneFramework& )
@@ -137,6 +140,50 @@ void AliHLTTPCCAStandaloneFramework::FinishDataReading()
 }
 
 
+int AliHLTTPCCAStandaloneFramework::BenchmarkThreads(int maxThreads, int nIterations)
+{
+  // run the CPU slice tracking of the current event with 1..maxThreads threads and print the timing
+
+  if (fTracker.GetGPUStatus() == 2)
+  {
+	printf("Thread benchmark requires the CPU tracker, disable the GPU tracker first\n");
+	return(1);
+  }
+  if (fOutputControl.fOutputPtr)
+  {
+	printf("Thread benchmark cannot be run with an external output buffer\n");
+	return(1);
+  }
+  if (maxThreads < 1 || nIterations < 1) return(1);
+
+  const int oldNThreads = fTracker.NThreads();
+  const int nThreadsSlice = fTracker.NThreadsSlice();
+  double timeSingle = 0.;
+  int retVal = 0;
+
+  for (int nThreads = 1;nThreads <= maxThreads && retVal == 0;nThreads++)
+  {
+	fTracker.SetNThreads(nThreads, nThreadsSlice);
+	TStopwatch timer;
+	for (int iIter = 0;iIter < nIterations;iIter++)
+	{
+	  if (fTracker.ProcessSlices(0, fgkNSlices, fClusterData, fSliceOutput))
+	  {
+		retVal = 1;
+		break;
+	  }
+	}
+	timer.Stop();
+	if (retVal) break;
+	const double timePerEvent = timer.RealTime() / nIterations;
+	if (nThreads == 1) timeSingle = timePerEvent;
+	printf("CPU slice tracking with %3d threads: %10.3f ms per event, speedup %6.2f\n", nThreads, timePerEvent * 1000., timePerEvent > 0. ? timeSingle / timePerEvent : 0.);
+  }
+
+  fTracker.SetNThreads(oldNThreads, nThreadsSlice);
+  return(retVal);
+}
+
 int AliHLTTPCCAStandaloneFramework::ProcessEvent(int forceSingleSlice)
 {
   // perform the event reconstruction
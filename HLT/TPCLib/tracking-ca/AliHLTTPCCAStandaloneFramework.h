@@ -70,6 +70,11 @@ class AliHLTTPCCAStandaloneFramework
      */
     int ProcessEvent(int forceSingleSlice = -1);
 
+    /**
+     *  time the CPU slice tracking of the current event for 1..maxThreads threads
+     */
+    int BenchmarkThreads(int maxThreads, int nIterations = 1);
+
 
     int NSlices() const { return fgkNSlices; }
 
@@ -90,6 +95,7 @@ class AliHLTTPCCAStandaloneFramework
 	void SetGPUDebugLevel(int Level, std::ostream *OutFile = NULL, std::ostream *GPUOutFile = NULL) { fDebugLevel = Level; fTracker.SetGPUDebugLevel(Level, OutFile, GPUOutFile); fMerger.SetDebugLevel(Level);}
 	int SetGPUTrackerOption(char* OptionName, int OptionValue) {return(fTracker.SetGPUTrackerOption(OptionName, OptionValue));}
 	int SetGPUTracker(bool enable) { return(fTracker.SetGPUTracker(enable)); }
+	int SetNThreads(int nThreads, int nThreadsSlice = 1) { fMerger.SetNThreads(nThreads); return(fTracker.SetNThreads(nThreads, nThreadsSlice)); }
 	int GetGPUStatus() const { return(fTracker.GetGPUStatus()); }
 	int GetGPUMaxSliceCount() const { return(fTracker.MaxSliceCount()); }
 	void SetEventDisplay(int v) {fEventDisplay = v;}
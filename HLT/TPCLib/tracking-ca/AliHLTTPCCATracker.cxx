@@ -61,6 +61,8 @@ ClassImp( AliHLTTPCCATracker )
 
 #if !defined(HLTCA_GPUCODE)
 
+bool AliHLTTPCCATracker::fgUseVc = true;
+
 AliHLTTPCCATracker::~AliHLTTPCCATracker()
 {
 	// destructor
@@ -486,8 +488,8 @@ GPUh() int AliHLTTPCCATracker::CheckEmptySlice() const
 
 void AliHLTTPCCATracker::RunNeighboursFinder()
 {
-	//Run the CPU Neighbours Finder
-	AliHLTTPCCAProcess<AliHLTTPCCANeighboursFinder>( Param().NRows(), 1, *this );
+	//Run the CPU Neighbours Finder, rows are independent and can be processed in parallel
+	AliHLTTPCCAProcessCPUThreads<AliHLTTPCCANeighboursFinder>( Param().NRows(), 1, *this, fNCPUThreads );
 }
 
 void AliHLTTPCCATracker::RunNeighboursCleaner()
@@ -66,6 +66,7 @@ MEM_CLASS_PRE() class AliHLTTPCCATracker
       fIsGPUTracker( false ),
       fGPUDebugLevel( 0 ),
       fGPUDebugOut( 0 ),
+      fNCPUThreads( 1 ),
       fRowStartHitCountOffset( NULL ),
       fTrackletTmpStartHits( NULL ),
       fGPUTrackletTemp( NULL ),
@@ -146,6 +147,12 @@ MEM_CLASS_PRE() class AliHLTTPCCATracker
   void SetGPUTracker();
 #if !defined(__OPENCL__) || defined(HLTCA_HOSTCODE)
   void SetGPUDebugLevel(int Level, std::ostream *NewDebugOut = NULL) {fGPUDebugLevel = Level;if (NewDebugOut) fGPUDebugOut = NewDebugOut;}
+  void SetNCPUThreads(int n) {fNCPUThreads = n < 1 ? 1 : n;}
+  int NCPUThreads() const {return(fNCPUThreads);}
+#ifndef HLTCA_GPUCODE
+  static void SetUseVc(bool v) {fgUseVc = v;}
+  static bool UseVc() {return(fgUseVc);}
+#endif
   char* SetGPUTrackerCommonMemory(char* const pGPUMemory);
   char* SetGPUTrackerHitsMemory(char* pGPUMemory, int MaxNHits);
   char* SetGPUTrackerTrackletsMemory(char* pGPUMemory, int MaxNTracklets, int constructorBlockCount);
@@ -357,6 +364,10 @@ private:
 #else
   void* fGPUDebugOut; //No this is a hack, but I have no better idea.
 #endif
+  int fNCPUThreads; //Number of OpenMP threads used inside one slice by the CPU tracker (neighbours finder, tracklet constructor)
+#ifndef HLTCA_GPUCODE
+  static bool fgUseVc; //Use the Vc SIMD candidate searches of the CPU tracker if compiled with HLTCA_CPU_VC (default), false for the scalar loops
+#endif
   
   //GPU Temp Arrays
   GPUglobalref() uint3* fRowStartHitCountOffset;				//Offset, length and new offset of start hits in row
@@ -71,6 +71,8 @@ ClassImp( AliHLTTPCCATrackerComponent )
   fAllowGPU( 0),
   fGPUHelperThreads(-1),
   fCPUTrackers(0),
+  fCPUThreads(1),
+  fCPUSliceThreads(1),
   fGlobalTracking(0),
   fGPUDeviceNum(-1),
   fGPULibrary("")
@@ -103,6 +105,8 @@ AliHLTProcessor(),
   fAllowGPU( 0),
   fGPUHelperThreads(-1),
   fCPUTrackers(0),
+  fCPUThreads(1),
+  fCPUSliceThreads(1),
   fGlobalTracking(0),
   fGPUDeviceNum(-1),
   fGPULibrary("")
@@ -279,6 +283,20 @@ int AliHLTTPCCATrackerComponent::ReadConfigurationString(  const char* arguments
       continue;
     }
 
+    if ( argument.CompareTo( "-CPUThreads" ) == 0 ) {
+      if ( ( bMissingParam = ( ++i >= pTokens->GetEntries() ) ) ) break;
+      fCPUThreads = ( ( TObjString* )pTokens->At( i ) )->GetString().Atoi();
+      HLTInfo( "Number of CPU tracker threads set to: %d", fCPUThreads );
+      continue;
+    }
+
+    if ( argument.CompareTo( "-CPUSliceThreads" ) == 0 ) {
+      if ( ( bMissingParam = ( ++i >= pTokens->GetEntries() ) ) ) break;
+      fCPUSliceThreads = ( ( TObjString* )pTokens->At( i ) )->GetString().Atoi();
+      HLTInfo( "Number of CPU tracker threads per slice set to: %d", fCPUSliceThreads );
+      continue;
+    }
+
     if ( argument.CompareTo( "-GPUDeviceNum" ) == 0 ) {
       if ( ( bMissingParam = ( ++i >= pTokens->GetEntries() ) ) ) break;
       fGPUDeviceNum = ( ( TObjString* )pTokens->At( i ) )->GetString().Atoi();
@@ -443,6 +461,10 @@ int AliHLTTPCCATrackerComponent::DoInit( int argc, const char** argv )
       return -ENODEV;
     }
     fClusterData = new AliHLTTPCCAClusterData[fgkNSlices];
+    if (fTracker->SetNThreads(fCPUThreads, fCPUSliceThreads)) {
+      HLTError("Invalid CPU tracker thread configuration");
+      return -EINVAL;
+    }
     if (fGPUHelperThreads != -1)
     {
       char cc[256] = "HelperThreads";
@@ -102,6 +102,8 @@ class AliHLTTPCCATrackerComponent : public AliHLTProcessor
     bool fAllowGPU;                   //* Allow this tracker to run on GPU
     int fGPUHelperThreads;            // Number of helper threads for GPU tracker, set to -1 to use default number
     int fCPUTrackers;                 //Number of CPU trackers to run in addition to GPU tracker
+    int fCPUThreads;                  //Number of threads processing slices in parallel on the CPU, default 1, 0 for all OpenMP threads
+    int fCPUSliceThreads;             //Number of threads used inside a single slice on the CPU
     bool fGlobalTracking;             //Activate global tracking feature
 	int fGPUDeviceNum;				  //GPU Device to use, default -1 for auto detection
 	TString fGPULibrary;			  //Name of the library file that provides the GPU tracker object
@@ -32,7 +32,7 @@
 #include <dlfcn.h>
 #endif
 
-#ifdef HLTCA_STANDALONE
+#if defined(HLTCA_STANDALONE) || defined(_OPENMP)
 #include <omp.h>
 #endif
 
@@ -113,16 +113,20 @@ int AliHLTTPCCATrackerFramework::ProcessSlices(int firstSlice, int sliceCount, A
 	else
 	{
 #ifdef HLTCA_STANDALONE
-		if (fOutputControl->fOutputPtr && omp_get_max_threads() > 1)
+		int nLocalTracks = 0, nGlobalTracks = 0, nOutputTracks = 0, nLocalHits = 0, nGlobalHits = 0;
+#endif
+		//Slices are distributed dynamically over the CPU threads, so that large slices do not stall the others
+		const int nSlices = CAMath::Min(sliceCount, fgkNSlices - firstSlice);
+		const int nThreads = CPUThreadCount(nSlices);
+		for (int iSlice = 0;iSlice < nSlices;iSlice++)
 		{
-			HLTError("fOutputPtr must not be used with OpenMP\n");
-			return(1);
+			//Threads inside a slice only become active if the slice loop runs single-threaded (e.g. single slice) or nested OpenMP is enabled
+			fCPUTrackers[firstSlice + iSlice].SetNCPUThreads(fCPUNThreadsSlice);
 		}
-		int nLocalTracks = 0, nGlobalTracks = 0, nOutputTracks = 0, nLocalHits = 0, nGlobalHits = 0;
-
-#pragma omp parallel for
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nThreads) schedule(dynamic, 1) if(nThreads > 1)
 #endif
-		for (int iSlice = 0;iSlice < CAMath::Min(sliceCount, fgkNSlices - firstSlice);iSlice++)
+		for (int iSlice = 0;iSlice < nSlices;iSlice++)
 		{
 #ifdef HLTCA_STANDALONE
 			fCPUTrackers[firstSlice + iSlice].StandalonePerfTime(0);
@@ -195,6 +199,36 @@ int AliHLTTPCCATrackerFramework::ProcessSlices(int firstSlice, int sliceCount, A
 	return(0);
 }
 
+int AliHLTTPCCATrackerFramework::SetNThreads(int nThreads, int nThreadsSlice)
+{
+	//Set the number of CPU threads used to process slices in parallel (default 0 = all OpenMP threads)
+	//and the number of threads used inside a single slice tracker
+	if (nThreads < 0 || nThreadsSlice < 1)
+	{
+		HLTError("Invalid number of CPU tracker threads (%d / %d per slice)", nThreads, nThreadsSlice);
+		return(1);
+	}
+#ifndef _OPENMP
+	if (nThreads > 1 || nThreadsSlice > 1)
+	{
+		HLTWarning("Compiled without OpenMP support, CPU tracker will run single-threaded");
+	}
+#endif
+	fCPUNThreads = nThreads;
+	fCPUNThreadsSlice = nThreadsSlice;
+	return(0);
+}
+
+int AliHLTTPCCATrackerFramework::CPUThreadCount(int nSlices) const
+{
+	//Number of threads to use for processing nSlices slices in parallel
+	int nThreads = 1;
+#ifdef _OPENMP
+	nThreads = fCPUNThreads ? fCPUNThreads : omp_get_max_threads();
+#endif
+	return(CAMath::Max(1, CAMath::Min(nThreads, nSlices)));
+}
+
 unsigned long long int* AliHLTTPCCATrackerFramework::PerfTimer(int GPU, int iSlice, int iTimer)
 {
 	//Performance information for slice trackers
@@ -215,7 +249,7 @@ int AliHLTTPCCATrackerFramework::InitializeSliceParam(int iSlice, AliHLTTPCCAPar
 #define GPULIBNAME "libAliHLTTPCCAGPU"
 #endif
 
-AliHLTTPCCATrackerFramework::AliHLTTPCCATrackerFramework(int allowGPU, const char* GPU_Library, int GPUDeviceNum) : fGPULibAvailable(false), fGPUTrackerAvailable(false), fUseGPUTracker(false), fGPUDebugLevel(0), fGPUTracker(NULL), fGPULib(NULL), fOutputControl( NULL ), fKeepData(false), fGlobalTracking(false)
+AliHLTTPCCATrackerFramework::AliHLTTPCCATrackerFramework(int allowGPU, const char* GPU_Library, int GPUDeviceNum) : fGPULibAvailable(false), fGPUTrackerAvailable(false), fUseGPUTracker(false), fGPUDebugLevel(0), fGPUTracker(NULL), fGPULib(NULL), fOutputControl( NULL ), fKeepData(false), fGlobalTracking(false), fCPUNThreads(0), fCPUNThreadsSlice(1)
 {
 	//Constructor
 	if (GPU_Library && !GPU_Library[0]) GPU_Library = NULL;
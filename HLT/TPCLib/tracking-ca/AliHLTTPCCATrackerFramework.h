@@ -43,6 +43,9 @@ public:
 	GPUhd() void SetOutputControl( AliHLTTPCCASliceOutput::outputControlStruct* val);
 
 	int ProcessSlices(int firstSlice, int sliceCount, AliHLTTPCCAClusterData* pClusterData, AliHLTTPCCASliceOutput** pOutput);
+	int SetNThreads(int nThreads, int nThreadsSlice = 1);
+	int NThreads() const { return(fCPUNThreads); }
+	int NThreadsSlice() const { return(fCPUNThreadsSlice); }
 	unsigned long long int* PerfTimer(int GPU, int iSlice, int iTimer);
 
 	int MaxSliceCount() const { return(fUseGPUTracker ? (fGPUTrackerAvailable ? fGPUTracker->GetSliceCount() : 0) : fCPUSliceCount); }
@@ -72,6 +75,10 @@ private:
 
   bool fKeepData;		//Keep temporary data and do not free memory imediately, used for Standalone Debug Event Display
   bool fGlobalTracking;	//Use global tracking
+  int fCPUNThreads;		//Number of CPU threads processing slices in parallel, default 0 for all OpenMP threads, the AliRoot wrappers set 1
+  int fCPUNThreadsSlice;	//Number of CPU threads used inside a slice when there are more threads than slices
+
+  int CPUThreadCount(int nSlices) const;
 
   AliHLTTPCCATrackerFramework( const AliHLTTPCCATrackerFramework& );
   AliHLTTPCCATrackerFramework &operator=( const AliHLTTPCCATrackerFramework& );
@@ -26,6 +26,41 @@
 #include "AliHLTTPCCATracklet.h"
 #include "AliHLTTPCCATrackletConstructor.h"
 
+#ifdef HLTCA_CPU_VC
+#include "Vc/Vc"
+
+static inline void AliHLTTPCCATrackletConstructorClosestHitVc( const ushort2 *hits, unsigned int first, unsigned int last, int y0, int z0, int &ds, int &best )
+{
+  //SIMD version of the search for the closest hit in the hit range [first, last) of a row.
+  //The y and z ushort coordinates of Vc::int_v::Size hits are gathered into int vectors,
+  //which does not depend on the layout of ushort2 in memory.
+  //The first hit with the smallest distance is kept, so the result is identical to the scalar loop.
+  unsigned int i = first;
+  for ( ; i + Vc::int_v::Size <= last; i += Vc::int_v::Size ) {
+    Vc::int_v hy, hz;
+    for ( unsigned int j = 0; j < Vc::int_v::Size; j++ ) {
+      hy[j] = hits[i + j].x;
+      hz[j] = hits[i + j].y;
+    }
+    const Vc::int_v ddy = hy - Vc::int_v( y0 );
+    const Vc::int_v ddz = hz - Vc::int_v( z0 );
+    const Vc::int_v dds = Vc::abs( ddy ) + Vc::abs( ddz );
+    const int dsMin = dds.min();
+    if ( dsMin < ds ) {
+      ds = dsMin;
+      best = i + ( dds == dsMin ).firstOne();
+    }
+  }
+  for ( ; i < last; i++ ) {
+    const int dds = CAMath::Abs( ( int ) hits[i].x - y0 ) + CAMath::Abs( ( int ) hits[i].y - z0 );
+    if ( dds < ds ) {
+      ds = dds;
+      best = i;
+    }
+  }
+}
+#endif //HLTCA_CPU_VC
+
 #define kMaxRowGap 4
 
 MEM_CLASS_PRE2() GPUdi() void AliHLTTPCCATrackletConstructor::InitTracklet( MEM_LG2(AliHLTTPCCATrackParam) &tParam )
@@ -334,6 +369,14 @@ MEM_CLASS_PRE2() GPUdi() void AliHLTTPCCATrackletConstructor::UpdateTracklet
           assert( (signed) fHitYlst1 <= row.NHits() );
         }
 
+#ifdef HLTCA_CPU_VC
+		if ( r.fStage <= 2 && AliHLTTPCCATracker::UseVc() ) {
+		  //No hit weight check needed, both hit ranges can be searched with SIMD instructions
+		  AliHLTTPCCATrackletConstructorClosestHitVc( hits, fHitYfst, fHitYlst, fY0, fZ0, ds, best );
+		  AliHLTTPCCATrackletConstructorClosestHitVc( hits, fHitYfst1, fHitYlst1, fY0, fZ0, ds, best );
+		} else
+#endif //HLTCA_CPU_VC
+		{
 		for ( unsigned int fIh = fHitYfst; fIh < fHitYlst; fIh++ ) {
           assert( (signed) fIh < row.NHits() );
           ushort2 hh;
@@ -370,6 +413,7 @@ MEM_CLASS_PRE2() GPUdi() void AliHLTTPCCATrackletConstructor::UpdateTracklet
             best = fIh;
           }
         }
+		}
       }// end of search for the closest hit
 
       if ( best < 0 )
@@ -438,9 +482,14 @@ MEM_CLASS_PRE2() GPUdi() void AliHLTTPCCATrackletConstructor::UpdateTracklet
 GPUdi() void AliHLTTPCCATrackletConstructor::AliHLTTPCCATrackletConstructorCPU(AliHLTTPCCATracker &tracker)
 {
 	//Tracklet constructor simple CPU Function that does not neew a scheduler
+	//Tracklets are independent (hit weights are maximized atomically), so they are distributed over the CPU threads of the slice tracker
 	GPUshared() AliHLTTPCCASharedMemory sMem;
 	sMem.fNTracklets = *tracker.NTracklets();
-	for (int iTracklet = 0;iTracklet < *tracker.NTracklets();iTracklet++)
+	const int nCPUThreads = tracker.NCPUThreads();
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nCPUThreads) schedule(dynamic, 16) if(nCPUThreads > 1)
+#endif
+	for (int iTracklet = 0;iTracklet < sMem.fNTracklets;iTracklet++)
 	{
 		AliHLTTPCCATrackParam tParam;
 		AliHLTTPCCAThreadMemory rMem;
@@ -79,7 +79,7 @@ AliTPCtrackerCA::AliTPCtrackerCA( const AliTPCParam *par ):
   fDoHLTPerformanceClusters = 0;
 
   AliHLTTPCCAStandaloneFramework &hlt = AliHLTTPCCAStandaloneFramework::Instance();
-
+  hlt.SetNThreads( 1 ); // the reconstruction may share the node, all OpenMP threads only in the standalone tracker
 
   for ( int iSlice = 0; iSlice < hlt.NSlices(); iSlice++ ) {
 
@@ -45,6 +45,7 @@ const UInt_t AliZMQhelpers::DataTopic::fgkTopicSerialization = CharArr2uint64("N
 const ULong64_t AliZMQhelpers::kSerializationROOT = CharArr2uint64("ROOT   ");
 const ULong64_t AliZMQhelpers::kSerializationNONE = CharArr2uint64("NONE   ");
 
+const AliZMQhelpers::DataTopic AliZMQhelpers::kDataTypeBatch("BATCH___","***\n",0);
 const AliZMQhelpers::DataTopic AliZMQhelpers::kDataTypeStreamerInfos("ROOTSTRI","***\n",0);
 const AliZMQhelpers::DataTopic AliZMQhelpers::kDataTypeInfo("INFO____","***\n",0);
 const AliZMQhelpers::DataTopic AliZMQhelpers::kDataTypeConfig("CONFIG__","***\n",0);
@@ -375,6 +376,170 @@ int AliZMQhelpers::alizmq_msg_add(aliZMQmsg* message, const DataTopic* topic, vo
   return message->size();
 }
 
+//_______________________________________________________________________________________
+int AliZMQhelpers::alizmq_msg_add_nocopy(aliZMQmsg* message, const DataTopic* topic, void* data, size_t size,
+                                         alizmq_free_fn* freeFn, void* hint)
+{
+  //add a frame to the message, the data is not copied
+  int rc = 0;
+
+  //prepare topic msg
+  zmq_msg_t* topicMsg = new zmq_msg_t;
+  rc = zmq_msg_init_size( topicMsg, sizeof(*topic));
+  if (rc<0) {
+    zmq_msg_close(topicMsg);
+    delete topicMsg;
+    return -1;
+  }
+  memcpy(zmq_msg_data(topicMsg),topic,sizeof(*topic));
+
+  //prepare data msg
+  zmq_msg_t* dataMsg = new zmq_msg_t;
+  rc = zmq_msg_init_data( dataMsg, data, size, freeFn, hint);
+  if (rc<0) {
+    zmq_msg_close(topicMsg);
+    zmq_msg_close(dataMsg);
+    delete topicMsg;
+    delete dataMsg;
+    return -1;
+  }
+
+  //add the frame to the message
+  message->push_back(std::make_pair(topicMsg,dataMsg));
+  return message->size();
+}
+
+//_______________________________________________________________________________________
+int AliZMQhelpers::alizmq_batch_add(BatchBuffer* batch, const DataTopic* topic, const void* buffer, size_t size)
+{
+  //append a block to the batch, payloads are 8 byte aligned
+  if (!batch || !topic) return -1;
+  if (!batch->fPayload) {
+    batch->fPayload = new std::vector<char>;
+    batch->fPayload->reserve(batch->fReserve);
+  }
+  std::vector<char>& payload = *batch->fPayload;
+  size_t offset = (payload.size()+7) & ~(size_t)7;
+
+  BatchIndexEntry entry;
+  entry.fID = *topic->GetIDptr();
+  entry.fOrigin = *topic->GetOriginPtr();
+  entry.fEvent = batch->fNevents;
+  entry.fSerialization = topic->fDataSerialization;
+  entry.fSpecification = topic->fSpecification;
+  entry.fOffset = offset;
+  entry.fSize = size;
+  batch->fIndex.push_back(entry);
+
+  payload.resize(offset+size);
+  if (size>0) memcpy(&payload[offset], buffer, size);
+  return batch->fIndex.size();
+}
+
+//_______________________________________________________________________________________
+void AliZMQhelpers::alizmq_batch_close_event(BatchBuffer* batch)
+{
+  //blocks added from now on belong to the next event
+  if (!batch) return;
+  batch->fNevents++;
+}
+
+//_______________________________________________________________________________________
+int AliZMQhelpers::alizmq_msg_add(aliZMQmsg* message, BatchBuffer* batch)
+{
+  //add the batch as one frame: topic + index in the first part, all payloads
+  //in the second. The payload buffer is handed over to ZMQ.
+  int rc = 0;
+  if (!batch || batch->fIndex.empty()) return 0;
+
+  //an event with blocks which was not closed yet counts as well
+  if (batch->fIndex.back().fEvent==batch->fNevents) alizmq_batch_close_event(batch);
+
+  DataTopic topic = kDataTypeBatch;
+  topic.fSpecification = batch->fIndex.size();
+  topic.fPayloadSize = batch->PayloadSize();
+  BatchHeader header;
+  header.fNblocks = batch->fIndex.size();
+  header.fNevents = batch->fNevents;
+  size_t indexSize = batch->fIndex.size()*sizeof(BatchIndexEntry);
+
+  //prepare topic msg
+  zmq_msg_t* topicMsg = new zmq_msg_t;
+  rc = zmq_msg_init_size( topicMsg, sizeof(topic)+sizeof(header)+indexSize);
+  if (rc<0) {
+    zmq_msg_close(topicMsg);
+    delete topicMsg;
+    return -1;
+  }
+  char* topicData = static_cast<char*>(zmq_msg_data(topicMsg));
+  memcpy(topicData, &topic, sizeof(topic));
+  memcpy(topicData+sizeof(topic), &header, sizeof(header));
+  memcpy(topicData+sizeof(topic)+sizeof(header), &batch->fIndex[0], indexSize);
+
+  //prepare data msg
+  std::vector<char>* payload = batch->fPayload;
+  zmq_msg_t* dataMsg = new zmq_msg_t;
+  rc = zmq_msg_init_data( dataMsg, payload->empty()?NULL:&(*payload)[0], payload->size(),
+                          alizmq_deleteBatchPayload, payload);
+  if (rc<0) {
+    zmq_msg_close(topicMsg);
+    zmq_msg_close(dataMsg);
+    delete topicMsg;
+    delete dataMsg;
+    return -1;
+  }
+
+  //reset the batch, the next payload starts with the capacity of this one
+  batch->fReserve = payload->capacity();
+  batch->fPayload = NULL;
+  batch->fIndex.clear();
+  batch->fNevents = 0;
+
+  //add the frame to the message
+  message->push_back(std::make_pair(topicMsg,dataMsg));
+  return message->size();
+}
+
+//_______________________________________________________________________________________
+int AliZMQhelpers::alizmq_msg_iter_batch(aliZMQmsg::iterator it, aliZMQbatchIndex& blocks)
+{
+  //unpack the index of a batch frame, the blocks point into the data frame
+  blocks.clear();
+  size_t topicSize = zmq_msg_size(it->first);
+  if (topicSize<sizeof(DataTopic)+sizeof(BatchHeader)) return -1;
+  const char* topicData = static_cast<const char*>(zmq_msg_data(it->first));
+  DataTopic* topic = DataTopic::Get(const_cast<char*>(topicData));
+  if (!topic || *topic->GetIDptr()!=*kDataTypeBatch.GetIDptr()) return -1;
+
+  BatchHeader header;
+  memcpy(&header, topicData+sizeof(DataTopic), sizeof(header));
+  if (topicSize<sizeof(DataTopic)+sizeof(header)+header.fNblocks*sizeof(BatchIndexEntry)) return -1;
+  const BatchIndexEntry* index =
+    reinterpret_cast<const BatchIndexEntry*>(topicData+sizeof(DataTopic)+sizeof(header));
+
+  char* payload = static_cast<char*>(zmq_msg_data(it->second));
+  size_t payloadSize = zmq_msg_size(it->second);
+  blocks.reserve(header.fNblocks);
+  for (UInt_t i=0; i<header.fNblocks; i++) {
+    const BatchIndexEntry& entry = index[i];
+    if (entry.fOffset+entry.fSize>payloadSize) {
+      blocks.clear();
+      return -1;
+    }
+    BatchBlock block;
+    block.fTopic.SetID(entry.fID);
+    block.fTopic.SetOrigin(entry.fOrigin);
+    block.fTopic.SetSerialization(entry.fSerialization);
+    block.fTopic.fSpecification = entry.fSpecification;
+    block.fTopic.fPayloadSize = entry.fSize;
+    block.fPtr = payload+entry.fOffset;
+    block.fSize = entry.fSize;
+    block.fEvent = entry.fEvent;
+    blocks.push_back(block);
+  }
+  return blocks.size();
+}
+
 //_______________________________________________________________________________________
 int AliZMQhelpers::alizmq_msg_add(aliZMQmsg* message, const DataTopic* topic, const std::string& data)
 {
@@ -740,6 +905,13 @@ void AliZMQhelpers::alizmq_deleteTopic(void*, void* object)
   delete topic;
 }
 
+//______________________________________________________________________________
+void AliZMQhelpers::alizmq_deleteBatchPayload(void*, void* object)
+{
+  //delete the batch payload, for use in zmq_msg_init_data(...) only.
+  std::vector<char>* payload = static_cast<std::vector<char>*>(object);
+  delete payload;
+}
 
 //_______________________________________________________________________________________
 int AliZMQhelpers::alizmq_msg_close(aliZMQmsg* message)
@@ -23,6 +23,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include "TMessage.h"
 struct zmq_msg_t;
 class TVirtualStreamerInfo;
@@ -76,6 +77,11 @@ int alizmq_msg_add(aliZMQmsg* message, DataTopic* topic, TObject* object, int co
 int alizmq_msg_add(aliZMQmsg* message, const DataTopic* topic, const std::string& data);
 int alizmq_msg_add(aliZMQmsg* message, const DataTopic* topic, void* buffer, int size);
 int alizmq_msg_add(aliZMQmsg* message, const std::string& topic, const std::string& data);
+//zero copy: the buffer is attached to the frame and has to stay valid until
+//ZMQ calls freeFn(buffer,hint), possibly from the ZMQ I/O thread
+typedef void (alizmq_free_fn)(void* data, void* hint);
+int alizmq_msg_add_nocopy(aliZMQmsg* message, const DataTopic* topic, void* buffer, size_t size,
+                          alizmq_free_fn* freeFn, void* hint);
 int alizmq_msg_copy(aliZMQmsg* dst, aliZMQmsg* src);
 int alizmq_msg_send(aliZMQmsg* message, void* socket, int flags);
 int alizmq_msg_close(aliZMQmsg* message);
@@ -112,6 +118,7 @@ int alizmq_msg_send(const DataTopic& topic, const std::string& data, void* socke
 //deallocate an object - callback for ZMQ
 void alizmq_deleteTObject(void*, void* object);
 void alizmq_deleteTopic(void*, void* object);
+void alizmq_deleteBatchPayload(void*, void* object);
 
 const int kDataTypefIDsize = 8;
 const int kDataTypefOriginSize = 4;
@@ -228,7 +235,67 @@ struct DataTopic : public BaseDataTopic
   }
 };
 
+//batched frames: the blocks of one or more events in one topic/data frame pair.
+//The topic frame is a DataTopic of type kDataTypeBatch followed by a BatchHeader
+//and a compact index of BatchIndexEntry, the data frame holds the payloads
+//at the (8 byte aligned) offsets given in the index.
+struct BatchHeader
+{
+  UInt_t fNblocks;  // 4 bytes
+  UInt_t fNevents;  // 4 bytes
+};
+
+struct BatchIndexEntry
+{
+  ULong64_t fID;                // 8 bytes data description
+  UInt_t fOrigin;               // 4 bytes
+  UInt_t fEvent;                // 4 bytes event number within the batch
+  ULong64_t fSerialization;     // 8 bytes
+  ULong64_t fSpecification;     // 8 bytes
+  ULong64_t fOffset;            // 8 bytes offset in the data frame
+  ULong64_t fSize;              // 8 bytes
+};
+
+//a batch under construction on the sending side
+struct BatchBuffer
+{
+  BatchBuffer() : fIndex(), fPayload(NULL), fNevents(0), fReserve(0) {}
+  ~BatchBuffer() {delete fPayload;}
+  size_t PayloadSize() const {return fPayload?fPayload->size():0;}
+  size_t GetNblocks() const {return fIndex.size();}
+
+  std::vector<BatchIndexEntry> fIndex; //the block index
+  std::vector<char>* fPayload;         //the payloads, ownership goes to ZMQ on send
+  UInt_t fNevents;                     //number of closed events
+  size_t fReserve;                     //capacity of the last payload, reused for the next one
+
+private:
+  BatchBuffer(const BatchBuffer&);
+  BatchBuffer& operator=(const BatchBuffer&);
+};
+
+//a block of a received batch, the data stays in the ZMQ frame
+struct BatchBlock
+{
+  DataTopic fTopic;
+  void* fPtr;
+  size_t fSize;
+  UInt_t fEvent;
+};
+typedef std::vector<BatchBlock> aliZMQbatchIndex;
+
+//copy a block into the batch, it belongs to the currently open event
+int alizmq_batch_add(BatchBuffer* batch, const DataTopic* topic, const void* buffer, size_t size);
+//close the current event, following blocks belong to the next one
+void alizmq_batch_close_event(BatchBuffer* batch);
+//move the batch into a message without copying the payload, the batch is reset
+int alizmq_msg_add(aliZMQmsg* message, BatchBuffer* batch);
+//get the index of a batch frame, returns the number of blocks or -1 if the
+//frame is not a (valid) batch
+int alizmq_msg_iter_batch(aliZMQmsg::iterator it, aliZMQbatchIndex& blocks);
+
 //common data type definitions, compatible with AliHLTDataTypes v25
+extern const DataTopic kDataTypeBatch;
 extern const DataTopic kDataTypeStreamerInfos;
 extern const DataTopic kDataTypeInfo;
 extern const DataTopic kDataTypeConfig;
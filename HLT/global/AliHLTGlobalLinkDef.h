@@ -45,6 +45,7 @@
 #pragma link C++ class AliHLTGlobalFlatEsdTestComponent+;
 #pragma link C++ class AliHLTAnalysisManager+;
 #pragma link C++ class AliHLTAnalysisManagerComponent+;
+#pragma link C++ class AliHLTFlatESDInputHandler+;
 #pragma link C++ class AliHLTLumiRegComponent+;
 #pragma link C++ class AliHLTGlobalPromptRecoQAComponent+;
 #pragma link C++ class AliAnalysisTaskExampleV+;
@@ -28,6 +28,7 @@
 #include "TCollection.h"
 #include "TList.h"
 #include "AliHLTZMQhelpers.h"
+#include <unistd.h>
 
 using namespace std;
 
@@ -53,6 +54,12 @@ AliHLTZMQsink::AliHLTZMQsink() :
   , fSendStreamerInfos(kFALSE)
   , fCDBpattern("^/*[a-zA-Z0-9_.-]+/[a-zA-Z0-9_.-]+/[a-zA-Z0-9_.-]+/*$")
   , fInfoString()
+  , fBatchEvents(0)
+  , fBatchMaxSize(64000000)
+  , fBatch()
+  , fZMQzeroCopy(kFALSE)
+  , fZMQzeroCopyTimeout(1000)
+  , fNzeroCopyPending(0)
 {
   //ctor
 }
@@ -132,6 +139,20 @@ Int_t AliHLTZMQsink::DoInit( Int_t /*argc*/, const Char_t** /*argv*/ )
     return -1;
   }
 
+  //replies are sent per request, batching only for PUB/PUSH
+  if (fBatchEvents>0 && fZMQsocketType==ZMQ_REP)
+  {
+    HLTWarning("batching not supported for REP sockets, sending every event");
+    fBatchEvents=0;
+  }
+  //with inproc the receiver gets the frames by reference and would
+  //keep using the input blocks after they are released
+  if (fZMQzeroCopy && fZMQoutConfig.find("inproc://")!=std::string::npos)
+  {
+    HLTWarning("zero copy not supported for inproc transport, blocks are copied");
+    fZMQzeroCopy=kFALSE;
+  }
+
   HLTMessage(Form("socket create ptr %p %s",fZMQout,(rc<0)?zmq_strerror(errno):""));
   HLTMessage(Form("ZMQ connected to: %s (%s(id %i)) rc %i %s",
                fZMQoutConfig.c_str(),alizmq_socket_name(fZMQsocketType),
@@ -150,6 +171,7 @@ Int_t AliHLTZMQsink::DoDeinit()
 {
   // see header file for class documentation
   int retCode = 0;
+  if (fBatch.GetNblocks()>0) SendBatch();
   retCode = alizmq_socket_close(fZMQout);
   return retCode;
 }
@@ -365,81 +387,116 @@ int AliHLTZMQsink::DoProcessing( const AliHLTComponentEventData& evtData,
     int nSelectedBlocks = selectedBlockIdx.size();
     int nSentBlocks = 0;
 
-    aliZMQmsg message;
-
-    //only send the INFO block if there is some data to send
-    if (fSendRunNumber && nSelectedBlocks>0)
+    if (fBatchEvents>0)
     {
-      AliHLTDataTopic topic = kAliHLTDataTypeInfo;
-      rc = alizmq_msg_add(&message, &topic, fInfoString);
-      if (rc<0) {
-        HLTWarning("ZMQ error adding INFO");
+      //batching: collect the selected blocks, send when the batch is full
+      for (int iSelectedBlock = 0;
+           iSelectedBlock < nSelectedBlocks;
+           iSelectedBlock++)
+      {
+        inputBlock = &blocks[selectedBlockIdx[iSelectedBlock]];
+        AliHLTDataTopic blockTopic(*inputBlock);
+        rc = alizmq_batch_add(&fBatch, &blockTopic, inputBlock->fPtr, inputBlock->fSize);
+        if (rc<0) {
+          HLTWarning("error adding block %s to batch", blockTopic.Description().c_str());
+        }
+      }
+      if (nSelectedBlocks>0) alizmq_batch_close_event(&fBatch);
+      if (fBatch.fNevents>=(UInt_t)fBatchEvents || fBatch.PayloadSize()>=fBatchMaxSize)
+      {
+        SendBatch();
       }
     }
-
-    //maybe send the ECS param string
-    //once if requested or always if so configured
-    if ((fSendECSparamString && nSelectedBlocks>0) || doSendECSparamString)
+    else
     {
-      AliHLTDataTopic topic = kAliHLTDataTypeECSParam;
-      rc = alizmq_msg_add(&message, &topic, fECSparamString);
-      if (rc<0) {
-        HLTWarning("ZMQ error adding ECS param string");
+      aliZMQmsg message;
+
+      //only send the INFO block if there is some data to send
+      if (fSendRunNumber && nSelectedBlocks>0)
+      {
+        AliHLTDataTopic topic = kAliHLTDataTypeInfo;
+        rc = alizmq_msg_add(&message, &topic, fInfoString);
+        if (rc<0) {
+          HLTWarning("ZMQ error adding INFO");
+        }
       }
-      doSendECSparamString = kFALSE;
-    }
 
-    //send the streamer infos if requested
-    if ((fSendStreamerInfos && nSelectedBlocks>0)|| doSendStreamerInfos)
-    {
-      AliHLTDataTopic topic = kAliHLTDataTypeStreamerInfo;
-      rc = alizmq_msg_add(&message, &topic, GetSchema(), GetCompressionLevel());
-      if (rc<0) {
-        HLTWarning("ZMQ error adding schema infos");
+      //maybe send the ECS param string
+      //once if requested or always if so configured
+      if ((fSendECSparamString && nSelectedBlocks>0) || doSendECSparamString)
+      {
+        AliHLTDataTopic topic = kAliHLTDataTypeECSParam;
+        rc = alizmq_msg_add(&message, &topic, fECSparamString);
+        if (rc<0) {
+          HLTWarning("ZMQ error adding ECS param string");
+        }
+        doSendECSparamString = kFALSE;
       }
-      doSendStreamerInfos = kFALSE;
-    }
 
-    //send the CDB entry if requested (on request only)
-    if (doSendCDB && cdbEntry)
-    {
-      AliHLTDataTopic topic = kAliHLTDataTypeCDBEntry;
-      rc = alizmq_msg_add(&message, &topic, cdbEntry, GetCompressionLevel());
-      if (rc<0) {
-        HLTWarning("ZMQ error adding CDB entry %s", requestedCDBpath.Data());
+      //send the streamer infos if requested
+      if ((fSendStreamerInfos && nSelectedBlocks>0)|| doSendStreamerInfos)
+      {
+        AliHLTDataTopic topic = kAliHLTDataTypeStreamerInfo;
+        rc = alizmq_msg_add(&message, &topic, GetSchema(), GetCompressionLevel());
+        if (rc<0) {
+          HLTWarning("ZMQ error adding schema infos");
+        }
+        doSendStreamerInfos = kFALSE;
       }
-      doSendCDB = kFALSE;
-    }
 
-    //add the selected blocks
-    for (int iSelectedBlock = 0;
-         iSelectedBlock < selectedBlockIdx.size();
-         iSelectedBlock++)
-    {
-      inputBlock = &blocks[selectedBlockIdx[iSelectedBlock]];
-      AliHLTDataTopic blockTopic(*inputBlock);
+      //send the CDB entry if requested (on request only)
+      if (doSendCDB && cdbEntry)
+      {
+        AliHLTDataTopic topic = kAliHLTDataTypeCDBEntry;
+        rc = alizmq_msg_add(&message, &topic, cdbEntry, GetCompressionLevel());
+        if (rc<0) {
+          HLTWarning("ZMQ error adding CDB entry %s", requestedCDBpath.Data());
+        }
+        doSendCDB = kFALSE;
+      }
+
+      //add the selected blocks
+      for (int iSelectedBlock = 0;
+           iSelectedBlock < selectedBlockIdx.size();
+           iSelectedBlock++)
+      {
+        inputBlock = &blocks[selectedBlockIdx[iSelectedBlock]];
+        AliHLTDataTopic blockTopic(*inputBlock);
 
-      rc = alizmq_msg_add(&message, &blockTopic, inputBlock->fPtr, inputBlock->fSize);
-      if (rc<0) {
-        HLTWarning("ZMQ error adding block %s", blockTopic.Description().c_str());
+        if (fZMQzeroCopy)
+        {
+          __sync_fetch_and_add(&fNzeroCopyPending, 1);
+          rc = alizmq_msg_add_nocopy(&message, &blockTopic, inputBlock->fPtr, inputBlock->fSize,
+                                     ReleaseZeroCopy, &fNzeroCopyPending);
+          if (rc<0) __sync_fetch_and_sub(&fNzeroCopyPending, 1);
+        }
+        else
+        {
+          rc = alizmq_msg_add(&message, &blockTopic, inputBlock->fPtr, inputBlock->fSize);
+        }
+        if (rc<0) {
+          HLTWarning("ZMQ error adding block %s", blockTopic.Description().c_str());
+        }
       }
-    }
 
 
-    //send an empty message if we really need a reply (ZMQ_REP mode)
-    //only in case no blocks were sent
-    if (message.size()==0 && fZMQsocketType==ZMQ_REP)
-    {
-      rc = alizmq_msg_add(&message, "", "");
-      if (rc<0) {
-        HLTWarning("ZMQ error adding dummy rep data");
+      //send an empty message if we really need a reply (ZMQ_REP mode)
+      //only in case no blocks were sent
+      if (message.size()==0 && fZMQsocketType==ZMQ_REP)
+      {
+        rc = alizmq_msg_add(&message, "", "");
+        if (rc<0) {
+          HLTWarning("ZMQ error adding dummy rep data");
+        }
       }
+      int flags = 0;
+      if (fZMQneverBlock) flags = ZMQ_DONTWAIT;
+      rc = alizmq_msg_send(&message, fZMQout, flags);
+      HLTMessage(Form("sent data rc %i %s",rc,(rc<0)?zmq_strerror(errno):""));
+      alizmq_msg_close(&message);
+      //the input blocks are released after DoProcessing returns
+      if (fZMQzeroCopy) WaitForZeroCopyRelease();
     }
-    int flags = 0;
-    if (fZMQneverBlock) flags = ZMQ_DONTWAIT;
-    rc = alizmq_msg_send(&message, fZMQout, flags);
-    HLTMessage(Form("sent data rc %i %s",rc,(rc<0)?zmq_strerror(errno):""));
-    alizmq_msg_close(&message);
   } //if (doSend)
   else if (eventType==gkAliEventTypeStartOfRun)
   {
@@ -449,10 +506,83 @@ int AliHLTZMQsink::DoProcessing( const AliHLTComponentEventData& evtData,
     alizmq_msg_send(kAliHLTDataTypeInfo,fInfoString,fZMQout,flags);
   }
 
+  //flush the last batch of the run
+  if (eventType==gkAliEventTypeEndOfRun && fBatch.GetNblocks()>0)
+  {
+    SendBatch();
+  }
+
   outputBlocks.clear();
   return retCode;
 }
 
+//______________________________________________________________________________
+int AliHLTZMQsink::SendBatch()
+{
+  //send the batch in one message, the run info, ECS params and streamer infos
+  //are sent once per batch if so configured
+  int rc = 0;
+  aliZMQmsg message;
+  if (fSendRunNumber)
+  {
+    AliHLTDataTopic topic = kAliHLTDataTypeInfo;
+    alizmq_msg_add(&message, &topic, fInfoString);
+  }
+  if (fSendECSparamString)
+  {
+    AliHLTDataTopic topic = kAliHLTDataTypeECSParam;
+    alizmq_msg_add(&message, &topic, fECSparamString);
+  }
+  if (fSendStreamerInfos)
+  {
+    AliHLTDataTopic topic = kAliHLTDataTypeStreamerInfo;
+    alizmq_msg_add(&message, &topic, GetSchema(), GetCompressionLevel());
+  }
+  rc = alizmq_msg_add(&message, &fBatch);
+  if (rc<0) {
+    HLTWarning("ZMQ error adding batch");
+  }
+
+  int flags = 0;
+  if (fZMQneverBlock) flags = ZMQ_DONTWAIT;
+  rc = alizmq_msg_send(&message, fZMQout, flags);
+  HLTMessage(Form("sent batch rc %i %s",rc,(rc<0)?zmq_strerror(errno):""));
+  alizmq_msg_close(&message);
+  return rc;
+}
+
+//______________________________________________________________________________
+int AliHLTZMQsink::WaitForZeroCopyRelease()
+{
+  //ZMQ releases the frames once they are written to the transport, if that
+  //does not happen in time the socket is reset which discards pending frames
+  const int sleepTime = 100; //us
+  bool reset = false;
+  for (int nWait = 0; __sync_fetch_and_add(&fNzeroCopyPending, 0)>0; nWait++)
+  {
+    if (nWait*sleepTime>=fZMQzeroCopyTimeout*1000)
+    {
+      if (reset) {
+        HLTError("%i zero copy blocks not released by ZMQ", fNzeroCopyPending);
+        return -ETIMEDOUT;
+      }
+      HLTWarning("zero copy blocks not released after %i ms, resetting socket", fZMQzeroCopyTimeout);
+      alizmq_socket_init(fZMQout, fZMQcontext, fZMQoutConfig, 0, 10);
+      reset = true;
+      nWait = 0;
+    }
+    usleep(sleepTime);
+  }
+  return 0;
+}
+
+//______________________________________________________________________________
+void AliHLTZMQsink::ReleaseZeroCopy(void* /*data*/, void* hint)
+{
+  //called by ZMQ (I/O thread) when a frame attached without copy is done
+  __sync_fetch_and_sub(static_cast<int*>(hint), 1);
+}
+
 //______________________________________________________________________________
 int AliHLTZMQsink::ProcessOption(TString option, TString value)
 {
@@ -518,6 +648,26 @@ int AliHLTZMQsink::ProcessOption(TString option, TString value)
     fSendStreamerInfos = kTRUE;
   }
 
+  else if (option.EqualTo("BatchEvents"))
+  {
+    fBatchEvents = value.Atoi();
+  }
+
+  else if (option.EqualTo("BatchMaxSize"))
+  {
+    fBatchMaxSize = value.Atoll();
+  }
+
+  else if (option.EqualTo("ZMQzeroCopy"))
+  {
+    fZMQzeroCopy=(value.EqualTo("0") || value.EqualTo("no") || value.EqualTo("false"))?kFALSE:kTRUE;
+  }
+
+  else if (option.EqualTo("ZMQzeroCopyTimeout"))
+  {
+    fZMQzeroCopyTimeout = value.Atoi();
+  }
+
   else
   {
     HLTError("unrecognized option %s", option.Data());
@@ -53,6 +53,13 @@ private:
   AliHLTZMQsink(const AliHLTZMQsink&);
   AliHLTZMQsink& operator=(const AliHLTZMQsink&);
 
+  //send the collected batch together with the configured INFO/ECS/schema parts
+  int SendBatch();
+  //wait until ZMQ released all blocks attached without copy
+  int WaitForZeroCopyRelease();
+  //callback for ZMQ, hint is the counter of attached blocks
+  static void ReleaseZeroCopy(void* data, void* hint);
+
   void* fZMQcontext;       //!ZMQ context pointer
   void* fZMQout;           //!the output socket
   int fZMQsocketType;      //ZMQ_REP,ZMQ_PUB,ZMQ_PUSH
@@ -71,7 +78,13 @@ private:
   Bool_t fSendStreamerInfos;   //send the cached streamer infos
   TRegexp fCDBpattern;          //keep the pattern for cdb string checks
   std::string fInfoString;  //cache the string with the run information
+  Int_t fBatchEvents;       //number of events per batch, 0 sends every event
+  ULong64_t fBatchMaxSize;  //send the batch earlier once the payload reaches this size
+  BatchBuffer fBatch;       //!the batch under construction
+  Bool_t fZMQzeroCopy;      //attach the HLT input blocks to the ZMQ frames without copy
+  Int_t fZMQzeroCopyTimeout; //max wait in ms for ZMQ to release the blocks
+  int fNzeroCopyPending;    //!number of blocks still held by ZMQ
 
-  ClassDef(AliHLTZMQsink, 1)
+  ClassDef(AliHLTZMQsink, 2)
 };
 #endif
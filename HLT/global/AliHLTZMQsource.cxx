@@ -51,6 +51,9 @@ AliHLTZMQsource::AliHLTZMQsource()
   , fIncomingData()
   , fSkipSOR(kFALSE)
   , fOnlyOnDataEvents(kFALSE)
+  , fIncomingBlocks()
+  , fBatchEvent(0)
+  , fBatchNevents(0)
 {
 }
 
@@ -229,9 +232,13 @@ int AliHLTZMQsource::DoProcessing( const AliHLTComponentEventData& evtData,
 
   int rc = -1;
 
+  //events of a received batch are injected one per call, nothing new
+  //is requested or received until all of them are done
+  bool pendingEvents = fBatchEvent<fBatchNevents;
+
   //in case we do requests: request first and poll for replies
   //if no reply arrives after a timeout period, reset the connection
-  if (fZMQsocketType==ZMQ_REQ)
+  if (fZMQsocketType==ZMQ_REQ && !pendingEvents)
   {
     //send request (header + an empty body for good measure)
     HLTMessage("sending request");
@@ -263,29 +270,56 @@ int AliHLTZMQsource::DoProcessing( const AliHLTComponentEventData& evtData,
   }
 
   //get data via ZMQ
-  alizmq_msg_recv(&fIncomingData, fZMQin, (fZMQneverBlock)?ZMQ_DONTWAIT:0);
+  if (!pendingEvents)
+  {
+    alizmq_msg_recv(&fIncomingData, fZMQin, (fZMQneverBlock)?ZMQ_DONTWAIT:0);
+
+    //index all blocks, batches are unpacked in place,
+    //plain frames belong to the first event
+    fIncomingBlocks.clear();
+    for (aliZMQmsg::iterator i=fIncomingData.begin(); i!=fIncomingData.end(); ++i)
+    {
+      aliZMQbatchIndex batch;
+      if (alizmq_msg_iter_batch(i, batch)>=0)
+      {
+        fIncomingBlocks.insert(fIncomingBlocks.end(), batch.begin(), batch.end());
+        continue;
+      }
+      BatchBlock block;
+      if (alizmq_msg_iter_topic(i, block.fTopic)!=0) continue; //no valid topic - skip also data
+      alizmq_msg_iter_data(i, block.fPtr, block.fSize);
+      block.fEvent = 0;
+      fIncomingBlocks.push_back(block);
+    }
+    fBatchEvent = 0;
+    fBatchNevents = fIncomingData.empty()?0:1;
+    for (aliZMQbatchIndex::iterator i=fIncomingBlocks.begin(); i!=fIncomingBlocks.end(); ++i)
+    {
+      if (i->fEvent>=fBatchNevents) fBatchNevents = i->fEvent+1;
+    }
+  }
 
-  //forward all parts to the HLT chain
+  //forward the blocks of the current event to the HLT chain
   //init internal
   AliHLTUInt32_t initialOutputBufferCapacity = outputBufferSize;
   AliHLTUInt32_t outputBufferCapacity = outputBufferSize;
   outputBufferSize=0;
   int blockSize = 0;
   void* block = NULL;
-  for (aliZMQmsg::iterator i=fIncomingData.begin(); i!=fIncomingData.end(); ++i)
+  for (aliZMQbatchIndex::iterator i=fIncomingBlocks.begin(); i!=fIncomingBlocks.end(); ++i)
   {
+    if (i->fEvent!=fBatchEvent) continue;
     outputBufferCapacity -= blockSize;
     outputBufferSize += blockSize;
     block = outputBuffer + outputBufferSize;
 
     //get the topic
-    AliHLTDataTopic blockTopic = kAliHLTAnyDataType | kAliHLTDataOriginAny;
-    if (alizmq_msg_iter_topic(i, blockTopic)!=0) continue; //no valid topic - skip also data
+    AliHLTDataTopic blockTopic;
+    static_cast<DataTopic&>(blockTopic) = i->fTopic;
 
     //get the data
-    void* dataIN = NULL;
-    size_t dataINsize = 0;
-    alizmq_msg_iter_data(i, dataIN, dataINsize);
+    void* dataIN = i->fPtr;
+    size_t dataINsize = i->fSize;
     if (dataINsize > outputBufferCapacity)
     {
       HLTWarning("output buffer too small: %i, doubling size", initialOutputBufferCapacity);
@@ -312,8 +346,15 @@ int AliHLTZMQsource::DoProcessing( const AliHLTComponentEventData& evtData,
 
   }
 
-  // after we sent the data, discard the ZMQ data
-  alizmq_msg_close(&fIncomingData);
+  //the event stays pending if it did not fit, the framework retries
+  //with a bigger buffer. After the last event discard the ZMQ data
+  if (retCode!=-ENOSPC && ++fBatchEvent>=fBatchNevents)
+  {
+    fIncomingBlocks.clear();
+    fBatchEvent = 0;
+    fBatchNevents = 0;
+    alizmq_msg_close(&fIncomingData);
+  }
 
   edd=NULL;
   return retCode;
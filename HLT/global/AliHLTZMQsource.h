@@ -69,6 +69,9 @@ class AliHLTZMQsource : public AliHLTComponent, public AliOptionParser  {
     aliZMQmsg fIncomingData;  //the incoming messages
     Bool_t fSkipSOR;          //whether to skip SOR
     Bool_t fOnlyOnDataEvents; //inject only in data events
+    aliZMQbatchIndex fIncomingBlocks; //!index of the incoming blocks, batches unpacked
+    UInt_t fBatchEvent;       //!event of the incoming batch to inject next
+    UInt_t fBatchNevents;     //!number of events in the incoming batch
 
     ClassDef(AliHLTZMQsource, 0)
 };
@@ -0,0 +1,253 @@
+/**************************************************************************
+ * Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved. *
+ *                                                                        *
+ * Author: The ALICE HLT Project.                                         *
+ * Contributors are mentioned in the code where appropriate.              *
+ *                                                                        *
+ * Permission to use, copy, modify and distribute this software and its   *
+ * documentation strictly for non-commercial purposes is hereby granted   *
+ * without fee, provided that the above copyright notice appears in all   *
+ * copies and that both the copyright notice and this permission notice   *
+ * appear in the supporting documentation. The authors make no claims     *
+ * about the suitability of this software for any purpose. It is          *
+ * provided "as is" without express or implied warranty.                  *
+ **************************************************************************/
+
+/* $Id$ */
+
+//==============================================================================
+// AliHLTFlatESDInputHandler
+//
+// The flat ESD layout is contiguous and pointer free, the events produced by
+// HLT can therefore be used directly from the file or message buffer. The
+// handler maps the data, indexes the consecutive events and restores the
+// virtual tables of an event on first access. AliFlatESDEvent and
+// AliFlatESDTrack implement AliVEvent and AliVTrack, analysis tasks using
+// the V interfaces run without conversion to AliESDEvent.
+//
+// Usage with an analysis manager in external loop mode:
+//   AliHLTAnalysisManager* mgr=new AliHLTAnalysisManager;
+//   AliHLTFlatESDInputHandler* handler=new AliHLTFlatESDInputHandler("flat","flat ESD");
+//   mgr->SetInputEventHandler(handler);
+//   ... add tasks ...
+//   mgr->InitAnalysis();
+//   handler->MapFile("outFlatESD.dat", "outFlatESDFriend.dat");
+//   handler->Process(mgr);
+//==============================================================================
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "TObjArray.h"
+#include "AliAnalysisManager.h"
+#include "AliFlatESDEvent.h"
+#include "AliFlatESDFriend.h"
+#include "AliHLTFlatESDInputHandler.h"
+
+ClassImp(AliHLTFlatESDInputHandler)
+
+//_____________________________________________________________________________
+AliHLTFlatESDInputHandler::AliHLTFlatESDInputHandler()
+  : AliHLTVEventInputHandler()
+  , fESD()
+  , fFriends()
+  , fEventOffsets()
+  , fFriendOffsets()
+  , fEventReinitialized()
+  , fFriendReinitialized()
+{
+  //ctor
+}
+
+//_____________________________________________________________________________
+AliHLTFlatESDInputHandler::AliHLTFlatESDInputHandler(const char* name, const char* title)
+  : AliHLTVEventInputHandler(name, title)
+  , fESD()
+  , fFriends()
+  , fEventOffsets()
+  , fFriendOffsets()
+  , fEventReinitialized()
+  , fFriendReinitialized()
+{
+  //ctor
+}
+
+//_____________________________________________________________________________
+AliHLTFlatESDInputHandler::~AliHLTFlatESDInputHandler()
+{
+  //dtor
+  Unmap();
+}
+
+//_____________________________________________________________________________
+Int_t AliHLTFlatESDInputHandler::MapBuffer(const char* filename, AliFlatBuffer& buffer)
+{
+  //map a file private and writable, pages are only copied when the
+  //virtual tables are restored
+  int fd=open(filename, O_RDONLY);
+  if (fd<0) {
+    Error("MapBuffer", "can not open file %s", filename);
+    return -1;
+  }
+  struct stat st;
+  if (fstat(fd, &st)<0 || st.st_size==0) {
+    Error("MapBuffer", "can not map empty file %s", filename);
+    close(fd);
+    return -1;
+  }
+  void* ptr=mmap(NULL, st.st_size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (ptr==MAP_FAILED) {
+    Error("MapBuffer", "mapping of file %s failed", filename);
+    return -1;
+  }
+  buffer.fPtr=reinterpret_cast<Byte_t*>(ptr);
+  buffer.fSize=st.st_size;
+  buffer.fMapped=kTRUE;
+  return 0;
+}
+
+//_____________________________________________________________________________
+Int_t AliHLTFlatESDInputHandler::IndexEvents(const AliFlatBuffer& buffer, std::vector<size_t>& offsets, Bool_t bFriend) const
+{
+  //find the consecutive events in the buffer, the size is plain data
+  //and can be read before the virtual table is restored
+  offsets.clear();
+  size_t offset=0;
+  const size_t minSize=bFriend?sizeof(AliFlatESDFriend):sizeof(AliFlatESDEvent);
+  while (offset+minSize<=buffer.fSize) {
+    ULong64_t size=bFriend?
+      reinterpret_cast<const AliFlatESDFriend*>(buffer.fPtr+offset)->GetSize():
+      reinterpret_cast<const AliFlatESDEvent*>(buffer.fPtr+offset)->GetSize();
+    if (size<minSize || offset+size>buffer.fSize) {
+      Error("IndexEvents", "inconsistent %s at offset %lu, ignoring remaining %lu bytes",
+            bFriend?"friend":"event", (unsigned long)offset, (unsigned long)(buffer.fSize-offset));
+      break;
+    }
+    offsets.push_back(offset);
+    offset+=size;
+  }
+  return offsets.size();
+}
+
+//_____________________________________________________________________________
+Int_t AliHLTFlatESDInputHandler::MapFile(const char* esdFile, const char* friendFile)
+{
+  //map the event file and optionally the friend file
+  Unmap();
+  if (!esdFile || MapBuffer(esdFile, fESD)<0) return -1;
+  if (friendFile && MapBuffer(friendFile, fFriends)<0) {
+    Unmap();
+    return -1;
+  }
+  return AttachBuffer(fESD.fPtr, fESD.fSize, fFriends.fPtr, fFriends.fSize);
+}
+
+//_____________________________________________________________________________
+Int_t AliHLTFlatESDInputHandler::AttachBuffer(void* esdBuffer, size_t esdSize,
+                                              void* friendBuffer, size_t friendSize)
+{
+  //attach the buffers and index the events, buffers of MapFile are kept
+  if (!fESD.fMapped || fESD.fPtr!=esdBuffer) {
+    Unmap();
+    fESD.fPtr=reinterpret_cast<Byte_t*>(esdBuffer);
+    fESD.fSize=esdSize;
+    fFriends.fPtr=reinterpret_cast<Byte_t*>(friendBuffer);
+    fFriends.fSize=friendBuffer?friendSize:0;
+  }
+  if (!fESD.fPtr) return -1;
+
+  IndexEvents(fESD, fEventOffsets, kFALSE);
+  fEventReinitialized.assign(fEventOffsets.size(), false);
+  fFriendOffsets.clear();
+  if (fFriends.fPtr) {
+    IndexEvents(fFriends, fFriendOffsets, kTRUE);
+    if (fFriendOffsets.size()!=fEventOffsets.size()) {
+      Warning("AttachBuffer", "number of friends (%lu) does not match number of events (%lu), ignoring friends",
+              (unsigned long)fFriendOffsets.size(), (unsigned long)fEventOffsets.size());
+      fFriendOffsets.clear();
+    }
+  }
+  fFriendReinitialized.assign(fFriendOffsets.size(), false);
+  return fEventOffsets.size();
+}
+
+//_____________________________________________________________________________
+void AliHLTFlatESDInputHandler::Unmap()
+{
+  //release the mapped memory, attached buffers are owned externally
+  SetEvent(NULL);
+  SetVFriendEvent(NULL);
+  AliFlatBuffer* buffers[]={&fESD, &fFriends};
+  for (unsigned i=0; i<sizeof(buffers)/sizeof(buffers[0]); i++) {
+    if (buffers[i]->fMapped) munmap(buffers[i]->fPtr, buffers[i]->fSize);
+    *buffers[i]=AliFlatBuffer();
+  }
+  fEventOffsets.clear();
+  fFriendOffsets.clear();
+  fEventReinitialized.clear();
+  fFriendReinitialized.clear();
+}
+
+//_____________________________________________________________________________
+AliFlatESDEvent* AliHLTFlatESDInputHandler::GetFlatEvent(Int_t i)
+{
+  //get event i in place
+  if (i<0 || i>=(Int_t)fEventOffsets.size()) return NULL;
+  AliFlatESDEvent* event=reinterpret_cast<AliFlatESDEvent*>(fESD.fPtr+fEventOffsets[i]);
+  if (!fEventReinitialized[i]) {
+    event->Reinitialize();
+    fEventReinitialized[i]=true;
+  }
+  return event;
+}
+
+//_____________________________________________________________________________
+AliFlatESDFriend* AliHLTFlatESDInputHandler::GetFlatFriend(Int_t i)
+{
+  //get friend of event i in place
+  if (i<0 || i>=(Int_t)fFriendOffsets.size()) return NULL;
+  AliFlatESDFriend* pFriend=reinterpret_cast<AliFlatESDFriend*>(fFriends.fPtr+fFriendOffsets[i]);
+  if (!fFriendReinitialized[i]) {
+    pFriend->Reinitialize();
+    fFriendReinitialized[i]=true;
+  }
+  return pFriend;
+}
+
+//_____________________________________________________________________________
+Bool_t AliHLTFlatESDInputHandler::BeginEvent(Long64_t entry)
+{
+  //reset the per event state, the previous event must not be seen by the
+  //tasks if the next one can not be connected
+  SetEvent(NULL);
+  SetVFriendEvent(NULL);
+  return AliHLTVEventInputHandler::BeginEvent(entry);
+}
+
+//_____________________________________________________________________________
+Bool_t AliHLTFlatESDInputHandler::ReadEvent(Int_t i, TObjArray* arrTasks)
+{
+  //connect event i to the tasks
+  AliFlatESDEvent* event=GetFlatEvent(i);
+  if (!event || !arrTasks) return kFALSE;
+  return InitTaskInputData(event, GetFlatFriend(i), arrTasks);
+}
+
+//_____________________________________________________________________________
+Long64_t AliHLTFlatESDInputHandler::Process(AliAnalysisManager* mgr, Long64_t nEvents, Long64_t firstEvent)
+{
+  //run the analysis on the attached events
+  if (!mgr) return 0;
+  Long64_t lastEvent=GetNumberOfEvents();
+  if (nEvents>=0 && firstEvent+nEvents<lastEvent) lastEvent=firstEvent+nEvents;
+  Long64_t nProcessed=0;
+  for (Long64_t i=firstEvent; i<lastEvent; i++) {
+    if (!BeginEvent(i) || !ReadEvent(i, mgr->GetTasks())) break;
+    mgr->ExecAnalysis();
+    FinishEvent();
+    nProcessed++;
+  }
+  return nProcessed;
+}
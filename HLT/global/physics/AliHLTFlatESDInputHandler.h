@@ -0,0 +1,75 @@
+#ifndef ALIHLTFLATESDINPUTHANDLER_H
+#define ALIHLTFLATESDINPUTHANDLER_H
+/* Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved. *
+ * See cxx source for full Copyright notice                               */
+
+/* $Id$ */
+
+//==============================================================================
+//   AliHLTFlatESDInputHandler
+//   input handler for analysis on flat ESD events without deserialization
+//
+//==============================================================================
+
+#include <vector>
+#include "AliHLTVEventInputHandler.h"
+
+class AliFlatESDEvent;
+class AliFlatESDFriend;
+class AliAnalysisManager;
+
+class AliHLTFlatESDInputHandler : public AliHLTVEventInputHandler {
+
+public:
+  AliHLTFlatESDInputHandler();
+  AliHLTFlatESDInputHandler(const char* name, const char* title);
+  virtual ~AliHLTFlatESDInputHandler();
+
+  // map files of consecutive flat ESD events and optionally friends,
+  // the events are used in place, no copy or conversion
+  Int_t MapFile(const char* esdFile, const char* friendFile=NULL);
+  // attach memory of consecutive flat events, e.g. the payload of a ZMQ
+  // message; the buffer stays owned by the caller and must be writable
+  // because the virtual tables are restored in place
+  Int_t AttachBuffer(void* esdBuffer, size_t esdSize,
+                     void* friendBuffer=NULL, size_t friendSize=0);
+  // release mapped files and attached buffers
+  void Unmap();
+
+  Int_t GetNumberOfEvents() const {return fEventOffsets.size();}
+  AliFlatESDEvent* GetFlatEvent(Int_t i);
+  AliFlatESDFriend* GetFlatFriend(Int_t i);
+
+  // reset the per event state before an event is connected
+  virtual Bool_t BeginEvent(Long64_t entry);
+  // connect event i to the tasks of the analysis manager
+  Bool_t ReadEvent(Int_t i, TObjArray* arrTasks);
+  // event loop for an analysis manager in external loop mode, returns the
+  // number of processed events
+  Long64_t Process(AliAnalysisManager* mgr, Long64_t nEvents=-1, Long64_t firstEvent=0);
+
+private:
+  AliHLTFlatESDInputHandler(const AliHLTFlatESDInputHandler&);
+  AliHLTFlatESDInputHandler& operator=(const AliHLTFlatESDInputHandler&);
+
+  struct AliFlatBuffer {
+    AliFlatBuffer() : fPtr(NULL), fSize(0), fMapped(kFALSE) {}
+    Byte_t* fPtr;
+    size_t  fSize;
+    Bool_t  fMapped;
+  };
+
+  Int_t MapBuffer(const char* filename, AliFlatBuffer& buffer);
+  Int_t IndexEvents(const AliFlatBuffer& buffer, std::vector<size_t>& offsets, Bool_t bFriend) const;
+
+  AliFlatBuffer fESD;                      //! events
+  AliFlatBuffer fFriends;                  //! friend events
+  std::vector<size_t> fEventOffsets;       //! offsets of the events in the buffer
+  std::vector<size_t> fFriendOffsets;      //! offsets of the friends in the buffer
+  std::vector<bool> fEventReinitialized;   //! virtual tables of the event restored
+  std::vector<bool> fFriendReinitialized;  //! virtual tables of the friend restored
+
+  ClassDef(AliHLTFlatESDInputHandler, 0)
+};
+
+#endif
@@ -117,6 +117,7 @@ class AliITShit : public AliHit {
                                                      fz0=x.Z();}
     virtual void SetTime(Float_t t){fTof = t;}
     virtual void SetStartTime(Float_t t){ft0 = t;}
+    virtual Float_t GetStartTime() const {return ft0;}
     virtual void SetStatus(Int_t stat){fStatus = stat;}
     virtual void SetStartStatus(Int_t stat){fStatus0 = stat;}
     virtual void SetEdep(Float_t de){fDestep = de;}
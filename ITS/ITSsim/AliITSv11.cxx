@@ -1717,7 +1717,24 @@ void AliITSv11::StepManager()
     } // end if IsEntering
     // Fill hit structure with this new hit.
     //Info("StepManager","Calling Copy Constructor");
-    new(lhits[fNhits++]) AliITShit(hit); // Use Copy Construtor.
+    if(IsHitBufferOn()){
+        // Store the hit record, the AliITShit is created by AddBufferedHit
+        // when the buffer is flushed. The track number is the one of the
+        // hit, already shunted and flagged by SetShunt above.
+        Int_t   vol[5];
+        Float_t hits[12];
+        vol[0] = mod; vol[1] = 0; vol[2] = 0;
+        vol[3] = status; vol[4] = hit.GetTrackStatus0();
+        hits[0] = position.X(); hits[1] = position.Y(); hits[2] = position.Z();
+        hits[3] = momentum.Px(); hits[4] = momentum.Py(); hits[5] = momentum.Pz();
+        hits[6] = fMC->Edep(); hits[7] = fMC->TrackTime();
+        Float_t tof;
+        hit.GetPositionG0(hits[8],hits[9],hits[10],tof);
+        hits[11] = hit.GetStartTime();
+        BufferHit(hit.GetTrack(),vol,hits);
+    } else {
+        new(lhits[fNhits++]) AliITShit(hit); // Use Copy Construtor.
+    } // end if IsHitBufferOn
     // Save old position... for next hit.
     hit.SetStartPosition(position);
     hit.SetStartTime(fMC->TrackTime());
@@ -1725,3 +1742,37 @@ void AliITSv11::StepManager()
 
     return;
 }
+//______________________________________________________________________
+void AliITSv11::AddBufferedHit(Int_t track, Int_t *vol, Float_t *hits){
+    //     Create the AliITShit of a record of the hit buffer as the
+    // StepManager does without buffer, by copying a filled hit. The
+    // constructor AliITShit(shunt,track,vol,hits) is not used since it
+    // would shunt and flag the track a second time, now with the keep
+    // bits at the end of the primary.
+    // Inputs:
+    //   Int_t   track   Track number of the hit, already shunted
+    //   Int_t   *vol    Array of integer hit data, see AliITShit
+    //   Float_t *hits   Array of hit information, see AliITShit
+    // Outputs:
+    //   none.
+    // Return:
+    //   none.
+    static TLorentzVector position, momentum, position0;
+    static AliITShit hit;
+
+    TClonesArray &lhits = *(Hits());
+    position.SetXYZT(hits[0],hits[1],hits[2],hits[7]);
+    momentum.SetXYZT(hits[3],hits[4],hits[5],0.);
+    position0.SetXYZT(hits[8],hits[9],hits[10],hits[11]);
+    hit.SetTrack(track);
+    hit.SetModule(vol[0]);
+    hit.SetStatus(vol[3]);
+    hit.SetStartStatus(vol[4]);
+    hit.SetPosition(position);
+    hit.SetMomentum(momentum);
+    hit.SetEdep(hits[6]);
+    hit.SetTime(hits[7]);
+    hit.SetStartPosition(position0);
+    hit.SetStartTime(hits[11]);
+    new(lhits[fNhits++]) AliITShit(hit); // Use Copy Construtor.
+}
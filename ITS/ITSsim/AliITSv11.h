@@ -53,6 +53,9 @@ class AliITSv11 : public AliITS {
     virtual void   Init(); 
     virtual void   SetDefaults();
     virtual void   StepManager();
+    virtual void   SetHitBuffering(Bool_t on=kTRUE){// hits stored as records
+        // during the steps, created at the end of the primary
+        SetHitBuffer(on ? 5 : 0, on ? 12 : 0, 10000);}
     virtual void SetDensityServicesByThickness(){// uses services density
 	// calculation based on the thickness of the services.
 	fByThick = kTRUE;}
@@ -62,6 +65,7 @@ class AliITSv11 : public AliITS {
 
 
  protected:
+    virtual void AddBufferedHit(Int_t track, Int_t *vol, Float_t *hits);
     void SetT2Lmatrix(Int_t uid, Double_t yShift,
 		      Bool_t yFlip, Bool_t yRot180=kFALSE) const; // Set T2L matrix in TGeoPNEntries
 
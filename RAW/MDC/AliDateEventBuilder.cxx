@@ -0,0 +1,428 @@
+/**************************************************************************
+ * Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved. *
+ *                                                                        *
+ * Author: The ALICE Off-line Project.                                    *
+ * Contributors are mentioned in the code where appropriate.              *
+ *                                                                        *
+ * Permission to use, copy, modify and distribute this software and its   *
+ * documentation strictly for non-commercial purposes is hereby granted   *
+ * without fee, provided that the above copyright notice appears in all   *
+ * copies and that both the copyright notice and this permission notice   *
+ * appear in the supporting documentation. The authors make no claims     *
+ * about the suitability of this software for any purpose. It is          *
+ * provided "as is" without express or implied warranty.                  *
+ **************************************************************************/
+
+//-------------------------------------------------------------------------
+// This is the class which builds DATE events out of the simulated
+// DDL payloads in memory, without the DDL files and the dateStream
+// program. The events are the ones produced by
+//   dateStream -c -s -D -C -run <run>
+// (CDH handling, no SOR/EOR events, collider mode) from the lines
+//   GDC DetectorPattern <pattern> Timestamp <time>
+//    LDC Id <ldc>
+//     Equipment Id <ddl> Payload <file>
+// written by AliSimulation::ConvertRawFilesToDate. This includes the
+// coherency checks of the CDHs, the trigger pattern and the attributes
+// taken from the CDHs and the event ID loaded into the CDHs.
+//
+// Usage:
+//   AliDateEventBuilder builder(run);
+//   builder.StartEvent(detectorPattern, timestamp);
+//   builder.AddEquipment(ldcId, ddlId, payload, size);  // for each DDL
+//   if (builder.FinishEvent()) builder.WriteEvent(file);
+//-------------------------------------------------------------------------
+
+#include <string.h>
+#include <TMath.h>
+#include "event.h"
+#include "AliDateEventBuilder.h"
+#include "AliLog.h"
+
+ClassImp(AliDateEventBuilder)
+
+//______________________________________________________________________________
+AliDateEventBuilder::AliDateEventBuilder(UInt_t runNumber):
+  fRunNumber(runNumber),
+  fDetectorPattern(0),
+  fTimestamp(0),
+  fAliceTrigger(kFALSE),
+  fSoftwareTrigger(kFALSE),
+  fPayloads(),
+  fPayloadsSize(0),
+  fEquipments(),
+  fNEquipments(0),
+  fEvent(),
+  fEventSize(0),
+  fNEvents(0)
+{
+  // Constructor
+  // The event ID starts from zero as in dateStream
+
+  ZERO_EVENT_ID(fEventId);
+}
+
+//______________________________________________________________________________
+void AliDateEventBuilder::Reset(UInt_t runNumber)
+{
+  // Start a new run, the event
+  // ID starts again from zero
+
+  fRunNumber = runNumber;
+  fAliceTrigger = kFALSE;
+  fSoftwareTrigger = kFALSE;
+  fPayloadsSize = 0;
+  fNEquipments = 0;
+  fEventSize = 0;
+  fNEvents = 0;
+  ZERO_EVENT_ID(fEventId);
+}
+
+//______________________________________________________________________________
+void AliDateEventBuilder::StartEvent(UInt_t detectorPattern, UInt_t timestamp)
+{
+  // Start a new event with the
+  // given detector pattern and
+  // time stamp of the GDC line
+
+  fDetectorPattern = detectorPattern;
+  fTimestamp = timestamp;
+  fPayloadsSize = 0;
+  fNEquipments = 0;
+}
+
+//______________________________________________________________________________
+void AliDateEventBuilder::AddEquipment(Int_t ldcId, Int_t equipmentId,
+				       const char *payload, UInt_t size)
+{
+  // Add the payload of one DDL,
+  // a new LDC sub-event is started
+  // when the LDC ID changes.
+  // The payload is copied and
+  // padded to 4 bytes
+
+  UInt_t paddedSize = size;
+  while ((paddedSize & 3) != 0) paddedSize++;
+
+  if (fPayloadsSize + paddedSize > (UInt_t)fPayloads.GetSize())
+    fPayloads.Set(TMath::Max(fPayloadsSize + paddedSize, 2*(UInt_t)fPayloads.GetSize()));
+  memcpy(fPayloads.GetArray() + fPayloadsSize, payload, size);
+  memset(fPayloads.GetArray() + fPayloadsSize + size, 0, paddedSize - size);
+
+  if (4*(fNEquipments+1) > fEquipments.GetSize())
+    fEquipments.Set(TMath::Max(4*(fNEquipments+1), 2*fEquipments.GetSize()));
+  Int_t *eq = fEquipments.GetArray() + 4*fNEquipments;
+  eq[0] = ldcId;
+  eq[1] = equipmentId;
+  eq[2] = fPayloadsSize;
+  eq[3] = paddedSize;
+  fNEquipments++;
+  fPayloadsSize += paddedSize;
+}
+
+//______________________________________________________________________________
+void AliDateEventBuilder::InitHeader(char *header) const
+{
+  // Initialize an event header
+  // (initEvent of dateStream) of
+  // a physics event of the GDC
+
+  eventHeaderStruct *ev = (eventHeaderStruct *)header;
+  memset(ev, 0, sizeof(*ev));
+  ev->eventMagic = EVENT_MAGIC_NUMBER;
+  ev->eventHeadSize = EVENT_HEAD_BASE_SIZE;
+  ev->eventVersion = EVENT_CURRENT_VERSION;
+  ev->eventRunNb = fRunNumber;
+  ZERO_EVENT_ID(ev->eventId);
+  ZERO_TRIGGER_PATTERN(ev->eventTriggerPattern);
+  ZERO_DETECTOR_PATTERN(ev->eventDetectorPattern);
+  RESET_ATTRIBUTES(ev->eventTypeAttribute);
+  SET_SYSTEM_ATTRIBUTE(ev->eventTypeAttribute, ATTR_ORBIT_BC);
+  ev->eventLdcId = VOID_ID;
+  ev->eventSize = ev->eventHeadSize;
+  ev->eventType = PHYSICS_EVENT;
+  ev->eventGdcId = HOST_ID_MIN;
+  ev->eventDetectorPattern[0] = fDetectorPattern;
+  ev->eventTimestamp = fTimestamp;
+  COPY_EVENT_ID(fEventId, ev->eventId);
+}
+
+//______________________________________________________________________________
+Bool_t AliDateEventBuilder::FinishEvent()
+{
+  // Build the event out of the
+  // equipments added since StartEvent.
+  // Returns kFALSE if a CDH is
+  // inconsistent, in this case
+  // dateStream would have failed
+
+  const UInt_t kHeadSize = sizeof(eventHeaderStruct);
+  const UInt_t kEqHeadSize = sizeof(equipmentHeaderStruct);
+  const Int_t *eqs = fEquipments.GetArray();
+
+  fEventSize = kHeadSize;
+  for (Int_t iEq = 0; iEq < fNEquipments; iEq++) {
+    if ((iEq == 0) || (eqs[4*iEq] != eqs[4*(iEq-1)])) fEventSize += kHeadSize;
+    fEventSize += kEqHeadSize + eqs[4*iEq+3];
+  }
+  if (fEventSize > (UInt_t)fEvent.GetSize()) fEvent.Set(fEventSize);
+
+  char *event = fEvent.GetArray();
+  eventHeaderStruct *gdc = (eventHeaderStruct *)event;
+  InitHeader(event);
+  SET_SYSTEM_ATTRIBUTE(gdc->eventTypeAttribute, ATTR_SUPER_EVENT);
+
+  const char *cdhRef = NULL;
+  eventHeaderStruct *ldc = NULL;
+  Bool_t firstLdc = kTRUE;
+  char *pos = event + kHeadSize;
+  for (Int_t iEq = 0; iEq < fNEquipments; iEq++) {
+    const Int_t *eq = eqs + 4*iEq;
+    if (!ldc || ((Int_t)ldc->eventLdcId != eq[0])) {
+      // dateStream takes the patterns of the GDC event from the first LDC only
+      if (ldc && firstLdc) {
+	for (Int_t n = 0; n < EVENT_TRIGGER_PATTERN_WORDS; n++)
+	  gdc->eventTriggerPattern[n] |= ldc->eventTriggerPattern[n];
+	for (Int_t n = 0; n < EVENT_DETECTOR_PATTERN_WORDS; n++)
+	  gdc->eventDetectorPattern[n] |= ldc->eventDetectorPattern[n];
+	for (Int_t n = 0; n < ALL_ATTRIBUTE_WORDS; n++)
+	  gdc->eventTypeAttribute[n] |= ldc->eventTypeAttribute[n];
+	firstLdc = kFALSE;
+      }
+      if (ldc) gdc->eventSize += ldc->eventSize;
+      ldc = (eventHeaderStruct *)pos;
+      InitHeader(pos);
+      ldc->eventLdcId = eq[0];
+      pos += kHeadSize;
+    }
+
+    equipmentHeaderStruct *eqHeader = (equipmentHeaderStruct *)pos;
+    memset(eqHeader, 0, sizeof(*eqHeader));
+    RESET_ATTRIBUTES(eqHeader->equipmentTypeAttribute);
+    eqHeader->equipmentBasicElementSize = 4;
+    eqHeader->equipmentId = eq[1];
+    SET_SYSTEM_ATTRIBUTE(eqHeader->equipmentTypeAttribute, ATTR_ORBIT_BC);
+    eqHeader->equipmentSize = eq[3] + kEqHeadSize;
+    ldc->eventSize += eqHeader->equipmentSize;
+    OR_ALL_ATTRIBUTES(eqHeader->equipmentTypeAttribute, ldc->eventTypeAttribute);
+    OR_ALL_ATTRIBUTES(eqHeader->equipmentTypeAttribute, gdc->eventTypeAttribute);
+    pos += kEqHeadSize;
+
+    memcpy(pos, fPayloads.GetArray() + eq[2], eq[3]);
+    if (!DecodeCDH((char *)ldc, pos, eq[3], eq[1], cdhRef)) return kFALSE;
+    LoadCDH(pos, eq[1]);
+    pos += eq[3];
+  }
+  if (ldc) {
+    if (firstLdc) {
+      for (Int_t n = 0; n < EVENT_TRIGGER_PATTERN_WORDS; n++)
+	gdc->eventTriggerPattern[n] |= ldc->eventTriggerPattern[n];
+      for (Int_t n = 0; n < EVENT_DETECTOR_PATTERN_WORDS; n++)
+	gdc->eventDetectorPattern[n] |= ldc->eventDetectorPattern[n];
+      for (Int_t n = 0; n < ALL_ATTRIBUTE_WORDS; n++)
+	gdc->eventTypeAttribute[n] |= ldc->eventTypeAttribute[n];
+    }
+    gdc->eventSize += ldc->eventSize;
+  }
+
+  eventIdType oneEventDelta;
+  ZERO_EVENT_ID(oneEventDelta);
+  LOAD_EVENT_ID(oneEventDelta, 0, 0, 1);
+  ADD_EVENT_ID(fEventId, oneEventDelta);
+  fNEvents++;
+
+  return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t AliDateEventBuilder::DecodeCDH(char *ldcHeader, const char *payload, UInt_t size,
+				      Int_t equipmentId, const char *&cdhRef)
+{
+  // Check the CDH of the payload
+  // against the first CDH of the
+  // event and set the trigger pattern
+  // and the user attributes of the
+  // LDC (decodeCDH of dateStream).
+  // The CTP raw data has no CDH
+
+  const Int_t kCTPEquipment = 4352;
+  const UInt_t kTriggerUnavailable = 1 << CDH_TRIGGER_INFORMATION_UNAVAILABLE_BIT;
+
+  if (equipmentId == kCTPEquipment) return kTRUE;
+
+  if (size < CDH_SIZE) {
+    AliError(Form("payload of equipment %d too small got:%d CDH:%d",
+		  equipmentId, size, CDH_SIZE));
+    return kFALSE;
+  }
+
+  eventHeaderStruct *ldc = (eventHeaderStruct *)ldcHeader;
+  const commonDataHeaderStruct *cdh = (const commonDataHeaderStruct *)payload;
+  if (cdh->cdhVersion != CDH_VERSION) {
+    AliError(Form("CDH version mismatch in equipment %d expected:%d got:%d",
+		  equipmentId, CDH_VERSION, cdh->cdhVersion));
+    return kFALSE;
+  }
+
+  if (!cdhRef) {
+    cdhRef = payload;
+    fAliceTrigger = (cdh->cdhStatusErrorBits & kTriggerUnavailable) == 0;
+    if (fAliceTrigger) {
+      if ((cdh->cdhL1TriggerMessage & 0x40) != 0) {
+	AliError(Form("CDH is a calibration trigger (unsupported) L1TriggerMessage:0x%x",
+		      cdh->cdhL1TriggerMessage));
+	return kFALSE;
+      }
+      if ((cdh->cdhL1TriggerMessage & 0x01) != 0) fSoftwareTrigger = kTRUE;
+      if (fSoftwareTrigger) {
+	UInt_t roc = (cdh->cdhL1TriggerMessage >> 2) & 0xF;
+	if ((roc < 0x9) || (roc > 0xC)) {
+	  AliError(Form("CDH trigger SOD/EOD/SST/DST/SYNC (unsupported) L1TriggerMessage:0x%x",
+			cdh->cdhL1TriggerMessage));
+	  return kFALSE;
+	}
+      }
+    }
+  }
+  else {
+    const commonDataHeaderStruct *ref = (const commonDataHeaderStruct *)cdhRef;
+    if ((cdh->cdhStatusErrorBits & kTriggerUnavailable) !=
+	(ref->cdhStatusErrorBits & kTriggerUnavailable)) {
+      AliError(Form("CDH coherency check failed for equipment %d: trigger information", equipmentId));
+      return kFALSE;
+    }
+    if (fAliceTrigger) {
+      if (ref->cdhL1TriggerMessage != cdh->cdhL1TriggerMessage) {
+	AliError(Form("CDH coherency check failed for equipment %d: L1 trigger message reference:0x%x current:0x%x",
+		      equipmentId, ref->cdhL1TriggerMessage, cdh->cdhL1TriggerMessage));
+	return kFALSE;
+      }
+      if (cdh->cdhParticipatingSubDetectors != ref->cdhParticipatingSubDetectors) {
+	AliError(Form("CDH coherency check failed for equipment %d: ParticipatingSubDetectors reference:0x%x current:0x%x",
+		      equipmentId, ref->cdhParticipatingSubDetectors, cdh->cdhParticipatingSubDetectors));
+	return kFALSE;
+      }
+      if ((cdh->cdhTriggerClassesLow != ref->cdhTriggerClassesLow) ||
+	  (cdh->cdhTriggerClassesHigh != ref->cdhTriggerClassesHigh)) {
+	AliError(Form("CDH coherency check failed for equipment %d: TriggerClassesHigh/Low reference:0x%x-%x current:0x%x-%x",
+		      equipmentId, ref->cdhTriggerClassesHigh, ref->cdhTriggerClassesLow,
+		      cdh->cdhTriggerClassesHigh, cdh->cdhTriggerClassesLow));
+	return kFALSE;
+      }
+      if ((cdh->cdhBlockLength != 0xffffffff) && (size != cdh->cdhBlockLength)) {
+	AliError(Form("CDH coherency check failed for equipment %d: payload size:%d CDH block length:%d",
+		      equipmentId, size, cdh->cdhBlockLength));
+	return kFALSE;
+      }
+      if ((cdh->cdhRoiLow != ref->cdhRoiLow) || (cdh->cdhRoiHigh != ref->cdhRoiHigh)) {
+	AliError(Form("CDH coherency check failed for equipment %d: RoiHigh/Low reference:0x%x-%x current:0x%x-%x",
+		      equipmentId, ref->cdhRoiHigh, ref->cdhRoiLow, cdh->cdhRoiHigh, cdh->cdhRoiLow));
+	return kFALSE;
+      }
+    }
+    if ((cdh->cdhMBZ0 != 0) || (cdh->cdhMBZ1 != 0) || (cdh->cdhMBZ4 != 0)) {
+      AliError(Form("CDH check failed for equipment %d: MBZ0:0x%x MBZ1:0x%x MBZ4:0x%x",
+		    equipmentId, cdh->cdhMBZ0, cdh->cdhMBZ1, cdh->cdhMBZ4));
+      return kFALSE;
+    }
+  }
+
+  for (Int_t attr = 0; attr < 8; attr++) {
+    if ((cdh->cdhBlockAttributes & (1<<attr)) != 0)
+      SET_USER_ATTRIBUTE(ldc->eventTypeAttribute, attr);
+  }
+  for (Int_t trig = 0; trig < 32; trig++) {
+    if ((cdh->cdhTriggerClassesLow & (1U<<trig)) != 0)
+      SET_TRIGGER_IN_PATTERN(ldc->eventTriggerPattern, trig);
+  }
+  for (Int_t trig = 0; trig < 18; trig++) {
+    if ((cdh->cdhTriggerClassesMiddleLow & (1U<<trig)) != 0)
+      SET_TRIGGER_IN_PATTERN(ldc->eventTriggerPattern, 32+trig);
+  }
+  for (Int_t trig = 0; trig < 32; trig++) {
+    if ((cdh->cdhTriggerClassesMiddleHigh & (1U<<trig)) != 0)
+      SET_TRIGGER_IN_PATTERN(ldc->eventTriggerPattern, 18+32+trig);
+  }
+  for (Int_t trig = 0; trig < 18; trig++) {
+    if ((cdh->cdhTriggerClassesHigh & (1U<<trig)) != 0)
+      SET_TRIGGER_IN_PATTERN(ldc->eventTriggerPattern, 32+18+32+trig);
+  }
+  if (fAliceTrigger) VALIDATE_TRIGGER_PATTERN(ldc->eventTriggerPattern);
+
+  return kTRUE;
+}
+
+//______________________________________________________________________________
+void AliDateEventBuilder::LoadCDH(char *payload, Int_t equipmentId) const
+{
+  // Set the event ID in the CDH
+  // of the payload (loadCdh of
+  // dateStream)
+
+  const Int_t kCTPEquipment = 4352;
+  if (equipmentId == kCTPEquipment) return;
+
+  commonDataHeaderStruct *cdh = (commonDataHeaderStruct *)payload;
+  if (fAliceTrigger) {
+    cdh->cdhEventId1 = EVENT_ID_GET_BUNCH_CROSSING(fEventId);
+    cdh->cdhEventId2 = EVENT_ID_GET_ORBIT(fEventId);
+  }
+  else {
+    cdh->cdhEventId1 = 0;
+    cdh->cdhEventId2 = EVENT_ID_GET_NB_IN_RUN(fEventId);
+  }
+  cdh->cdhMiniEventId = cdh->cdhEventId1;
+}
+
+//______________________________________________________________________________
+Bool_t AliDateEventBuilder::Output(FILE *file, const char *data, UInt_t size) const
+{
+  // Write one block of the event,
+  // on big endian machines the first
+  // header size bytes are swapped as
+  // done by dateStream
+
+#ifdef R__BYTESWAP
+  return (fwrite(data, size, 1, file) == 1);
+#else
+  UInt_t swapSize = TMath::Min(size, (UInt_t)sizeof(eventHeaderStruct));
+  UInt_t buffer[sizeof(eventHeaderStruct)/sizeof(UInt_t)];
+  memcpy(buffer, data, swapSize);
+  for (UInt_t i = 0; i < swapSize/sizeof(UInt_t); i++) {
+    UInt_t x = buffer[i];
+    buffer[i] = (((x & 0x000000ffU) << 24) | ((x & 0x0000ff00U) <<  8) |
+		 ((x & 0x00ff0000U) >>  8) | ((x & 0xff000000U) >> 24));
+  }
+  if (fwrite(buffer, swapSize, 1, file) != 1) return kFALSE;
+  if (size > swapSize)
+    return (fwrite(data + swapSize, size - swapSize, 1, file) == 1);
+  return kTRUE;
+#endif
+}
+
+//______________________________________________________________________________
+Bool_t AliDateEventBuilder::WriteEvent(FILE *file) const
+{
+  // Append the last built event
+  // to the DATE file
+
+  const UInt_t kHeadSize = sizeof(eventHeaderStruct);
+  const UInt_t kEqHeadSize = sizeof(equipmentHeaderStruct);
+  const Int_t *eqs = fEquipments.GetArray();
+  const char *pos = fEvent.GetArray();
+
+  if (!Output(file, pos, kHeadSize)) return kFALSE;
+  pos += kHeadSize;
+  for (Int_t iEq = 0; iEq < fNEquipments; iEq++) {
+    if ((iEq == 0) || (eqs[4*iEq] != eqs[4*(iEq-1)])) {
+      if (!Output(file, pos, kHeadSize)) return kFALSE;
+      pos += kHeadSize;
+    }
+    if (!Output(file, pos, kEqHeadSize)) return kFALSE;
+    pos += kEqHeadSize;
+    if ((eqs[4*iEq+3] > 0) && !Output(file, pos, eqs[4*iEq+3])) return kFALSE;
+    pos += eqs[4*iEq+3];
+  }
+
+  return kTRUE;
+}
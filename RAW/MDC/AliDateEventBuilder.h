@@ -0,0 +1,62 @@
+#ifndef ALIDATEEVENTBUILDER_H
+#define ALIDATEEVENTBUILDER_H
+/* Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved. *
+ * See cxx source for full Copyright notice                               */
+
+//-------------------------------------------------------------------------
+// This is the class which builds DATE events out of the simulated
+// DDL payloads in memory. The events are identical to the ones
+// produced by "dateStream -c -s -D -C" from the DDL files: one GDC
+// event with one LDC sub-event per sequence of equipments with the
+// same LDC ID, the CDH of the payloads is decoded and its event ID set.
+//-------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <TObject.h>
+#include <TArrayC.h>
+#include <TArrayI.h>
+
+class AliDateEventBuilder : public TObject {
+public:
+  AliDateEventBuilder(UInt_t runNumber = 0);
+  virtual ~AliDateEventBuilder() {}
+
+  void        Reset(UInt_t runNumber);  // new run, event IDs from zero
+  void        StartEvent(UInt_t detectorPattern, UInt_t timestamp);
+  void        AddEquipment(Int_t ldcId, Int_t equipmentId, const char *payload, UInt_t size);
+  Bool_t      FinishEvent();
+  Bool_t      WriteEvent(FILE *file) const;
+
+  const char *GetEvent() const {return fEvent.GetArray();}
+  UInt_t      GetEventSize() const {return fEventSize;}
+  Int_t       GetNEquipments() const {return fNEquipments;}
+  Int_t       GetNEvents() const {return fNEvents;}
+
+private:
+
+  AliDateEventBuilder(const AliDateEventBuilder &source);
+  AliDateEventBuilder &operator =(const AliDateEventBuilder &source);
+
+  void   InitHeader(char *header) const;
+  Bool_t DecodeCDH(char *ldc, const char *payload, UInt_t size, Int_t equipmentId, const char *&cdhRef);
+  void   LoadCDH(char *payload, Int_t equipmentId) const;
+  Bool_t Output(FILE *file, const char *data, UInt_t size) const;
+
+  UInt_t   fRunNumber;        // Run number in the event headers
+  UInt_t   fDetectorPattern;  // Detector pattern of the current event
+  UInt_t   fTimestamp;        // Time stamp of the current event
+  UInt_t   fEventId[2];       // Event ID of the next event
+  Bool_t   fAliceTrigger;     // Trigger information available in the CDHs
+  Bool_t   fSoftwareTrigger;  // Software trigger seen in a CDH
+  TArrayC  fPayloads;         // Payloads of the current event
+  UInt_t   fPayloadsSize;     // Used size of fPayloads
+  TArrayI  fEquipments;       // LDC ID, equipment ID, offset and padded size of the equipments
+  Int_t    fNEquipments;      // Number of equipments of the current event
+  TArrayC  fEvent;            // Last built event
+  UInt_t   fEventSize;        // Size of the last built event
+  Int_t    fNEvents;          // Number of built events
+
+  ClassDef(AliDateEventBuilder,0)
+};
+
+#endif
@@ -0,0 +1,115 @@
+/**************************************************************************
+ * Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved. *
+ *                                                                        *
+ * Author: The ALICE Off-line Project.                                    *
+ * Contributors are mentioned in the code where appropriate.              *
+ *                                                                        *
+ * Permission to use, copy, modify and distribute this software and its   *
+ * documentation strictly for non-commercial purposes is hereby granted   *
+ * without fee, provided that the above copyright notice appears in all   *
+ * copies and that both the copyright notice and this permission notice   *
+ * appear in the supporting documentation. The authors make no claims     *
+ * about the suitability of this software for any purpose. It is          *
+ * provided "as is" without express or implied warranty.                  *
+ **************************************************************************/
+
+//-------------------------------------------------------------------------
+// This is the writer of simulated raw data events which AliSimulation
+// loads with the plugin manager (AliRawEventWriter, "DATE"). The events
+// are built by AliDateEventBuilder as "dateStream -c -s -D -C" does and
+// written to the DATE file, or for the extension ".root" with AliMDC
+// (compression 1, no filter, as alimdc in AliSimulation::ConvertDateToRoot)
+// to the root file.
+//
+// Usage:
+//   AliDateEventWriter writer;
+//   writer.Open("raw.root", run);
+//   writer.StartEvent(detectorPattern, timestamp);
+//   writer.AddEquipment(ldcId, ddlId, payload, size);  // for each DDL
+//   writer.WriteEvent();
+//   writer.Close();
+//-------------------------------------------------------------------------
+
+#include <TString.h>
+#include "AliMDC.h"
+#include "AliDateEventWriter.h"
+#include "AliLog.h"
+
+ClassImp(AliDateEventWriter)
+
+//______________________________________________________________________________
+AliDateEventWriter::AliDateEventWriter():
+  AliRawEventWriter(),
+  fBuilder(),
+  fFile(NULL),
+  fMDC(NULL)
+{
+  // Default constructor
+}
+
+//______________________________________________________________________________
+AliDateEventWriter::~AliDateEventWriter()
+{
+  // Destructor
+
+  Close();
+}
+
+//______________________________________________________________________________
+Bool_t AliDateEventWriter::Open(const char *fileName, UInt_t runNumber)
+{
+  // Open the DATE or root file,
+  // the event IDs start from zero
+
+  const Int_t kCompression = 1;
+
+  Close();
+  fBuilder.Reset(runNumber);
+  if (TString(fileName).EndsWith(".root")) {
+    fMDC = new AliMDC(kCompression, kFALSE, AliMDC::kFilterOff);
+    if (fMDC->Open(AliMDC::kLOCAL, fileName) < 0) {
+      AliError(Form("could not open the root file %s", fileName));
+      delete fMDC;
+      fMDC = NULL;
+      return kFALSE;
+    }
+  }
+  else if (!(fFile = fopen(fileName, "wb"))) {
+    AliError(Form("could not open the DATE file %s", fileName));
+    return kFALSE;
+  }
+
+  return kTRUE;
+}
+
+//______________________________________________________________________________
+Bool_t AliDateEventWriter::WriteEvent()
+{
+  // Build the event and
+  // write it to the file
+
+  if (!fBuilder.FinishEvent()) return kFALSE;
+  if (fMDC) return (fMDC->ProcessEvent((void *) fBuilder.GetEvent()) >= 0);
+  if (fFile) return fBuilder.WriteEvent(fFile);
+  AliError("no output file open");
+  return kFALSE;
+}
+
+//______________________________________________________________________________
+Bool_t AliDateEventWriter::Close()
+{
+  // Close the file
+
+  Bool_t result = kTRUE;
+  if (fMDC) {
+    if (fMDC->Close() < 0) result = kFALSE;
+    delete fMDC;
+    fMDC = NULL;
+  }
+  if (fFile) {
+    if (fclose(fFile)) result = kFALSE;
+    fFile = NULL;
+  }
+
+  return result;
+}
@@ -0,0 +1,43 @@
+#ifndef ALIDATEEVENTWRITER_H
+#define ALIDATEEVENTWRITER_H
+/* Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved. *
+ * See cxx source for full Copyright notice                               */
+
+//-------------------------------------------------------------------------
+// Writer of simulated raw data events: the events are built by
+// AliDateEventBuilder and written to a DATE file, or with AliMDC to a
+// root file if the file name has the extension ".root".
+//-------------------------------------------------------------------------
+
+#include <stdio.h>
+#include "AliRawEventWriter.h"
+#include "AliDateEventBuilder.h"
+
+class AliMDC;
+
+class AliDateEventWriter : public AliRawEventWriter {
+public:
+  AliDateEventWriter();
+  virtual ~AliDateEventWriter();
+
+  virtual Bool_t Open(const char *fileName, UInt_t runNumber);
+  virtual void   StartEvent(UInt_t detectorPattern, UInt_t timestamp)
+    {fBuilder.StartEvent(detectorPattern, timestamp);}
+  virtual void   AddEquipment(Int_t ldcId, Int_t equipmentId, const char *payload, UInt_t size)
+    {fBuilder.AddEquipment(ldcId, equipmentId, payload, size);}
+  virtual Bool_t WriteEvent();
+  virtual Bool_t Close();
+  virtual Int_t  GetNEvents() const {return fBuilder.GetNEvents();}
+
+private:
+  AliDateEventWriter(const AliDateEventWriter &source);
+  AliDateEventWriter &operator =(const AliDateEventWriter &source);
+
+  AliDateEventBuilder fBuilder;  // Builder of the events
+  FILE   *fFile;                 //! DATE file
+  AliMDC *fMDC;                  //! Writer of the root file
+
+  ClassDef(AliDateEventWriter,0)
+};
+
+#endif
@@ -12,5 +12,7 @@
 #pragma link C++ class AliTagDB;
 #pragma link C++ class AliTagNullDB;
 #pragma link C++ class AliMDC;
+#pragma link C++ class AliDateEventBuilder+;
+#pragma link C++ class AliDateEventWriter+;
 
 #endif
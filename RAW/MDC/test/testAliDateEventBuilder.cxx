@@ -0,0 +1,157 @@
+/**************************************************************************
+ * Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved. *
+ *                                                                        *
+ * Author: The ALICE Off-line Project.                                    *
+ * Contributors are mentioned in the code where appropriate.              *
+ *                                                                        *
+ * Permission to use, copy, modify and distribute this software and its   *
+ * documentation strictly for non-commercial purposes is hereby granted   *
+ * without fee, provided that the above copyright notice appears in all   *
+ * copies and that both the copyright notice and this permission notice   *
+ * appear in the supporting documentation. The authors make no claims     *
+ * about the suitability of this software for any purpose. It is          *
+ * provided "as is" without express or implied warranty.                  *
+ **************************************************************************/
+
+//-------------------------------------------------------------------------
+// Comparison of AliDateEventBuilder with dateStream: synthetic DDL
+// payloads with CDHs are written to DDL files and converted with
+//   dateStream -c -s -D -o <file> -# <n> -C -run <run>
+// as in AliSimulation::ConvertRawFilesToDate, the same payloads are
+// given to AliDateEventBuilder. The two DATE files have to be identical
+// byte for byte.
+//
+// Usage:
+//   testAliDateEventBuilder <path of dateStream>
+//-------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "event.h"
+#include "AliDateEventBuilder.h"
+
+const UInt_t kRunNumber = 123;
+const Int_t  kNEvents = 4;
+const Int_t  kNEquipments = 7;
+const Int_t  kCTPEquipment = 4352;
+
+// deterministic pseudo random numbers, independent of the platform
+UInt_t gSeed = 7;
+UInt_t Random()
+{
+  gSeed = gSeed*1103515245U + 12345U;
+  return gSeed >> 8;
+}
+
+// DDL payload of equipment iEq of an event, the last equipment is the CTP
+// without CDH and with a size which is not a multiple of 4
+void CreatePayload(std::vector<char>& payload, Int_t iEq, UInt_t triggerClasses,
+                   Bool_t triggerUnavailable)
+{
+  UInt_t size = (iEq == kNEquipments-1) ? 13 : CDH_SIZE + Random()%50;
+  if (iEq%2) size &= ~3U;  // the CDH block length is compared with the padded size
+  payload.resize(size);
+  for (UInt_t i = 0; i < size; i++) payload[i] = (char)Random();
+  if (iEq == kNEquipments-1) return;
+
+  commonDataHeaderStruct* cdh = (commonDataHeaderStruct*)&payload[0];
+  memset(cdh, 0, CDH_SIZE);
+  cdh->cdhVersion = CDH_VERSION;
+  cdh->cdhBlockLength = (iEq%2) ? size : 0xffffffff;
+  cdh->cdhBlockAttributes = iEq;
+  cdh->cdhParticipatingSubDetectors = 5;
+  cdh->cdhTriggerClassesLow = triggerClasses;
+  cdh->cdhTriggerClassesMiddleLow = triggerClasses >> 3;
+  if (triggerUnavailable) cdh->cdhStatusErrorBits = 1 << CDH_TRIGGER_INFORMATION_UNAVAILABLE_BIT;
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 2) {
+    printf("usage: %s <path of dateStream>\n", argv[0]);
+    return 1;
+  }
+
+  FILE* config = fopen("testAliDateEventBuilder.cfg", "w");
+  FILE* output = fopen("testAliDateEventBuilder.date", "wb");
+  if (!config || !output) {
+    printf("error: could not open the output files\n");
+    return 1;
+  }
+
+  AliDateEventBuilder builder(kRunNumber);
+  std::vector<char> payload;
+  for (Int_t iEvent = 0; iEvent < kNEvents; iEvent++) {
+    UInt_t detectorPattern = Random();
+    UInt_t timestamp = 1000 + iEvent;
+    UInt_t triggerClasses = Random();
+    Bool_t triggerUnavailable = (iEvent == kNEvents-1);
+    fprintf(config, "GDC DetectorPattern %u Timestamp %u\n", detectorPattern, timestamp);
+    builder.StartEvent(detectorPattern, timestamp);
+
+    Int_t prevLdc = -1;
+    for (Int_t iEq = 0; iEq < kNEquipments; iEq++) {
+      Int_t ldcId = iEq/3;
+      Int_t equipmentId = (iEq == kNEquipments-1) ? kCTPEquipment : 10*iEq + iEvent;
+      CreatePayload(payload, iEq, triggerClasses, triggerUnavailable);
+
+      char fileName[256];
+      snprintf(fileName, 256, "testAliDateEventBuilder_%d_%d.ddl", iEvent, iEq);
+      FILE* file = fopen(fileName, "wb");
+      if (!file || fwrite(&payload[0], payload.size(), 1, file) != 1) {
+        printf("error: could not write %s\n", fileName);
+        return 1;
+      }
+      fclose(file);
+
+      if (ldcId != prevLdc) {
+        fprintf(config, " LDC Id %d\n", ldcId);
+        prevLdc = ldcId;
+      }
+      fprintf(config, "  Equipment Id %d Payload %s\n", equipmentId, fileName);
+      builder.AddEquipment(ldcId, equipmentId, &payload[0], payload.size());
+    }
+
+    if (!builder.FinishEvent() || !builder.WriteEvent(output)) {
+      printf("error: event %d could not be built\n", iEvent);
+      return 1;
+    }
+  }
+  fclose(config);
+  fclose(output);
+
+  char command[1024];
+  snprintf(command, 1024, "%s -c -s -D -o testAliDateEventBuilder.ref.date -# %d -C -run %u "
+           "< testAliDateEventBuilder.cfg", argv[1], kNEvents, kRunNumber);
+  if (system(command) != 0) {
+    printf("error: %s failed\n", command);
+    return 1;
+  }
+
+  // byte for byte comparison
+  FILE* ref = fopen("testAliDateEventBuilder.ref.date", "rb");
+  FILE* out = fopen("testAliDateEventBuilder.date", "rb");
+  if (!ref || !out) {
+    printf("error: could not read the DATE files\n");
+    return 1;
+  }
+  long position = 0;
+  int cRef = 0, cOut = 0;
+  do {
+    cRef = fgetc(ref);
+    cOut = fgetc(out);
+    if (cRef != cOut) {
+      printf("error: DATE files differ at byte %ld: dateStream 0x%x, AliDateEventBuilder 0x%x\n",
+             position, cRef, cOut);
+      return 1;
+    }
+    position++;
+  } while (cRef != EOF);
+  fclose(ref);
+  fclose(out);
+
+  printf("%d events, %ld bytes identical to dateStream\n", kNEvents, position-1);
+  return 0;
+}
@@ -36,6 +36,8 @@
 #pragma link C++ function  TStatToolkit::LTMHisto(TH1 * , TVectorD &, Float_t);
 #pragma link C++ function  TStatToolkit::LTMUnbinned(int, const float*, TVectorF & , Float_t);
 #pragma link C++ function  TStatToolkit::LTMUnbinned(int, const double*, TVectorD & , Float_t);
+#pragma link C++ function  TStatToolkit::LTMUnbinned(int, const float*, TVectorF & , Float_t, Int_t*);
+#pragma link C++ function  TStatToolkit::LTMUnbinned(int, const double*, TVectorD & , Float_t, Int_t*);
 
 #pragma link C++ function TStatToolkit::Reorder(int , float *, const int *);
 #pragma link C++ function TStatToolkit::Reorder(int , double *, const int *);
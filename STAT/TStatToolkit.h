@@ -66,6 +66,7 @@ namespace TStatToolkit {
 
   template <typename T> Bool_t  LTMHisto(TH1 * his, TVectorT<T> &param , Float_t fraction=1);
   template <typename T> Int_t*  LTMUnbinned(int np, const T *arr, TVectorT<T> &params , Float_t keep=1.0);
+  template <typename T> Int_t*  LTMUnbinned(int np, const T *arr, TVectorT<T> &params , Float_t keep, Int_t *index);
 
   template <typename T> void Reorder(int np, T *arr, const int *idx);
   //
@@ -640,22 +641,34 @@ Int_t* TStatToolkit::LTMUnbinned(int np, const T *arr, TVectorT<T> &params , Flo
   //             - 5 - first accepted element (of sorted array)
   //             - 6 - last accepted  element (of sorted array)
   //
-  // On success returns index of sorted events 
+  // On success returns index of sorted events (internal buffer, not thread safe)
   //
   static int book = 0;
   static int *index = 0;
-  static float* w = 0;
-  int keepN = np*keep;
-  if (keepN>np) keepN = np;
-  if (keepN<2) return 0;
-  params[0] = 0.0f;
   if (book<np) {
     delete[] index;
     book = np;
     index = new int[book];
-    delete[] w;
-    w = new float[book+book];
   }
+  return LTMUnbinned(np,arr,params,keep,index);
+}
+
+template <typename T> 
+Int_t* TStatToolkit::LTMUnbinned(int np, const T *arr, TVectorT<T> &params , Float_t keep, Int_t *index)
+{
+  //
+  // LTM : Trimmed mean of unbinned array, see above
+  // index  - user buffer of at least np elements for the index of sorted events
+  // 
+  // On success returns index, thread safe
+  //
+  const int kMaxOnStack = 10000;
+  int keepN = np*keep;
+  if (keepN>np) keepN = np;
+  if (keepN<2) return 0;
+  params[0] = 0.0f;
+  // don't abuse stack
+  float *wHeap=0, wStack[2*np<kMaxOnStack ? 2*np:1], *w=2*np<kMaxOnStack ? &wStack[0] : (wHeap=new float[2*np]);
   //
   float *wx1 = w, *wx2 = wx1+np;
   TMath::Sort(np,arr,index,kFALSE); // sort in increasing order
@@ -684,6 +697,7 @@ Int_t* TStatToolkit::LTMUnbinned(int np, const T *arr, TVectorT<T> &params , Flo
     params[6] = limJ;
   }
   //
+  delete[] wHeap;
   if (!params[0]) return 0;
   if (params[2]<0) {
     ::Error("TStatToolkit::LTMUnbinned","rounding error in RMS<0");
@@ -35,6 +35,7 @@
 
 #include <TBrowser.h>
 #include <TClonesArray.h>
+#include <TMath.h>
 #include <TTree.h>
 
 #include "AliLog.h"
@@ -60,7 +61,12 @@ AliDetector::AliDetector():
   fCurIterHit(0),
   fHits(0),
   fDigits(0),
-  fLoader(0x0)
+  fLoader(0x0),
+  fHitBufferNvol(0),
+  fHitBufferNhits(0),
+  fNBufferedHits(0),
+  fHitBufferVol(0),
+  fHitBufferData(0)
 {
   //
   // Default constructor for the AliDetector class
@@ -79,7 +85,12 @@ AliDetector::AliDetector(const char* name,const char *title):
   fCurIterHit(0),
   fHits(0),
   fDigits(0),
-  fLoader(0x0)
+  fLoader(0x0),
+  fHitBufferNvol(0),
+  fHitBufferNhits(0),
+  fNBufferedHits(0),
+  fHitBufferVol(0),
+  fHitBufferData(0)
 {
   //
   // Normal constructor invoked by all Detectors.
@@ -272,9 +283,44 @@ void AliDetector::ResetHits()
   // Reset number of hits and the hits array
   //
   fNhits   = 0;
+  fNBufferedHits = 0;
   if (fHits) fHits->Clear();
 }
 
+//_______________________________________________________________________
+void AliDetector::SetHitBuffer(Int_t nvol, Int_t nhits, Int_t size)
+{
+  //
+  // Switch on the hit buffer for hits with nvol volume IDs and nhits
+  // values as passed to AddHit, size is the initial number of hits.
+  // The buffer grows as needed and is kept for the next primaries.
+  // nhits = 0 switches the buffer off
+  //
+  FlushHitBuffer();
+  fHitBufferNvol  = nhits>0 ? TMath::Max(nvol,0) : 0;
+  fHitBufferNhits = TMath::Max(nhits,0);
+  size = TMath::Max(size,1);
+  fHitBufferVol.Set(fHitBufferNhits>0 ? size*(fHitBufferNvol+1) : 0);
+  fHitBufferData.Set(size*fHitBufferNhits);
+}
+
+//_______________________________________________________________________
+void AliDetector::FlushHitBuffer()
+{
+  //
+  // Create the hits of the buffered records in the order they
+  // were stored. Called before the stack of the primary is purified
+  //
+  Int_t *vol = fHitBufferVol.GetArray();
+  Float_t *hits = fHitBufferData.GetArray();
+  for (Int_t i=0; i<fNBufferedHits; i++) {
+    AddBufferedHit(vol[0],vol+1,hits);
+    vol  += fHitBufferNvol+1;
+    hits += fHitBufferNhits;
+  }
+  fNBufferedHits = 0;
+}
+
 //_______________________________________________________________________
 void AliDetector::SetTreeAddress()
 {
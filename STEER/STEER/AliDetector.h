@@ -12,6 +12,8 @@
 // in ALICE
 //
 
+#include <TArrayI.h>
+#include <TArrayF.h>
 #include "AliModule.h"
 
 class AliHit;
@@ -61,6 +63,14 @@ public:
   
   void MakeTree(Option_t *option); //skowron
   virtual void        RemapTrackHitIDs(Int_t *) {}
+
+  // Hit buffer: the StepManager stores fixed size hit records, the
+  // hits are created with AddHit when the buffer is flushed
+  void                SetHitBuffer(Int_t nvol, Int_t nhits, Int_t size=1000);
+  Bool_t              IsHitBufferOn() const {return fHitBufferNhits>0;}
+  Int_t               GetNBufferedHits() const {return fNBufferedHits;}
+  void                BufferHit(Int_t track, const Int_t *vol, const Float_t *hits);
+  virtual void        FlushHitBuffer();
   
   virtual AliLoader* MakeLoader(const char* topfoldername); //builds standard getter (AliLoader type)
   void    SetLoader(AliLoader* loader){fLoader = loader;}
@@ -81,10 +91,36 @@ protected:
 
   AliLoader*  fLoader;//! pointer to getter for this module skowron
 
+  Int_t         fHitBufferNvol;  //!Number of volume IDs of a buffered hit
+  Int_t         fHitBufferNhits; //!Number of hit values of a buffered hit, 0 if no buffer
+  Int_t         fNBufferedHits;  //!Number of buffered hits
+  TArrayI       fHitBufferVol;   //!Track and volume IDs of the buffered hits
+  TArrayF       fHitBufferData;  //!Hit values of the buffered hits
+
+  virtual void        AddBufferedHit(Int_t track, Int_t *vol, Float_t *hits) {AddHit(track,vol,hits);}
+
  private:
   AliDetector(const AliDetector &det);
   AliDetector &operator=(const AliDetector &det);
 
   ClassDef(AliDetector,5)  //Base class for ALICE detectors
 };
+
+//_______________________________________________________________________
+inline void AliDetector::BufferHit(Int_t track, const Int_t *vol, const Float_t *hits)
+{
+  //
+  // Store a hit record, no object is created during the step
+  //
+  if (fNBufferedHits*fHitBufferNhits >= fHitBufferData.GetSize()) {
+    fHitBufferVol.Set(2*fHitBufferVol.GetSize());
+    fHitBufferData.Set(2*fHitBufferData.GetSize());
+  }
+  Int_t *dvol = fHitBufferVol.GetArray()+fNBufferedHits*(fHitBufferNvol+1);
+  Float_t *dhits = fHitBufferData.GetArray()+fNBufferedHits*fHitBufferNhits;
+  dvol[0] = track;
+  for (Int_t i=0; i<fHitBufferNvol; i++) dvol[i+1] = vol[i];
+  for (Int_t i=0; i<fHitBufferNhits; i++) dhits[i] = hits[i];
+  fNBufferedHits++;
+}
 #endif
@@ -22,11 +22,22 @@
 // to the real life situation when the detector data is coming from
 // the hardware). The implementation of this class is based on Root
 // tobuf() method defined in Bytes.h
+//
+// In memory mode (SetMemoryMode(kTRUE)) the content of a file is kept
+// in memory and handed over to a static store when the AliFstream is
+// deleted. The store is filled thread safe, so that the detectors can
+// write their DDLs concurrently (AliSimulation::SetNThreadsRawData).
+// GetMemoryFile returns the content by the file name given to the
+// constructor, ClearMemoryFiles frees it.
 //-------------------------------------------------------------------------
 
 #include <unistd.h>
 #include <Riostream.h>
 #include <stdio.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <TMath.h>
 #include "AliFstream.h"
 #include "AliLog.h"
 
@@ -34,11 +45,24 @@
 using std::ios;
 ClassImp(AliFstream)
 
+Bool_t AliFstream::fgMemoryMode = kFALSE;
+
+namespace {
+  // content and size of the files written in memory mode
+  typedef std::map<std::string, std::pair<char*, UInt_t> > AliFstreamMemoryFiles;
+  AliFstreamMemoryFiles gMemoryFiles;
+}
+
 //______________________________________________________________________________
 AliFstream::AliFstream():
   fFile(0x0),
   fBuffer(0x0),
-  fBufferSize(0)
+  fBufferSize(0),
+  fFileName(),
+  fMemory(0x0),
+  fMemorySize(0),
+  fFileSize(0),
+  fPosition(0)
 {
   // Default constructor
 }
@@ -47,12 +71,23 @@ AliFstream::AliFstream():
 AliFstream::AliFstream(const char *fileName):
   fFile(0x0),
   fBuffer(0x0),
-  fBufferSize(0)
+  fBufferSize(0),
+  fFileName(),
+  fMemory(0x0),
+  fMemorySize(0),
+  fFileSize(0),
+  fPosition(0)
 {
   // Constructor
   // Takes the input filename and
-  // opens the output stream
+  // opens the output stream.
+  // In memory mode the file is
+  // kept in memory
 
+  if (fgMemoryMode) {
+    fFileName = fileName;
+    return;
+  }
 #ifndef __DECCXX
   fFile = new fstream(fileName, ios::binary|ios::out);
 #else
@@ -64,12 +99,27 @@ AliFstream::AliFstream(const char *fileName):
 AliFstream::~AliFstream()
 {
   // Destructor
-  //
+  // In memory mode the file content
+  // is moved to the store of the
+  // memory files
   if (fFile) {
     fFile->close();
     delete fFile;
   }
   if (fBuffer) delete [] fBuffer;
+  if (!fFileName.IsNull()) {
+    std::pair<char*, UInt_t> file(fMemory, fFileSize);
+    fMemory = 0x0;
+#ifdef _OPENMP
+#pragma omp critical(AliFstreamMemoryFiles)
+#endif
+    {
+      std::pair<char*, UInt_t>& entry = gMemoryFiles[fFileName.Data()];
+      delete [] entry.first;
+      entry = file;
+    }
+  }
+  delete [] fMemory;
 }
 
 //______________________________________________________________________________
@@ -78,6 +128,7 @@ void AliFstream::Seekp(UInt_t position)
   // Go to a given position
   // inside the output stream
   if (fFile) fFile->seekp(position);
+  else if (!fFileName.IsNull()) fPosition = position;
 }
 
 //______________________________________________________________________________
@@ -87,7 +138,7 @@ UInt_t AliFstream::Tellp()
   // position inside the
   // output stream
   if (fFile) return fFile->tellp();
-  else return 0;
+  else return fPosition;
 }
 
 //______________________________________________________________________________
@@ -117,11 +168,11 @@ void AliFstream::WriteBuffer(const char *buffer, UInt_t size, Bool_t force)
     AliFatal(Form("Size of the buffer is not multiple of 4 (size = %d) !",size));
   
   if (force) {
-    fFile->write(buffer,size);
+    Write(buffer,size);
   }
   else {
 #ifdef R__BYTESWAP
-    fFile->write(buffer,size);
+    Write(buffer,size);
 #else
     size /= sizeof(UInt_t);
 
@@ -137,7 +188,61 @@ void AliFstream::WriteBuffer(const char *buffer, UInt_t size, Bool_t force)
       memcpy(fBuffer+i, &value, sizeof(UInt_t));
     }
 
-    fFile->write((const char *)fBuffer,size*sizeof(UInt_t));
+    Write((const char *)fBuffer,size*sizeof(UInt_t));
 #endif
   }
 }
+
+//______________________________________________________________________________
+void AliFstream::Write(const char *buffer, UInt_t size)
+{
+  // Write the buffer at the current
+  // position of the file or of the
+  // memory buffer in memory mode
+
+  if (fFile) {
+    fFile->write(buffer,size);
+    return;
+  }
+  if (fFileName.IsNull()) return;
+
+  if (fPosition + size > fMemorySize) {
+    UInt_t memorySize = TMath::Max(fPosition + size, 2*fMemorySize);
+    char *memory = new char[memorySize];
+    if (fMemory) memcpy(memory, fMemory, fFileSize);
+    delete [] fMemory;
+    fMemory = memory;
+    fMemorySize = memorySize;
+  }
+  if (fPosition > fFileSize) memset(fMemory + fFileSize, 0, fPosition - fFileSize);
+  memcpy(fMemory + fPosition, buffer, size);
+  fPosition += size;
+  if (fPosition > fFileSize) fFileSize = fPosition;
+}
+
+//______________________________________________________________________________
+const char *AliFstream::GetMemoryFile(const char *fileName, UInt_t &size)
+{
+  // Return the content of a file
+  // written in memory mode and set
+  // its size, NULL if there is no
+  // such file
+
+  size = 0;
+  AliFstreamMemoryFiles::const_iterator file = gMemoryFiles.find(fileName);
+  if (file == gMemoryFiles.end()) return NULL;
+  size = file->second.second;
+  return file->second.first;
+}
+
+//______________________________________________________________________________
+void AliFstream::ClearMemoryFiles()
+{
+  // Delete the files written
+  // in memory mode
+
+  for (AliFstreamMemoryFiles::iterator file = gMemoryFiles.begin();
+       file != gMemoryFiles.end(); ++file)
+    delete [] file->second.first;
+  gMemoryFiles.clear();
+}
@@ -11,9 +11,12 @@
 // data payload is stored always with little endian (this corresponds
 // to the real life situation when the detector data is coming from
 // the hardware).
+// In memory mode the DDL files are kept in memory instead of being
+// written to disk, see SetMemoryMode.
 //-------------------------------------------------------------------------
 
 #include <TObject.h>
+#include <TString.h>
 using std::fstream;
 
 class AliFstream : public TObject {
@@ -26,16 +29,29 @@ public:
   UInt_t Tellp();
   void   WriteBuffer(const char *buffer, UInt_t size, Bool_t force = kFALSE);
 
+  static void        SetMemoryMode(Bool_t memory) {fgMemoryMode = memory;}
+  static Bool_t      IsMemoryMode() {return fgMemoryMode;}
+  static const char *GetMemoryFile(const char *fileName, UInt_t &size);
+  static void        ClearMemoryFiles();
+
 private:
 
   AliFstream(const AliFstream &source);
   AliFstream &operator =(const AliFstream& source);
 
   UInt_t Swap(UInt_t x);
+  void   Write(const char *buffer, UInt_t size);
 
   fstream *fFile;       // Output file stream
   UInt_t  *fBuffer;     // Pointer to the internal buffer
   UInt_t   fBufferSize; // Internal buffer size
+  TString  fFileName;   // File name in memory mode
+  char    *fMemory;     // File content in memory mode
+  UInt_t   fMemorySize; // Allocated size of fMemory
+  UInt_t   fFileSize;   // File size in memory mode
+  UInt_t   fPosition;   // Output position in memory mode
+
+  static Bool_t fgMemoryMode; // Keep the files in memory
 
   ClassDef(AliFstream,0)
 };
@@ -69,6 +69,7 @@ AliMC::AliMC() :
   fSaveRndmEventStatus(kFALSE),
   fReadRndmStatus(kFALSE),
   fUseMonitoring(kFALSE),
+  fMonitorSampling(1),
   fRndmFileName("random.root"),
   fEventEnergy(0),
   fSummEnergy(0),
@@ -101,6 +102,7 @@ AliMC::AliMC(const char *name, const char *title) :
   fSaveRndmEventStatus(kFALSE),
   fReadRndmStatus(kFALSE),
   fUseMonitoring(kFALSE),
+  fMonitorSampling(1),
   fRndmFileName("random.root"),
   fEventEnergy(0),
   fSummEnergy(0),
@@ -1043,6 +1045,7 @@ void AliMC::FinishRun()
   // Monitoring information
   if (fMonitor) {
     fMonitor->Print();
+    fMonitor->Report();
     fMonitor->Export("timing.root");
   }
 
@@ -1100,22 +1103,26 @@ void AliMC::Stepping()
   }
 
   // --- If monitoring timing was requested, monitor the step
+  // (or one step in fMonitorSampling)
   if (fUseMonitoring) {
     if (!fMonitor) {
       fMonitor = new AliTransportMonitor(fMC->NofVolumes()+1);
+      fMonitor->SetSampling(fMonitorSampling);
       fMonitor->Start();
     }  
-    if (fMC->IsNewTrack() || fMC->TrackTime() == 0. || fMC->TrackStep()<1.1E-10) {
-      fMonitor->DummyStep();
-    } else {
-    // Normal stepping
-      Int_t copy;
-      Int_t volId = fMC->CurrentVolID(copy);
-      Int_t pdg = fMC->TrackPid();
-      TLorentzVector xyz, pxpypz;
-      fMC->TrackPosition(xyz);
-      fMC->TrackMomentum(pxpypz);
-      fMonitor->StepInfo(volId, pdg, pxpypz.E(), xyz.X(), xyz.Y(), xyz.Z());
+    if (fMonitor->Sample()) {
+      if (fMC->IsNewTrack() || fMC->TrackTime() == 0. || fMC->TrackStep()<1.1E-10) {
+        fMonitor->DummyStep();
+      } else {
+      // Normal stepping
+        Int_t copy;
+        Int_t volId = fMC->CurrentVolID(copy);
+        Int_t pdg = fMC->TrackPid();
+        TLorentzVector xyz, pxpypz;
+        fMC->TrackPosition(xyz);
+        fMC->TrackMomentum(pxpypz);
+        fMonitor->StepInfo(volId, pdg, pxpypz.E(), xyz.X(), xyz.Y(), xyz.Z());
+      }
     }
   }
   //
@@ -1376,6 +1383,12 @@ void AliMC::FinishPrimary()
   AliRunLoader *runloader=AliRunLoader::Instance();
   //  static Int_t count=0;
   //  const Int_t times=10;
+
+  // Create the buffered hits while the track labels are still valid
+  TIter nextbuf(gAlice->Modules());
+  AliModule *module;
+  while((module = dynamic_cast<AliModule*>(nextbuf()))) module->FlushHitBuffer();
+
   // This primary is finished, purify stack
 #if ROOT_VERSION_CODE > 262152
   if (!(TVirtualMC::GetMC()->SecondariesAreOrdered())) {
@@ -113,7 +113,7 @@ public:
    void           SetGeometryFromCDB();
    Bool_t         IsGeometryFromCDB() const;
 // Monitor transport   
-   void           SetUseMonitoring(Bool_t flag=kTRUE)      { fUseMonitoring = flag; }
+   void           SetUseMonitoring(Bool_t flag=kTRUE, Int_t sampling=1) { fUseMonitoring = flag; fMonitorSampling = sampling; }
    AliTransportMonitor *GetTransportMonitor() const        { return fMonitor; }
 // Random number generator status
    void           SetSaveRndmStatus(Bool_t value)          { fSaveRndmStatus = value; }  
@@ -136,6 +136,7 @@ public:
    Bool_t         fSaveRndmEventStatus; //! Options to save random engine status for each event
    Bool_t         fReadRndmStatus;    //! Options to read random engine status
    Bool_t         fUseMonitoring;     //! Activate monitoring
+   Int_t          fMonitorSampling;   //! Monitor one step in fMonitorSampling
    TString        fRndmFileName;      //! The file name of random engine status to be read in
    TArrayF        fEventEnergy;       //! Energy deposit for current event
    TArrayF        fSummEnergy;        //! Energy per event in each volume
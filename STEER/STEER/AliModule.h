@@ -98,6 +98,7 @@ public:
   virtual void        Digits2Raw();
   virtual void        Raw2Digits()  {}
   virtual Bool_t      Raw2SDigits(AliRawReader*) {return kFALSE;}
+  virtual Bool_t      MakeFastClusters() {return kFALSE;} // recpoints from track references, parametrized response
   virtual void        QADataMaker (const char *) {} 
   virtual void        Browse(TBrowser *) {} //PH Do we need it?
   virtual void        CreateGeometry() {}
@@ -126,6 +127,7 @@ public:
   virtual void        ResetDigits() {}
   virtual void        ResetSDigits() {}
   virtual void        ResetHits() {}
+  virtual void        FlushHitBuffer() {}
   virtual void        SetTimeGate(Float_t) {}
   virtual Float_t     GetTimeGate() const {return 1.e10;}
   virtual void        StepManager() {}
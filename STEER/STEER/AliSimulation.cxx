@@ -61,6 +61,16 @@
 // this feature is not available for all detectors and that merging is not   //
 // possible, when digits are created directly from hits.                     //
 //                                                                           //
+// For efficiency studies the detectors providing a parametrized response    //
+// can produce their clusters directly from the track references, without    //
+// sdigits and digits:                                                       //
+//                                                                           //
+//   sim.SetMakeFastClusters("TPC");                                         //
+//                                                                           //
+// The clusters are written to the recpoints, these detectors have to be     //
+// excluded from the local reconstruction (AliReconstruction::SetRunLocal-   //
+// Reconstruction), raw data can not be written for them.                    //
+//                                                                           //
 // Background events can be merged by calling                                //
 //                                                                           //
 //   sim.MergeWith("background/galice.root", 2);                             //
@@ -115,6 +125,45 @@
 //                                                                           //
 // Default is to read from OCDB.                                             //
 //                                                                           //
+// The digitizers of the detectors can run concurrently, each detector       //
+// writing its digits with its own loader, by                                //
+//                                                                           //
+//   sim.SetNThreadsDigitization(4);   // 0: all available threads           //
+//   sim.SetDigitizationDependency("TPC", "");                               //
+//   sim.SetDigitizationDependency("TRD", "TPC ITS");                        //
+//                                                                           //
+// Only the detectors with such a declaration are digitized concurrently,    //
+// the declaration states that their digitizer is thread safe and which      //
+// detectors have to be digitized before: TRD after TPC and ITS. Detectors   //
+// without declaration are digitized one after another before the            //
+// concurrent steps. During the concurrent digitization gRandom serves       //
+// every detector with its own generator seeded from gRandom, the digits do  //
+// not depend on the number of threads. Requires OpenMP.                     //
+//                                                                           //
+// With                                                                      //
+//                                                                           //
+//   sim.SetRawDataInMemory();                                               //
+//                                                                           //
+// the DDLs written with AliFstream are kept in memory. Every event is       //
+// written directly to the DATE file, or to the root file, by the writer     //
+// AliDateEventWriter of libMDC, which is loaded as plugin                   //
+// AliRawEventWriter "DATE". Neither the DDL files nor the programs          //
+// dateStream and alimdc are needed. DDLs which are not written with         //
+// AliFstream are taken from the DDL files. As the HLT simulation reads the  //
+// DDL files, the DDL files are still written if the HLT simulation is       //
+// switched on.                                                              //
+//                                                                           //
+// The DDLs of the detectors can be written concurrently by                  //
+//                                                                           //
+//   sim.SetNThreadsRawData(4);        // 0: all available threads           //
+//   sim.SetRawDataThreadSafe("TPC ITS TRD");                                //
+//                                                                           //
+// Only the detectors declared with a thread safe Digits2Raw run             //
+// concurrently, the others one after another before them. AliFstream        //
+// stores the DDLs of concurrent detectors safely in both modes. As in the   //
+// concurrent digitization every detector draws the random numbers from its  //
+// own generator seeded from gRandom. Requires OpenMP.                       //
+//                                                                           //
 ///////////////////////////////////////////////////////////////////////////////
 
 #include <TFile.h>
@@ -127,6 +176,16 @@
 #include <TVirtualMCApplication.h>
 #include <TDatime.h>
 #include <TInterpreter.h>
+#include <RVersion.h>
+#include <TRandom3.h>
+#include <TStopwatch.h>
+#include <TMath.h>
+#include <TArrayC.h>
+#include <TArrayD.h>
+#include <TPluginManager.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "AliAlignObj.h"
 #include "AliCDBEntry.h"
@@ -141,6 +200,7 @@
 #include "AliDigitizer.h"
 #include "AliESDEvent.h"
 #include "AliFileUtilities.h"
+#include "AliFstream.h"
 #include "AliGRPObject.h"
 #include "AliGenEventHeader.h"
 #include "AliGenerator.h"
@@ -154,6 +214,7 @@
 #include "AliMagF.h"
 #include "AliModule.h"
 #include "AliPDG.h"
+#include "AliRawEventWriter.h"
 #include "AliRawReaderDate.h"
 #include "AliRawReaderFile.h"
 #include "AliRawReaderRoot.h"
@@ -171,6 +232,32 @@
 using std::ofstream;
 ClassImp(AliSimulation)
 
+namespace {
+  // generator of the detector processed by the current thread
+  TRandom* gDetectorRandom = 0;
+#ifdef _OPENMP
+#pragma omp threadprivate(gDetectorRandom)
+#endif
+
+  // gRandom while the detectors run concurrently: the random numbers are
+  // taken from the generator of the detector processed by the calling thread
+  class AliThreadRandom : public TRandom {
+  public:
+    AliThreadRandom(TRandom* master) : TRandom(), fMaster(master) {}
+#if ROOT_VERSION_CODE < ROOT_VERSION(6,4,0)
+    virtual Double_t Rndm(Int_t i=0) {return Current()->Rndm(i);}
+#else
+    virtual Double_t Rndm() {return Current()->Rndm();}
+#endif
+    virtual void     RndmArray(Int_t n, Float_t* array) {Current()->RndmArray(n, array);}
+    virtual void     RndmArray(Int_t n, Double_t* array) {Current()->RndmArray(n, array);}
+    virtual Double_t Gaus(Double_t mean=0, Double_t sigma=1) {return Current()->Gaus(mean, sigma);}
+  private:
+    TRandom* Current() const {return gDetectorRandom ? gDetectorRandom : fMaster;}
+    TRandom* fMaster; // gRandom outside of the concurrent steps
+  };
+}
+
 AliSimulation *AliSimulation::fgInstance = 0;
  const char* AliSimulation::fgkDetectorName[AliSimulation::fgkNDetectors] = {"ITS", "TPC", "TRD", 
  "TOF", "PHOS", "HMPID", "EMCAL", "MUON", "FMD", "ZDC", "PMD", "T0", "VZERO", "ACORDE","AD",
@@ -192,6 +279,7 @@ AliSimulation::AliSimulation(const char* configFileName,
   fMakeDigits("ALL"),
   fTriggerConfig(""),
   fMakeDigitsFromHits(""),
+  fMakeFastClusters(""),
   fWriteRawData(""),
   fRawDataFileName(""),
   fDeleteIntermediateFiles(kFALSE),
@@ -221,6 +309,11 @@ AliSimulation::AliSimulation(const char* configFileName,
   fUseMagFieldFromGRP(0),
   fGRPWriteLocation(Form("local://%s", gSystem->pwd())),
   fUseDetectorsFromGRP(kTRUE),
+  fNThreadsDigitization(1),
+  fDigitizationDependencies(),
+  fRawDataInMemory(kFALSE),
+  fNThreadsRawData(1),
+  fRawDataThreadSafe(""),
   fUseTimeStampFromCDB(0),
   fTimeStart(0),
   fTimeEnd(0),
@@ -253,6 +346,7 @@ AliSimulation::~AliSimulation()
 // clean up
 
   fEventsPerFile.Delete();
+  fDigitizationDependencies.Delete();
 //  if(fAlignObjArray) fAlignObjArray->Delete(); // fAlignObjArray->RemoveAll() ???
 //  delete fAlignObjArray; fAlignObjArray=0;
 
@@ -531,6 +625,21 @@ void AliSimulation::SetEventsPerFile(const char* detector, const char* type,
   fEventsPerFile.Add(obj);
 }
 
+//_____________________________________________________________________________
+void AliSimulation::SetDigitizationDependency(const char* detector, const char* dependsOn)
+{
+// declare that the digitizer of detector is thread safe and needs the digits
+// of the detectors in dependsOn (separated by a space, "" for none), only
+// detectors with a declaration are digitized concurrently
+
+  TObject* obj = fDigitizationDependencies.FindObject(detector);
+  if (obj) {
+    fDigitizationDependencies.Remove(obj);
+    delete obj;
+  }
+  fDigitizationDependencies.Add(new TNamed(detector, dependsOn));
+}
+
 //_____________________________________________________________________________
 Bool_t AliSimulation::MisalignGeometry(AliRunLoader *runLoader)
 {
@@ -742,6 +851,12 @@ Bool_t AliSimulation::Run(Int_t nEvents)
   AliSysInfo::AddStamp("MissalignGeometry");
 
 
+  // track references -> clusters
+  if (!fMakeFastClusters.IsNull()) {
+    if (!RunFastClusters(fMakeFastClusters)) if (fStopOnError) return kFALSE;
+  }
+  AliSysInfo::AddStamp("FastClusters");
+
   // hits -> summable digits
   AliSysInfo::AddStamp("Start_sdigitization");
   if (!fMakeSDigits.IsNull()) {
@@ -753,7 +868,8 @@ Bool_t AliSimulation::Run(Int_t nEvents)
   AliSysInfo::AddStamp("Start_digitization");  
   // summable digits -> digits  
   if (!fMakeDigits.IsNull()) {
-    if (!RunDigitization(fMakeDigits, fMakeDigitsFromHits)) {
+    TString excludeDetectors = fMakeDigitsFromHits+" "+fMakeFastClusters;
+    if (!RunDigitization(fMakeDigits, excludeDetectors)) {
       if (fStopOnError) return kFALSE;
     }
    }
@@ -1458,6 +1574,7 @@ Bool_t AliSimulation::RunSDigitization(const char* detectors)
   if (!runLoader) return kFALSE;
   //
   TString detStr = detectors;
+  TString fastStr = fMakeFastClusters; // no sdigits for the fast clusters
   TObjArray* detArray = runLoader->GetAliRun()->Detectors();
   //
   if (fUseDetectorsFromGRP) {
@@ -1468,10 +1585,12 @@ Bool_t AliSimulation::RunSDigitization(const char* detectors)
   for (Int_t iDet = 0; iDet < detArray->GetEntriesFast(); iDet++) {
     AliModule* det = (AliModule*) detArray->At(iDet);
     if (!det || !det->IsActive()) continue;
-    if (IsSelected(det->GetName(), detStr)) {
+    if (IsSelected(det->GetName(), detStr) && !IsSelected(det->GetName(), fastStr)) {
       AliInfo(Form("creating summable digits for %s", det->GetName()));
       AliCodeTimerStart(Form("creating summable digits for %s", det->GetName()));
+      TStopwatch timer;
       det->Hits2SDigits();
+      AliInfo(Form("summable digitization time of %s: %.2f s", det->GetName(), timer.RealTime()));
       AliCodeTimerStop(Form("creating summable digits for %s", det->GetName()));
       AliSysInfo::AddStamp(Form("SDigit_%s_%d",det->GetName(),eventNr), 0,1, eventNr);
     }
@@ -1518,6 +1637,8 @@ Bool_t AliSimulation::RunDigitization(const char* detectors,
   }
   TObjArray detArr;
   detArr.SetOwner(kTRUE);
+  TObjArray detNames;
+  detNames.SetOwner(kTRUE);
   TString detStr = detectors;
   TString detExcl = excludeDetectors;
   if (!static_cast<AliStream*>(digInp.GetInputStream(0))->ImportgAlice()) {
@@ -1543,6 +1664,7 @@ Bool_t AliSimulation::RunDigitization(const char* detectors,
       else continue;
     }
     detArr.AddLast(digitizer);    
+    detNames.AddLast(new TObjString(det->GetName()));
     AliInfo(Form("Created digitizer from SDigits -> Digits for %s", det->GetName()));    
 
   }
@@ -1553,6 +1675,19 @@ Bool_t AliSimulation::RunDigitization(const char* detectors,
   }
   //
   Int_t ndigs = detArr.GetEntriesFast();
+  Int_t nStages = 0; // >0: digitize the declared detectors concurrently in nStages steps
+  TArrayI stages;
+  if (fNThreadsDigitization!=1 && ndigs>1) {
+#ifdef _OPENMP
+    nStages = GetDigitizationStages(detNames, stages);
+    if (nStages<0) AliError("cyclic digitization dependencies, the detectors are digitized one after another");
+    else if (nStages==0) AliWarning("no digitization dependencies declared, the detectors are digitized one after another");
+    else AliInfo(Form("digitizing the declared detectors concurrently in %d steps", nStages));
+#else
+    AliWarning("built without OpenMP support, the detectors are digitized one after another");
+#endif
+  }
+  TArrayD times(ndigs), totalTimes(ndigs);
   Int_t eventsCreated = 0;
   AliRunLoader* outRl =  digInp.GetOutRunLoader();
   while ((eventsCreated++ < fNEvents) || (fNEvents < 0)) {
@@ -1561,16 +1696,102 @@ Bool_t AliSimulation::RunDigitization(const char* detectors,
     if (outRl) outRl->SetEventNumber(eventsCreated-1);
     static_cast<AliStream*>(digInp.GetInputStream(0))->ImportgAlice(); // use gAlice of the first input stream
     for (int id=0;id<ndigs;id++) {
+      if (nStages>0 && stages[id]>=0) continue; // digitized below
+      TStopwatch timer;
       ((AliDigitizer*)detArr[id])->Digitize("");
+      times[id] = timer.RealTime();
+    }
+    if (nStages>0) RunDigitizersConcurrently(detArr, stages, nStages, times);
+    for (int id=0;id<ndigs;id++) {
       AliSysInfo::AddStamp(Form("Digit_%s_%d",detArr[id]->GetName(),eventsCreated), 0,2, eventsCreated);       
+      AliDebug(1, Form("digitization of %s in event %d: %.3f s", detNames[id]->GetName(), eventsCreated-1, times[id]));
+      totalTimes[id] += times[id];
     }
     digInp.FinishEvent();
   };
   digInp.FinishGlobal();
   // 
+  for (int id=0;id<ndigs;id++) {
+    AliInfo(Form("digitization time of %s: %.2f s", detNames[id]->GetName(), totalTimes[id]));
+  }
   return kTRUE;
 }
 
+//_____________________________________________________________________________
+Int_t AliSimulation::GetDigitizationStages(const TObjArray& detNames, TArrayI& stages) const
+{
+// assign the detectors declared with SetDigitizationDependency to steps such
+// that every detector is digitized after the declared detectors it depends
+// on, the detectors without declaration get the step -1, they are digitized
+// one after another before the concurrent steps
+// returns the number of steps, -1 for cyclic dependencies
+
+  Int_t ndet = detNames.GetEntriesFast();
+  stages.Set(ndet);
+  Int_t nStages = 0;
+  for (Int_t i = 0; i < ndet; i++) {
+    stages[i] = fDigitizationDependencies.FindObject(detNames[i]->GetName()) ? 0 : -1;
+    if (stages[i] == 0) nStages = 1;
+  }
+  for (Int_t iter = 0; iter <= ndet; iter++) {
+    Bool_t changed = kFALSE;
+    for (Int_t i = 0; i < ndet; i++) {
+      if (stages[i] < 0) continue;
+      const char* dependsOn = fDigitizationDependencies.FindObject(detNames[i]->GetName())->GetTitle();
+      for (Int_t j = 0; j < ndet; j++) {
+        TString detStr = dependsOn;
+        if (j == i || stages[j] < 0 || !IsSelected(detNames[j]->GetName(), detStr)) continue;
+        if (stages[i] <= stages[j]) {
+          stages[i] = stages[j]+1;
+          nStages = TMath::Max(nStages, stages[i]+1);
+          changed = kTRUE;
+        }
+      }
+    }
+    if (!changed) return nStages;
+  }
+  return -1;
+}
+
+//_____________________________________________________________________________
+void AliSimulation::RunDigitizersConcurrently(const TObjArray& digitizers, const TArrayI& stages,
+                                              Int_t nStages, TArrayD& times) const
+{
+// digitize the current event with the digitizers of one step running
+// concurrently, every digitizer draws the random numbers from its own
+// generator seeded from gRandom, the real time per digitizer is set in times
+
+  Int_t ndigs = digitizers.GetEntriesFast();
+  TArrayI seeds(ndigs);
+  for (Int_t id = 0; id < ndigs; id++) seeds[id] = gRandom->Integer(kMaxInt-1)+1; // 0 would be a time based seed
+
+  Int_t nThreads = 1;
+#ifdef _OPENMP
+  nThreads = fNThreadsDigitization>0 ? fNThreadsDigitization : omp_get_max_threads();
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,6,0)
+  if (nThreads>1) ROOT::EnableThreadSafety();
+#endif
+#endif
+  TRandom* master = gRandom;
+  AliThreadRandom threadRandom(master);
+  gRandom = &threadRandom;
+  for (Int_t stage = 0; stage < nStages; stage++) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,1) num_threads(nThreads)
+#endif
+    for (Int_t id = 0; id < ndigs; id++) {
+      if (stages[id] != stage) continue;
+      TRandom3 rnd(seeds[id]);
+      gDetectorRandom = &rnd;
+      TStopwatch timer;
+      ((AliDigitizer*)digitizers.UncheckedAt(id))->Digitize("");
+      times[id] = timer.RealTime();
+      gDetectorRandom = 0;
+    }
+  }
+  gRandom = master;
+}
+
 //_____________________________________________________________________________
 Bool_t AliSimulation::RunHitsDigitization(const char* detectors)
 {
@@ -1612,6 +1833,50 @@ Bool_t AliSimulation::RunHitsDigitization(const char* detectors)
   return kTRUE;
 }
 
+//_____________________________________________________________________________
+Bool_t AliSimulation::RunFastClusters(const char* detectors)
+{
+// run the parametrized response and produce clusters from track references
+
+  AliCodeTimerAuto("",0)
+
+  // initialize CDB storage, run number, set CDB lock
+  InitCDB();
+  if (!SetRunNumberFromData()) if (fStopOnError) return kFALSE;
+  SetCDBLock();
+  
+  AliRunLoader* runLoader = LoadRun("READ");
+  if (!runLoader) return kFALSE;
+
+  TString detStr = detectors;
+  TObjArray* detArray = runLoader->GetAliRun()->Detectors();
+  //
+  if (fUseDetectorsFromGRP) {
+    AliInfo("Will run only for detectors seen in the GRP");
+    DeactivateDetectorsAbsentInGRP(detArray);  
+  }
+  //
+  for (Int_t iDet = 0; iDet < detArray->GetEntriesFast(); iDet++) {
+    AliModule* det = (AliModule*) detArray->At(iDet);
+    if (!det || !det->IsActive()) continue;
+    if (IsSelected(det->GetName(), detStr)) {
+      AliInfo(Form("creating clusters from track references for %s", det->GetName()));
+      if (!det->MakeFastClusters()) {
+        AliError(Form("no fast clusters for %s", det->GetName()));
+        if (fStopOnError) return kFALSE;
+      }
+    }
+  }
+
+  if ((detStr.CompareTo("ALL") != 0) && !detStr.IsNull()) {
+    AliError(Form("the following detectors were not found: %s", 
+                  detStr.Data()));
+    if (fStopOnError) return kFALSE;
+  }
+
+  return kTRUE;
+}
+
 //_____________________________________________________________________________
 Bool_t AliSimulation::WriteRawData(const char* detectors, 
 				   const char* fileName,
@@ -1632,6 +1897,15 @@ Bool_t AliSimulation::WriteRawData(const char* detectors,
   AliCodeTimerAuto("",0)
   AliSysInfo::AddStamp("WriteRawData_Start");
   
+  if (fRawDataInMemory && fileName && strlen(fileName)) {
+    if (fRunHLT.IsNull()) {
+      Bool_t result = WriteRawEvents(detectors, fileName, deleteIntermediateFiles, selrawdata);
+      AliSysInfo::AddStamp("WriteRawEvents");
+      return result;
+    }
+    AliWarning("the HLT simulation needs the DDL files, the raw data are not kept in memory");
+  }
+
   TString detStr = detectors;
   if (!WriteRawFiles(detStr.Data())) {
     if (fStopOnError) return kFALSE;
@@ -1715,56 +1989,306 @@ Bool_t AliSimulation::WriteRawFiles(const char* detectors)
 
   // write raw data to DDL files
   for (Int_t iEvent = 0; iEvent < runLoader->GetNumberOfEvents(); iEvent++) {
-    AliInfo(Form("processing event %d", iEvent));
-    runLoader->GetEvent(iEvent);
-    TString baseDir = gSystem->WorkingDirectory();
-    char dirName[256];
-    snprintf(dirName, 256, "raw%d", iEvent);
-    gSystem->MakeDirectory(dirName);
-    if (!gSystem->ChangeDirectory(dirName)) {
-      AliError(Form("couldn't change to directory %s", dirName));
-      if (fStopOnError) return kFALSE; else continue;
+    if (!WriteEventRawFiles(runLoader, iEvent, detectors))
+      if (fStopOnError) return kFALSE;
+  }
+
+  delete runLoader;
+  
+  return kTRUE;
+}
+
+//_____________________________________________________________________________
+Bool_t AliSimulation::WriteEventRawFiles(AliRunLoader* runLoader, Int_t iEvent,
+                                         const char* detectors)
+{
+// convert the digits of one event to raw data DDL files in the directory
+// raw<iEvent>, in memory mode of AliFstream the DDLs are kept in memory
+
+  AliInfo(Form("processing event %d", iEvent));
+  runLoader->GetEvent(iEvent);
+  TString baseDir = gSystem->WorkingDirectory();
+  char dirName[256];
+  snprintf(dirName, 256, "raw%d", iEvent);
+  gSystem->MakeDirectory(dirName);
+  if (!gSystem->ChangeDirectory(dirName)) {
+    AliError(Form("couldn't change to directory %s", dirName));
+    return kFALSE;
+  }
+
+  ofstream runNbFile(Form("run%u",runLoader->GetHeader()->GetRun()));
+  runNbFile.close();
+
+  TString detStr = detectors;
+  if (IsSelected("HLT", detStr)) {
+    // Do nothing. "HLT" will be removed from detStr and HLT raw
+    // data files are generated in RunHLT.
+  }
+
+  TObjArray* detArray = runLoader->GetAliRun()->Detectors();
+  //
+  if (fUseDetectorsFromGRP) {
+    AliInfo("Will run only for detectors seen in the GRP");
+    DeactivateDetectorsAbsentInGRP(detArray);  
+  }
+  //
+  TObjArray modules;
+  for (Int_t iDet = 0; iDet < detArray->GetEntriesFast(); iDet++) {
+    AliModule* det = (AliModule*) detArray->At(iDet);
+    if (!det || !det->IsActive()) continue;
+    if (IsSelected(det->GetName(), detStr)) {
+      AliInfo(Form("creating raw data from digits for %s", det->GetName()));
+      modules.AddLast(det);
     }
+  }
+  RunDigits2Raw(modules);
 
-    ofstream runNbFile(Form("run%u",runLoader->GetHeader()->GetRun()));
-    runNbFile.close();
+  Bool_t result = WriteTriggerRawData();
 
-    TString detStr = detectors;
-    if (IsSelected("HLT", detStr)) {
-      // Do nothing. "HLT" will be removed from detStr and HLT raw
-      // data files are generated in RunHLT.
+  gSystem->ChangeDirectory(baseDir);
+  if ((detStr.CompareTo("ALL") != 0) && !detStr.IsNull()) {
+    AliError(Form("the following detectors were not found: %s", 
+                  detStr.Data()));
+    result = kFALSE;
+  }
+
+  return result;
+}
+
+//_____________________________________________________________________________
+void AliSimulation::RunDigits2Raw(const TObjArray& modules) const
+{
+// create the raw data of the given detectors for the current event; with
+// fNThreadsRawData != 1 the detectors declared with SetRawDataThreadSafe
+// run concurrently after the others, every one drawing the random numbers
+// from its own generator seeded from gRandom
+
+  Int_t nmod = modules.GetEntriesFast();
+  TArrayI concurrent(nmod);
+  Int_t nConcurrent = 0;
+  if (fNThreadsRawData != 1) {
+    for (Int_t im = 0; im < nmod; im++) {
+      TString detStr = fRawDataThreadSafe;
+      concurrent[im] = IsSelected(modules.UncheckedAt(im)->GetName(), detStr);
+      nConcurrent += concurrent[im];
     }
+#ifndef _OPENMP
+    AliWarning("built without OpenMP support, the raw data are created one detector after another");
+    concurrent.Reset();
+    nConcurrent = 0;
+#endif
+  }
+  for (Int_t im = 0; im < nmod; im++) {
+    if (!concurrent[im] || nConcurrent < 2) ((AliModule*)modules.UncheckedAt(im))->Digits2Raw();
+  }
+  if (nConcurrent < 2) return;
 
-    TObjArray* detArray = runLoader->GetAliRun()->Detectors();
-    //
-    if (fUseDetectorsFromGRP) {
-      AliInfo("Will run only for detectors seen in the GRP");
-      DeactivateDetectorsAbsentInGRP(detArray);  
+  TArrayI seeds(nmod);
+  for (Int_t im = 0; im < nmod; im++) seeds[im] = gRandom->Integer(kMaxInt-1)+1; // 0 would be a time based seed
+  Int_t nThreads = 1;
+#ifdef _OPENMP
+  nThreads = fNThreadsRawData>0 ? fNThreadsRawData : omp_get_max_threads();
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,6,0)
+  if (nThreads>1) ROOT::EnableThreadSafety();
+#endif
+#endif
+  TRandom* master = gRandom;
+  AliThreadRandom threadRandom(master);
+  gRandom = &threadRandom;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,1) num_threads(nThreads)
+#endif
+  for (Int_t im = 0; im < nmod; im++) {
+    if (!concurrent[im]) continue;
+    TRandom3 rnd(seeds[im]);
+    gDetectorRandom = &rnd;
+    ((AliModule*)modules.UncheckedAt(im))->Digits2Raw();
+    gDetectorRandom = 0;
+  }
+  gRandom = master;
+}
+
+//_____________________________________________________________________________
+AliRawEventWriter* AliSimulation::CreateRawEventWriter() const
+{
+// load the writer of the raw data events, AliDateEventWriter from
+// libMDC unless another plugin is defined
+
+  TPluginManager* pluginManager = gROOT->GetPluginManager();
+  TPluginHandler* pluginHandler = pluginManager->FindHandler("AliRawEventWriter", "DATE");
+  if (!pluginHandler) {
+    pluginManager->AddHandler("AliRawEventWriter", "DATE", 
+                              "AliDateEventWriter", "MDC", "AliDateEventWriter()");
+    pluginHandler = pluginManager->FindHandler("AliRawEventWriter", "DATE");
+  }
+  AliRawEventWriter* writer = NULL;
+  if (pluginHandler && (pluginHandler->LoadPlugin() == 0)) {
+    writer = (AliRawEventWriter*) pluginHandler->ExecPlugin(0);
+  }
+  if (!writer) AliError("could not load the raw event writer AliDateEventWriter");
+  return writer;
+}
+
+//_____________________________________________________________________________
+Bool_t AliSimulation::WriteRawEvents(const char* detectors, const char* fileName,
+                                     Bool_t deleteIntermediateFiles, Bool_t selrawdata)
+{
+// create the raw data event by event with the DDLs kept in memory and write
+// the events directly to the DATE file or, for the extension ".root", to the
+// root file. The events are identical to the ones of ConvertRawFilesToDate.
+// With selrawdata the events triggered by the CTP are written in addition
+// to "selected.<fileName>" with the detectors of the trigger cluster only.
+
+  AliCodeTimerAuto("",0)
+
+  AliRunLoader* runLoader = LoadRun("READ");
+  if (!runLoader) return kFALSE;
+  UInt_t run = runLoader->GetHeader()->GetRun();
+
+  TString selFileName = "selected.";
+  selFileName += fileName;
+  AliInfo(Form("writing raw data directly to %s", fileName));
+
+  AliRawEventWriter* writer = CreateRawEventWriter();
+  if (!writer || !writer->Open(fileName, run)) {
+    delete writer;
+    delete runLoader;
+    return kFALSE;
+  }
+  AliRawEventWriter* selWriter = NULL;
+
+  Bool_t result = kTRUE;
+  AliFstream::SetMemoryMode(kTRUE);
+  for (Int_t iEvent = 0; iEvent < runLoader->GetNumberOfEvents(); iEvent++) {
+    if (!WriteEventRawFiles(runLoader, iEvent, detectors)) {
+      result = kFALSE;
+      if (fStopOnError) break;
     }
-    //
-    for (Int_t iDet = 0; iDet < detArray->GetEntriesFast(); iDet++) {
-      AliModule* det = (AliModule*) detArray->At(iDet);
-      if (!det || !det->IsActive()) continue;
-      if (IsSelected(det->GetName(), detStr)) {
-	AliInfo(Form("creating raw data from digits for %s", det->GetName()));
-	det->Digits2Raw();
+
+    UInt_t detectorPattern = 0;
+    Bool_t selected = kFALSE;
+    TString detClust;
+    if (!runLoader->LoadTrigger()) {
+      AliCentralTrigger *aCTP = runLoader->GetTrigger();
+      detectorPattern = aCTP->GetClusterMask();
+      // Check if the event was triggered by CTP
+      if (selrawdata && aCTP->GetClassMask()) {
+        selected = kTRUE;
+        detClust = AliDAQ::ListOfTriggeredDetectors(detectorPattern);
+        AliInfo(Form("List of detectors to be read out: %s",detClust.Data()));
       }
     }
+    else {
+      AliWarning("No trigger can be loaded! Some fields in the event header will be empty !");
+      if (selrawdata) {
+        AliWarning("No trigger can be loaded! Writing of selected raw data is abandoned !");
+        selrawdata = kFALSE;
+      }
+    }
+    UInt_t timeStamp = runLoader->GetHeader()->GetTimeStamp();
 
-    if (!WriteTriggerRawData())
-      if (fStopOnError) return kFALSE;
+    writer->StartEvent(detectorPattern, timeStamp);
+    AddRawDataToEvent(*writer, iEvent, "ALL");
+    if (!writer->WriteEvent()) {
+      AliError(Form("writing of event %d to %s failed", iEvent, fileName));
+      result = kFALSE;
+    }
 
-    gSystem->ChangeDirectory(baseDir);
-    if ((detStr.CompareTo("ALL") != 0) && !detStr.IsNull()) {
-      AliError(Form("the following detectors were not found: %s", 
-                    detStr.Data()));
-      if (fStopOnError) return kFALSE;
+    if (selected) {
+      if (!selWriter) {
+        AliInfo(Form("writing selected by trigger cluster raw data to %s", selFileName.Data()));
+        selWriter = CreateRawEventWriter();
+        if (selWriter && !selWriter->Open(selFileName, run)) {
+          delete selWriter;
+          selWriter = NULL;
+        }
+      }
+      Bool_t written = kFALSE;
+      if (selWriter) {
+        selWriter->StartEvent(detectorPattern, timeStamp);
+        AddRawDataToEvent(*selWriter, iEvent, detClust);
+        written = selWriter->WriteEvent();
+      }
+      if (!written) {
+        AliError(Form("writing of event %d to %s failed", iEvent, selFileName.Data()));
+        result = kFALSE;
+      }
     }
+
+    AliFstream::ClearMemoryFiles();
+    if (deleteIntermediateFiles) {
+      char dir[256];
+      snprintf(dir, 256, "raw%d", iEvent);
+      AliFileUtilities::Remove_All(dir);
+    }
+    if (!result && fStopOnError) break;
+  }
+  AliFstream::SetMemoryMode(kFALSE);
+  AliFstream::ClearMemoryFiles();
+
+  if (!writer->Close()) result = kFALSE;
+  AliInfo(Form("%d events written to %s", writer->GetNEvents(), fileName));
+  delete writer;
+  if (selWriter) {
+    if (!selWriter->Close()) result = kFALSE;
+    AliInfo(Form("%d selected events written to %s", selWriter->GetNEvents(), selFileName.Data()));
+    delete selWriter;
   }
 
   delete runLoader;
-  
-  return kTRUE;
+  return result;
+}
+
+//_____________________________________________________________________________
+Int_t AliSimulation::AddRawDataToEvent(AliRawEventWriter& writer, Int_t iEvent,
+                                       const char* detectors) const
+{
+// add the non empty DDLs of the given detectors to the event, the DDLs are
+// taken from memory or from the DDL files in raw<iEvent>, the assignment
+// of the DDLs to the LDCs is the one of ConvertRawFilesToDate
+// returns the number of added DDLs
+
+  TString detStr = detectors;
+  Bool_t all = (detStr.CompareTo("ALL") == 0);
+  TArrayC buffer;
+  Int_t nDDLs = 0;
+  Float_t ldc = 0;
+
+  // loop over detectors and DDLs
+  for (Int_t iDet = 0; iDet < AliDAQ::kNDetectors; iDet++) {
+    if (!all && !IsSelected(AliDAQ::DetectorName(iDet),detStr)) continue;
+
+    for (Int_t iDDL = 0; iDDL < AliDAQ::NumberOfDdls(iDet); iDDL++) {
+
+      Int_t ddlID = AliDAQ::DdlID(iDet,iDDL);
+      Int_t ldcID = Int_t(ldc + 0.0001);
+      ldc += AliDAQ::NumberOfLdcs(iDet) / AliDAQ::NumberOfDdls(iDet);
+
+      UInt_t size = 0;
+      const char* payload = AliFstream::GetMemoryFile(AliDAQ::DdlFileName(iDet,iDDL), size);
+      if (!payload) {
+        // DDL written without AliFstream
+        char rawFileName[256];
+        snprintf(rawFileName, 256, "raw%d/%s", 
+                 iEvent, AliDAQ::DdlFileName(iDet,iDDL));
+        FILE* file = fopen(rawFileName, "rb");
+        if (!file) continue;
+        fseek(file, 0, SEEK_END);
+        size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        buffer.Set(size);
+        if (size && (fread(buffer.GetArray(), size, 1, file) != 1)) size = 0;
+        fclose(file);
+        payload = buffer.GetArray();
+      }
+      if (!size) continue;
+
+      writer.AddEquipment(ldcID, ddlID, payload, size);
+      nDDLs++;
+    }
+  }
+
+  return nDDLs;
 }
 
 //_____________________________________________________________________________
@@ -15,6 +15,8 @@
 #include <TNamed.h>
 #include <TString.h>
 #include <TObjArray.h>
+#include <TArrayI.h>
+#include <TArrayD.h>
 #include "AliQAv1.h"
 #include "AliQAManager.h"
 #include <time.h>
@@ -27,6 +29,7 @@ class AliLegoGenerator;
 class AliLego;
 class AliMagF;
 class AliHLTSimulation;
+class AliRawEventWriter;
 
 class AliSimulation: public TNamed {
 public:
@@ -60,6 +63,8 @@ public:
                    {fMakeDigits = detectors;};
   void           SetMakeDigitsFromHits(const char* detectors)
                    {fMakeDigitsFromHits = detectors;};
+  void           SetMakeFastClusters(const char* detectors)
+                   {fMakeFastClusters = detectors;};
   void           SetWriteRawData(const char* detectors, 
 				 const char* fileName = NULL,
 				 Bool_t deleteIntermediateFiles = kFALSE)
@@ -99,6 +104,7 @@ public:
   virtual Bool_t RunDigitization(const char* detectors = "ALL",
 				 const char* excludeDetectors = "");
   virtual Bool_t RunHitsDigitization(const char* detectors = "ALL");
+  virtual Bool_t RunFastClusters(const char* detectors = "ALL");
   virtual Bool_t WriteRawData(const char* detectors = "ALL",
 			      const char* fileName = NULL,
 			      Bool_t deleteIntermediateFiles = kFALSE,
@@ -151,6 +157,18 @@ public:
   Bool_t          GetUseDetectorsFromGRP()               const {return fUseDetectorsFromGRP;}
   void            SetUseDetectorsFromGRP(Bool_t v=kTRUE)       {fUseDetectorsFromGRP = v;}
   //
+  // concurrent digitization of the detectors
+  Int_t           GetNThreadsDigitization()              const {return fNThreadsDigitization;}
+  void            SetNThreadsDigitization(Int_t n)             {fNThreadsDigitization = n;}
+  void            SetDigitizationDependency(const char* detector, const char* dependsOn);
+  //
+  // raw data: DDLs kept in memory, events written directly
+  Bool_t          GetRawDataInMemory()                   const {return fRawDataInMemory;}
+  void            SetRawDataInMemory(Bool_t v=kTRUE)           {fRawDataInMemory = v;}
+  Int_t           GetNThreadsRawData()                   const {return fNThreadsRawData;}
+  void            SetNThreadsRawData(Int_t n)                  {fNThreadsRawData = n;}
+  void            SetRawDataThreadSafe(const char* detectors)  {fRawDataThreadSafe = detectors;}
+  //
 
  private:
 
@@ -164,6 +182,15 @@ public:
   AliRunLoader*  LoadRun(const char* mode = "UPDATE") const;
   Int_t          GetNSignalPerBkgrd(Int_t nEvents = 0) const;
   Bool_t         IsSelected(TString detName, TString& detectors) const;
+  Int_t          GetDigitizationStages(const TObjArray& detNames, TArrayI& stages) const;
+  void           RunDigitizersConcurrently(const TObjArray& digitizers, const TArrayI& stages,
+                                           Int_t nStages, TArrayD& times) const;
+  Bool_t         WriteEventRawFiles(AliRunLoader* runLoader, Int_t iEvent, const char* detectors);
+  void           RunDigits2Raw(const TObjArray& modules) const;
+  AliRawEventWriter* CreateRawEventWriter() const;
+  Bool_t         WriteRawEvents(const char* detectors, const char* fileName,
+                                Bool_t deleteIntermediateFiles, Bool_t selrawdata);
+  Int_t          AddRawDataToEvent(AliRawEventWriter& writer, Int_t iEvent, const char* detectors) const;
 
   static AliSimulation *fgInstance;    // Static pointer to object
 
@@ -176,6 +203,7 @@ public:
   TString        fMakeDigits;         // create digits for these detectors
   TString        fTriggerConfig;      // run trigger for these descriptors
   TString        fMakeDigitsFromHits; // create digits from hits for these detectors
+  TString        fMakeFastClusters;   // create clusters from track references for these detectors
   TString        fWriteRawData;       // write raw data for these detectors
   TString        fRawDataFileName;    // file name for the raw data file
   Bool_t         fDeleteIntermediateFiles; // delete intermediate raw data files
@@ -211,6 +239,11 @@ public:
   TString         fGRPWriteLocation;   // Location to write the GRP entry from simulation
   
   Bool_t          fUseDetectorsFromGRP; // do not simulate detectors absent in the GRP
+  Int_t           fNThreadsDigitization; // number of threads for the digitization of the detectors, 1: serial, 0: all
+  TObjArray       fDigitizationDependencies; // declared thread safe digitizers and the detectors digitized before them
+  Bool_t          fRawDataInMemory;    // keep the DDLs in memory and write the DATE/root file directly
+  Int_t           fNThreadsRawData;    // number of threads for Digits2Raw of the detectors, 1: serial, 0: all
+  TString         fRawDataThreadSafe;  // detectors with a thread safe Digits2Raw
 
   Int_t           fUseTimeStampFromCDB;// Flag to generate event time-stamps: see GenerateTimeStamp() 
   time_t          fTimeStart;          // SOR time-stamp
@@ -237,7 +270,7 @@ public:
 
   static const Char_t *fgkRunHLTAuto;         // flag for automatic HLT mode detection
   static const Char_t *fgkHLTDefConf;         // default configuration to run HLT
-  ClassDef(AliSimulation, 15)  // class for running generation, simulation and digitization
+  ClassDef(AliSimulation, 16)  // class for running generation, simulation and digitization
 };
 
 #endif
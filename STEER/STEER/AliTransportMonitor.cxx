@@ -28,9 +28,13 @@
 #include "THashList.h"
 #include "TH2F.h"
 #include "TGeoManager.h"
+#include "TGeoVolume.h"
+#include "TGeoMedium.h"
 #include "AliPDG.h"
 #include "TVirtualMC.h"
 #include <RVersion.h>
+#include <map>
+#include <vector>
 
 ClassImp(AliTransportMonitor)
 ClassImp(AliTransportMonitor::AliTransportMonitorVol)
@@ -64,14 +68,18 @@ void AliTransportMonitor::AliTransportMonitorVol::StepInfo(
                                     Int_t pdg,
                                     Double_t energy, 
                                     Double_t dt,
-                                    Double_t x, Double_t y, Double_t z)
+                                    Double_t x, Double_t y, Double_t z,
+                                    Double_t weight)
 {
-// This method is called at each N steps to store timing info.
+// This method is called at each N steps to store timing info. A sampled step
+// stands for weight steps.
   PMonData &data = GetPMonData(pdg);
+  dt *= weight;
   data.fEdt += energy*dt;
   data.fTime += dt;
+  data.fNSteps += weight;
   fTotalTime += dt;
-  fNSteps += 1.;
+  fNSteps += weight;
   if (!fTimeRZ) {
     Bool_t status = TH1::AddDirectoryStatus();
     TH1::AddDirectory(kFALSE);
@@ -140,6 +148,7 @@ void AliTransportMonitor::AliTransportMonitorVol::Merge(AliTransportMonitorVol*
   // Merging
   //
   fTotalTime = (fTotalTime + volM->GetTotalTime());
+  fNSteps += volM->GetNSteps();
   if (fTimeRZ && volM->GetHistogram()) {
     fTimeRZ->Add(volM->GetHistogram()); 
   } else if (volM->GetHistogram()) {
@@ -152,6 +161,7 @@ void AliTransportMonitor::AliTransportMonitorVol::Merge(AliTransportMonitorVol*
      PMonData &data  = GetPMonData(pdg);
      data.fEdt  += (volM->GetEmed(i) * volM->GetTotalTime());
      data.fTime += (volM->GetTime(i));
+     data.fNSteps += (volM->GetNSteps(i));
   }
 }
 
@@ -162,7 +172,9 @@ AliTransportMonitor::AliTransportMonitor()
                     :TObject(),
                      fTotalTime(0),
                      fTimer(),
-                     fVolumeMon(0)
+                     fVolumeMon(0),
+                     fSampling(1),
+                     fStepCounter(0)
 {
 // Default constructor
 }
@@ -172,7 +184,9 @@ AliTransportMonitor::AliTransportMonitor(Int_t nvolumes)
                     :TObject(),
                      fTotalTime(0),
                      fTimer(),
-                     fVolumeMon(0)
+                     fVolumeMon(0),
+                     fSampling(1),
+                     fStepCounter(0)
 {
 // Default constructor
   fVolumeMon = new TObjArray(nvolumes);
@@ -282,6 +296,107 @@ void AliTransportMonitor::Print(Option_t *volName) const
   printf("=============================================================================\n");  
 }     
 
+//______________________________________________________________________________
+namespace {
+  typedef std::pair<Double_t,Double_t> TimeSteps_t;
+
+  void PrintRanking(FILE *out, const char *title, const std::vector<TString> &names,
+                    const std::vector<TimeSteps_t> &stat, Int_t ntop, Double_t total)
+  {
+  // Print the ntop entries with the largest time
+    Int_t n = stat.size();
+    if (!n) return;
+    std::vector<Double_t> time(n);
+    std::vector<Int_t> isort(n);
+    for (Int_t i=0; i<n; i++) time[i] = stat[i].first;
+    TMath::Sort(n, &time[0], &isort[0], kTRUE);
+    fprintf(out, "-----------------------------------------------------------------------------\n");
+    fprintf(out, "%-32s %12s %7s %14s %12s\n", title, "time [s]", "time %", "steps", "us/step");
+    for (Int_t i=0; i<n && i<ntop; i++) {
+      const TimeSteps_t &st = stat[isort[i]];
+      if (st.first <= 0 && st.second <= 0) break;
+      fprintf(out, "%-32s %12.4g %7.2f %14.6g %12.4g\n", names[isort[i]].Data(), st.first,
+              (total>0) ? 100.*st.first/total : 0., st.second,
+              (st.second>0) ? 1.e6*st.first/st.second : 0.);
+    }
+  }
+}
+
+//______________________________________________________________________________
+void AliTransportMonitor::Report(Int_t ntop, const char *fname) const
+{
+// Rank the volumes, the media and the particle types by transport time and
+// print the ntop first ones with their number of steps, to stdout or to the
+// file fname. With sampling the times and steps are estimates.
+  if (!fVolumeMon || !fVolumeMon->GetEntriesFast()) {
+     Info("Report", "Transport monitor is empty !");
+     return;
+  }
+  FILE *out = stdout;
+  if (fname && strlen(fname)) {
+    out = fopen(fname, "w");
+    if (!out) {
+      Error("Report", "Cannot open %s", fname);
+      return;
+    }
+  }
+  std::vector<TString> volNames, medNames, partNames;
+  std::vector<TimeSteps_t> volStat, medStat, partStat;
+  std::map<TString, Int_t> media;
+  std::map<Int_t, Int_t> particles;
+  Double_t totalTime = 0., totalSteps = 0.;
+  TIter next(fVolumeMon);
+  AliTransportMonitorVol *volMon;
+  while ((volMon=(AliTransportMonitorVol*)next())) {
+    if (!volMon->GetNtypes()) continue;
+    TimeSteps_t st(volMon->GetTotalTime(), volMon->GetNSteps());
+    totalTime += st.first;
+    totalSteps += st.second;
+    volNames.push_back(volMon->GetName());
+    volStat.push_back(st);
+    // medium of the volume, needs the geometry
+    TString medName = "unknown";
+    TGeoVolume *vol = gGeoManager ? gGeoManager->GetVolume(volMon->GetName()) : 0;
+    if (vol && vol->GetMedium()) medName = vol->GetMedium()->GetName();
+    std::map<TString, Int_t>::iterator itm = media.find(medName);
+    if (itm == media.end()) {
+      itm = media.insert(std::make_pair(medName, (Int_t)medNames.size())).first;
+      medNames.push_back(medName);
+      medStat.push_back(TimeSteps_t(0.,0.));
+    }
+    medStat[itm->second].first += st.first;
+    medStat[itm->second].second += st.second;
+    for (Int_t i=0; i<volMon->GetNtypes(); i++) {
+      Int_t pdg = volMon->GetPDG(i);
+      std::map<Int_t, Int_t>::iterator itp = particles.find(pdg);
+      if (itp == particles.end()) {
+        itp = particles.insert(std::make_pair(pdg, (Int_t)partNames.size())).first;
+        partNames.push_back("");
+        partStat.push_back(TimeSteps_t(0.,0.));
+      }
+      partStat[itp->second].first += volMon->GetTime(i);
+      partStat[itp->second].second += volMon->GetNSteps(i);
+    }
+  }
+  TDatabasePDG *pdgDB = TDatabasePDG::Instance();    
+  if (!pdgDB->ParticleList()) AliPDG::AddParticlesToPdgDataBase();
+  for (std::map<Int_t, Int_t>::iterator itp=particles.begin(); itp!=particles.end(); ++itp) {
+    TParticlePDG *pdgP = pdgDB->GetParticle(itp->first);
+    if (pdgP) partNames[itp->second] = pdgP->GetName();
+    else if (itp->first == 1111111111) partNames[itp->second] = "heavy fragment";
+    else partNames[itp->second] = Form("pdg %d", itp->first);
+  }
+
+  fprintf(out, "=============================================================================\n");
+  fprintf(out, "Transport time: %g [s] in %g steps, %s\n", totalTime, totalSteps,
+          (fSampling>1) ? Form("sampled 1 in %d steps", fSampling) : "all steps");
+  PrintRanking(out, "Volume", volNames, volStat, ntop, totalTime);
+  PrintRanking(out, "Medium", medNames, medStat, ntop, totalTime);
+  PrintRanking(out, "Particle", partNames, partStat, ntop, totalTime);
+  fprintf(out, "=============================================================================\n");
+  if (out != stdout) fclose(out);
+}
+
 //______________________________________________________________________________
 void AliTransportMonitor::DummyStep()
 {
@@ -296,12 +411,13 @@ void AliTransportMonitor::StepInfo( Int_t volId,
                                     Double_t energy, 
                                     Double_t x, Double_t y, Double_t z)
 {
-// This method is called at each N steps to store timing info.
+// This method is called at each N steps to store timing info. In sampling
+// mode the step is accounted for fSampling steps.
   fTimer.Stop();
   Double_t dt = fTimer.RealTime();
-  fTotalTime += dt;
+  fTotalTime += dt*fSampling;
   AliTransportMonitorVol *volMon = (AliTransportMonitorVol*)fVolumeMon->At(volId);
-  volMon->StepInfo(pdg,energy,dt,x,y,z);
+  volMon->StepInfo(pdg,energy,dt,x,y,z,fSampling);
   fTimer.Start(kTRUE);
 }
 
@@ -36,9 +36,10 @@ public:
       Int_t         fPDG;        // particle PDG
       Double_t      fEdt;        // Energy * dt integral
       Double_t      fTime;       // Total transport time for the particle in this volume
-      AliPMonData() : fPDG(0), fEdt(0), fTime(0) {}
+      Double_t      fNSteps;     // Number of steps of the particle in this volume
+      AliPMonData() : fPDG(0), fEdt(0), fTime(0), fNSteps(0) {}
       virtual ~AliPMonData() {}
-      ClassDef(AliPMonData, 1)     // Basic monitoring info structure
+      ClassDef(AliPMonData, 2)     // Basic monitoring info structure
     };   
     //___________________________________________________   
     AliTransportMonitorVol();
@@ -48,9 +49,11 @@ public:
     void            StepInfo(Int_t    pdg,
                              Double_t energy, 
                              Double_t dt,
-                             Double_t x, Double_t y, Double_t z);
+                             Double_t x, Double_t y, Double_t z,
+                             Double_t weight=1.);
     Double_t        GetTotalTime() const       {return fTotalTime;}
     Double_t        GetTime(Int_t itype) const {return fPData[itype].fTime;}
+    Double_t        GetNSteps(Int_t itype) const {return fPData[itype].fNSteps;}
     Double_t        GetEmed(Int_t itype) const {return (fTotalTime>0)?fPData[itype].fEdt/fTotalTime : 0.;}
     Int_t           GetPDG(Int_t itype)  const {return fPData[itype].fPDG;}
     Double_t        GetNSteps() const {return fNSteps;}
@@ -75,7 +78,7 @@ public:
   };
   //________________________________________________________________
 private:
-  AliTransportMonitor(const AliTransportMonitor&other) : TObject(other), fTotalTime(0), fTimer(), fVolumeMon(0) {}
+  AliTransportMonitor(const AliTransportMonitor&other) : TObject(other), fTotalTime(0), fTimer(), fVolumeMon(0), fSampling(1), fStepCounter(0) {}
   AliTransportMonitor &operator=(const AliTransportMonitor&) {return *this;}
 public:
   AliTransportMonitor();
@@ -87,7 +90,11 @@ public:
                              Double_t energy, 
                              Double_t x, Double_t y, Double_t z);
   void              Print(Option_t *volName="") const;
+  void              Report(Int_t ntop=20, const char *fname=0) const;
   void              DummyStep();
+  Bool_t            Sample();
+  void              SetSampling(Int_t nsteps) {fSampling = (nsteps>1) ? nsteps : 1; fStepCounter = 0;}
+  Int_t             GetSampling() const {return fSampling;}
   void              Start();
   void              Stop();
   void              Export(const char *fname);
@@ -98,9 +105,26 @@ private:
   Double_t          fTotalTime;  // Total simulation time
   TStopwatch        fTimer;      //! Global timer
   TObjArray        *fVolumeMon;  // Array of monitoring objects per volume
+  Int_t             fSampling;   // One step in fSampling is recorded
+  Int_t             fStepCounter;//! Steps since the last recorded one
   
-ClassDef(AliTransportMonitor,1)  // Class to monitor timing per volume 
+ClassDef(AliTransportMonitor,2)  // Class to monitor timing per volume 
 };
+
+//______________________________________________________________________________
+inline Bool_t AliTransportMonitor::Sample()
+{
+// Check if the current step has to be recorded. In sampling mode the timer
+// is restarted at the step preceding the recorded one, the other steps
+// cost only the counter
+  if (fSampling <= 1) return kTRUE;
+  if (++fStepCounter < fSampling) {
+    if (fStepCounter == fSampling-1) DummyStep();
+    return kFALSE;
+  }
+  fStepCounter = 0;
+  return kTRUE;
+}
 //______________________________________________________________________________
 
 
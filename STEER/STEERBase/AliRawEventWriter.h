@@ -0,0 +1,37 @@
+#ifndef ALIRAWEVENTWRITER_H
+#define ALIRAWEVENTWRITER_H
+/* Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved. *
+ * See cxx source for full Copyright notice                               */
+
+//-------------------------------------------------------------------------
+// Interface of the writers of simulated raw data events. The DDL payloads
+// of one event are added per equipment and the event is written to the
+// DATE or root file. The implementation lives in the raw data libraries
+// and is loaded by AliSimulation with the plugin manager, STEER does not
+// depend on them.
+//-------------------------------------------------------------------------
+
+#include <TObject.h>
+
+class AliRawEventWriter : public TObject {
+public:
+  AliRawEventWriter() : TObject() {}
+  virtual ~AliRawEventWriter() {}
+
+  // open the output, files with the extension ".root" are root files
+  virtual Bool_t Open(const char *fileName, UInt_t runNumber) = 0;
+  virtual void   StartEvent(UInt_t detectorPattern, UInt_t timestamp) = 0;
+  virtual void   AddEquipment(Int_t ldcId, Int_t equipmentId, const char *payload, UInt_t size) = 0;
+  // build the event out of the equipments and write it
+  virtual Bool_t WriteEvent() = 0;
+  virtual Bool_t Close() = 0;
+  virtual Int_t  GetNEvents() const = 0;
+
+private:
+  AliRawEventWriter(const AliRawEventWriter &source);
+  AliRawEventWriter &operator =(const AliRawEventWriter &source);
+
+  ClassDef(AliRawEventWriter,0)
+};
+
+#endif
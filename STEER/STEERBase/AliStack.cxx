@@ -60,7 +60,10 @@ AliStack::AliStack():
   fHgwmk(0),
   fLoadPoint(0),
   fTrackLabelMap(0),
-  fMCEmbeddingFlag(kFALSE)
+  fMCEmbeddingFlag(kFALSE),
+  fPendingTracks(0),
+  fNPending(0),
+  fDecayFromPrimary(0)
 {
   //
   // Default constructor
@@ -83,7 +86,10 @@ AliStack::AliStack(Int_t size, const char* /*evfoldname*/):
   fHgwmk(0),
   fLoadPoint(0),
   fTrackLabelMap(0),
-  fMCEmbeddingFlag(kFALSE)
+  fMCEmbeddingFlag(kFALSE),
+  fPendingTracks(0),
+  fNPending(0),
+  fDecayFromPrimary(0)
 {
   //
   //  Constructor
@@ -107,7 +113,10 @@ AliStack::AliStack(const AliStack& st):
     fHgwmk(0),
     fLoadPoint(0),
     fTrackLabelMap(0),
-    fMCEmbeddingFlag(kFALSE)
+    fMCEmbeddingFlag(kFALSE),
+    fPendingTracks(0),
+    fNPending(0),
+    fDecayFromPrimary(0)
 {
     // Copy constructor
 }
@@ -164,7 +173,7 @@ void AliStack::PushTrack(Int_t done, Int_t parent, Int_t pdg, const Float_t *pmo
   //
     TParticlePDG* pmc =  TDatabasePDG::Instance()->GetParticle(pdg);
     if (pmc) {
-	Float_t mass = TDatabasePDG::Instance()->GetParticle(pdg)->Mass();
+	Float_t mass = pmc->Mass();
 	Float_t e=TMath::Sqrt(mass*mass+pmom[0]*pmom[0]+
 			      pmom[1]*pmom[1]+pmom[2]*pmom[2]);
 	
@@ -229,6 +238,12 @@ void AliStack::PushTrack(Int_t done, Int_t parent, Int_t pdg,
   } else {
       particle->SetBit(kTransportBit);
       fNtransported++;
+      //
+      // Remember it for GetNextParticle, the tracks are loaded
+      // in increasing order so the last one is on top
+      if (fNPending >= fPendingTracks.GetSize()) 
+	  fPendingTracks.Set(TMath::Max(2*fNPending, 1000));
+      fPendingTracks[fNPending++] = fNtrack;
   }
   
   
@@ -315,16 +330,28 @@ Bool_t AliStack::PurifyKine()
   // If no tracks generated return now
   if(fHgwmk+1 == fNtrack) return kFALSE;
 
+  // Decay cascade flags of the secondaries, filled in the first pass
+  // in increasing order as the mother is always before its daughters
+  if (fDecayFromPrimary.GetSize() < fNtrack-fHgwmk-1) fDecayFromPrimary.Set(fNtrack-fHgwmk-1);
+
   // First pass, invalid Daughter information
   for(i=0; i<fNtrack; i++) {
       // Preset map, to be removed later
       if(i<=fHgwmk) fTrackLabelMap[i]=i ; 
       else {
 	  fTrackLabelMap[i] = -99;
+	  fDecayFromPrimary[i-fHgwmk-1] = 0;
 	  if((part=GetParticleMapEntry(i))) {
 //
 //        Check of this track should be kept for physics reasons 
 	      if (KeepPhysics(part)) KeepTrack(i);
+//
+//        Decay product of a primary or of a decay cascade from a primary
+	      if (part->GetUniqueID() == kPDecay) {
+		  parent = part->GetFirstMother();
+		  if (parent <= fHgwmk || fDecayFromPrimary[parent-fHgwmk-1]) 
+		      fDecayFromPrimary[i-fHgwmk-1] = 1;
+	      }
 //
 	      part->ResetBit(kDaughtersBit);
 	      part->SetFirstDaughter(-1);
@@ -390,6 +417,7 @@ Bool_t AliStack::PurifyKine()
   for(i=fLoadPoint; i<fLoadPoint+toshrink; ++i) fParticles.RemoveAt(i);
   fNtrack=nkeep;
   fHgwmk=nkeep-1;
+  ResetPendingTracks();
   return kTRUE;
 }
 
@@ -490,6 +518,7 @@ Bool_t AliStack::ReorderKine()
 	      fTrackLabelMap[i] = map1[i - fHgwmk -1];
 	  }
       }
+      ResetPendingTracks();
   } // new particles poduced
   
   return kTRUE;
@@ -529,14 +558,9 @@ Bool_t AliStack::KeepPhysics(const TParticle* part)
     // Decay(cascade) from primaries
     // 
     if ((part->GetUniqueID() == kPDecay) && (parent >= 0)) {
-      // Particles from decay
-      TParticle* father = GetParticleMapEntry(parent);
-      Int_t imo = parent;
-      while((imo > fHgwmk) && (father->GetUniqueID() == kPDecay)) {
-	imo =  father->GetFirstMother();
-	father = GetParticleMapEntry(imo);
-      }
-      if ((imo <= fHgwmk)) keep = kTRUE;
+      // Particles from decay, the cascade up to the primaries has
+      // been followed by PurifyKine for the mothers already
+      if ((parent <= fHgwmk) || fDecayFromPrimary[parent-fHgwmk-1]) keep = kTRUE;
     }
     return keep;
 }
@@ -660,6 +684,7 @@ void  AliStack::ResetArrays(Int_t size)
   fParticles.Clear();
   fParticleMap.Clear();
   if (size>0) fParticleMap.Expand(size);
+  fNPending = 0;
 }
 
 //_____________________________________________________________________________
@@ -896,15 +921,19 @@ TParticle* AliStack::GetNextParticle()
   
   TParticle* particle = 0;
   
-  // search secondaries
-  //for(Int_t i=fNtrack-1; i>=0; i--) {
-  for(Int_t i=fNtrack-1; i>fHgwmk; i--) {
-      particle = GetParticleMapEntry(i);
+  // search secondaries, the last loaded one not yet done is on top
+  // of the pending tracks. Tracks done or below the high water mark
+  // meanwhile are dropped
+  while (fNPending > 0) {
+      Int_t i = fPendingTracks[fNPending-1];
+      particle = (i > fHgwmk && i < fNtrack) ? GetParticleMapEntry(i) : 0;
       if ((particle) && (!particle->TestBit(kDoneBit))) {
 	  fCurrent=i;    
 	  return particle;
       }   
+      fNPending--;
   }    
+  particle = 0;
 
   // take next primary if all secondaries were done
   while (fCurrentPrimary>=0) {
@@ -921,6 +950,26 @@ TParticle* AliStack::GetNextParticle()
   
   return particle;  
 }
+
+//_____________________________________________________________________________
+void AliStack::ResetPendingTracks()
+{
+  //
+  // Rebuild the secondaries to be transported after
+  // the stack has been renumbered
+  //
+  
+  fNPending = 0;
+  for(Int_t i=fHgwmk+1; i<fNtrack; i++) {
+      TParticle* particle = GetParticleMapEntry(i);
+      if ((particle) && (!particle->TestBit(kDoneBit))) {
+	  if (fNPending >= fPendingTracks.GetSize()) 
+	      fPendingTracks.Set(TMath::Max(2*fNPending, 1000));
+	  fPendingTracks[fNPending++] = i;
+      }
+  }
+}
+
 //__________________________________________________________________________________________
 
 void AliStack::ConnectTree(TTree* tree)
@@ -958,7 +1007,9 @@ void AliStack::ConnectTree(TTree* tree)
   TBranch *branch=fTreeK->GetBranch("Particles");
   if(branch == 0x0)
    {
-    branch = fTreeK->Branch("Particles", &fParticleBuffer, 4000);
+    // Large baskets: the particles are filled in bulk after each primary,
+    // fewer baskets compress better and are written with fewer calls
+    branch = fTreeK->Branch("Particles", &fParticleBuffer, 32000);
     AliDebug(2, "Creating Branch in Tree");
    }  
   else
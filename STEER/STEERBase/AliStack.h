@@ -18,6 +18,7 @@ class TString;
 class TTree;
 #include <TClonesArray.h>
 #include <TArrayI.h>
+#include <TArrayC.h>
 #include <TVirtualMCStack.h>
 
 class AliHeader;
@@ -98,6 +99,7 @@ class AliStack : public TVirtualMCStack
     void  ResetArrays(Int_t size);
     TParticle* GetParticleMapEntry(Int_t id) const;
     TParticle* GetNextParticle();
+    void  ResetPendingTracks();
     Bool_t KeepPhysics(const TParticle* part);
     Bool_t IsStable(Int_t pdg) const;
   private:
@@ -119,6 +121,9 @@ class AliStack : public TVirtualMCStack
     Int_t          fLoadPoint;         //! Next free position in the particle buffer
     TArrayI        fTrackLabelMap;     //! Map of track labels
     Bool_t         fMCEmbeddingFlag;   //! Flag that this is a top stack of embedded MC
+    TArrayI        fPendingTracks;     //! Secondaries to be transported in order of loading
+    Int_t          fNPending;          //! Number of entries in fPendingTracks
+    TArrayC        fDecayFromPrimary;  //! Secondaries from a decay cascade of a primary (PurifyKine)
 
     static TParticle* fgDummyParticle;     // dummy particle returned in Stack::Particle call in embedding mode
     static const Char_t *fgkEmbedPathsKey;       // keyword for embedding paths
@@ -129,7 +134,7 @@ class AliStack : public TVirtualMCStack
 // inline
 
 inline void  AliStack::SetNtrack(Int_t ntrack)
-{ fNtrack = ntrack; }
+{ fNtrack = ntrack; ResetPendingTracks(); }
 
 inline Int_t AliStack::GetNtrack() const
 { return fNtrack; }
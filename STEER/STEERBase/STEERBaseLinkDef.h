@@ -97,6 +97,7 @@
 
 #pragma link C++ class  AliExternalTrackParam+;
 #pragma link C++ class AliQA+;
+#pragma link C++ class AliRawEventWriter+;
 
 #pragma link C++ class AliTRDPIDReference+;
 #pragma link C++ class AliTRDPIDParams+;
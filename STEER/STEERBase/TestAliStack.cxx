@@ -0,0 +1,170 @@
+#include "AliStack.h"
+#include <TMCProcess.h>
+#include <TMath.h>
+#include <TParticle.h>
+#include <TRandom3.h>
+#include <TTree.h>
+#include <cstdio>
+#include <vector>
+
+#ifdef NDEBUG
+#undef NDEBUG
+#endif
+#include <cassert>
+
+// Checks of the AliStack transport order and of PurifyKine against the
+// former implementations, on generated events:
+// - the next track of PopNextTrack (LIFO of pending tracks) against the
+//   former scan of all secondaries from the top of the stack
+// - the particles kept by PurifyKine (decay cascade flags of KeepPhysics)
+//   against the former walk up the decay chain of every particle
+
+Int_t OldNextTrack(AliStack &stack, Int_t hgwmk)
+{
+  // next track of the former GetNextParticle: the last loaded secondary
+  // not done, otherwise the last primary not done
+  for (Int_t i=stack.GetNtrack()-1; i>hgwmk; i--) {
+    TParticle *particle = stack.Particle(i);
+    if (particle && !particle->TestBit(kDoneBit)) return i;
+  }
+  for (Int_t i=stack.GetNprimary()-1; i>=0; i--) {
+    TParticle *particle = stack.Particle(i);
+    if (particle && !particle->TestBit(kDoneBit)) return i;
+  }
+  return -1;
+}
+
+Bool_t OldKeepPhysics(AliStack &stack, Int_t hgwmk, const TParticle *part)
+{
+  // former AliStack::KeepPhysics, the decay cascade is followed up to the
+  // primaries for every particle
+  Bool_t keep = kFALSE;
+  Int_t parent = part->GetFirstMother();
+  if (parent >= 0 && parent <= hgwmk) {
+    TParticle *father = stack.Particle(parent);
+    Int_t kf = TMath::Abs(father->GetPdgCode());
+    Int_t kfl = kf;
+    if (kfl > 10) kfl/=100;
+    if (kfl > 10) kfl/=10;
+    if (kfl > 10) kfl/=10;
+    if (kfl >= 4) keep = kTRUE;
+    if (part->GetUniqueID() == kPPair) keep = kTRUE;
+  }
+  if ((part->GetUniqueID() == kPDecay) && (parent >= 0)) {
+    TParticle *father = stack.Particle(parent);
+    Int_t imo = parent;
+    while ((imo > hgwmk) && (father->GetUniqueID() == kPDecay)) {
+      imo = father->GetFirstMother();
+      father = stack.Particle(imo);
+    }
+    if (imo <= hgwmk) keep = kTRUE;
+  }
+  return keep;
+}
+
+Int_t CheckPurifyKine(AliStack &stack, Int_t hgwmk)
+{
+  // purify the stack and compare the kept particles with the former
+  // selection, returns the number of differences
+  const Int_t ntrack = stack.GetNtrack();
+  if (ntrack == hgwmk+1) return 0;
+  std::vector<Bool_t> keep(ntrack, kFALSE);
+  Int_t nkeep = 0;
+  for (Int_t i=hgwmk+1; i<ntrack; i++) {
+    TParticle *part = stack.Particle(i);
+    keep[i] = part->TestBit(kKeepBit) || OldKeepPhysics(stack, hgwmk, part);
+    if (keep[i]) nkeep++;
+  }
+  Bool_t purified = stack.PurifyKine();
+  assert(purified);
+  Int_t ndiff = 0;
+  for (Int_t i=hgwmk+1; i<ntrack; i++) {
+    if ((stack.TrackLabel(i) >= 0) != keep[i]) {
+      if (ndiff < 10) printf("PurifyKine: track %d %s, former selection %s\n", i,
+                             stack.TrackLabel(i) >= 0 ? "kept" : "dropped", keep[i] ? "kept" : "dropped");
+      ndiff++;
+    }
+  }
+  if (stack.GetNtrack()-hgwmk-1 != nkeep) {
+    printf("PurifyKine: %d tracks kept, former selection %d\n", stack.GetNtrack()-hgwmk-1, nkeep);
+    ndiff++;
+  }
+  return ndiff;
+}
+
+void PushSecondaries(AliStack &stack, TRandom3 &random, Int_t parent, const TParticle *mother)
+{
+  // decay, hadronic or electromagnetic secondaries, the energy drops with
+  // every generation
+  const Int_t kCodes[] = {211, -211, 111, 22, 11, -11, 321, 2212, 2112, 13};
+  const Int_t kNCodes = sizeof(kCodes)/sizeof(kCodes[0]);
+  if (mother->Energy() < 0.02) return;
+  Int_t nsecondaries = random.Integer(4);
+  for (Int_t i=0; i<nsecondaries; i++) {
+    Int_t pdg = kCodes[random.Integer(kNCodes)];
+    TMCProcess mech = kPDecay;
+    Double_t r = random.Rndm();
+    if (mother->GetPdgCode() == 22) mech = r < 0.5 ? kPPair : kPCompton;
+    else if (r > 0.5) mech = r < 0.8 ? kPHadronic : kPDeltaRay;
+    Double_t e = mother->Energy()*random.Uniform(0.1, 0.6);
+    Double_t px, py, pz;
+    random.Sphere(px, py, pz, e);
+    Int_t ntr;
+    stack.PushTrack(random.Rndm() < 0.8, parent, pdg, px, py, pz, e,
+                    mother->Vx(), mother->Vy(), mother->Vz(), 0., 0., 0., 0., mech, ntr, 1., 0);
+  }
+}
+
+void testEvent(UInt_t seed) {
+  // transport of a generated event with checks of the track order and of
+  // the purification after every primary
+  TRandom3 random(seed);
+  AliStack stack(1000);
+  TTree treeK("TreeK", "kinematics");
+  treeK.SetDirectory(0);
+  stack.ConnectTree(&treeK);
+
+  // light and heavy flavour primaries, some of them not transported
+  const Int_t kCodes[] = {211, -211, 321, 22, 2212, 421, 411, -4122, 521};
+  const Int_t kNCodes = sizeof(kCodes)/sizeof(kCodes[0]);
+  for (Int_t i=0; i<50; i++) {
+    Double_t e = random.Uniform(0.5, 20.);
+    Double_t px, py, pz;
+    random.Sphere(px, py, pz, e);
+    Int_t ntr;
+    stack.PushTrack(random.Rndm() < 0.9, -1, kCodes[random.Integer(kNCodes)], px, py, pz, e,
+                    0., 0., 0., 0., 0., 0., 0., kPPrimary, ntr, 1., 0);
+  }
+  stack.SetHighWaterMark(0);
+  Int_t hgwmk = stack.GetNtrack()-1;
+
+  Int_t ntransported = 0, norder = 0, npurify = 0;
+  while (1) {
+    Int_t expected = OldNextTrack(stack, hgwmk);
+    if (expected < stack.GetNprimary()) {
+      // the secondaries of the last primary are done, or the event
+      npurify += CheckPurifyKine(stack, hgwmk);
+      hgwmk = stack.GetNtrack()-1;
+    }
+    Int_t itrack;
+    TParticle *particle = stack.PopNextTrack(itrack);
+    if (itrack != expected) {
+      if (norder < 10) printf("PopNextTrack: track %d, former order %d\n", itrack, expected);
+      norder++;
+    }
+    if (!particle) break;
+    ntransported++;
+    // tracks with hits
+    if (random.Rndm() < 0.05) stack.FlagTrack(itrack);
+    PushSecondaries(stack, random, itrack, particle);
+  }
+  printf("seed %u: %d tracks transported, %d kept, %d differences in the order, %d in PurifyKine\n",
+         seed, ntransported, stack.GetNtrack(), norder, npurify);
+  assert(norder == 0);
+  assert(npurify == 0);
+}
+
+int main() {
+  for (UInt_t seed=1; seed<=5; seed++) testEvent(seed);
+  return 0;
+}
@@ -248,6 +248,44 @@ void AliDigits::ExpandBuffer()
   fBufType = 0;
 }
 
+Int_t AliDigits::AddTo(Float_t *signal, UChar_t *mark, Int_t markThreshold, UChar_t markValue)
+{
+  /// add the digits to signal (fNrows*fNcols, column wise as the expanded
+  /// buffer) without expanding a compressed buffer; digits above
+  /// markThreshold are flagged with markValue in mark.
+  /// signal and mark can be NULL, returns the number of non zero digits
+  ///
+  /// used for merging of segments with few non zero digits
+
+  Int_t ndigits=0;
+  if (fBufType==0) {
+    Int_t n=fNrows*fNcols;
+    for (Int_t i=0;i<n;i++){
+      Short_t value=fElements->At(i);
+      if (value==0) continue;
+      if (signal) signal[i]+=value;
+      if (mark && value>markThreshold) mark[i]=markValue;
+      ndigits++;
+    }
+  }
+  if (fBufType==1) {
+    Int_t pos=0;
+    for (Int_t i=0;i<fNelems;i++){
+      Short_t value=fElements->At(i);
+      //oposite signa means how many unwrited (under threshold) values
+      if (value<0) {
+        pos-=value;
+        continue;
+      }
+      if (signal) signal[pos]+=value;
+      if (mark && value>markThreshold) mark[pos]=markValue;
+      pos++;
+      ndigits++;
+    }
+  }
+  return ndigits;
+}
+
 void AliDigits::CompresBuffer(Int_t bufferType,Int_t threshold)
 {
   /// compres buffer according buffertype algorithm
@@ -31,6 +31,7 @@ public:
   virtual Short_t GetDigit(Int_t row, Int_t column);
   virtual void ExpandBuffer();  //expand buffer to twodimensional array
   virtual void CompresBuffer(Int_t bufferType,Int_t threshold); //compres buffer according buffertype algorithm   
+  Int_t AddTo(Float_t *signal, UChar_t *mark=0, Int_t markThreshold=0, UChar_t markValue=1); //add digits to expanded array without expansion
   virtual Bool_t First(); //adjust  first valid current digit
   virtual Bool_t Next();  //addjust next valid current digit
   void SetThreshold(Int_t th) {fThreshold = th;} //set threshold
@@ -53,15 +53,16 @@ AliSimDigits::AliSimDigits()
 }
 //
 AliSimDigits::AliSimDigits(const AliSimDigits &param)
-             :AliDigits(),
+             :AliDigits(param),
 	      fTracks(0),
 	      fTrIndex(0),
-	      fNlevel(0),
-	      fTrBufType(0) 
+	      fNlevel(param.fNlevel),
+	      fTrBufType(param.fTrBufType) 
 {
-  /// dummy
+  /// copy constructor
 
-  fTrIndex = param.fTrIndex;
+  fTracks = param.fTracks ? new TArrayI(*(param.fTracks)) : new TArrayI;
+  fTrIndex = param.fTrIndex ? new TArrayI(*(param.fTrIndex)) : new TArrayI;
 }
 //
 AliSimDigits::~AliSimDigits()
@@ -77,10 +78,16 @@ AliSimDigits::~AliSimDigits()
 }
 AliSimDigits & AliSimDigits::operator =(const AliSimDigits & param)
 {
-  /// assignment operator - dummy
+  /// assignment operator
 
   if(this!=&param){
-    fTrIndex=param.fTrIndex;
+    AliDigits::operator=(param);
+    delete fTracks;
+    delete fTrIndex;
+    fTracks = param.fTracks ? new TArrayI(*(param.fTracks)) : new TArrayI;
+    fTrIndex = param.fTrIndex ? new TArrayI(*(param.fTrIndex)) : new TArrayI;
+    fNlevel = param.fNlevel;
+    fTrBufType = param.fTrBufType;
   }
   return (*this);
 }
@@ -113,6 +120,112 @@ void  AliSimDigits::AllocateTrack(Int_t length)
   fTrBufType =0;
 }
 
+Int_t AliSimDigits::MergeTo(Float_t *signal, Int_t *tracks, Int_t nLevels, UChar_t *nTracks,
+                            UChar_t *mark, Int_t threshold, Int_t trackOffset)
+{
+  /// add the digits to signal and the track IDs of the digits above
+  /// threshold, shifted by trackOffset, to tracks without expanding the
+  /// compressed buffers. signal (fNrows*fNcols) and tracks (nLevels times
+  /// fNrows*fNcols) are column wise as the expanded buffers, nTracks
+  /// counts the track IDs of each digit. mark is a work array of zeros,
+  /// it is zero again on return.
+  /// Returns the number of non zero digits
+
+  Int_t ndigits = AddTo(signal,mark,threshold,1);
+  if (ndigits==0) return 0;
+  Int_t all = fNrows*fNcols;
+  if (fTrBufType!=1) ExpandTrackBuffer();
+  if (fTrBufType==0) {
+    for (Int_t level=0;level<fNlevel && level<nLevels;level++) {
+      const Int_t *ids = fTracks->GetArray()+level*all;
+      for (Int_t i=0;i<all;i++) {
+        if (!mark[i] || ids[i]<=1 || nTracks[i]>=nLevels) continue;
+        tracks[nTracks[i]*all+i] = ids[i]+trackOffset;
+        nTracks[i]++;
+      }
+    }
+  }
+  else if (fTrBufType==1) {
+    // walk the buffer as ExpandTrackBuffer1, the IDs of a level are
+    // stored as (-number of digits without ID) or (number of digits, ID)
+    Int_t level = 0;
+    Int_t col=0;
+    Int_t row = 0;
+    Int_t n=fTracks->fN;
+    for (Int_t i=0;i<n && level<nLevels;i++){
+      Int_t num = fTracks->At(i);
+      if (num<0) row-=num;
+      else {
+        num %= 10000000; //PH: take into account the case of underlying events
+        i++;
+        Int_t id = fTracks->At(i);
+        for (Int_t j = 0; j<num; j++,row++) {
+          Int_t pos = col*fNrows+row;
+          if (pos>=all || !mark[pos] || id<=1 || nTracks[pos]>=nLevels) continue;
+          tracks[nTracks[pos]*all+pos] = id+trackOffset;
+          nTracks[pos]++;
+        }
+      }
+      if (row>=fNrows) {
+        row=0;
+        col++;
+      }
+      if (col>=fNcols) {
+        col=0;
+        level++;
+      }
+    }
+  }
+  AddTo(0,mark,threshold,0);
+  return ndigits;
+}
+
+void AliSimDigits::GetTrackIDs(Int_t column, Int_t level, Int_t n, const Short_t *rows, Int_t *ids)
+{
+  /// fill ids with the stored track IDs (track label+2, 0 for no track) of
+  /// the n rows of the given column, the rows have to be sorted.
+  /// The compressed buffer of type 1 is walked once, no expansion needed
+
+  if (level<0 || level>=fNlevel || column<0 || column>=fNcols) {
+    for (Int_t k=0;k<n;k++) ids[k]=0;
+    return;
+  }
+  if (fTrBufType==0) {
+    for (Int_t k=0;k<n;k++) ids[k]=GetTrackIDFast(rows[k],column,level);
+    return;
+  }
+  Int_t k=0;
+  if (fTrBufType==1) {
+    // (-number of digits without ID) or (number of digits, ID) as in GetTrackID1
+    Int_t i = level*fNcols+column;
+    Int_t n1 = fTrIndex->At(i);
+    Int_t n2 = ((i+1)>=fTrIndex->fN) ? fTracks->fN : fTrIndex->At(i+1);
+    Int_t rowold=0, rownew=0;
+    for (i=n1; i<n2 && k<n; i++) {
+      Int_t num = fTracks->At(i);
+      Int_t id = 0;
+      if (num<0) {
+        rownew-=num;
+        rowold=rownew;
+        i++;
+        if (i<n2) {
+          rownew+=fTracks->At(i)%10000000;
+          i++;
+          id = fTracks->At(i);
+        }
+      }
+      else {
+        rowold=rownew;
+        rownew+=num%10000000;
+        i++;
+        id = fTracks->At(i);
+      }
+      for (;k<n && rows[k]<rownew;k++) ids[k] = (rows[k]>=rowold) ? id : 0;
+    }
+  }
+  for (;k<n;k++) ids[k]=0;
+}
+
 Int_t AliSimDigits::GetTrackID(Int_t row, Int_t column, Int_t level) 
 {
   /// Get track ID
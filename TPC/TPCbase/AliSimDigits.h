@@ -31,6 +31,11 @@ public:
   virtual Int_t GetTrackID(Int_t row, Int_t column, Int_t level);
   virtual void ExpandTrackBuffer();  //expand buffer to twodimensional array
   virtual void CompresTrackBuffer(Int_t bufType); //compres buffer according buffertype algorithm 
+  Int_t MergeTo(Float_t *signal, Int_t *tracks, Int_t nLevels, UChar_t *nTracks,
+                UChar_t *mark, Int_t threshold, Int_t trackOffset); //add digits and tracks to expanded arrays
+  void  GetTrackIDs(Int_t column, Int_t level, Int_t n, const Short_t *rows, Int_t *ids); //track IDs of sorted rows of one column
+  Int_t GetNLevels() const {return fNlevel;}
+  Int_t GetTrackBufferType() const {return fTrBufType;}
   AliH2F *  DrawTracks( const char *option=0,Int_t level=0, 
 		  Float_t x1=-1, Float_t x2=-1, Float_t y1=-1, Float_t y2=-1); //draw tracks
   //only for demonstration purpose
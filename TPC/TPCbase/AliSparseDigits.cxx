@@ -0,0 +1,231 @@
+/**************************************************************************
+ * Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved. *
+ *                                                                        *
+ * Author: The ALICE Off-line Project.                                    *
+ * Contributors are mentioned in the code where appropriate.              *
+ *                                                                        *
+ * Permission to use, copy, modify and distribute this software and its   *
+ * documentation strictly for non-commercial purposes is hereby granted   *
+ * without fee, provided that the above copyright notice appears in all   *
+ * copies and that both the copyright notice and this permission notice   *
+ * appear in the supporting documentation. The authors make no claims     *
+ * about the suitability of this software for any purpose. It is          *
+ * provided "as is" without express or implied warranty.                  *
+ **************************************************************************/
+
+/* $Id$ */
+
+/// \class AliSparseDigits
+///
+///   Alice digits of one segment in compressed sparse column layout
+///
+///   Only the stored digits are kept: for every column (pad) the index of its
+///   first digit, for every digit the row (time bin), the value and fNlevel
+///   track IDs. The digits and the track IDs are accessible without the
+///   expansion needed for AliDigits and AliSimDigits, the random access is a
+///   binary search within the column.
+///
+///   The digits trees keep the AliSimDigits format, Set converts the
+///   compressed AliSimDigits read from a tree walking the compressed buffers,
+///   Get converts back for writing.
+///
+///   Filling: Allocate, AddDigit in order of increasing column and row, Close
+///
+/// ~~~{.cpp}
+/// AliSparseDigits sparse;
+/// sparse.Set(simDigits);
+/// if (sparse.First()) do {
+///   sparse.CurrentRow(); sparse.CurrentColumn(); sparse.CurrentDigit();
+/// } while (sparse.Next());
+/// ~~~
+
+#include "TError.h"
+#include "TMath.h"
+#include "AliDigits.h"
+#include "AliSimDigits.h"
+#include "AliSparseDigits.h"
+#include <vector>
+
+
+/// \cond CLASSIMP
+ClassImp(AliSparseDigits)
+/// \endcond
+
+AliSparseDigits::AliSparseDigits()
+               :AliSegmentID(),
+                fNrows(0),
+                fNcols(0),
+                fNlevel(0),
+                fNdigits(0),
+                fColumnStart(),
+                fRows(),
+                fDigits(),
+                fTracks(),
+                fLastCol(-1),
+                fCurrentCol(-1),
+                fCurrentIndex(-1)
+{
+  /// default constructor
+}
+
+void AliSparseDigits::Allocate(Int_t rows, Int_t columns, Int_t levels, Int_t size)
+{
+  /// empty segment of rows x columns with levels track IDs per digit,
+  /// size is the expected number of digits
+
+  fNrows = rows;
+  fNcols = columns;
+  fNlevel = levels;
+  fNdigits = 0;
+  fLastCol = -1;
+  fCurrentCol = -1;
+  fCurrentIndex = -1;
+  fColumnStart.Set(fNcols+1);
+  fColumnStart.Reset();
+  fRows.Set(0);
+  fDigits.Set(0);
+  fTracks.Set(0);
+  if (size>0) Reserve(size);
+}
+
+void AliSparseDigits::Reserve(Int_t size)
+{
+  /// grow the digit arrays to at least size digits
+
+  if (size<=fDigits.fN) return;
+  Int_t n = TMath::Max(size,2*fDigits.fN);
+  fRows.Set(n);
+  fDigits.Set(n);
+  if (fNlevel>0) fTracks.Set(n*fNlevel);
+}
+
+Int_t AliSparseDigits::AddDigit(Int_t row, Int_t column, Short_t value, const Int_t *ids)
+{
+  /// append digit, columns have to be increasing and rows increasing
+  /// within a column. ids are fNlevel track IDs+2 (AliSimDigits convention)
+  /// Returns the index of the digit
+
+  if (column<fLastCol || column>=fNcols || row<0 || row>=fNrows ||
+      (column==fLastCol && fNdigits>0 && fRows.fArray[fNdigits-1]>=row)) {
+    ::Error("AliSparseDigits::AddDigit", "row %d col %d out of order or bounds (size: %d x %d)",
+            row, column, fNrows, fNcols);
+    return -1;
+  }
+  for (Int_t col=fLastCol+1; col<=column; col++) fColumnStart.fArray[col] = fNdigits;
+  fLastCol = column;
+  if (fNdigits>=fDigits.fN) Reserve(fNdigits+1);
+  fRows.fArray[fNdigits] = row;
+  fDigits.fArray[fNdigits] = value;
+  for (Int_t level=0; level<fNlevel; level++)
+    fTracks.fArray[fNdigits*fNlevel+level] = ids ? ids[level] : 0;
+  return fNdigits++;
+}
+
+void AliSparseDigits::Close()
+{
+  /// finish the column index and trim the arrays to the number of digits
+
+  for (Int_t col=fLastCol+1; col<=fNcols; col++) fColumnStart.fArray[col] = fNdigits;
+  fLastCol = fNcols;
+  fRows.Set(fNdigits);
+  fDigits.Set(fNdigits);
+  fTracks.Set(fNdigits*fNlevel);
+}
+
+Int_t AliSparseDigits::Set(AliDigits &digits)
+{
+  /// convert the digits above threshold of AliDigits, the compressed
+  /// buffer is iterated without expansion
+  /// Returns the number of digits
+
+  SetID(digits.GetID());
+  Allocate(digits.GetNRows(),digits.GetNCols());
+  if (digits.First()) do {
+    AddDigit(digits.CurrentRow(),digits.CurrentColumn(),digits.CurrentDigit());
+  } while (digits.Next());
+  Close();
+  return fNdigits;
+}
+
+Int_t AliSparseDigits::Set(AliSimDigits &digits)
+{
+  /// convert AliSimDigits with the track IDs, neither the digits nor the
+  /// track buffer of type 1 are expanded
+  /// Returns the number of digits
+
+  Set(static_cast<AliDigits&>(digits));
+  fNlevel = digits.GetNLevels();
+  if (fNlevel<=0 || fNdigits==0) {
+    fTracks.Set(fNdigits*TMath::Max(fNlevel,0));
+    return fNdigits;
+  }
+  fTracks.Set(fNdigits*fNlevel);
+  std::vector<Int_t> ids;
+  for (Int_t col=0; col<fNcols; col++) {
+    Int_t first = fColumnStart.fArray[col];
+    Int_t n = fColumnStart.fArray[col+1]-first;
+    if (n==0) continue;
+    ids.resize(n);
+    for (Int_t level=0; level<fNlevel; level++) {
+      digits.GetTrackIDs(col,level,n,fRows.fArray+first,&ids[0]);
+      for (Int_t k=0; k<n; k++) fTracks.fArray[(first+k)*fNlevel+level] = ids[k];
+    }
+  }
+  return fNdigits;
+}
+
+void AliSparseDigits::Get(AliSimDigits &digits, Int_t threshold) const
+{
+  /// convert to AliSimDigits compressed with algorithm 1 as stored in the
+  /// digits trees
+
+  digits.SetID(fSegmentID);
+  digits.Allocate(fNrows,fNcols);
+  digits.AllocateTrack(fNlevel);
+  for (Int_t col=0; col<fNcols; col++) {
+    for (Int_t index=fColumnStart.fArray[col]; index<fColumnStart.fArray[col+1]; index++) {
+      Int_t row = fRows.fArray[index];
+      digits.SetDigitFast(fDigits.fArray[index],row,col);
+      for (Int_t level=0; level<fNlevel; level++)
+        digits.SetTrackIDFast(fTracks.fArray[index*fNlevel+level]-2,row,col,level);
+    }
+  }
+  digits.CompresBuffer(1,threshold);
+  digits.CompresTrackBuffer(1);
+}
+
+Int_t AliSparseDigits::GetSize() const
+{
+  /// return total size of object in bytes
+
+  return sizeof(*this)+fColumnStart.fN*sizeof(Int_t)+fRows.fN*sizeof(Short_t)
+    +fDigits.fN*sizeof(Short_t)+fTracks.fN*sizeof(Int_t);
+}
+
+Bool_t AliSparseDigits::First()
+{
+  /// adjust first digit
+
+  fCurrentCol = -1;
+  fCurrentIndex = -1;
+  if (fNdigits<=0) return kFALSE;
+  fCurrentIndex = 0;
+  fCurrentCol = 0;
+  while (fColumnStart.fArray[fCurrentCol+1]<=fCurrentIndex) fCurrentCol++;
+  return kTRUE;
+}
+
+Bool_t AliSparseDigits::Next()
+{
+  /// adjust next digit
+
+  if (fCurrentIndex<0) return kFALSE;
+  fCurrentIndex++;
+  if (fCurrentIndex>=fNdigits) {
+    fCurrentIndex = -1;
+    fCurrentCol = -1;
+    return kFALSE;
+  }
+  while (fColumnStart.fArray[fCurrentCol+1]<=fCurrentIndex) fCurrentCol++;
+  return kTRUE;
+}
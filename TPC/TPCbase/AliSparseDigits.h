@@ -0,0 +1,104 @@
+#ifndef ALISPARSEDIGITS_H
+#define ALISPARSEDIGITS_H
+/* Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved. *
+ * See cxx source for full Copyright notice                               */
+
+/* $Id$ */
+
+/// \class AliSparseDigits
+///
+///  Digits of one segment (pad row) in compressed sparse column layout
+///  rows are the time bins, columns the pads as in AliDigits
+
+#include   <TArrayI.h>
+#include   <TArrayS.h>
+#include   "AliSegmentID.h"
+
+class AliDigits;
+class AliSimDigits;
+
+class AliSparseDigits: public AliSegmentID{
+public:
+  AliSparseDigits();
+  virtual ~AliSparseDigits() {}
+  void  Allocate(Int_t rows, Int_t columns, Int_t levels=0, Int_t size=0); //empty segment of rows x columns
+  Int_t AddDigit(Int_t row, Int_t column, Short_t value, const Int_t *ids=0); //append digit, columns and rows increasing
+  void  Close(); //finish the column offsets after the last AddDigit
+  Int_t Set(AliDigits &digits);  //convert from AliDigits, no expansion
+  Int_t Set(AliSimDigits &digits); //convert from AliSimDigits with track IDs, no expansion
+  void  Get(AliSimDigits &digits, Int_t threshold=0) const; //convert to compressed AliSimDigits for the digits trees
+  Int_t GetNRows() const {return fNrows;}
+  Int_t GetNCols() const {return fNcols;}
+  Int_t GetNLevels() const {return fNlevel;}
+  Int_t GetNDigits() const {return fNdigits;}
+  Int_t GetSize() const; //return total size of object in bytes
+  Int_t FindDigit(Int_t row, Int_t column) const; //index of digit, -1 if not stored
+  Short_t GetDigit(Int_t row, Int_t column) const;
+  Int_t GetTrackIDFast(Int_t row, Int_t column, Int_t level) const; //return track ID+2 as AliSimDigits
+  // access by digit index, the digits of column c are [GetColumnStart(c),GetColumnStart(c+1))
+  Int_t   GetColumnStart(Int_t column) const {return fColumnStart.fArray[column];}
+  Short_t GetRow(Int_t index) const {return fRows.fArray[index];}
+  Short_t GetDigitAt(Int_t index) const {return fDigits.fArray[index];}
+  Int_t   GetTrackIDAt(Int_t index, Int_t level) const {return fTracks.fArray[index*fNlevel+level];}
+  const Short_t * GetRowsColumn(Int_t column) const {return fRows.fArray+fColumnStart.fArray[column];}
+  const Short_t * GetDigitsColumn(Int_t column) const {return fDigits.fArray+fColumnStart.fArray[column];}
+  // iteration as in AliDigits
+  Bool_t First();
+  Bool_t Next();
+  Int_t CurrentRow() const {return fRows.fArray[fCurrentIndex];}
+  Int_t CurrentColumn() const {return fCurrentCol;}
+  Int_t CurrentDigit() const {return fDigits.fArray[fCurrentIndex];}
+  Int_t CurrentIndex() const {return fCurrentIndex;}
+private:
+  void  Reserve(Int_t size); //grow the digit arrays
+
+  Int_t   fNrows;        ///< number of rows (time bins) in segment
+  Int_t   fNcols;        ///< number of columns (pads) in segment
+  Int_t   fNlevel;       ///< number of track IDs for one digit
+  Int_t   fNdigits;      ///< number of stored digits
+  TArrayI fColumnStart;  ///< index of the first digit of each column, fNcols+1 entries
+  TArrayS fRows;         ///< row of each digit, increasing within a column
+  TArrayS fDigits;       ///< value of each digit
+  TArrayI fTracks;       ///< track IDs+2, fNlevel for each digit
+  Int_t   fLastCol;      //!<! column of the last added digit
+  Int_t   fCurrentCol;   //!<! current column iteration
+  Int_t   fCurrentIndex; //!<! current index iteration
+
+  /// \cond CLASSIMP
+  ClassDef(AliSparseDigits,1)
+  /// \endcond
+};
+
+inline Int_t AliSparseDigits::FindDigit(Int_t row, Int_t column) const
+{
+  /// binary search of row in the given column
+
+  if (column<0 || column>=fNcols) return -1;
+  Int_t lo = fColumnStart.fArray[column], hi = fColumnStart.fArray[column+1];
+  const Short_t *rows = fRows.fArray;
+  while (lo<hi) {
+    Int_t mid = (lo+hi)>>1;
+    if (rows[mid]<row) lo = mid+1;
+    else hi = mid;
+  }
+  return (lo<fColumnStart.fArray[column+1] && rows[lo]==row) ? lo : -1;
+}
+
+inline Short_t AliSparseDigits::GetDigit(Int_t row, Int_t column) const
+{
+  /// return digit at row and column, 0 if not stored
+
+  Int_t index = FindDigit(row,column);
+  return index<0 ? 0 : fDigits.fArray[index];
+}
+
+inline Int_t AliSparseDigits::GetTrackIDFast(Int_t row, Int_t column, Int_t level) const
+{
+  /// return track ID+2 at given row and column, 0 if there is no digit
+
+  if (level<0 || level>=fNlevel) return 0;
+  Int_t index = FindDigit(row,column);
+  return index<0 ? 0 : fTracks.fArray[index*fNlevel+level];
+}
+
+#endif
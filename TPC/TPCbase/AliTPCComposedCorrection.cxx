@@ -323,6 +323,19 @@ void AliTPCComposedCorrection::Update(const TTimeStamp &timeStamp) {
 
 }
 
+Bool_t AliTPCComposedCorrection::IsReentrant() const {
+  /// reentrant if all sub corrections are
+
+  if (!fCorrections) return kFALSE;
+  TIterator *i=fCorrections->MakeIterator();
+  AliTPCCorrection *c;
+  Bool_t reentrant=kTRUE;
+  while (reentrant && 0!=(c=dynamic_cast<AliTPCCorrection*>(i->Next())))
+    reentrant=c->IsReentrant();
+  delete i;
+  return reentrant;
+}
+
 
 
 void AliTPCComposedCorrection::SetOmegaTauT1T2(Float_t omegaTau,Float_t t1,Float_t t2) {
@@ -55,6 +55,7 @@ public:
   // initialization and update functions
   virtual void Init();
   virtual void Update(const TTimeStamp &timeStamp);
+  virtual Bool_t IsReentrant() const;
   void SetWeights(TVectorD * weights){fWeights= (TVectorD*) weights->Clone();}
   const  TVectorD * GetWeights() const {return fWeights;}
 
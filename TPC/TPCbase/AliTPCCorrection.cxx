@@ -98,6 +98,8 @@
 //#include "AliTPCRecoParam.h"
 #include "TLinearFitter.h"
 #include <AliSysInfo.h>
+#include <algorithm>
+#include <vector>
 
 /// \cond CLASSIMP
 ClassImp(AliTPCCorrection)
@@ -124,7 +126,8 @@ const Double_t AliTPCCorrection::fgke0 = 8.854187817e-12;                 ///< v
 
 
 AliTPCCorrection::AliTPCCorrection()
-  : TNamed("correction_unity","unity"),fILow(0),fJLow(0),fKLow(0), fT1(1), fT2(1), fIsLocal(kFALSE), fIntegrationType(kIntegral)
+  : TNamed("correction_unity","unity"),fT1(1), fT2(1), fIsLocal(kFALSE), fIntegrationType(kIntegral),
+    fPoissonSolver(kRelaxation), fMGCycleType(1), fMGNSweeps(2), fMGMaxCycles(50), fMGTolerance(1e-8)
 {
   /// default constructor
 
@@ -135,7 +138,8 @@ AliTPCCorrection::AliTPCCorrection()
 }
 
 AliTPCCorrection::AliTPCCorrection(const char *name,const char *title)
-  : TNamed(name,title),fILow(0),fJLow(0),fKLow(0), fT1(1), fT2(1), fIsLocal(kFALSE), fIntegrationType(kIntegral)
+  : TNamed(name,title),fT1(1), fT2(1), fIsLocal(kFALSE), fIntegrationType(kIntegral),
+    fPoissonSolver(kRelaxation), fMGCycleType(1), fMGNSweeps(2), fMGMaxCycles(50), fMGTolerance(1e-8)
 {
   /// default constructor, that set the name and title
 
@@ -281,12 +285,9 @@ void AliTPCCorrection::GetCorrectionDz(const Float_t x[], Short_t roc,Float_t dx
     GetCorrection(x, roc, dx);
   } else if (fIntegrationType == kIntegral) {
 
-    static TLinearFitter fitx(2,"pol1");
-    static TLinearFitter fity(2,"pol1");
-    static TLinearFitter fitz(2,"pol1");
-    fitx.ClearPoints();
-    fity.ClearPoints();
-    fitz.ClearPoints();
+    // straight line fit of dx(z) in the neighbourhood, the slopes are the derivatives
+    Double_t sumA=0, sumAA=0, sumD[3]={0,0,0}, sumAD[3]={0,0,0};
+    Int_t    npoints=0;
     Int_t zmin=-2;
     Int_t zmax=0;
     //adjust limits around CE to stay on one side
@@ -326,17 +327,17 @@ void AliTPCCorrection::GetCorrectionDz(const Float_t x[], Short_t roc,Float_t dx
           Float_t dxyz[3];
           GetCorrection(xyz,roc,dxyz);
           Double_t adelta=zdelta*delta;
-          fitx.AddPoint(&adelta, dxyz[0]);
-          fity.AddPoint(&adelta, dxyz[1]);
-          fitz.AddPoint(&adelta, dxyz[2]);
+          ++npoints;
+          sumA +=adelta;
+          sumAA+=adelta*adelta;
+          for (Int_t j=0;j<3;++j) {
+            sumD[j] +=dxyz[j];
+            sumAD[j]+=adelta*dxyz[j];
+          }
         }
       }
-      fitx.Eval();
-      fity.Eval();
-      fitz.Eval();
-      dx[0] = fitx.GetParameter(1);
-      dx[1] = fity.GetParameter(1);
-      dx[2] = fitz.GetParameter(1);
+      const Double_t det=npoints*sumAA-sumA*sumA;
+      for (Int_t j=0;j<3;++j) dx[j] = (det>0) ? (npoints*sumAD[j]-sumA*sumD[j])/det : 0.;
   }
 }
 
@@ -362,12 +363,9 @@ void AliTPCCorrection::GetDistortionDz(const Float_t x[], Short_t roc,Float_t dx
   } else if (fIntegrationType == kIntegral) {
     //in this case do the differentiation first
 
-    static TLinearFitter fitx(2,"pol1");
-    static TLinearFitter fity(2,"pol1");
-    static TLinearFitter fitz(2,"pol1");
-    fitx.ClearPoints();
-    fity.ClearPoints();
-    fitz.ClearPoints();
+    // straight line fit of dx(z) in the neighbourhood, the slopes are the derivatives
+    Double_t sumA=0, sumAA=0, sumD[3]={0,0,0}, sumAD[3]={0,0,0};
+    Int_t    npoints=0;
 
     Int_t zmin=-1;
     Int_t zmax=1;
@@ -398,17 +396,17 @@ void AliTPCCorrection::GetDistortionDz(const Float_t x[], Short_t roc,Float_t dx
           Float_t dxyz[3];
           GetDistortion(xyz,roc,dxyz);
           Double_t adelta=zdelta*delta;
-          fitx.AddPoint(&adelta, dxyz[0]);
-          fity.AddPoint(&adelta, dxyz[1]);
-          fitz.AddPoint(&adelta, dxyz[2]);
+          ++npoints;
+          sumA +=adelta;
+          sumAA+=adelta*adelta;
+          for (Int_t j=0;j<3;++j) {
+            sumD[j] +=dxyz[j];
+            sumAD[j]+=adelta*dxyz[j];
+          }
         }
       }
-      fitx.Eval();
-      fity.Eval();
-      fitz.Eval();
-      dx[0] = fitx.GetParameter(1);
-      dx[1] = fity.GetParameter(1);
-      dx[2] = fitz.GetParameter(1);
+      const Double_t det=npoints*sumAA-sumA*sumA;
+      for (Int_t j=0;j<3;++j) dx[j] = (det>0) ? (npoints*sumAD[j]-sumA*sumD[j])/det : 0.;
   }
 }
 
@@ -747,19 +745,20 @@ void AliTPCCorrection::Interpolate2DEdistortion( Int_t order, Double_t r, Double
 						  const Double_t er[kNZ][kNR], Double_t &erValue ) {
   /// Interpolate table - 2D interpolation
 
+  Int_t jlow = 0, klow = 0 ;
   Double_t saveEr[5] = {0,0,0,0,0};
 
-  Search( kNZ,   fgkZList,  z,   fJLow   ) ;
-  Search( kNR,   fgkRList,  r,   fKLow   ) ;
-  if ( fJLow < 0 ) fJLow = 0 ;   // check if out of range
-  if ( fKLow < 0 ) fKLow = 0 ;
-  if ( fJLow + order  >=    kNZ - 1 ) fJLow =   kNZ - 1 - order ;
-  if ( fKLow + order  >=    kNR - 1 ) fKLow =   kNR - 1 - order ;
+  Search( kNZ,   fgkZList,  z,   jlow   ) ;
+  Search( kNR,   fgkRList,  r,   klow   ) ;
+  if ( jlow < 0 ) jlow = 0 ;   // check if out of range
+  if ( klow < 0 ) klow = 0 ;
+  if ( jlow + order  >=    kNZ - 1 ) jlow =   kNZ - 1 - order ;
+  if ( klow + order  >=    kNR - 1 ) klow =   kNR - 1 - order ;
 
-  for ( Int_t j = fJLow ; j < fJLow + order + 1 ; j++ ) {
-      saveEr[j-fJLow]     = Interpolate( &fgkRList[fKLow], &er[j][fKLow], order, r )   ;
+  for ( Int_t j = jlow ; j < jlow + order + 1 ; j++ ) {
+      saveEr[j-jlow]     = Interpolate( &fgkRList[klow], &er[j][klow], order, r )   ;
   }
-  erValue = Interpolate( &fgkZList[fJLow], saveEr, order, z )   ;
+  erValue = Interpolate( &fgkZList[jlow], saveEr, order, z )   ;
 
 }
 
@@ -777,31 +776,33 @@ void AliTPCCorrection::Interpolate3DEdistortion( Int_t order, Double_t r, Float_
   Double_t saveEz[5]= {0,0,0,0,0};
   Double_t savedEz[5]= {0,0,0,0,0} ;
 
-  Search( kNZ,   fgkZList,   z,   fILow   ) ;
-  Search( kNPhi, fgkPhiList, z,   fJLow   ) ;
-  Search( kNR,   fgkRList,   r,   fKLow   ) ;
+  Int_t ilow = 0, jlow = 0, klow = 0 ;
+
+  Search( kNZ,   fgkZList,   z,   ilow   ) ;
+  Search( kNPhi, fgkPhiList, z,   jlow   ) ;
+  Search( kNR,   fgkRList,   r,   klow   ) ;
 
-  if ( fILow < 0 ) fILow = 0 ;   // check if out of range
-  if ( fJLow < 0 ) fJLow = 0 ;
-  if ( fKLow < 0 ) fKLow = 0 ;
+  if ( ilow < 0 ) ilow = 0 ;   // check if out of range
+  if ( jlow < 0 ) jlow = 0 ;
+  if ( klow < 0 ) klow = 0 ;
 
-  if ( fILow + order  >=    kNZ - 1 ) fILow =   kNZ - 1 - order ;
-  if ( fJLow + order  >=  kNPhi - 1 ) fJLow = kNPhi - 1 - order ;
-  if ( fKLow + order  >=    kNR - 1 ) fKLow =   kNR - 1 - order ;
+  if ( ilow + order  >=    kNZ - 1 ) ilow =   kNZ - 1 - order ;
+  if ( jlow + order  >=  kNPhi - 1 ) jlow = kNPhi - 1 - order ;
+  if ( klow + order  >=    kNR - 1 ) klow =   kNR - 1 - order ;
 
-  for ( Int_t i = fILow ; i < fILow + order + 1 ; i++ ) {
-    for ( Int_t j = fJLow ; j < fJLow + order + 1 ; j++ ) {
-      saveEr[j-fJLow]     = Interpolate( &fgkRList[fKLow], &er[i][j][fKLow], order, r )   ;
-      saveEphi[j-fJLow]   = Interpolate( &fgkRList[fKLow], &ephi[i][j][fKLow], order, r ) ;
-      saveEz[j-fJLow]     = Interpolate( &fgkRList[fKLow], &ez[i][j][fKLow], order, r )   ;
+  for ( Int_t i = ilow ; i < ilow + order + 1 ; i++ ) {
+    for ( Int_t j = jlow ; j < jlow + order + 1 ; j++ ) {
+      saveEr[j-jlow]     = Interpolate( &fgkRList[klow], &er[i][j][klow], order, r )   ;
+      saveEphi[j-jlow]   = Interpolate( &fgkRList[klow], &ephi[i][j][klow], order, r ) ;
+      saveEz[j-jlow]     = Interpolate( &fgkRList[klow], &ez[i][j][klow], order, r )   ;
     }
-    savedEr[i-fILow]     = Interpolate( &fgkPhiList[fJLow], saveEr, order, phi )   ;
-    savedEphi[i-fILow]   = Interpolate( &fgkPhiList[fJLow], saveEphi, order, phi ) ;
-    savedEz[i-fILow]     = Interpolate( &fgkPhiList[fJLow], saveEz, order, phi )   ;
+    savedEr[i-ilow]     = Interpolate( &fgkPhiList[jlow], saveEr, order, phi )   ;
+    savedEphi[i-ilow]   = Interpolate( &fgkPhiList[jlow], saveEphi, order, phi ) ;
+    savedEz[i-ilow]     = Interpolate( &fgkPhiList[jlow], saveEz, order, phi )   ;
   }
-  erValue     = Interpolate( &fgkZList[fILow], savedEr, order, z )    ;
-  ephiValue   = Interpolate( &fgkZList[fILow], savedEphi, order, z )  ;
-  ezValue     = Interpolate( &fgkZList[fILow], savedEz, order, z )    ;
+  erValue     = Interpolate( &fgkZList[ilow], savedEr, order, z )    ;
+  ephiValue   = Interpolate( &fgkZList[ilow], savedEphi, order, z )  ;
+  ezValue     = Interpolate( &fgkZList[ilow], savedEz, order, z )    ;
 
 }
 
@@ -810,7 +811,7 @@ Double_t AliTPCCorrection::Interpolate2DTable( Int_t order, Double_t x, Double_t
 					      const TMatrixD &array ) {
   /// Interpolate table (TMatrix format) - 2D interpolation
 
-  static  Int_t jlow = 0, klow = 0 ;
+  Int_t jlow = 0, klow = 0 ;
   Double_t saveArray[5] = {0,0,0,0,0} ;
 
   Search( nx,  xv,  x,   jlow  ) ;
@@ -836,7 +837,7 @@ Double_t AliTPCCorrection::Interpolate3DTable( Int_t order, Double_t x,   Double
 					      TMatrixD **arrayofArrays ) {
   /// Interpolate table (TMatrix format) - 3D interpolation
 
-  static  Int_t ilow = 0, jlow = 0, klow = 0 ;
+  Int_t ilow = 0, jlow = 0, klow = 0 ;
   Double_t saveArray[5]= {0,0,0,0,0};
   Double_t savedArray[5]= {0,0,0,0,0} ;
 
@@ -888,7 +889,7 @@ Float_t AliTPCCorrection::Interpolate2DTable( Int_t order, Double_t x, Double_t
   /// Interpolate table (TMatrix format) - 2D interpolation
   /// Float version (in order to decrease the OCDB size)
 
-  static  Int_t jlow = 0, klow = 0 ;
+  Int_t jlow = 0, klow = 0 ;
   Float_t saveArray[5] = {0.,0.,0.,0.,0.} ;
 
   Search( nx,  xv,  x,   jlow  ) ;
@@ -915,7 +916,7 @@ Float_t AliTPCCorrection::Interpolate3DTable( Int_t order, Double_t x,   Double_
   /// Interpolate table (TMatrix format) - 3D interpolation
   /// Float version (in order to decrease the OCDB size)
 
-  static  Int_t ilow = 0, jlow = 0, klow = 0 ;
+  Int_t ilow = 0, jlow = 0, klow = 0 ;
   Float_t saveArray[5]= {0.,0.,0.,0.,0.};
   Float_t savedArray[5]= {0.,0.,0.,0.,0.} ;
 
@@ -1311,14 +1312,15 @@ void AliTPCCorrection::PoissonRelaxation3D( TMatrixD**arrayofArrayV, TMatrixD**a
   /// = 1 if we have reflection symmetry at the boundaries (eg. sector symmetry or half sector symmetries).
   ///
   /// NOTE: rocDisplacement is used to include (or ignore) the ROC misalignment in the dz calculation
+  ///
+  /// The potential is obtained by over-relaxation (PoissonSOR3D, iterations per grid) or with
+  /// SetPoissonSolver(kMultigrid) by multigrid cycles (PoissonMultigrid3D, iterations unused)
 
   const Double_t ezField = (fgkCathodeV-fgkGG)/fgkTPCZ0; // = ALICE Electric Field (V/cm) Magnitude ~ -400 V/cm;
 
   const Float_t  gridSizeR   =  (fgkOFCRadius-fgkIFCRadius) / (rows-1) ;
   const Float_t  gridSizePhi =  deltaphi ;
   const Float_t  gridSizeZ   =  fgkTPCZ0 / (columns-1) ;
-  const Float_t  ratioPhi    =  gridSizeR*gridSizeR / (gridSizePhi*gridSizePhi) ;
-  const Float_t  ratioZ      =  gridSizeR*gridSizeR / (gridSizeZ*gridSizeZ) ;
 
   TMatrixD arrayE(rows,columns) ;
 
@@ -1339,6 +1341,210 @@ void AliTPCCorrection::PoissonRelaxation3D( TMatrixD**arrayofArrayV, TMatrixD**a
     AliError("Poisson3D  phislices > 1000 is not allowed (nor wise) ");
     return; }
 
+  if (fPoissonSolver==kMultigrid) {
+    PoissonMultigrid3D( arrayofArrayV, arrayofChargeDensities, rows, columns, phislices, deltaphi, symmetry ) ;
+  } else {
+    PoissonSOR3D( arrayofArrayV, arrayofChargeDensities, rows, columns, phislices, deltaphi, iterations, symmetry ) ;
+  }
+  AliInfo(Form("Poisson3D %s: max residual %.3g", fPoissonSolver==kMultigrid ? "multigrid" : "relaxation",
+               PoissonResidual3D( arrayofArrayV, arrayofChargeDensities, rows, columns, phislices, deltaphi, symmetry ))) ;
+
+  Int_t mplus, mminus, signplus, signminus ;
+
+  //Differentiate V(r) and solve for E(r) using special equations for the first and last row
+  //Integrate E(r)/E(z) from point of origin to pad plane
+  AliSysInfo::AddStamp("CalcField", 100,0,0);
+
+  for ( Int_t m = 0 ; m < phislices ; m++ ) {
+    TMatrixD& arrayV    =  *arrayofArrayV[m] ;
+    TMatrixD& eroverEz  =  *arrayofEroverEz[m] ;
+
+    for ( Int_t j = columns-1 ; j >= 0 ; j-- ) {  // Count backwards to facilitate integration over Z
+
+      // Differentiate in R
+      for ( Int_t i = 1 ; i < rows-1 ; i++ )  arrayE(i,j) = -1 * ( arrayV(i+1,j) - arrayV(i-1,j) ) / (2*gridSizeR) ;
+      arrayE(0,j)      =  -1 * ( -0.5*arrayV(2,j) + 2.0*arrayV(1,j) - 1.5*arrayV(0,j) ) / gridSizeR ;
+      arrayE(rows-1,j) =  -1 * ( 1.5*arrayV(rows-1,j) - 2.0*arrayV(rows-2,j) + 0.5*arrayV(rows-3,j) ) / gridSizeR ;
+      // Integrate over Z
+      for ( Int_t i = 0 ; i < rows ; i++ ) {
+        Int_t index = 1 ;   // Simpsons rule if N=odd.  If N!=odd then add extra point by trapezoidal rule.
+        eroverEz(i,j) = 0.0 ;
+        if(integrationType==kIntegral) {
+          for ( Int_t k = j ; k < columns ; k++ ) {
+
+            eroverEz(i,j)  +=  index*(gridSizeZ/3.0)*arrayE(i,k)/(-1*ezField) ;
+            if ( index != 4 )  index = 4; else index = 2 ;
+          }
+          if ( index == 4 ) eroverEz(i,j)  -=  (gridSizeZ/3.0)*arrayE(i,columns-1)/ (-1*ezField) ;
+          if ( index == 2 ) eroverEz(i,j)  +=
+            (gridSizeZ/3.0)*(0.5*arrayE(i,columns-2)-2.5*arrayE(i,columns-1))/(-1*ezField) ;
+          if ( j == columns-2 ) eroverEz(i,j) =
+            (gridSizeZ/3.0)*(1.5*arrayE(i,columns-2)+1.5*arrayE(i,columns-1))/(-1*ezField) ;
+          if ( j == columns-1 ) eroverEz(i,j) =  0.0 ;
+        } else if(integrationType==kDifferential) {
+          eroverEz(i,j) = arrayE(i,j)/(-1*ezField);
+
+
+          if ( j == columns-2 ) eroverEz(i,j) =
+            (0.5*arrayE(i,columns-2)+0.5*arrayE(i,columns-1))/(-1*ezField) ;
+          if ( j == columns-1 ) eroverEz(i,j) =  0.0 ;
+
+          if ( j == 2 ) eroverEz(i,j) =
+            (0.5*arrayE(i,2)+0.5*arrayE(i,1))/(-1*ezField) ;
+          if ( j == 1 ) eroverEz(i,j) =  0.0 ;
+        }
+      }
+    }
+    // if ( m == 0 ) { TCanvas*  c1 =  new TCanvas("erOverEz","erOverEz",50,50,840,600) ;  c1 -> cd() ;
+    // eroverEz.Draw("surf") ; } // JT test
+  }
+  AliSysInfo::AddStamp("IntegrateEr", 120,0,0);
+
+  //Differentiate V(r) and solve for E(phi)
+  //Integrate E(phi)/E(z) from point of origin to pad plane
+
+  for ( Int_t m = 0 ; m < phislices ; m++ ) {
+
+    mplus  = m + 1;   signplus  = 1 ;
+    mminus = m - 1 ;  signminus = 1 ;
+    if (symmetry==1) { // Reflection symmetry in phi (e.g. symmetry at sector boundaries, or half sectors, etc.)
+      if ( mplus  > phislices-1 ) mplus  = phislices - 2 ;
+      if ( mminus < 0 )           mminus = 1 ;
+    }
+    else if (symmetry==-1) {       // Anti-symmetry in phi
+      if ( mplus  > phislices-1 ) { mplus  = phislices - 2 ;  signplus  = -1 ; }
+      if ( mminus < 0 )           { mminus = 1 ;	            signminus = -1 ; }
+    }
+    else { // No Symmetries in phi, no boundaries, the calculations is continuous across all phi
+      if ( mplus  > phislices-1 ) mplus  = m + 1 - phislices ;
+      if ( mminus < 0 )           mminus = m - 1 + phislices ;
+    }
+    TMatrixD &arrayVP     =  *arrayofArrayV[mplus] ;
+    TMatrixD &arrayVM     =  *arrayofArrayV[mminus] ;
+    TMatrixD &ePhioverEz  =  *arrayofEPhioverEz[m] ;
+    for ( Int_t j = columns-1 ; j >= 0 ; j-- ) { // Count backwards to facilitate integration over Z
+      // Differentiate in Phi
+      for ( Int_t i = 0 ; i < rows ; i++ ) {
+        Float_t radius = fgkIFCRadius + i*gridSizeR ;
+        arrayE(i,j) = -1 * (signplus * arrayVP(i,j) - signminus * arrayVM(i,j) ) / (2*radius*gridSizePhi) ;
+      }
+      // Integrate over Z
+      for ( Int_t i = 0 ; i < rows ; i++ ) {
+        Int_t index = 1 ;   // Simpsons rule if N=odd.  If N!=odd then add extra point by trapezoidal rule.
+        ePhioverEz(i,j) = 0.0 ;
+        if(integrationType==kIntegral) {
+          for ( Int_t k = j ; k < columns ; k++ ) {
+
+            ePhioverEz(i,j)  +=  index*(gridSizeZ/3.0)*arrayE(i,k)/(-1*ezField) ;
+            if ( index != 4 )  index = 4; else index = 2 ;
+          }
+          if ( index == 4 ) ePhioverEz(i,j)  -=  (gridSizeZ/3.0)*arrayE(i,columns-1)/ (-1*ezField) ;
+          if ( index == 2 ) ePhioverEz(i,j)  +=
+            (gridSizeZ/3.0)*(0.5*arrayE(i,columns-2)-2.5*arrayE(i,columns-1))/(-1*ezField) ;
+          if ( j == columns-2 ) ePhioverEz(i,j) =
+            (gridSizeZ/3.0)*(1.5*arrayE(i,columns-2)+1.5*arrayE(i,columns-1))/(-1*ezField) ;
+          if ( j == columns-1 ) ePhioverEz(i,j) =  0.0 ;
+        } else if(integrationType==kDifferential) {
+          ePhioverEz(i,j) = arrayE(i,j)/(-1*ezField);
+          if ( j == columns-2 ) ePhioverEz(i,j) =
+            (0.5*arrayE(i,columns-2)+0.5*arrayE(i,columns-1))/(-1*ezField) ;
+          if ( j == columns-1 ) ePhioverEz(i,j) =  0.0 ;
+
+          if ( j == 2 ) ePhioverEz(i,j) =
+            (0.5*arrayE(i,2)+0.5*arrayE(i,1))/(-1*ezField) ;
+          if ( j == 1 ) ePhioverEz(i,j) =  0.0 ;
+        }
+      }
+    }
+    // if ( m == 5 ) { TCanvas* c2 =  new TCanvas("arrayE","arrayE",50,50,840,600) ;  c2 -> cd() ;
+    // arrayE.Draw("surf") ; } // JT test
+  }
+  AliSysInfo::AddStamp("IntegrateEphi", 130,0,0);
+
+
+  // Differentiate V(r) and solve for E(z) using special equations for the first and last row
+  // Integrate (E(z)-Ezstd) from point of origin to pad plane
+
+  for ( Int_t m = 0 ; m < phislices ; m++ ) {
+    TMatrixD& arrayV   =  *arrayofArrayV[m] ;
+    TMatrixD& deltaEz  =  *arrayofDeltaEz[m] ;
+
+    // Differentiate V(z) and solve for E(z) using special equations for the first and last columns
+    for ( Int_t i = 0 ; i < rows ; i++) {
+      for ( Int_t j = 1 ; j < columns-1 ; j++ ) arrayE(i,j) = -1 * ( arrayV(i,j+1) - arrayV(i,j-1) ) / (2*gridSizeZ) ;
+      arrayE(i,0)         =  -1 * ( -0.5*arrayV(i,2) + 2.0*arrayV(i,1) - 1.5*arrayV(i,0) ) / gridSizeZ ;
+      arrayE(i,columns-1) =  -1 * ( 1.5*arrayV(i,columns-1) - 2.0*arrayV(i,columns-2) + 0.5*arrayV(i,columns-3) ) / gridSizeZ ;
+    }
+
+    for ( Int_t j = columns-1 ; j >= 0 ; j-- ) {  // Count backwards to facilitate integration over Z
+      // Integrate over Z
+      for ( Int_t i = 0 ; i < rows ; i++ ) {
+        Int_t index = 1 ;   // Simpsons rule if N=odd.  If N!=odd then add extra point by trapezoidal rule.
+        deltaEz(i,j) = 0.0 ;
+        if(integrationType==kIntegral) {
+          for ( Int_t k = j ; k < columns ; k++ ) {
+            deltaEz(i,j)  +=  index*(gridSizeZ/3.0)*arrayE(i,k) ;
+            if ( index != 4 )  index = 4; else index = 2 ;
+          }
+          if ( index == 4 ) deltaEz(i,j)  -=  (gridSizeZ/3.0)*arrayE(i,columns-1) ;
+          if ( index == 2 ) deltaEz(i,j)  +=
+            (gridSizeZ/3.0)*(0.5*arrayE(i,columns-2)-2.5*arrayE(i,columns-1)) ;
+          if ( j == columns-2 ) deltaEz(i,j) =
+            (gridSizeZ/3.0)*(1.5*arrayE(i,columns-2)+1.5*arrayE(i,columns-1)) ;
+          if ( j == columns-1 ) deltaEz(i,j) =  0.0 ;
+        } else if(integrationType==kDifferential) {
+          deltaEz(i,j) = arrayE(i,j) ;
+          if ( j == columns-2 ) deltaEz(i,j) =
+            (0.5*arrayE(i,columns-2)+0.5*arrayE(i,columns-1)) ;
+          if ( j == columns-1 ) deltaEz(i,j) =  0.0 ;
+          if ( j == 2 ) deltaEz(i,j) =
+            (0.5*arrayE(i,2)+0.5*arrayE(i,1)) ;
+          if ( j == 1 ) deltaEz(i,j) =  0.0 ;
+        };
+      }
+    }
+
+    // if ( m == 0 ) { TCanvas*  c1 =  new TCanvas("erOverEz","erOverEz",50,50,840,600) ;  c1 -> cd() ;
+    // eroverEz.Draw("surf") ; } // JT test
+
+    // calculate z distortion from the integrated Delta Ez residuals
+    // and include the aquivalence (Volt to cm) of the ROC shift !!
+
+    for ( Int_t j = 0 ; j < columns ; j++ )  {
+      for ( Int_t i = 0 ; i < rows ; i++ ) {
+
+	// Scale the Ez distortions with the drift velocity pertubation -> delivers cm
+	deltaEz(i,j) = deltaEz(i,j)*fgkdvdE;
+
+	// ROC Potential in cm aquivalent
+	Double_t dzROCShift =  arrayV(i, columns -1)/ezField;
+	if ( rocDisplacement ) deltaEz(i,j) = deltaEz(i,j) + dzROCShift;  // add the ROC misaligment
+
+      }
+    }
+
+  } // end loop over phi
+  AliSysInfo::AddStamp("IntegrateEz", 140,0,0);
+
+
+
+
+
+  arrayE.Clear();
+}
+
+void AliTPCCorrection::PoissonSOR3D( TMatrixD**arrayofArrayV, TMatrixD**arrayofChargeDensities,
+				     Int_t rows, Int_t columns,  Int_t phislices,
+				     Float_t deltaphi, Int_t iterations, Int_t symmetry ) {
+  /// 3D - Solve Poisson's Equation by successive over-relaxation with a binary
+  /// expansion of the grid, see PoissonRelaxation3D
+
+  const Float_t  gridSizeR   =  (fgkOFCRadius-fgkIFCRadius) / (rows-1) ;
+  const Float_t  gridSizePhi =  deltaphi ;
+  const Float_t  gridSizeZ   =  fgkTPCZ0 / (columns-1) ;
+  const Float_t  ratioPhi    =  gridSizeR*gridSizeR / (gridSizePhi*gridSizePhi) ;
+  const Float_t  ratioZ      =  gridSizeR*gridSizeR / (gridSizeZ*gridSizeZ) ;
+
   // Solve Poisson's equation in cylindrical coordinates by relaxation technique
   // Allow for different size grid spacing in R and Z directions
   // Use a binary expansion of the matrix to speed up the solution of the problem
@@ -1516,190 +1722,353 @@ void AliTPCCorrection::PoissonRelaxation3D( TMatrixD**arrayofArrayV, TMatrixD**a
 
   }
 
-  //Differentiate V(r) and solve for E(r) using special equations for the first and last row
-  //Integrate E(r)/E(z) from point of origin to pad plane
-  AliSysInfo::AddStamp("CalcField", 100,0,0);
-
-  for ( Int_t m = 0 ; m < phislices ; m++ ) {
-    TMatrixD& arrayV    =  *arrayofArrayV[m] ;
-    TMatrixD& eroverEz  =  *arrayofEroverEz[m] ;
-
-    for ( Int_t j = columns-1 ; j >= 0 ; j-- ) {  // Count backwards to facilitate integration over Z
-
-      // Differentiate in R
-      for ( Int_t i = 1 ; i < rows-1 ; i++ )  arrayE(i,j) = -1 * ( arrayV(i+1,j) - arrayV(i-1,j) ) / (2*gridSizeR) ;
-      arrayE(0,j)      =  -1 * ( -0.5*arrayV(2,j) + 2.0*arrayV(1,j) - 1.5*arrayV(0,j) ) / gridSizeR ;
-      arrayE(rows-1,j) =  -1 * ( 1.5*arrayV(rows-1,j) - 2.0*arrayV(rows-2,j) + 0.5*arrayV(rows-3,j) ) / gridSizeR ;
-      // Integrate over Z
-      for ( Int_t i = 0 ; i < rows ; i++ ) {
-        Int_t index = 1 ;   // Simpsons rule if N=odd.  If N!=odd then add extra point by trapezoidal rule.
-        eroverEz(i,j) = 0.0 ;
-        if(integrationType==kIntegral) {
-          for ( Int_t k = j ; k < columns ; k++ ) {
-
-            eroverEz(i,j)  +=  index*(gridSizeZ/3.0)*arrayE(i,k)/(-1*ezField) ;
-            if ( index != 4 )  index = 4; else index = 2 ;
-          }
-          if ( index == 4 ) eroverEz(i,j)  -=  (gridSizeZ/3.0)*arrayE(i,columns-1)/ (-1*ezField) ;
-          if ( index == 2 ) eroverEz(i,j)  +=
-            (gridSizeZ/3.0)*(0.5*arrayE(i,columns-2)-2.5*arrayE(i,columns-1))/(-1*ezField) ;
-          if ( j == columns-2 ) eroverEz(i,j) =
-            (gridSizeZ/3.0)*(1.5*arrayE(i,columns-2)+1.5*arrayE(i,columns-1))/(-1*ezField) ;
-          if ( j == columns-1 ) eroverEz(i,j) =  0.0 ;
-        } else if(integrationType==kDifferential) {
-          eroverEz(i,j) = arrayE(i,j)/(-1*ezField);
+  for ( Int_t k = 0 ; k < phislices ; k++ )
+    {
+      arrayofSumChargeDensities[k]->Delete() ;
+    }
+}
 
+namespace {
+  // Multigrid for the 3D Poisson equation of PoissonRelaxation3D. The grids
+  // are coarsened in r and z only, the phi slices are kept on all levels and
+  // solved by line relaxation along phi, which stays efficient when the phi
+  // coupling dominates on the coarse grids. A direction much weaker coupled
+  // than the other one is not coarsened (semi-coarsening).
+
+  struct AliTPCPoissonPhi {             // phi neighbours for the symmetry of PoissonRelaxation3D
+    Int_t                 fN;           // phi slices
+    Bool_t                fCyclic;      // no symmetry, slice 0 follows the last slice
+    std::vector<Int_t>    fPlus;        // slice m+1
+    std::vector<Int_t>    fMinus;       // slice m-1
+    std::vector<Double_t> fSignPlus;    // sign of slice m+1
+    std::vector<Double_t> fSignMinus;   // sign of slice m-1
+    std::vector<Double_t> fLower;       // coupling of the line to slice m-1 in units of the phi coupling
+    std::vector<Double_t> fUpper;       // coupling of the line to slice m+1 in units of the phi coupling
+  };
+
+  struct AliTPCPoissonLevel {           // one (r,z) grid of the hierarchy, all phi slices
+    Int_t                 fRows;        // points in r
+    Int_t                 fColumns;     // points in z
+    Bool_t                fCoarsenR;    // half the points in r of the finer grid
+    Bool_t                fCoarsenZ;    // half the points in z of the finer grid
+    Double_t              fCoefZ;       // coupling to the z neighbours
+    std::vector<Double_t> fCoefRPlus;   // coupling to row i+1
+    std::vector<Double_t> fCoefRMinus;  // coupling to row i-1
+    std::vector<Double_t> fCoefPhi;     // coupling to the phi neighbours
+    std::vector<Double_t> fDiag;        // diagonal
+    std::vector<Double_t> fV;           // potential, correction on the coarse levels
+    std::vector<Double_t> fF;           // right hand side
+    std::vector<Double_t> fRes;         // residual
+  };
+
+  void InitPoissonPhi(AliTPCPoissonPhi &phi, Int_t phislices, Int_t symmetry)
+  {
+    // neighbours as in AliTPCCorrection::PoissonSOR3D
+    phi.fN = phislices;
+    phi.fCyclic = (symmetry!=1 && symmetry!=-1);
+    phi.fPlus.resize(phislices);
+    phi.fMinus.resize(phislices);
+    phi.fSignPlus.assign(phislices,1.);
+    phi.fSignMinus.assign(phislices,1.);
+    phi.fLower.assign(phislices,0.);
+    phi.fUpper.assign(phislices,0.);
+    for (Int_t m=0; m<phislices; m++) {
+      Int_t mplus = m+1, mminus = m-1;
+      if (!phi.fCyclic) {
+        if (mplus>phislices-1) { mplus = phislices-2; phi.fSignPlus[m] = symmetry; }
+        if (mminus<0)          { mminus = 1;          phi.fSignMinus[m] = symmetry; }
+      } else {
+        if (mplus>phislices-1) mplus = m+1-phislices;
+        if (mminus<0)          mminus = m-1+phislices;
+      }
+      phi.fPlus[m] = mplus;
+      phi.fMinus[m] = mminus;
+      // reflected neighbours fall on the same side of the line
+      if (mplus==m+1 || (phi.fCyclic && m==phislices-1)) phi.fUpper[m] += phi.fSignPlus[m];
+      else phi.fLower[m] += phi.fSignPlus[m];
+      if (mminus==m-1 || (phi.fCyclic && m==0)) phi.fLower[m] += phi.fSignMinus[m];
+      else phi.fUpper[m] += phi.fSignMinus[m];
+    }
+  }
 
-          if ( j == columns-2 ) eroverEz(i,j) =
-            (0.5*arrayE(i,columns-2)+0.5*arrayE(i,columns-1))/(-1*ezField) ;
-          if ( j == columns-1 ) eroverEz(i,j) =  0.0 ;
+  void InitPoissonLevel(AliTPCPoissonLevel &level, Int_t rows, Int_t columns, Int_t phislices,
+                        Double_t rMin, Double_t gridSizeR, Double_t gridSizePhi, Double_t gridSizeZ)
+  {
+    // coefficients of -laplace(V) in cylindrical coordinates
+    level.fRows = rows;
+    level.fColumns = columns;
+    level.fCoarsenR = level.fCoarsenZ = kFALSE;
+    level.fCoefZ = 1./(gridSizeZ*gridSizeZ);
+    level.fCoefRPlus.assign(rows,0.);
+    level.fCoefRMinus.assign(rows,0.);
+    level.fCoefPhi.assign(rows,0.);
+    level.fDiag.assign(rows,1.);
+    for (Int_t i=1; i<rows-1; i++) {
+      Double_t radius = rMin+i*gridSizeR;
+      level.fCoefRPlus[i]  = (1.+gridSizeR/(2*radius))/(gridSizeR*gridSizeR);
+      level.fCoefRMinus[i] = (1.-gridSizeR/(2*radius))/(gridSizeR*gridSizeR);
+      level.fCoefPhi[i]    = 1./(radius*radius*gridSizePhi*gridSizePhi);
+      level.fDiag[i]       = 2./(gridSizeR*gridSizeR)+2.*level.fCoefZ+2.*level.fCoefPhi[i];
+    }
+    level.fV.assign(phislices*rows*columns,0.);
+    level.fF.assign(phislices*rows*columns,0.);
+    level.fRes.assign(phislices*rows*columns,0.);
+  }
 
-          if ( j == 2 ) eroverEz(i,j) =
-            (0.5*arrayE(i,2)+0.5*arrayE(i,1))/(-1*ezField) ;
-          if ( j == 1 ) eroverEz(i,j) =  0.0 ;
+  Double_t PoissonResidual(AliTPCPoissonLevel &level, const AliTPCPoissonPhi &phi)
+  {
+    // residual f-AV at the inner points, returns the maximal absolute value
+    const Int_t rows = level.fRows, columns = level.fColumns, slice = rows*columns;
+    std::vector<Double_t> maxRes(phi.fN,0.);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (Int_t m=0; m<phi.fN; m++) {
+      const Double_t *v  = &level.fV[m*slice];
+      const Double_t *vp = &level.fV[phi.fPlus[m]*slice];
+      const Double_t *vm = &level.fV[phi.fMinus[m]*slice];
+      const Double_t *f  = &level.fF[m*slice];
+      Double_t *res = &level.fRes[m*slice];
+      for (Int_t i=1; i<rows-1; i++) {
+        for (Int_t j=1; j<columns-1; j++) {
+          Int_t k = i*columns+j;
+          res[k] = f[k]-level.fDiag[i]*v[k]
+            +level.fCoefRPlus[i]*v[k+columns]+level.fCoefRMinus[i]*v[k-columns]
+            +level.fCoefZ*(v[k+1]+v[k-1])
+            +level.fCoefPhi[i]*(phi.fSignPlus[m]*vp[k]+phi.fSignMinus[m]*vm[k]);
+          maxRes[m] = TMath::Max(maxRes[m],TMath::Abs(res[k]));
         }
       }
     }
-    // if ( m == 0 ) { TCanvas*  c1 =  new TCanvas("erOverEz","erOverEz",50,50,840,600) ;  c1 -> cd() ;
-    // eroverEz.Draw("surf") ; } // JT test
+    Double_t result = 0;
+    for (Int_t m=0; m<phi.fN; m++) result = TMath::Max(result,maxRes[m]);
+    return result;
   }
-  AliSysInfo::AddStamp("IntegrateEr", 120,0,0);
-
-  //Differentiate V(r) and solve for E(phi)
-  //Integrate E(phi)/E(z) from point of origin to pad plane
-
-  for ( Int_t m = 0 ; m < phislices ; m++ ) {
 
-    mplus  = m + 1;   signplus  = 1 ;
-    mminus = m - 1 ;  signminus = 1 ;
-    if (symmetry==1) { // Reflection symmetry in phi (e.g. symmetry at sector boundaries, or half sectors, etc.)
-      if ( mplus  > phislices-1 ) mplus  = phislices - 2 ;
-      if ( mminus < 0 )           mminus = 1 ;
+  void SolvePhiLine(const AliTPCPoissonPhi &phi, Double_t diag, Double_t coefPhi,
+                    std::vector<Double_t> &rhs, std::vector<Double_t> &work)
+  {
+    // solve diag*x[m] - coefPhi*(lower[m]*x[m-1] + upper[m]*x[m+1]) = rhs[m] in place,
+    // cyclic (Sherman-Morrison) without phi symmetry
+    const Int_t n = phi.fN;
+    Double_t *c = &work[0], *z = &work[n], *b = &work[2*n];
+    Double_t alpha = 0, beta = 0, gamma = 0;
+    for (Int_t m=0; m<n; m++) b[m] = diag;
+    if (phi.fCyclic) {
+      alpha = -coefPhi*phi.fUpper[n-1];  // last row, coupling to x[0]
+      beta  = -coefPhi*phi.fLower[0];    // first row, coupling to x[n-1]
+      gamma = -diag;
+      b[0]   -= gamma;
+      b[n-1] -= alpha*beta/gamma;
     }
-    else if (symmetry==-1) {       // Anti-symmetry in phi
-      if ( mplus  > phislices-1 ) { mplus  = phislices - 2 ;  signplus  = -1 ; }
-      if ( mminus < 0 )           { mminus = 1 ;	            signminus = -1 ; }
+    // forward elimination, c[m] holds the modified upper diagonal
+    for (Int_t pass=0; pass<(phi.fCyclic ? 2 : 1); pass++) {
+      Double_t *x = (pass==0) ? &rhs[0] : z;
+      if (pass==1) {
+        for (Int_t m=0; m<n; m++) z[m] = 0;
+        z[0] = gamma;
+        z[n-1] = alpha;
+      }
+      Double_t denom = b[0];
+      x[0] /= denom;
+      for (Int_t m=1; m<n; m++) {
+        c[m-1] = -coefPhi*phi.fUpper[m-1]/denom;
+        Double_t lower = -coefPhi*phi.fLower[m];
+        denom = b[m]-lower*c[m-1];
+        x[m] = (x[m]-lower*x[m-1])/denom;
+      }
+      for (Int_t m=n-2; m>=0; m--) x[m] -= c[m]*x[m+1];
     }
-    else { // No Symmetries in phi, no boundaries, the calculations is continuous across all phi
-      if ( mplus  > phislices-1 ) mplus  = m + 1 - phislices ;
-      if ( mminus < 0 )           mminus = m - 1 + phislices ;
+    if (phi.fCyclic) {
+      Double_t fact = (rhs[0]+beta*rhs[n-1]/gamma)/(1.+z[0]+beta*z[n-1]/gamma);
+      for (Int_t m=0; m<n; m++) rhs[m] -= fact*z[m];
     }
-    TMatrixD &arrayVP     =  *arrayofArrayV[mplus] ;
-    TMatrixD &arrayVM     =  *arrayofArrayV[mminus] ;
-    TMatrixD &ePhioverEz  =  *arrayofEPhioverEz[m] ;
-    for ( Int_t j = columns-1 ; j >= 0 ; j-- ) { // Count backwards to facilitate integration over Z
-      // Differentiate in Phi
-      for ( Int_t i = 0 ; i < rows ; i++ ) {
-        Float_t radius = fgkIFCRadius + i*gridSizeR ;
-        arrayE(i,j) = -1 * (signplus * arrayVP(i,j) - signminus * arrayVM(i,j) ) / (2*radius*gridSizePhi) ;
-      }
-      // Integrate over Z
-      for ( Int_t i = 0 ; i < rows ; i++ ) {
-        Int_t index = 1 ;   // Simpsons rule if N=odd.  If N!=odd then add extra point by trapezoidal rule.
-        ePhioverEz(i,j) = 0.0 ;
-        if(integrationType==kIntegral) {
-          for ( Int_t k = j ; k < columns ; k++ ) {
+  }
 
-            ePhioverEz(i,j)  +=  index*(gridSizeZ/3.0)*arrayE(i,k)/(-1*ezField) ;
-            if ( index != 4 )  index = 4; else index = 2 ;
+  void PoissonSmooth(AliTPCPoissonLevel &level, const AliTPCPoissonPhi &phi, Int_t nSweeps)
+  {
+    // red-black Gauss-Seidel in (r,z) with exact solution along the phi lines,
+    // the lines of one colour are independent
+    const Int_t rows = level.fRows, columns = level.fColumns, slice = rows*columns;
+    for (Int_t sweep=0; sweep<nSweeps; sweep++) {
+      for (Int_t colour=0; colour<2; colour++) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (Int_t i=1; i<rows-1; i++) {
+          std::vector<Double_t> line(phi.fN), work(3*phi.fN);
+          for (Int_t j=((i+1)%2==colour) ? 1 : 2; j<columns-1; j+=2) {
+            Int_t k = i*columns+j;
+            for (Int_t m=0; m<phi.fN; m++) {
+              const Double_t *v = &level.fV[m*slice];
+              line[m] = level.fF[m*slice+k]
+                +level.fCoefRPlus[i]*v[k+columns]+level.fCoefRMinus[i]*v[k-columns]
+                +level.fCoefZ*(v[k+1]+v[k-1]);
+            }
+            SolvePhiLine(phi,level.fDiag[i],level.fCoefPhi[i],line,work);
+            for (Int_t m=0; m<phi.fN; m++) level.fV[m*slice+k] = line[m];
           }
-          if ( index == 4 ) ePhioverEz(i,j)  -=  (gridSizeZ/3.0)*arrayE(i,columns-1)/ (-1*ezField) ;
-          if ( index == 2 ) ePhioverEz(i,j)  +=
-            (gridSizeZ/3.0)*(0.5*arrayE(i,columns-2)-2.5*arrayE(i,columns-1))/(-1*ezField) ;
-          if ( j == columns-2 ) ePhioverEz(i,j) =
-            (gridSizeZ/3.0)*(1.5*arrayE(i,columns-2)+1.5*arrayE(i,columns-1))/(-1*ezField) ;
-          if ( j == columns-1 ) ePhioverEz(i,j) =  0.0 ;
-        } else if(integrationType==kDifferential) {
-          ePhioverEz(i,j) = arrayE(i,j)/(-1*ezField);
-          if ( j == columns-2 ) ePhioverEz(i,j) =
-            (0.5*arrayE(i,columns-2)+0.5*arrayE(i,columns-1))/(-1*ezField) ;
-          if ( j == columns-1 ) ePhioverEz(i,j) =  0.0 ;
-
-          if ( j == 2 ) ePhioverEz(i,j) =
-            (0.5*arrayE(i,2)+0.5*arrayE(i,1))/(-1*ezField) ;
-          if ( j == 1 ) ePhioverEz(i,j) =  0.0 ;
         }
       }
     }
-    // if ( m == 5 ) { TCanvas* c2 =  new TCanvas("arrayE","arrayE",50,50,840,600) ;  c2 -> cd() ;
-    // arrayE.Draw("surf") ; } // JT test
   }
-  AliSysInfo::AddStamp("IntegrateEphi", 130,0,0);
-
-
-  // Differentiate V(r) and solve for E(z) using special equations for the first and last row
-  // Integrate (E(z)-Ezstd) from point of origin to pad plane
 
-  for ( Int_t m = 0 ; m < phislices ; m++ ) {
-    TMatrixD& arrayV   =  *arrayofArrayV[m] ;
-    TMatrixD& deltaEz  =  *arrayofDeltaEz[m] ;
-
-    // Differentiate V(z) and solve for E(z) using special equations for the first and last columns
-    for ( Int_t i = 0 ; i < rows ; i++) {
-      for ( Int_t j = 1 ; j < columns-1 ; j++ ) arrayE(i,j) = -1 * ( arrayV(i,j+1) - arrayV(i,j-1) ) / (2*gridSizeZ) ;
-      arrayE(i,0)         =  -1 * ( -0.5*arrayV(i,2) + 2.0*arrayV(i,1) - 1.5*arrayV(i,0) ) / gridSizeZ ;
-      arrayE(i,columns-1) =  -1 * ( 1.5*arrayV(i,columns-1) - 2.0*arrayV(i,columns-2) + 0.5*arrayV(i,columns-3) ) / gridSizeZ ;
+  void PoissonRestrict(const AliTPCPoissonLevel &fine, AliTPCPoissonLevel &coarse, Int_t phislices)
+  {
+    // full weighting of the residual in the coarsened directions, zero initial correction
+    const Int_t fslice = fine.fRows*fine.fColumns, cslice = coarse.fRows*coarse.fColumns;
+    const Int_t fcol = fine.fColumns, ccol = coarse.fColumns;
+    const Int_t sr = coarse.fCoarsenR ? 2 : 1, sz = coarse.fCoarsenZ ? 2 : 1;
+    Double_t weightR[3], weightZ[3];
+    for (Int_t d=0; d<3; d++) {
+      weightR[d] = (sr==2) ? ((d==1) ? 0.5 : 0.25) : ((d==1) ? 1. : 0.);
+      weightZ[d] = (sz==2) ? ((d==1) ? 0.5 : 0.25) : ((d==1) ? 1. : 0.);
     }
-
-    for ( Int_t j = columns-1 ; j >= 0 ; j-- ) {  // Count backwards to facilitate integration over Z
-      // Integrate over Z
-      for ( Int_t i = 0 ; i < rows ; i++ ) {
-        Int_t index = 1 ;   // Simpsons rule if N=odd.  If N!=odd then add extra point by trapezoidal rule.
-        deltaEz(i,j) = 0.0 ;
-        if(integrationType==kIntegral) {
-          for ( Int_t k = j ; k < columns ; k++ ) {
-            deltaEz(i,j)  +=  index*(gridSizeZ/3.0)*arrayE(i,k) ;
-            if ( index != 4 )  index = 4; else index = 2 ;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (Int_t m=0; m<phislices; m++) {
+      const Double_t *res = &fine.fRes[m*fslice];
+      Double_t *f = &coarse.fF[m*cslice];
+      for (Int_t i=1; i<coarse.fRows-1; i++) {
+        for (Int_t j=1; j<ccol-1; j++) {
+          Int_t k = sr*i*fcol+sz*j;
+          Double_t sum = 0;
+          for (Int_t di=-1; di<=1; di++) {
+            for (Int_t dj=-1; dj<=1; dj++) sum += weightR[di+1]*weightZ[dj+1]*res[k+di*fcol+dj];
           }
-          if ( index == 4 ) deltaEz(i,j)  -=  (gridSizeZ/3.0)*arrayE(i,columns-1) ;
-          if ( index == 2 ) deltaEz(i,j)  +=
-            (gridSizeZ/3.0)*(0.5*arrayE(i,columns-2)-2.5*arrayE(i,columns-1)) ;
-          if ( j == columns-2 ) deltaEz(i,j) =
-            (gridSizeZ/3.0)*(1.5*arrayE(i,columns-2)+1.5*arrayE(i,columns-1)) ;
-          if ( j == columns-1 ) deltaEz(i,j) =  0.0 ;
-        } else if(integrationType==kDifferential) {
-          deltaEz(i,j) = arrayE(i,j) ;
-          if ( j == columns-2 ) deltaEz(i,j) =
-            (0.5*arrayE(i,columns-2)+0.5*arrayE(i,columns-1)) ;
-          if ( j == columns-1 ) deltaEz(i,j) =  0.0 ;
-          if ( j == 2 ) deltaEz(i,j) =
-            (0.5*arrayE(i,2)+0.5*arrayE(i,1)) ;
-          if ( j == 1 ) deltaEz(i,j) =  0.0 ;
-        };
+          f[i*ccol+j] = sum;
+        }
       }
+      for (Int_t k=0; k<cslice; k++) coarse.fV[m*cslice+k] = 0;
     }
+  }
 
-    // if ( m == 0 ) { TCanvas*  c1 =  new TCanvas("erOverEz","erOverEz",50,50,840,600) ;  c1 -> cd() ;
-    // eroverEz.Draw("surf") ; } // JT test
-
-    // calculate z distortion from the integrated Delta Ez residuals
-    // and include the aquivalence (Volt to cm) of the ROC shift !!
-
-    for ( Int_t j = 0 ; j < columns ; j++ )  {
-      for ( Int_t i = 0 ; i < rows ; i++ ) {
-
-	// Scale the Ez distortions with the drift velocity pertubation -> delivers cm
-	deltaEz(i,j) = deltaEz(i,j)*fgkdvdE;
-
-	// ROC Potential in cm aquivalent
-	Double_t dzROCShift =  arrayV(i, columns -1)/ezField;
-	if ( rocDisplacement ) deltaEz(i,j) = deltaEz(i,j) + dzROCShift;  // add the ROC misaligment
-
+  void PoissonProlongate(const AliTPCPoissonLevel &coarse, AliTPCPoissonLevel &fine, Int_t phislices)
+  {
+    // add the bilinear interpolation of the coarse correction
+    const Int_t fslice = fine.fRows*fine.fColumns, cslice = coarse.fRows*coarse.fColumns;
+    const Int_t fcol = fine.fColumns, ccol = coarse.fColumns;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (Int_t m=0; m<phislices; m++) {
+      const Double_t *e = &coarse.fV[m*cslice];
+      Double_t *v = &fine.fV[m*fslice];
+      for (Int_t i=1; i<fine.fRows-1; i++) {
+        Int_t i0 = coarse.fCoarsenR ? i/2 : i, i1 = coarse.fCoarsenR ? (i+1)/2 : i;
+        for (Int_t j=1; j<fcol-1; j++) {
+          Int_t j0 = coarse.fCoarsenZ ? j/2 : j, j1 = coarse.fCoarsenZ ? (j+1)/2 : j;
+          v[i*fcol+j] += 0.25*(e[i0*ccol+j0]+e[i1*ccol+j0]+e[i0*ccol+j1]+e[i1*ccol+j1]);
+        }
       }
     }
+  }
 
-  } // end loop over phi
-  AliSysInfo::AddStamp("IntegrateEz", 140,0,0);
-
+  void PoissonCycle(std::vector<AliTPCPoissonLevel> &levels, const AliTPCPoissonPhi &phi,
+                    UInt_t ilevel, Int_t gamma, Int_t nSweeps)
+  {
+    // V (gamma 1) or W (gamma 2) cycle starting at ilevel
+    AliTPCPoissonLevel &level = levels[ilevel];
+    if (ilevel+1==levels.size()) {
+      PoissonSmooth(level,phi,4*level.fRows*level.fColumns);
+      return;
+    }
+    PoissonSmooth(level,phi,nSweeps);
+    PoissonResidual(level,phi);
+    PoissonRestrict(level,levels[ilevel+1],phi.fN);
+    for (Int_t g=0; g<gamma; g++) PoissonCycle(levels,phi,ilevel+1,gamma,nSweeps);
+    PoissonProlongate(levels[ilevel+1],level,phi.fN);
+    PoissonSmooth(level,phi,nSweeps);
+  }
 
-  for ( Int_t k = 0 ; k < phislices ; k++ )
-    {
-      arrayofSumChargeDensities[k]->Delete() ;
+  void PoissonFineLevel(AliTPCPoissonLevel &level, TMatrixD **arrayofArrayV, TMatrixD **arrayofChargeDensities,
+                        Int_t phislices)
+  {
+    // copy the potential with its boundary values and the charge density
+    const Int_t slice = level.fRows*level.fColumns;
+    for (Int_t m=0; m<phislices; m++) {
+      const Double_t *v = arrayofArrayV[m]->GetMatrixArray();
+      const Double_t *f = arrayofChargeDensities[m]->GetMatrixArray();
+      std::copy(v,v+slice,level.fV.begin()+m*slice);
+      std::copy(f,f+slice,level.fF.begin()+m*slice);
     }
+  }
+}
 
+void AliTPCCorrection::PoissonMultigrid3D( TMatrixD**arrayofArrayV, TMatrixD**arrayofChargeDensities,
+					   Int_t rows, Int_t columns,  Int_t phislices,
+					   Float_t deltaphi, Int_t symmetry ) {
+  /// 3D - Solve Poisson's Equation by geometric multigrid, see PoissonRelaxation3D
+  ///
+  /// The grids are coarsened in r and z down to one inner point, the direction
+  /// with the weaker coupling only once the grid spacings are comparable. The
+  /// phi slices are kept. The smoother is a red-black Gauss-Seidel
+  /// in (r,z) solving exactly along phi. The cycles (fMGCycleType 1 - V, 2 - W,
+  /// fMGNSweeps smoothing sweeps before and after the coarse grid correction)
+  /// are repeated until the maximal residual is reduced by fMGTolerance, at
+  /// most fMGMaxCycles times.
+
+  Double_t gridSizeR = (fgkOFCRadius-fgkIFCRadius) / (rows-1) ;
+  Double_t gridSizeZ = fgkTPCZ0 / (columns-1) ;
+
+  AliTPCPoissonPhi phi;
+  InitPoissonPhi(phi,phislices,symmetry);
+
+  std::vector<AliTPCPoissonLevel> levels;
+  Int_t r = rows, c = columns;
+  Bool_t coarsenR = kFALSE, coarsenZ = kFALSE;
+  while (kTRUE) {
+    levels.push_back(AliTPCPoissonLevel());
+    InitPoissonLevel(levels.back(),r,c,phislices,fgkIFCRadius,gridSizeR,deltaphi,gridSizeZ);
+    levels.back().fCoarsenR = coarsenR;
+    levels.back().fCoarsenZ = coarsenZ;
+    coarsenR = r>3 && gridSizeR<1.5*gridSizeZ;
+    coarsenZ = c>3 && gridSizeZ<1.5*gridSizeR;
+    if (!coarsenR && !coarsenZ) {
+      coarsenR = r>3;
+      coarsenZ = c>3;
+      if (!coarsenR && !coarsenZ) break;
+    }
+    if (coarsenR) { r = (r-1)/2+1; gridSizeR *= 2; }
+    if (coarsenZ) { c = (c-1)/2+1; gridSizeZ *= 2; }
+  }
+  AliTPCPoissonLevel &fine = levels[0];
+  PoissonFineLevel(fine,arrayofArrayV,arrayofChargeDensities,phislices);
+  AliSysInfo::AddStamp("MGInit", 10,0,0);
+
+  const Double_t res0 = PoissonResidual(fine,phi);
+  Double_t res = res0;
+  Int_t ncycles = 0;
+  while (ncycles<fMGMaxCycles && res>fMGTolerance*res0) {
+    PoissonCycle(levels,phi,0,fMGCycleType,fMGNSweeps);
+    res = PoissonResidual(fine,phi);
+    ncycles++;
+    AliDebug(1,Form("multigrid cycle %d: max residual %.3g",ncycles,res));
+  }
+  AliSysInfo::AddStamp("MGCycles", 20,ncycles,0);
+  AliInfo(Form("Poisson3D multigrid: %d levels, %d cycles, max residual %.3g -> %.3g",
+               (Int_t)levels.size(),ncycles,res0,res));
 
+  const Int_t slice = rows*columns;
+  for (Int_t m=0; m<phislices; m++) {
+    std::copy(fine.fV.begin()+m*slice,fine.fV.begin()+(m+1)*slice,arrayofArrayV[m]->GetMatrixArray());
+  }
+}
 
-  arrayE.Clear();
+Double_t AliTPCCorrection::PoissonResidual3D( TMatrixD**arrayofArrayV, TMatrixD**arrayofChargeDensities,
+					      Int_t rows, Int_t columns,  Int_t phislices,
+					      Float_t deltaphi, Int_t symmetry ) {
+  /// maximal residual of the discretized Poisson equation of PoissonRelaxation3D,
+  /// used to compare the convergence of the solvers
+
+  AliTPCPoissonPhi phi;
+  InitPoissonPhi(phi,phislices,symmetry);
+  AliTPCPoissonLevel level;
+  InitPoissonLevel(level,rows,columns,phislices,fgkIFCRadius,(fgkOFCRadius-fgkIFCRadius)/(rows-1),
+                   deltaphi,fgkTPCZ0/(columns-1));
+  PoissonFineLevel(level,arrayofArrayV,arrayofChargeDensities,phislices);
+  return PoissonResidual(level,phi);
 }
 
 
@@ -27,6 +27,7 @@ class AliTPCCorrection : public TNamed {
 public:
   enum CompositionType {kParallel,kQueue};
   enum IntegrationType {kIntegral, kDifferential};
+  enum PoissonSolverType {kRelaxation, kMultigrid};
 
   AliTPCCorrection();
   AliTPCCorrection(const char *name,const char *title);
@@ -54,6 +55,15 @@ public:
   // initialization and update functions
   virtual void Init();
   virtual void Update(const TTimeStamp &timeStamp);
+  /// kTRUE if GetCorrection/GetDistortion can be called from several threads once
+  /// the first call did the lazy initialisation
+  virtual Bool_t IsReentrant() const { return kFALSE; }
+
+  // solver of the 3D Poisson equation for the distortion maps
+  void SetPoissonSolver(PoissonSolverType solver) { fPoissonSolver = solver; }
+  PoissonSolverType GetPoissonSolver() const { return fPoissonSolver; }
+  void SetMultigridParameters(Int_t cycleType=1, Int_t nSweeps=2, Int_t maxCycles=50, Double_t tolerance=1e-8)
+    { fMGCycleType = cycleType; fMGNSweeps = nSweeps; fMGMaxCycles = maxCycles; fMGTolerance = tolerance; }
 
   // map scaling
   virtual void    SetCorrScaleFactor(Float_t /*val*/) { ; }
@@ -133,7 +143,6 @@ protected:
   Double_t fgkZList[kNZ]; ///< points in the z direction (for the lookup table)
 
   // Simple Interpolation functions: e.g. with tricubic interpolation (not yet in TH3)
-  Int_t fILow, fJLow, fKLow;          ///< variable to help in the interpolation
   // Double_t versions
   void Interpolate2DEdistortion( Int_t order, Double_t r, Double_t z,
 				 const Double_t er[kNZ][kNR], Double_t &erValue );
@@ -179,6 +188,15 @@ protected:
 			    Int_t rows, Int_t columns,  Int_t phislices,
 			    Float_t deltaphi, Int_t iterations, Int_t summetry,
                             Bool_t rocDisplacement = kTRUE, IntegrationType integrationType=kIntegral);
+  void PoissonSOR3D( TMatrixD **arrayofArrayV, TMatrixD **arrayofChargeDensities,
+		     Int_t rows, Int_t columns,  Int_t phislices,
+		     Float_t deltaphi, Int_t iterations, Int_t symmetry);
+  void PoissonMultigrid3D( TMatrixD **arrayofArrayV, TMatrixD **arrayofChargeDensities,
+			   Int_t rows, Int_t columns,  Int_t phislices,
+			   Float_t deltaphi, Int_t symmetry);
+  Double_t PoissonResidual3D( TMatrixD **arrayofArrayV, TMatrixD **arrayofChargeDensities,
+			      Int_t rows, Int_t columns,  Int_t phislices,
+			      Float_t deltaphi, Int_t symmetry);
   void   SetIsLocal(Bool_t isLocal){fIsLocal=isLocal;}
   Bool_t IsLocal() const  { return fIsLocal;}
 protected:
@@ -187,6 +205,11 @@ protected:
   Bool_t fIsLocal;      ///< switch to indicate that the distortion is a local vector drphi/dz, dr/dz
   static TObjArray *fgVisualCorrection;  ///< array of orrection for visualization
   IntegrationType fIntegrationType; ///< Presentation of the underlying corrections, integrated, or differential
+  PoissonSolverType fPoissonSolver; //!<! solver of PoissonRelaxation3D
+  Int_t    fMGCycleType;            //!<! multigrid cycle: 1 - V, 2 - W
+  Int_t    fMGNSweeps;              //!<! multigrid smoothing sweeps before and after the coarse grid correction
+  Int_t    fMGMaxCycles;            //!<! maximal number of multigrid cycles
+  Double_t fMGTolerance;            //!<! multigrid stops at this reduction of the maximal residual
 private:
   AliTPCCorrection(const AliTPCCorrection &);               // not implemented
   AliTPCCorrection &operator=(const AliTPCCorrection &);    // not implemented
@@ -194,7 +217,7 @@ private:
   void InitLookUpfulcrums();   // to initialize the grid of the look up table
 
   /// \cond CLASSIMP
-  ClassDef(AliTPCCorrection,6);
+  ClassDef(AliTPCCorrection,7);
   /// \endcond
 };
 
@@ -33,6 +33,10 @@
 
 #include "AliTPCCorrectionLookupTable.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 /// \cond CLASSIMP
 ClassImp(AliTPCCorrectionLookupTable)
 /// \endcond
@@ -54,6 +58,9 @@ AliTPCCorrectionLookupTable::AliTPCCorrectionLookupTable()
 , fLookUpDxCorr(0x0)
 , fLookUpDyCorr(0x0)
 , fLookUpDzCorr(0x0)
+, fNThreads(1)
+, fPackedDist()
+, fPackedCorr()
 {
   //
   //
@@ -87,6 +94,24 @@ void AliTPCCorrectionLookupTable::GetCorrection(const Float_t x[],const Short_t
   }
 }
 
+//_________________________________________________________________________________________
+void AliTPCCorrectionLookupTable::GetDistortionBatch(Int_t n, const Float_t x[], const Short_t roc[], Float_t dx[])
+{
+  /// Interpolated distortion of n points, x and dx hold the 3 coordinates of each point
+
+  if (!PackTables()) return;
+  GetInterpolationBatch(n,x,roc,dx,fPackedDist,1.);
+}
+
+//_________________________________________________________________________________________
+void AliTPCCorrectionLookupTable::GetCorrectionBatch(Int_t n, const Float_t x[], const Short_t roc[], Float_t dx[])
+{
+  /// Interpolated correction of n points, x and dx hold the 3 coordinates of each point
+
+  if (!PackTables()) return;
+  GetInterpolationBatch(n,x,roc,dx,fPackedCorr,fCorrScaleFactor>0 ? fCorrScaleFactor : 1.);
+}
+
 //_________________________________________________________________________________________
 void AliTPCCorrectionLookupTable::GetInterpolation(const Float_t x[],const Short_t roc,Float_t dx[],
                                                    TMatrixF **mDx, TMatrixF **mDy, TMatrixF **mDz)
@@ -142,6 +167,111 @@ void AliTPCCorrectionLookupTable::GetInterpolation(const Float_t x[],const Short
                                mDz   );
 }
 
+namespace {
+  Int_t LowerBin(Int_t n, const Double_t limits[], Double_t x)
+  {
+    // lower point of the interpolation interval as in AliTPCCorrection::Search,
+    // outside of the table the closest interval is extrapolated
+    Int_t low=TMath::BinarySearch(n,limits,x);
+    if (low<0)   low=0;
+    if (low>n-2) low=n-2;
+    return low;
+  }
+}
+
+//_________________________________________________________________________________________
+void AliTPCCorrectionLookupTable::GetInterpolationBatch(Int_t n, const Float_t x[], const Short_t roc[], Float_t dx[],
+                                                        const TArrayF &table, Float_t scale)
+{
+  /// Linear interpolation of n points in the interleaved table, same result as GetInterpolation.
+  /// The 8 surrounding grid points of a point are read as 2x2 blocks of 6 consecutive values,
+  /// the points are distributed over fNThreads threads
+
+  const Double_t *limitsR   = fLimitsR.GetMatrixArray();
+  const Double_t *limitsZ   = fLimitsZ.GetMatrixArray();
+  const Double_t *limitsPhi = fLimitsPhi.GetMatrixArray();
+  const Float_t  *values    = table.GetArray();
+  const Int_t strideR   = 3*fNZ;
+  const Int_t stridePhi = strideR*fNR;
+
+#ifdef _OPENMP
+  const Int_t nThreads = fNThreads>0 ? fNThreads : omp_get_max_threads();
+#pragma omp parallel for num_threads(nThreads) schedule(static) if(nThreads>1 && n>1000)
+#endif
+  for (Int_t i=0; i<n; ++i){
+    const Float_t *xi = x+3*i;
+    Float_t *dxi = dx+3*i;
+
+    const Double_t r = TMath::Sqrt( xi[0]*xi[0] + xi[1]*xi[1] );
+    Double_t phi = TMath::ATan2(xi[1],xi[0]);
+    if ( phi < 0 ) phi += TMath::TwoPi();                    // Table uses phi from 0 to 2*Pi
+    Double_t z = xi[2];
+    if ( (roc[i]%36) < 18 ) {
+      if ( z <  fgkZOffSet ) z =  fgkZOffSet;                // Protect against discontinuity at CE
+    } else {
+      if ( z > -fgkZOffSet ) z = -fgkZOffSet;
+    }
+
+    const Int_t ir   = LowerBin(fNR,   limitsR,   r);
+    const Int_t iz   = LowerBin(fNZ,   limitsZ,   z);
+    const Int_t iphi = LowerBin(fNPhi, limitsPhi, phi);
+    const Double_t wr   = (r  -limitsR[ir])    /(limitsR[ir+1]    -limitsR[ir]);
+    const Double_t wz   = (z  -limitsZ[iz])    /(limitsZ[iz+1]    -limitsZ[iz]);
+    const Double_t wphi = (phi-limitsPhi[iphi])/(limitsPhi[iphi+1]-limitsPhi[iphi]);
+
+    const Float_t *corner = values + iphi*stridePhi + ir*strideR + 3*iz;
+    for (Int_t j=0; j<3; ++j){
+      Float_t savePhi[2];
+      for (Int_t k=0; k<2; ++k){
+        const Float_t *v0 = corner + k*stridePhi + j;
+        const Float_t *v1 = v0 + strideR;
+        const Float_t vr0 = v0[0] + (v0[3]-v0[0])*wz;
+        const Float_t vr1 = v1[0] + (v1[3]-v1[0])*wz;
+        savePhi[k] = vr0 + (vr1-vr0)*wr;
+      }
+      dxi[j] = scale*(savePhi[0] + (savePhi[1]-savePhi[0])*wphi);
+    }
+  }
+}
+
+//_________________________________________________________________________________________
+Bool_t AliTPCCorrectionLookupTable::PackTables()
+{
+  /// Copy the tables to the interleaved layout used by the batch interpolation,
+  /// done once after the tables changed
+
+  const Int_t size=3*fNPhi*fNR*fNZ;
+  if (size>0 && fPackedDist.GetSize()==size) return kTRUE;
+  if (!fLookUpDxDist || size==0) {
+    AliError("Lookup table not created");
+    return kFALSE;
+  }
+  for (Int_t iPhi=0; iPhi<fNPhi; ++iPhi){
+    if (!fLookUpDxDist[iPhi]) {
+      AliError(Form("Phi bin '%d' not initialised",iPhi));
+      return kFALSE;
+    }
+  }
+
+  fPackedDist.Set(size);
+  fPackedCorr.Set(size);
+  Float_t *dist=fPackedDist.GetArray();
+  Float_t *corr=fPackedCorr.GetArray();
+  for (Int_t iPhi=0; iPhi<fNPhi; ++iPhi){
+    const TMatrixF *mDist[3] = {fLookUpDxDist[iPhi], fLookUpDyDist[iPhi], fLookUpDzDist[iPhi]};
+    const TMatrixF *mCorr[3] = {fLookUpDxCorr[iPhi], fLookUpDyCorr[iPhi], fLookUpDzCorr[iPhi]};
+    for (Int_t j=0; j<3; ++j){
+      const Float_t *d=mDist[j]->GetMatrixArray();
+      const Float_t *c=mCorr[j]->GetMatrixArray();
+      for (Int_t irz=0; irz<fNR*fNZ; ++irz){
+        dist[3*(iPhi*fNR*fNZ+irz)+j]=d[irz];
+        corr[3*(iPhi*fNR*fNZ+irz)+j]=c[irz];
+      }
+    }
+  }
+  return kTRUE;
+}
+
 //_________________________________________________________________________________________
 void AliTPCCorrectionLookupTable::CreateLookupTable(AliTPCCorrection &tpcCorr, Float_t stepSize/*=5.*/)
 {
@@ -157,7 +287,25 @@ void AliTPCCorrectionLookupTable::CreateLookupTable(AliTPCCorrection &tpcCorr, F
   ResetTables();
   InitTables();
 
-  for (Int_t iPhi=0; iPhi<fNPhi; ++iPhi){
+  // the first phi bin serially, it triggers the lazy initialisation of the corrections.
+  // The remaining bins are distributed over the threads only if the correction is reentrant,
+  // others may use the magnetic field (AliMagWrapCheb::GetTPCRatInt keeps static buffers)
+  // or other shared state
+  CreateLookupTablePhiBin(tpcCorr,0,stepSize);
+
+  Int_t nThreads=1;
+#ifdef _OPENMP
+  nThreads = fNThreads>0 ? fNThreads : omp_get_max_threads();
+#endif
+  if (nThreads>1 && !tpcCorr.IsReentrant()) {
+    AliInfo(Form("Correction %s is not reentrant, lookup table created serially",tpcCorr.GetName()));
+    nThreads=1;
+  }
+  AliDebug(1,Form("Lookup table creation with %d threads",nThreads));
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nThreads) schedule(dynamic,1)
+#endif
+  for (Int_t iPhi=1; iPhi<fNPhi; ++iPhi){
     CreateLookupTablePhiBin(tpcCorr,iPhi,stepSize);
   }
 
@@ -168,7 +316,8 @@ void AliTPCCorrectionLookupTable::CreateLookupTable(AliTPCCorrection &tpcCorr, F
 //_________________________________________________________________________________________
 void AliTPCCorrectionLookupTable::CreateLookupTableSinglePhi(AliTPCCorrection &tpcCorr, Int_t iPhi, Float_t stepSize)
 {
-  /// Lookup table for only one phi bin. Can be used for parallel processing
+  /// Lookup table for only one phi bin. Can be used for parallel processing in separate jobs,
+  /// CreateLookupTable with SetNThreads builds the full table in parallel in one process
 
   if (fNR==0) {
     AliError("Limits are not set yet. Please use one of the Set..Limits functions first");
@@ -414,6 +563,8 @@ void AliTPCCorrectionLookupTable::ResetTables()
 {
   /// Reset the lookup tables
 
+  fPackedDist.Set(0);
+  fPackedCorr.Set(0);
   if (!fLookUpDxCorr) return;
 
   for (Int_t iPhi=0; iPhi<fNPhi; ++iPhi){
@@ -548,6 +699,10 @@ void AliTPCCorrectionLookupTable::BuildExactInverse()
   Float_t xd[3]   = {0.,0.,0.};
   Float_t dx[3]   = {0.,0.,0.};
 
+  // the packed tables are rebuilt with the new corrections
+  fPackedDist.Set(0);
+  fPackedCorr.Set(0);
+
   // reset correction matrices
   for (Int_t iPhi=0; iPhi<fNPhi; ++iPhi){
     TMatrixF &mDxCorr   = *fLookUpDxCorr[iPhi];
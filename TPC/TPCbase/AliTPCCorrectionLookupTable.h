@@ -9,6 +9,7 @@
 #include "AliTPCCorrection.h"
 #include <TVectorD.h>
 #include <TMatrixFfwd.h>
+#include <TArrayF.h>
 #include <THn.h>
 
 class AliTPCCorrectionLookupTable : public AliTPCCorrection {
@@ -19,6 +20,11 @@ public:
 
   virtual void GetCorrection(const Float_t x[],const Short_t roc,Float_t dx[]);
   virtual void GetDistortion(const Float_t x[],const Short_t roc,Float_t dx[]);
+  virtual Bool_t IsReentrant() const { return kTRUE; } // interpolation in the tables
+
+  // n points, x and dx with 3 coordinates per point
+  void GetCorrectionBatch(Int_t n, const Float_t x[], const Short_t roc[], Float_t dx[]);
+  void GetDistortionBatch(Int_t n, const Float_t x[], const Short_t roc[], Float_t dx[]);
 
   void SetupDefaultLimits();
   void CreateLookupTable(AliTPCCorrection &tpcCorr, Float_t stepSize=5.);
@@ -29,6 +35,9 @@ public:
 
   void MergePhiTables(const char* files);
 
+  void  SetNThreads(Int_t n)  { fNThreads=n;    } // 1: serial, 0: all available threads
+  Int_t GetNThreads() const   { return fNThreads; }
+
   void   SetFillCorrection(Bool_t fill) { fFillCorrection=fill;   }
   Bool_t GetFillCorrection() const      { return fFillCorrection; }
   void BuildExactInverse();
@@ -75,6 +84,10 @@ private:
   /// Array to store electric field integral (int Er/Ez)
   TMatrixF **fLookUpDzCorr;        //[fNPhi]
 
+  Int_t     fNThreads;             //!<! threads for the table creation and the batch interpolation
+  TArrayF   fPackedDist;           //!<! distortion tables interleaved as (phi,r,z,xyz) for the batch interpolation
+  TArrayF   fPackedCorr;           //!<! correction tables interleaved as (phi,r,z,xyz) for the batch interpolation
+
   void InitTables();
   void InitTableArrays();
   void InitTablesPhiBin(Int_t iPhi);
@@ -84,6 +97,9 @@ private:
 
   void GetInterpolation(const Float_t x[],const Short_t roc,Float_t dx[],
                         TMatrixF **mR, TMatrixF **mPhi, TMatrixF **mZ);
+  Bool_t PackTables();
+  void GetInterpolationBatch(Int_t n, const Float_t x[], const Short_t roc[], Float_t dx[],
+                             const TArrayF &table, Float_t scale);
 
   void CreateLookupTablePhiBin(AliTPCCorrection &tpcCorr, Int_t iPhi, Float_t stepSize);
 
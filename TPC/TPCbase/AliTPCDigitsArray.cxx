@@ -128,6 +128,43 @@ Bool_t  AliTPCDigitsArray::ClearRow(Int_t sector,Int_t row)
   return kTRUE;
 }
 
+AliDigits *  AliTPCDigitsArray::NewRow(Int_t sector, Int_t row) const
+{
+  /// create digits row which is not added to the array
+  ///
+  /// in contrast to CreateRow no shared data is modified
+
+  AliTPCParam * param = (AliTPCParam*)fParam;
+  if (param==0) return 0;
+  AliDigits * dig = 0;
+  if (fBSim == kTRUE) dig = new AliSimDigits;
+  else dig = new AliDigits;
+  dig->SetID(param->GetIndex(sector,row));
+  dig->Allocate(param->GetMaxTBin(),param->GetNPads(sector,row));
+  if (fBSim == kTRUE) ((AliSimDigits*) dig)->AllocateTrack(fTrackLevel);
+  return dig;
+}
+
+void  AliTPCDigitsArray::CompressRow(AliDigits *dig) const
+{
+  /// compress the buffers of a row as done in StoreRow
+
+  AliTPCParam * param = (AliTPCParam*)fParam;
+  dig->CompresBuffer(fCompression,param->GetZeroSup());
+  if (fBSim == kTRUE) ((AliSimDigits *)dig)->CompresTrackBuffer(1);
+}
+
+Bool_t  AliTPCDigitsArray::StoreRow(AliDigits *dig)
+{
+  /// store a compressed row created with NewRow, the row is deleted
+
+  if (dig==0 || !AddSegment(dig)) return kFALSE;
+  Int_t index = dig->GetID();
+  StoreSegment(index);
+  ClearSegment(index);
+  return kTRUE;
+}
+
 
 
 Bool_t AliTPCDigitsArray::Setup(AliDetectorParam *param)
@@ -25,6 +25,10 @@ public:
   AliDigits *  LoadRow(Int_t sector,Int_t row);
   Bool_t StoreRow(Int_t sector,Int_t row);
   Bool_t ClearRow(Int_t sector,Int_t row);
+  // rows outside of the array, can be created and filled concurrently
+  AliDigits *  NewRow(Int_t sector, Int_t row) const;
+  void   CompressRow(AliDigits *dig) const;
+  Bool_t StoreRow(AliDigits *dig); // store and delete a row from NewRow
   Bool_t Setup(AliDetectorParam *param);
 
   Bool_t IsSimulated(){return fBSim;}
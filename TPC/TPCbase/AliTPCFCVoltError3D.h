@@ -20,6 +20,7 @@ public:
   // initialization and update functions
   virtual void Init();
   virtual void Update(const TTimeStamp &timeStamp);
+  virtual Bool_t IsReentrant() const { return kTRUE; } // interpolation in the lookup tables
 
   // common setters and getters for tangled ExB effect
   virtual void SetOmegaTauT1T2(Float_t omegaTau,Float_t t1,Float_t t2) {
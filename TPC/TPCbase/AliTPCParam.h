@@ -392,6 +392,8 @@ public:
   //return response bin i  - bin given by  padrow [0] pad[1] timebin[2]
   Float_t & GetResWeight(Int_t i);
   //return  weight of response bin i
+  Int_t    GetNResponseMax() const {return fNResponseMax;}
+  //size of the response buffers
 
   // get L1 data
   Float_t  GetGateDelay() const {return fGateDelay;}
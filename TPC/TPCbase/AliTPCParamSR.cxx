@@ -421,6 +421,17 @@ void AliTPCParamSR::Streamer(TBuffer &R__b)
    }
 }
 Int_t  AliTPCParamSR::CalcResponseFast(Float_t* xyz, Int_t * index, Int_t row, Float_t phase)
+{
+  /// calculate bin response as function of the input position -x
+  /// return number of valid response bin, the response is available
+  /// with GetResBin and GetResWeight
+
+  fCurrentMax=CalcResponseFast(xyz,index,row,phase,fResponseBin,fResponseWeight);
+  return fCurrentMax;
+}
+
+Int_t  AliTPCParamSR::CalcResponseFast(Float_t* xyz, Int_t * index, Int_t row, Float_t phase,
+                                       Int_t* responseBin, Float_t* responseWeight)
 {
   /// calculate bin response as function of the input position -x
   /// return number of valid response bin
@@ -430,6 +441,9 @@ Int_t  AliTPCParamSR::CalcResponseFast(Float_t* xyz, Int_t * index, Int_t row, F
   /// xyz[0] - electron position w.r.t. pad center, normalized to pad length,
   /// xyz[1] is float pad  (center pad is number 0) and xyz[2] is float time bin
   /// xyz[3] - electron time in float time bin format
+  ///
+  /// responseBin (3 per bin) and responseWeight are filled, the function
+  /// does not modify the object and can be called from several threads
 
   if ( (fInnerPRF==0)||(fOuter1PRF==0)||(fOuter2PRF==0) ||(fTimeRF==0) ){
     Error("AliTPCParamSR", "response function was not adjusted");
@@ -459,13 +473,27 @@ Int_t  AliTPCParamSR::CalcResponseFast(Float_t* xyz, Int_t * index, Int_t row, F
   static TH1F * hdiff1=0;
   static TH1F * hdiff2=0;
 
-  if (blabla==0) {  //calculate Response function - only at the begginning
+  // the flag is read and written atomically, the tables are filled by
+  // the first thread in the critical section, the flushes order the
+  // table writes before the flag
+  Int_t initialized=0;
+#ifdef _OPENMP
+#pragma omp atomic read
+#endif
+  initialized=blabla;
+#ifdef _OPENMP
+#pragma omp flush
+#endif
+  if (initialized==0) {  //calculate Response function - only at the begginning
+#ifdef _OPENMP
+#pragma omp critical(AliTPCParamSR_CalcResponseFast)
+#endif
+  if (blabla==0) {  // tables are filled by the first thread only
     kTanMax = TMath::ATan(10.*TMath::DegToRad());
     hdiff =new TH1F("prf_diff","prf_diff",10000,-1,1);
     hdiff1 =new TH1F("no_repsonse1","no_response1",10000,-1,1);
     hdiff2 =new TH1F("no_response2","no_response2",10000,-1,1);
 
-    blabla=1;
     zoffset = GetZOffset();
     zwidth  = fZWidth;
     zoffset2 = zoffset/zwidth;
@@ -487,6 +515,12 @@ Int_t  AliTPCParamSR::CalcResponseFast(Float_t* xyz, Int_t * index, Int_t row, F
 			    *fOuterPadPitchWidth,(j-kfpadrn)/kfpadrn*fOuter2PadPitchLength);
       }
     }
+#ifdef _OPENMP
+#pragma omp flush
+#pragma omp atomic write
+#endif
+    blabla=1;
+  }
   } // the above is calculated only once
 
   // calculate central padrow, pad, time
@@ -533,62 +567,62 @@ Int_t  AliTPCParamSR::CalcResponseFast(Float_t* xyz, Int_t * index, Int_t row, F
 
   }
 
+  // pad response table and pad pitch of the row, the same for all
+  // electrons of the row
+  Float_t (*prf)[5*kpadn] = prfinner;
+  Float_t padPitchLength = fInnerPadPitchLength;
+  Float_t padPitchWidth = fInnerPadPitchWidth;
+  if (index[1]>=fNInnerSector){
+    padPitchWidth = fOuterPadPitchWidth;
+    if(row < fNRowUp1+1){
+      prf = prfouter1;
+      padPitchLength = fOuter1PadPitchLength;
+    }
+    else {
+      prf = prfouter2;
+      padPitchLength = fOuter2PadPitchLength;
+    }
+  }
+  // pad angular correction
+  Float_t angle = 0.;
+  if (npads != 0)
+    angle = kTanMax*2.*(cpad+0.5)/Float_t(npads);
+  // time response does not depend on the pad
+  Float_t timeWeight[5];
+  Int_t atime = TMath::Nint((dtime-ftime)*kftimen+2.5*kftimen);
+  for (Int_t itime = ftime;itime<=ltime;itime++){
+    timeWeight[itime-ftime] = rftime[atime];
+    atime-=ktimen;
+  }
+
   // "normal"
   Int_t apadrow = TMath::Nint((dpadrow-fpadrow)*kfpadrn+kfpadrn);
   for (Int_t ipadrow = fpadrow; ipadrow<=lpadrow;ipadrow++){
     if ( (apadrow<0) || (apadrow>=2*kpadrn))
       continue;
-    // pad angular correction
-    Float_t angle = 0.;
-    if (npads != 0)
-      angle = kTanMax*2.*(cpad+0.5)/Float_t(npads);
-    Float_t dpadangle =0;
-    if (index[1]<fNInnerSector){
-      dpadangle = angle*dpadrow*fInnerPadPitchLength/fInnerPadPitchWidth;
-    }
-    else{
-      if(row < fNRowUp1+1){
-        dpadangle    = angle*dpadrow*fOuter1PadPitchLength/fOuterPadPitchWidth;
-      }
-      else {
-	dpadangle    = angle*dpadrow*fOuter2PadPitchLength/fOuterPadPitchWidth;
-      }
-    }
+    Float_t dpadangle = angle*dpadrow*padPitchLength/padPitchWidth;
     if (ipadrow==0) dpadangle *=-1;
     //
     //    Int_t apad= TMath::Nint((dpad-fpad)*kfpadn+2.5*kfpadn);
     Int_t apad= TMath::Nint((dpad+dpadangle-fpad)*kfpadn+2.5*kfpadn);
+    const Float_t *prfrow = prf[apadrow];
     for (Int_t ipad = fpad; ipad<=lpad;ipad++){
-	Float_t cweight;
-	if (index[1]<fNInnerSector){
-	  cweight=prfinner[apadrow][apad];
-	}
-	else{
-	  if(row < fNRowUp1+1){
-	    cweight=prfouter1[apadrow][apad];
-	  }
-          else {
-	    cweight=prfouter2[apadrow][apad];
-	  }
-	}
+	Float_t cweight=prfrow[apad];
 	//	if (cweight<fResponseThreshold) continue;
-	Int_t atime = TMath::Nint((dtime-ftime)*kftimen+2.5*kftimen);
 	for (Int_t itime = ftime;itime<=ltime;itime++){
-	  Float_t cweight2 = cweight*rftime[atime];
+	  Float_t cweight2 = cweight*timeWeight[itime-ftime];
 	  if (cweight2>fResponseThreshold) {
-	    fResponseBin[cindex3++]=cpadrow+ipadrow;
-	    fResponseBin[cindex3++]=cpad+ipad;
-	    fResponseBin[cindex3++]=ctime+itime;
-	    fResponseWeight[cindex++]=cweight2;
+	    responseBin[cindex3++]=cpadrow+ipadrow;
+	    responseBin[cindex3++]=cpad+ipad;
+	    responseBin[cindex3++]=ctime+itime;
+	    responseWeight[cindex++]=cweight2;
 	  }
-	  atime-=ktimen;
 	}
 	apad-= kpadn;
     }
     apadrow-=kpadrn;
   }
-  fCurrentMax=cindex;
-  return fCurrentMax;
+  return cindex;
 
 }
 
@@ -21,6 +21,10 @@ public:
   Int_t CalcResponseFast(Float_t* x, Int_t * index, Int_t row,Float_t phase);
   //calculate bin response as function of the input position -x
   //return number of valid response bin
+  Int_t CalcResponseFast(Float_t* x, Int_t * index, Int_t row,Float_t phase,
+                         Int_t* responseBin, Float_t* responseWeight);
+  //same with caller owned buffers of size GetNResponseMax(), can be used
+  //concurrently
 
 
   void XYZtoCRXYZ(Float_t *xyz,
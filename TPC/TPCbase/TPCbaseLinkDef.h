@@ -30,6 +30,7 @@
 
 #pragma link C++ class AliSimDigits+;                  // Derived from AliDigits - MC track labels in addition
                                                        //  --- Maybe combine AliDigits and AliSimDigits to new AliTPCdigits
+#pragma link C++ class AliSparseDigits+;               // Digits per row in compressed sparse column layout, no expansion
 #pragma link C++ class AliDigitsArray+;                // Derived from AliSegmentArray - Adds only AliDetecorParam
                                                        // -> Keeps AliDigits (all rows)
                                                        // --- Is this ptr still nedded? use singleton
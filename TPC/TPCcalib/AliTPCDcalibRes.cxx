@@ -11,6 +11,10 @@
 #include "AliLumiTools.h"
 #include <TKey.h>
 #include <TF2.h>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using std::swap;
 
@@ -24,6 +28,7 @@ const char* AliTPCDcalibRes::kExtDetName[kNExtDetComb] = {"TRDonly","TOFonly","I
 const char* AliTPCDcalibRes::kControlBr[kCtrNbr] = {"itsOK","trdOK","tofOK","tofBC","nPrimTracks"}; 
 const char* AliTPCDcalibRes::kVoxName[AliTPCDcalibRes::kVoxHDim] = {"z2x","y2x","x","N"};
 const char* AliTPCDcalibRes::kResName[AliTPCDcalibRes::kResDim] = {"dX","dY","dZ","Disp"};
+const char* AliTPCDcalibRes::kStgName[AliTPCDcalibRes::kNProcStages] = {"load","fit","smooth","disp"};
 const float  AliTPCDcalibRes::kMaxResid=20.0f;   
 const float  AliTPCDcalibRes::kMaxResidZVD=40.0f;   
 const float  AliTPCDcalibRes::kMaxTgSlp=2.0;
@@ -109,6 +114,9 @@ AliTPCDcalibRes::AliTPCDcalibRes(int run,Long64_t tmin,Long64_t tmax,const char*
   ,fLearnSize(1)
   ,fBz(0)
   ,fDeleteSectorTrees(kFALSE) // set to true for production
+  ,fStreamResiduals(kFALSE)
+  ,fMaxPointsVoxel(0)
+  ,fNThreads(1)
   ,fResidualList(resList)
   ,fInputChunks(0)
   ,fOCDBPath()
@@ -179,6 +187,7 @@ AliTPCDcalibRes::AliTPCDcalibRes(int run,Long64_t tmin,Long64_t tmax,const char*
   ,fCorrTime(0)
 
   ,fStatTree(0)
+  ,fResInMemory(kFALSE)
 
   ,fDTS()
   ,fDTC()
@@ -219,6 +228,7 @@ AliTPCDcalibRes::AliTPCDcalibRes(int run,Long64_t tmin,Long64_t tmax,const char*
     fTmpFile[i] = 0;
     memset(fValidFracXBin[i],0,kNPadRows*sizeof(float));
     fNSmoothingFailedBins[i] = 0;
+    memset(fProcTiming[i],0,kNProcStages*sizeof(float));
   }
   SetKernelType();
 }
@@ -237,6 +247,7 @@ AliTPCDcalibRes::~AliTPCDcalibRes()
   for (int i=0;i<kNSect2;i++) {
     delete fSectGVoxRes[i];
     delete fStatHist[i];
+    ResetSectorResiduals(fSectRes[i]);
   }
   delete fTracksRate;
   delete fTOFBCTestH;
@@ -536,7 +547,8 @@ void AliTPCDcalibRes::ProcessFromDeltaTrees()
 {
   // process from residual trees
   TStopwatch sw;
-  // select tracks matching to time window and write compact local trees
+  // select tracks matching to time window and write compact local trees,
+  // or keep the binned residuals in memory if SetStreamResiduals was requested
   EstimateChunkStatistics();
   //
   CollectData(kDistExtractMode);
@@ -1372,7 +1384,8 @@ void AliTPCDcalibRes::FillLocalResidualsTrees()
     fDTS.dz   = fArrDZ[icl];
     fDTS.tgSlp = fArrTgSlp[icl];
     //
-    fTmpTree[sectID]->Fill();
+    if (fResInMemory) AddSectorResidual(fSectRes[sectID],fDTS.dy,fDTS.dz,fDTS.tgSlp,GetVoxGBin(fDTS.bvox));
+    else fTmpTree[sectID]->Fill();
     //
     // fill statistics on distribution within the voxel, last dimension, kVoxV is for Nentries
     ULong64_t binToFill = GetBin2Fill(fDTS.bvox,kVoxV); // bin of sector stat histo
@@ -1445,7 +1458,18 @@ void AliTPCDcalibRes::CreateLocalResidualsTrees(int mode)
     fTmpTree[0]->Branch("dtv", &dtvP);
   }
   else if (mode==kDistExtractMode||mode==kDistClosureTestMode) {    
+    fResInMemory = mode==kDistExtractMode && fStreamResiduals;
+    if (fResInMemory) {
+      AliInfoF("Binned residuals are kept in memory, max per voxel: %d (0: all)",fMaxPointsVoxel);
+      if (fMaxPointsVoxel<1) AliWarning("All points of all sectors are kept in memory, use SetMaxPointsVoxel to bound it");
+    }
     for (int is=0;is<kNSect2;is++) {
+      if (fResInMemory) { // no local trees, only the statistics histos
+	InitSectorResiduals(fSectRes[is]);
+	fStatHist[is] = CreateVoxelStatHisto(is);
+	fArrNDStat[is] = (TNDArrayT<float>*)&fStatHist[is]->GetArray();
+	continue;
+      }
       if      (mode==kDistExtractMode)         namef = Form("%s%d.root",kLocalResFileName,is);
       else /*if (mode==kDistClosureTestMode)*/ namef = Form("%s%d.root",kClosureTestFileName,is);
       fTmpFile[is] = TFile::Open(namef.Data(),"recreate");
@@ -1609,17 +1633,42 @@ void AliTPCDcalibRes::ProcessResiduals()
   LoadStatHistos();
   AliSysInfo::AddStamp("ProcResid",0,0,0,0);
   //
+  // sectors are independent, process them concurrently
+  TStopwatch sw;  sw.Start();
+  int nThreads = 1;
+#ifdef _OPENMP
+  nThreads = fNThreads>0 ? fNThreads : omp_get_max_threads();
+#pragma omp parallel for num_threads(nThreads) schedule(dynamic,1)
+#endif
   for (int is=0;is<kNSect2;is++) ProcessSectorResiduals(is);
+  fResInMemory = kFALSE; // the in-memory residuals are released by the sector processing
+  sw.Stop();
+  PrintProcTiming(nThreads,sw.RealTime());
   //
   AliSysInfo::AddStamp("ProcResid",1,0,0,0);
   //
 }
 
+//________________________________________________
+void AliTPCDcalibRes::PrintProcTiming(int nThreads, double realTime) const
+{
+  // print wall time of the sector processing and the time of its stages summed over sectors
+  double stg[kNProcStages] = {0};
+  for (int is=0;is<kNSect2;is++) for (int i=0;i<kNProcStages;i++) stg[i] += fProcTiming[is][i];
+  AliInfoF("Processed %d sectors with %d threads in %.3f s, summed stage timings: %s: %.3f %s: %.3f %s: %.3f %s: %.3f",
+	   kNSect2,nThreads,realTime,kStgName[kStgLoad],stg[kStgLoad],kStgName[kStgFit],stg[kStgFit],
+	   kStgName[kStgSmooth],stg[kStgSmooth],kStgName[kStgDisp],stg[kStgDisp]);
+}
+
 //________________________________________________
 void AliTPCDcalibRes::ProcessDispersions()
 {
   // extract distortions of corrected Y residuals ||| DEPRECATED
   if (!fInitDone) Init(); //{AliError("Init not done"); return;}
+  if (fStreamResiduals) {
+    AliError("Dispersions need the local sector trees, which are not written with SetStreamResiduals");
+    return;
+  }
   //
   LoadStatHistos();
   for (int is=0;is<kNSect2;is++) {
@@ -1640,6 +1689,10 @@ void AliTPCDcalibRes::ProcessSectorDispersions(int is)
   const float kEps = 1e-6;
 
   if (!fInitDone) {AliError("Init not done"); return;}
+  if (fStreamResiduals) {
+    AliErrorF("Dispersions of sector %d need the local sector tree, which is not written with SetStreamResiduals",is);
+    return;
+  }
   TStopwatch sw;  sw.Start();
   AliSysInfo::AddStamp("ProcessSectorDispersions",is,0,0,0);
 
@@ -1737,19 +1790,17 @@ void AliTPCDcalibRes::ProcessSectorDispersions(int is)
 void AliTPCDcalibRes::ProcessSectorResiduals(int is)
 {
   // process residuals for single sector staring from local binned per-sector trees
+  // or from the residuals kept in memory by CollectData in the streaming mode.
+  // Thread safe for different sectors: the messages and the I/O are serialized
   //
-  const int kMaxPnt = 30000000; // max points per sector to accept
   TStopwatch sw;  sw.Start();
+#ifdef _OPENMP
+#pragma omp critical(AliTPCDcalibResLog)
+#endif
   AliSysInfo::AddStamp("ProcSectRes",is,0,0,0);
   //
   fNSmoothingFailedBins[is] = 0;
-  //
-  TString sectFileName = Form("%s%d.root",kLocalResFileName,is);
-  TFile* sectFile = TFile::Open(sectFileName.Data());
-  if (!sectFile) AliFatalF("file %s not found",sectFileName.Data());
-  TString treeName = Form("ts%d",is);
-  TTree *sectTree = (TTree*) sectFile->Get(treeName.Data());
-  if (!sectTree) AliFatalF("tree %s is not found in file %s",treeName.Data(),sectFileName.Data());
+  memset(fProcTiming[is],0,kNProcStages*sizeof(float));
   //
   if (fSectGVoxRes[is]) delete[] fSectGVoxRes[is];
   fSectGVoxRes[is] = new bres_t[fNGVoxPerSector]; // here we keep main result
@@ -1770,119 +1821,84 @@ void AliTPCDcalibRes::ProcessSectorResiduals(int is)
     } 
   }
   //
-  dts_t *dtsP = &fDTS; 
-  sectTree->SetBranchAddress("dts",&dtsP);
-  int npoints = sectTree->GetEntries();
+  sres_t sectTreeRes; // residuals read from the local tree
+  sres_t &sectRes = fResInMemory ? fSectRes[is] : sectTreeRes;
+  if (!fResInMemory) {
+#ifdef _OPENMP
+#pragma omp critical(AliTPCDcalibResIO)
+#endif
+    LoadSectorResiduals(is,sectTreeRes); // ROOT I/O and fDTS buffer are shared
+  }
+  int npoints = sectRes.n;
   if (!npoints) {
+#ifdef _OPENMP
+#pragma omp critical(AliTPCDcalibResLog)
+#endif
     AliWarningF("No entries for sector %d, masking all rows",is);
     for (int ix=fNXBins;ix--;) SetXBinIgnored(is,ix);
-    delete sectTree;
-    sectFile->Close(); // to reconsider: reuse the file
-    delete sectFile;
+    ResetSectorResiduals(sectRes);
     return;
   }
-  if (npoints>kMaxPnt) npoints = kMaxPnt;
   sw.Stop();
-  AliInfoF("Sector%2d. Extracted %d points of unbinned data. Timing: real: %.3f cpu: %.3f",
-	   is, npoints, sw.RealTime(), sw.CpuTime());
-  sw.Start(kFALSE);
+  fProcTiming[is][kStgLoad] = sw.RealTime();
+  sw.Start();
   //
-  Short_t *resYArr = new Short_t[npoints];
-  Short_t *resZArr = new Short_t[npoints];
-  Short_t *tgslArr = new Short_t[npoints];
-  UShort_t *binArr = new UShort_t[npoints];
-  Int_t* index = new Int_t[npoints];
+  // the residuals are already grouped by voxel
   TArrayF dya(1000),dza(1000),tga(1000);
   float *dy = dya.GetArray(), *dz = dza.GetArray(), *tg = tga.GetArray();
-  int nacc = 0;
-  for (int ie=0;ie<npoints;ie++) {
-    sectTree->GetEntry(ie);
-    if (TMath::Abs(fDTS.tgSlp)>=kMaxTgSlp) continue;
-    resYArr[nacc] = Short_t(fDTS.dy*0x7fff/kMaxResid);
-    resZArr[nacc] = Short_t(fDTS.dz*0x7fff/kMaxResid);
-    tgslArr[nacc] = Short_t(fDTS.tgSlp*0x7fff/kMaxTgSlp);
-    binArr[nacc] = GetVoxGBin(fDTS.bvox);
-    nacc++;
-  }
-  //
-  delete sectTree;
-  sectFile->Close(); // to reconsider: reuse the file
-  delete sectFile;
-  //
-  TMath::Sort(nacc, binArr, index, kFALSE); // sort in voxel increasing order
-  UShort_t curBin = 0xffff;
   UChar_t bvox[kVoxDim];
-  int nproc = 0, npBin = 0;
-  while (nproc<nacc) {
-    int ip = index[nproc++];
-    if (curBin!=binArr[ip]) {
-      if (npBin) {
-	bres_t& resVox = sectData[curBin];
-	GBin2Vox(curBin,resVox.bvox);  // parse voxel
-	ProcessVoxelResiduals(npBin,tg,dy,dz,resVox);	
-      }
-      curBin = binArr[ip];
-      npBin = 0;
-    }
-    if (npBin==dya.GetSize()) {
+  for (int ibin=0;ibin<sectRes.nvox;ibin++) {
+    const vres_t &voxPnt = sectRes.vox[ibin];
+    int npBin = voxPnt.n;
+    if (!npBin) continue;
+    if (npBin>dya.GetSize()) {
       dya.Set(100+npBin); dy = dya.GetArray();
       dza.Set(100+npBin); dz = dza.GetArray();
       tga.Set(100+npBin); tg = tga.GetArray();
     }
-    dy[npBin] = resYArr[ip]*kMaxResid/0x7fff;
-    dz[npBin] = resZArr[ip]*kMaxResid/0x7fff;
-    tg[npBin] = tgslArr[ip]*kMaxTgSlp/0x7fff;
-    npBin++;
-  }
-  if (npBin) {
-    bres_t &resVox = sectData[curBin];
-    GBin2Vox(curBin,resVox.bvox);  // parse voxel
+    const Short_t *pnt = voxPnt.data.GetArray();
+    for (int ip=0;ip<npBin;ip++) {
+      dy[ip] = pnt[3*ip  ]*kMaxResid/0x7fff;
+      dz[ip] = pnt[3*ip+1]*kMaxResid/0x7fff;
+      tg[ip] = pnt[3*ip+2]*kMaxTgSlp/0x7fff;
+    }
+    bres_t& resVox = sectData[ibin];
+    GBin2Vox(ibin,resVox.bvox);  // parse voxel
     ProcessVoxelResiduals(npBin,tg,dy,dz,resVox);
   }
   //
   sw.Stop();
-  AliInfoF("Sector%2d. Extracted residuals. Timing: real: %.3f cpu: %.3f",
-	   is, sw.RealTime(), sw.CpuTime());
-  sw.Start(kFALSE);
+  fProcTiming[is][kStgFit] = sw.RealTime();
+  sw.Start();
   
   int nrowOK = ValidateVoxels(is);
-  if (!nrowOK) AliWarningF("Sector%2d: all X-bins disabled, abandon smoothing",is);
-  else Smooth0(is);
+  if (nrowOK) Smooth0(is);
+  else {
+#ifdef _OPENMP
+#pragma omp critical(AliTPCDcalibResLog)
+#endif
+    AliWarningF("Sector%2d: all X-bins disabled, abandon smoothing",is);
+  }
   //
   sw.Stop();
-  AliInfoF("Sector%2d. Smoothed residuals. Timing: real: %.3f cpu: %.3f",
-	   is, sw.RealTime(), sw.CpuTime());
-  sw.Start(kFALSE);
+  fProcTiming[is][kStgSmooth] = sw.RealTime();
+  sw.Start();
 
   // now process dispersions
-  curBin = 0xffff;
-
-  nproc = 0;
-  npBin = 0;
-  while (nproc<nacc) {
-    int ip = index[nproc++];
-    if (curBin!=binArr[ip]) {
-      if (npBin) {
-	bres_t& resVox = sectData[curBin];
-	GBin2Vox(curBin,resVox.bvox);  // parse voxel
-	if (!GetXBinIgnored(is,resVox.bvox[kVoxX])) ProcessVoxelDispersions(npBin,tg,dy,resVox);	
-      }
-      curBin = binArr[ip];
-      npBin = 0;
+  for (int ibin=0;ibin<sectRes.nvox;ibin++) {
+    const vres_t &voxPnt = sectRes.vox[ibin];
+    int npBin = voxPnt.n;
+    if (!npBin) continue;
+    bres_t& resVox = sectData[ibin];
+    if (GetXBinIgnored(is,resVox.bvox[kVoxX])) continue;
+    const Short_t *pnt = voxPnt.data.GetArray();
+    for (int ip=0;ip<npBin;ip++) {
+      dy[ip] = pnt[3*ip  ]*kMaxResid/0x7fff;
+      tg[ip] = pnt[3*ip+2]*kMaxTgSlp/0x7fff;
     }
-    if (npBin==dya.GetSize()) {
-      dya.Set(100+npBin); dy = dya.GetArray();
-      tga.Set(100+npBin); tg = tga.GetArray();
-    }
-    dy[npBin] = resYArr[ip]*kMaxResid/0x7fff;
-    tg[npBin] = tgslArr[ip]*kMaxTgSlp/0x7fff;
-    npBin++;
-  }
-  if (npBin) {
-    bres_t& resVox = sectData[curBin];
-    GBin2Vox(curBin,resVox.bvox);  // parse voxel
-    if (!GetXBinIgnored(is,resVox.bvox[kVoxX])) ProcessVoxelDispersions(npBin,tg,dy,resVox);
+    ProcessVoxelDispersions(npBin,tg,dy,resVox);
   }
+  ResetSectorResiduals(sectRes);
   //
   // now smooth the dispersion
   for (bvox[kVoxX]=0;bvox[kVoxX]<fNXBins;bvox[kVoxX]++) { 
@@ -1896,25 +1912,117 @@ void AliTPCDcalibRes::ProcessSectorResiduals(int is)
       }
     }
   }
-
-  delete[] binArr;
-  delete[] resYArr;
-  delete[] resZArr;
-  delete[] tgslArr;
-  delete[] index;
   //
   sw.Stop(); 
-  AliInfoF("Sector%2d. Processed dispersion. Timing: real: %.3f cpu: %.3f",is, sw.RealTime(), sw.CpuTime());
-  AliSysInfo::AddStamp("ProcSectRes",is,1,0,0);
+  fProcTiming[is][kStgDisp] = sw.RealTime();
+#ifdef _OPENMP
+#pragma omp critical(AliTPCDcalibResLog)
+#endif
+  {
+    AliInfoF("Sector%2d. Processed %d points. Timing (real) %s: %.3f %s: %.3f %s: %.3f %s: %.3f",is,npoints,
+	     kStgName[kStgLoad],fProcTiming[is][kStgLoad],kStgName[kStgFit],fProcTiming[is][kStgFit],
+	     kStgName[kStgSmooth],fProcTiming[is][kStgSmooth],kStgName[kStgDisp],fProcTiming[is][kStgDisp]);
+    AliSysInfo::AddStamp("ProcSectRes",is,1,0,0);
+  }
+  //
+}
+
+//_________________________________________________
+Int_t AliTPCDcalibRes::LoadSectorResiduals(int is, sres_t &res)
+{
+  // read binned residuals of the sector from its local tree, grouping them by voxel
+  //
+  TString sectFileName = Form("%s%d.root",kLocalResFileName,is);
+  TFile* sectFile = TFile::Open(sectFileName.Data());
+  if (!sectFile) AliFatalF("file %s not found",sectFileName.Data());
+  TString treeName = Form("ts%d",is);
+  TTree *sectTree = (TTree*) sectFile->Get(treeName.Data());
+  if (!sectTree) AliFatalF("tree %s is not found in file %s",treeName.Data(),sectFileName.Data());
   //
+  InitSectorResiduals(res);
+  dts_t *dtsP = &fDTS; 
+  sectTree->SetBranchAddress("dts",&dtsP);
+  int npoints = sectTree->GetEntries();
+  if (npoints>kMaxPntSect) npoints = kMaxPntSect;
+  for (int ie=0;ie<npoints;ie++) {
+    sectTree->GetEntry(ie);
+    AddSectorResidual(res,fDTS.dy,fDTS.dz,fDTS.tgSlp,GetVoxGBin(fDTS.bvox));
+  }
+  //
+  delete sectTree;
+  sectFile->Close(); // to reconsider: reuse the file
+  delete sectFile;
+  return res.n;
+}
+
+//_________________________________________________
+void AliTPCDcalibRes::InitSectorResiduals(sres_t &res)
+{
+  // empty per voxel storage of the binned residuals of a sector
+  ResetSectorResiduals(res);
+  res.nvox = fNGVoxPerSector;
+  res.vox = new vres_t[res.nvox];
+}
+
+//_________________________________________________
+void AliTPCDcalibRes::ResetSectorResiduals(sres_t &res)
+{
+  // release the binned residuals of a sector
+  delete[] res.vox;
+  res.vox = 0;
+  res.nvox = 0;
+  res.n = 0;
+  res.seed = 0;
+}
+
+//_________________________________________________
+Bool_t AliTPCDcalibRes::AddSectorResidual(sres_t &res, float dy, float dz, float tgSlp, UShort_t gbin)
+{
+  // store the binned residual in its voxel in compressed form, points with too large inclination
+  // are rejected. With fMaxPointsVoxel>0 the voxel keeps a uniform sample of fMaxPointsVoxel points
+  // (reservoir sampling), the voxel statistics of the stat histos is not affected
+  if (TMath::Abs(tgSlp)>=kMaxTgSlp || gbin>=res.nvox) return kFALSE;
+  vres_t &vox = res.vox[gbin];
+  int slot = vox.n;
+  vox.nSeen++;
+  if (fMaxPointsVoxel>0 && vox.n>=fMaxPointsVoxel) {
+    // 64 bit LCG: the sample depends only on the order of the input
+    res.seed = res.seed*6364136223846793005ULL + 1442695040888963407ULL;
+    slot = (res.seed>>33)%vox.nSeen;
+    if (slot>=vox.n) return kFALSE;
+  }
+  else {
+    if (res.n>=kMaxPntSect) return kFALSE;
+    if (3*vox.n>=vox.data.GetSize()) {
+      int size = TMath::Max(2*vox.n,16);
+      if (fMaxPointsVoxel>0 && size>fMaxPointsVoxel) size = fMaxPointsVoxel;
+      vox.data.Set(3*size);
+    }
+    vox.n++;
+    res.n++;
+  }
+  Short_t *pnt = vox.data.GetArray()+3*slot;
+  pnt[0] = Short_t(dy*0x7fff/kMaxResid);
+  pnt[1] = Short_t(dz*0x7fff/kMaxResid);
+  pnt[2] = Short_t(tgSlp*0x7fff/kMaxTgSlp);
+  return kTRUE;
 }
+
 //________________________________________________
 void AliTPCDcalibRes::ReProcessResiduals()
 {
   // reprocess residuals using raw voxel info filled from existing resVoxTree
   // The raw data is already loaded from the tree
   AliSysInfo::AddStamp("ReProcResid",0,0,0,0);
+  TStopwatch sw;  sw.Start();
+  int nThreads = 1;
+#ifdef _OPENMP
+  nThreads = fNThreads>0 ? fNThreads : omp_get_max_threads();
+#pragma omp parallel for num_threads(nThreads) schedule(dynamic,1)
+#endif
   for (int is=0;is<kNSect2;is++) ReProcessSectorResiduals(is);
+  sw.Stop();
+  PrintProcTiming(nThreads,sw.RealTime());
   AliSysInfo::AddStamp("ReProcResid",1,0,0,0);
 }
 
@@ -1923,17 +2031,30 @@ void AliTPCDcalibRes::ReProcessSectorResiduals(int is)
 {
   // Reprocess residuals for single sector filled from existing resVoxTree
   // The raw data is already loaded from the tree
+  // Thread safe for different sectors: the messages are serialized
   //
   TStopwatch sw;  sw.Start();
+#ifdef _OPENMP
+#pragma omp critical(AliTPCDcalibResLog)
+#endif
   AliSysInfo::AddStamp("RProcSectRes",is,0,0,0);
   //
   fNSmoothingFailedBins[is] = 0;
+  memset(fProcTiming[is],0,kNProcStages*sizeof(float));
   bres_t*  sectData = fSectGVoxRes[is];
   if (!sectData) AliFatalF("No SectGVoxRes data for sector %d",is);
   //
   int nrowOK = ValidateVoxels(is);
-  if (!nrowOK) AliWarningF("Sector%2d: all X-bins disabled, abandon smoothing",is);
-  else Smooth0(is);
+  if (nrowOK) Smooth0(is);
+  else {
+#ifdef _OPENMP
+#pragma omp critical(AliTPCDcalibResLog)
+#endif
+    AliWarningF("Sector%2d: all X-bins disabled, abandon smoothing",is);
+  }
+  sw.Stop();
+  fProcTiming[is][kStgSmooth] = sw.RealTime();
+  sw.Start();
   //
   UChar_t bvox[kVoxDim];
   // now smooth the dispersion
@@ -1949,8 +2070,15 @@ void AliTPCDcalibRes::ReProcessSectorResiduals(int is)
     }
   } 
   sw.Stop(); 
-  AliInfoF("Sector%2d. Processed dispersion. Timing: real: %.3f cpu: %.3f",is, sw.RealTime(), sw.CpuTime());
-  AliSysInfo::AddStamp("ReProcSectRes",is,1,0,0);
+  fProcTiming[is][kStgDisp] = sw.RealTime();
+#ifdef _OPENMP
+#pragma omp critical(AliTPCDcalibResLog)
+#endif
+  {
+    AliInfoF("Sector%2d. Reprocessed residuals. Timing (real) %s: %.3f %s: %.3f",is,
+	     kStgName[kStgSmooth],fProcTiming[is][kStgSmooth],kStgName[kStgDisp],fProcTiming[is][kStgDisp]);
+    AliSysInfo::AddStamp("ReProcSectRes",is,1,0,0);
+  }
   //
 }
 
@@ -1960,9 +2088,17 @@ Float_t AliTPCDcalibRes::FitPoly1Robust(int np, float* x, float* y, float* res,
   // robust pol1 fit, modifies input arrays order
   res[0] = res[1] = 0.f;
   if (np<2) return -1;
+  // don't abuse stack
+  float *ycmHeap=0,ycmStack[np<kMaxOnStack ? np:1],*ycm=np<kMaxOnStack ? &ycmStack[0] : (ycmHeap=new float[np]);
+  int   *indcmHeap=0,indcmStack[np<kMaxOnStack ? np:1],*indcm=np<kMaxOnStack ? &indcmStack[0] : (indcmHeap=new int[np]);
+  //
   TVectorF yres(7);
-  int *indY =  TStatToolkit::LTMUnbinned(np,y,yres,ltmCut);
-  if (!indY) return -1;
+  int *indY =  TStatToolkit::LTMUnbinned(np,y,yres,ltmCut,indcm);
+  if (!indY) {
+    delete[] ycmHeap;
+    delete[] indcmHeap;
+    return -1;
+  }
   // rearrange used events in increasing order
   TStatToolkit::Reorder(np,y,indY);
   TStatToolkit::Reorder(np,x,indY);
@@ -1974,10 +2110,6 @@ Float_t AliTPCDcalibRes::FitPoly1Robust(int np, float* x, float* y, float* res,
   float a,b;
   AliTPCDcalibRes::medFit(npuse, x+offs, y+offs, a, b, err);
   //
-  // don't abuse stack
-  float *ycmHeap=0,ycmStack[np<kMaxOnStack ? np:1],*ycm=np<kMaxOnStack ? &ycmStack[0] : (ycmHeap=new float[np]);
-  int   *indcmHeap=0,indcmStack[np<kMaxOnStack ? np:1],*indcm=np<kMaxOnStack ? &indcmStack[0] : (indcmHeap=new int[np]);
-  //  
   for (int i=np;i--;) ycm[i] = y[i]-(a+b*x[i]);
   TMath::Sort(np,ycm,indcm,kFALSE);
   TStatToolkit::Reorder(np,ycm,indcm);
@@ -1987,7 +2119,7 @@ Float_t AliTPCDcalibRes::FitPoly1Robust(int np, float* x, float* y, float* res,
   // robust estimate of sigma after crude slope correction
   float sigMAD = AliTPCDcalibRes::MAD2Sigma(npuse,ycm+offs);
   // find LTM estimate matching to sigMAD, keaping at least given fraction
-  indY = AliTPCDcalibRes::LTMUnbinnedSig(np, ycm, yres, sigMAD,0.5,kTRUE);
+  indY = AliTPCDcalibRes::LTMUnbinnedSig(np, ycm, yres, sigMAD,0.5,kTRUE,indcm);
   delete[] ycmHeap;
   delete[] indcmHeap;
   //
@@ -2008,7 +2140,11 @@ void AliTPCDcalibRes::ProcessVoxelResiduals(int np, float* tg, float *dy, float
   if (np<fMinEntriesVoxel) return;
   TVectorF zres(7);
   voxRes.flags = 0;
-  if (!TStatToolkit::LTMUnbinned(np,dz,zres,fLTMCut)) return; 
+  // don't abuse stack
+  int *indHeap=0,indStack[np<kMaxOnStack ? np:1],*ind=np<kMaxOnStack ? &indStack[0] : (indHeap=new int[np]);
+  int *indZ = TStatToolkit::LTMUnbinned(np,dz,zres,fLTMCut,ind);
+  delete[] indHeap;
+  if (!indZ) return; 
   //
   float ab[2],err[3];
   float sigMAD = FitPoly1Robust(np,tg,dy,ab,err,fLTMCut);
@@ -2600,7 +2736,7 @@ int AliTPCDcalibRes::DiffToMedLine(int np, const float* x, const float *y, const
 }
 
 //_________________________________________________________
-Int_t* AliTPCDcalibRes::LTMUnbinnedSig(int np, const float *arr, TVectorF &params , Float_t sigTgt, Float_t minFrac, Bool_t sorted)
+Int_t* AliTPCDcalibRes::LTMUnbinnedSig(int np, const float *arr, TVectorF &params , Float_t sigTgt, Float_t minFrac, Bool_t sorted, Int_t *index)
 {
   //
   // LTM : Trimmed keeping at most minFrac of unbinned array to reach targer sigma
@@ -2622,18 +2758,21 @@ Int_t* AliTPCDcalibRes::LTMUnbinnedSig(int np, const float *arr, TVectorF &param
   //             - 5 - first accepted element (of sorted array)
   //             - 6 - last accepted  element (of sorted array)
   //
-  // On success returns index of sorted events 
+  // On success returns index of sorted events: the user buffer index of at least np elements
+  // if provided (thread safe), otherwise the internal buffer
   //
-  static int *index = 0, book = 0;
-  static double* w = 0;
+  static int *indexB = 0, book = 0;
   params[0] = 0.0f;
-  if (book<np) {
-    delete[] index;
-    book = np;
-    index = new int[book];
-    delete[] w;
-    w = new double[book+book];
+  if (!index) {
+    if (book<np) {
+      delete[] indexB;
+      book = np;
+      indexB = new int[book];
+    }
+    index = indexB;
   }
+  // don't abuse stack
+  double *wHeap=0, wStack[2*np<kMaxOnStack ? 2*np:1], *w=2*np<kMaxOnStack ? &wStack[0] : (wHeap=new double[2*np]);
   //
   double *wx1 = w, *wx2 = wx1+np;
   if (!sorted) TMath::Sort(np,arr,index,kFALSE); // sort in increasing order
@@ -2654,7 +2793,10 @@ Int_t* AliTPCDcalibRes::LTMUnbinnedSig(int np, const float *arr, TVectorF &param
   while (1) {
     double minRMS = sum2+1e6;
     int keepN = (keepMax+keepMin)>>1;
-    if (keepN<2) return 0;
+    if (keepN<2) {
+      delete[] wHeap;
+      return 0;
+    }
     //
     params[0] = keepN;
     int limI = np - keepN+1;
@@ -2676,6 +2818,7 @@ Int_t* AliTPCDcalibRes::LTMUnbinnedSig(int np, const float *arr, TVectorF &param
     if (keepMin>=keepMax-1) break;
   }
   //
+  delete[] wHeap; // if any...
   if (!params[0]) return 0;
   params[2] = TMath::Sqrt(params[2]);
   params[3] = params[2]/TMath::Sqrt(params[0]); // error on mean
@@ -2785,13 +2928,8 @@ void AliTPCDcalibRes::medFit(int np, const float* x, const float* y, float &a, f
 float AliTPCDcalibRes::RoFunc(int np, const float* x, const float* y, float b, float &aa)
 {
   const float kEPS = 1.0e-7f; 
-  static float* arrTmp = 0;
-  static int nBook = 0;
-  if (np>nBook) { // make sure the buffer is ok
-    nBook = np;
-    delete[] arrTmp;
-    arrTmp = new float[nBook];
-  }
+  // don't abuse stack
+  float *arrTmpHeap=0, arrTmpStack[np<kMaxOnStack ? np:1], *arrTmp=np<kMaxOnStack ? &arrTmpStack[0] : (arrTmpHeap=new float[np]);
   float d,sum=0.0f;
   for (int j=np;j--;) arrTmp[j] = y[j]-b*x[j];
   //
@@ -2814,6 +2952,7 @@ float AliTPCDcalibRes::RoFunc(int np, const float* x, const float* y, float b, f
     if (y[j] != 0.0f) d /= TMath::Abs(y[j]);
     if (TMath::Abs(d) > kEPS) sum += (d >= 0.0f ? x[j] : -x[j]);
   }
+  delete[] arrTmpHeap; // if any...
   return sum;
 }
 
@@ -3197,6 +3336,8 @@ void AliTPCDcalibRes::WriteResTree()
   infoTree->Branch("tmaxCTPrun",&fTMaxCTP);
   infoTree->Branch("tminTBin",&fTMin);
   infoTree->Branch("tmaxTBin",&fTMax);
+  // real time of sector processing stages: load, fit, smooth, disp
+  infoTree->Branch("procTiming",fProcTiming,Form("procTiming[%d][%d]/F",kNSect2,kNProcStages));
   infoTree->Fill();
   //
   flOut->cd();
@@ -3351,6 +3492,44 @@ Bool_t AliTPCDcalibRes::FitPoly1(const float* x,const float* y, const float* w,
   return kTRUE;
 }
 
+//________________________________
+Bool_t AliTPCDcalibRes::SolveSymChol(int n, double* mat, double* rhs)
+{
+  // solve mat*x = rhs for symmetric positive-definite matrix given by its lower triangle
+  // stored row-wise (n*(n+1)/2 elements), the solution is returned in rhs.
+  // The mat is overwritten by its Cholesky decomposition. Same algorithm as AliSymMatrix::SolveChol
+  // but w/o its static buffer, so that it can be used concurrently
+  for (int i=0;i<n;i++) {
+    double *rowi = mat + i*(i+1)/2;
+    for (int j=i;j<n;j++) {
+      double *rowj = mat + j*(j+1)/2;
+      double sum = rowj[i];
+      for (int k=i-1;k>=0;k--) if (rowi[k]&&rowj[k]) sum -= rowi[k]*rowj[k];
+      if (i == j) {
+	if (sum <= 0.0) return kFALSE; // not positive-definite
+	rowi[i] = TMath::Sqrt(sum);
+      } 
+      else rowj[i] = sum/rowi[i];
+    }
+  }
+  //
+  for (int i=0;i<n;i++) {
+    const double *rowi = mat + i*(i+1)/2;
+    double sum = rhs[i];
+    for (int k=i-1;k>=0;k--) if (rowi[k]&&rhs[k]) sum -= rowi[k]*rhs[k];
+    rhs[i] = sum/rowi[i];
+  }
+  for (int i=n-1;i>=0;i--) {
+    double sum = rhs[i];
+    for (int k=i+1;k<n;k++) if (rhs[k]) {
+	double mki = mat[k*(k+1)/2+i]; 
+	if (mki) sum -= mki*rhs[k];
+      }
+    rhs[i] = sum/mat[i*(i+1)/2+i];
+  }
+  return kTRUE;
+}
+
 //________________________________
 Int_t AliTPCDcalibRes::ValidateVoxels(int isect)
 {
@@ -3388,6 +3567,9 @@ Int_t AliTPCDcalibRes::ValidateVoxels(int isect)
     //
     fValidFracXBin[isect][ix] = Float_t(nvalidXBin)/(fNY2XBins*fNZ2XBins);
     if (fValidFracXBin[isect][ix]<fMinValidVoxFracDrift) {
+#ifdef _OPENMP
+#pragma omp critical(AliTPCDcalibResLog)
+#endif
       AliWarningF("Sector%2d: Xbin%3d has %4.1f%% of voxels valid (%d out of %d)",
 		  isect,ix,100*fValidFracXBin[isect][ix],nvalidXBin,fNY2XBins*fNZ2XBins);
     }
@@ -3420,6 +3602,9 @@ Int_t AliTPCDcalibRes::ValidateVoxels(int isect)
   //
   fracBadRows /= fNXBins;
   if (fracBadRows>fMaxBadRowsPerSector) {
+#ifdef _OPENMP
+#pragma omp critical(AliTPCDcalibResLog)
+#endif
     AliWarningF("Sector%2d: Fraction of bad X-bins %.3f > %.3f: masking whole sector",
 		isect,fracBadRows,fMaxBadRowsPerSector);
     for (int ix=0;ix<fNXBins;ix++) SetXBinIgnored(isect,ix);
@@ -3452,6 +3637,9 @@ Int_t AliTPCDcalibRes::ValidateVoxels(int isect)
   }
   //
   int nMaskedRows = fXBinIgnore[isect].CountBits();
+#ifdef _OPENMP
+#pragma omp critical(AliTPCDcalibResLog)
+#endif
   AliInfoF("Sector%2d: Voxel stat: Masked: %5d(%07.3f%%) Invalid: %5d(%07.3f%%)  -> Masked %3d rows out of %3d",isect,
 	   cntMasked, 100*float(cntMasked)/fNGVoxPerSector,
 	   cntInvalid,100*float(cntInvalid)/fNGVoxPerSector,
@@ -3502,7 +3690,8 @@ Int_t AliTPCDcalibRes::Smooth0(int isect)
 Bool_t AliTPCDcalibRes::GetSmoothEstimate(int isect, float x, float p, float z, Int_t which, float *res, float *deriv)
 {
   // get smooth estimate of distortions mentioned in "which" bit pattern for point in sector coordinates (x,y/x,z/x)
-  // smoothing results also saved in the fLastSmoothingRes (allow derivative calculation)
+  // smoothing results also saved in the fLastSmoothingRes (allow derivative calculation) unless
+  // called concurrently from the parallel sector processing
   //
   int minPointsDir[kVoxDim]={0}; // min number of points per direction
   //
@@ -3523,9 +3712,10 @@ Bool_t AliTPCDcalibRes::GetSmoothEstimate(int isect, float x, float p, float z,
     }
   } 
   double cmat[kResDim][kMaxSmtDim*(kMaxSmtDim+1)/2];
-  static int maxNeighb = 10*10*10;
-  static bres_t **currClus = new bres_t*[maxNeighb];
-  static float* currCache = new float[maxNeighb*kVoxHDim];
+  double smtRes[kResDim*kMaxSmtDim];
+  // neighbours caches, local to allow concurrent smoothing of different sectors
+  std::vector<bres_t*> currClus;
+  std::vector<float> currCache;
   //
   //loop over neighbours which can contribute
   //
@@ -3544,7 +3734,7 @@ Bool_t AliTPCDcalibRes::GetSmoothEstimate(int isect, float x, float p, float z,
   int trial[kVoxDim]={0};
   while(1)  {
     //
-    memset(fLastSmoothingRes,0,kResDim*kMaxSmtDim*sizeof(double));
+    memset(smtRes,0,kResDim*kMaxSmtDim*sizeof(double));
     memset(cmat,0,kResDim*kMaxSmtDim*(kMaxSmtDim+1)/2*sizeof(double));
     //
     int nbOK=0; // accounted neighbours
@@ -3608,13 +3798,10 @@ Bool_t AliTPCDcalibRes::GetSmoothEstimate(int isect, float x, float p, float z,
     //
     // check if cache arrays should be expanded
     int nbCheck = (ixMx-ixMn+1)*(ipMx-ipMn+1)*(izMx-izMn+1);
-    if (nbCheck>=maxNeighb) { // need to expand caches
+    if (nbCheck>=int(currClus.size())) { // need to expand caches
       int mxNb = nbCheck+100;
-      delete[] currClus;
-      delete[] currCache;
-      currClus = new bres_t*[mxNb];
-      currCache= new float[mxNb*kVoxHDim];
-      maxNeighb = mxNb;
+      currClus.resize(mxNb);
+      currCache.resize(mxNb*kVoxHDim);
     }
     //
     for (int i=ixMx-ixMn+1;i--;) nOccX[i]=0;
@@ -3622,7 +3809,7 @@ Bool_t AliTPCDcalibRes::GetSmoothEstimate(int isect, float x, float p, float z,
     for (int i=izMx-izMn+1;i--;) nOccZ[i]=0;
     double u2Vec[3];
     //1st loop, check presence of enough points, cache precalculated values
-    float *cacheVal = currCache;
+    float *cacheVal = &currCache[0];
     for (int ix=ixMn;ix<=ixMx;ix++) {
       for (int ip=ipMn;ip<=ipMx;ip++) {
 	for (int iz=izMn;iz<=izMx;iz++) {
@@ -3678,6 +3865,9 @@ Bool_t AliTPCDcalibRes::GetSmoothEstimate(int isect, float x, float p, float z,
     }
     if (!enoughPoints) {
       if (!(incrDone[kVoxX]||incrDone[kVoxF]||incrDone[kVoxZ])) {
+#ifdef _OPENMP
+#pragma omp critical(AliTPCDcalibResLog)
+#endif
 	AliErrorF("Voxel Z:%d F:%d X:%d Trials limit reached: Z:%d F:%d X:%d",
 		  voxCen->bvox[kVoxZ],voxCen->bvox[kVoxF],voxCen->bvox[kVoxX],
 		  trial[kVoxZ],trial[kVoxF],trial[kVoxX]);
@@ -3694,7 +3884,7 @@ Bool_t AliTPCDcalibRes::GetSmoothEstimate(int isect, float x, float p, float z,
     }
     //
     // now fill the matrices and solve 
-    cacheVal = currCache;
+    cacheVal = &currCache[0];
     for (int ib=0;ib<nbOK;ib++) {
       double kernW = cacheVal[kVoxV];
       double dx=cacheVal[kVoxX], df=cacheVal[kVoxF], dz=cacheVal[kVoxZ],dx2=dx*dx, df2=df*df, dz2 = dz*dz;
@@ -3705,7 +3895,7 @@ Bool_t AliTPCDcalibRes::GetSmoothEstimate(int isect, float x, float p, float z,
 	double kernWD = kernW;
 	if (fUseErrInSmoothing) kernWD /= (voxNb->E[id]*voxNb->E[id]); // apart from the kernel value, account for the point error
 	double *cmatD = cmat[id];
-	double *rhsD = &fLastSmoothingRes[id*kMaxSmtDim];
+	double *rhsD = &smtRes[id*kMaxSmtDim];
 	//
 	double kernWDx=kernWD*dx, kernWDf=kernWD*df, kernWDz=kernWD*dz;
 	double kernWDx2=kernWDx*dx, kernWDf2=kernWDf*df, kernWDz2=kernWDz*dz;
@@ -3742,35 +3932,16 @@ Bool_t AliTPCDcalibRes::GetSmoothEstimate(int isect, float x, float p, float z,
     //
     Bool_t fitRes = kTRUE;
     //
-    // solve system of linear equations
-    AliSymMatrix mat(matSize);
+    // solve system of linear equations, cmat keeps the lower triangle of symmetric matrix row-wise
     for (int id=0;id<kResDim;id++) {
       if (!doDim[id]) continue;
-      mat.Reset();
-      double *cmatD = cmat[id];
-      double *rhsD = &fLastSmoothingRes[id*kMaxSmtDim];
-      int el=-1,elR=-1,row=-1;
-      mat(++row,0) = cmatD[++el];
-      mat(++row,0) = cmatD[++el];   mat(row,1) = cmatD[++el];
-      mat(++row,0) = cmatD[++el];   mat(row,1) = cmatD[++el];  mat(row,2) = cmatD[++el]; 
-      mat(++row,0) = cmatD[++el];   mat(row,1) = cmatD[++el];  mat(row,2) = cmatD[++el];  mat(row,3) = cmatD[++el];
-      // pol2 elements if needed
-      if (fSmoothPol2[kVoxX]) {
-	const int colLim = (++row)+1;
-	for (int col=0;col<colLim;col++) mat(row,col) = cmatD[++el];
-      }
-      if (fSmoothPol2[kVoxF]) {
-	const int colLim = (++row)+1;
-	for (int col=0;col<colLim;col++) mat(row,col) = cmatD[++el];
-      }
-      if (fSmoothPol2[kVoxZ]) {
-	const int colLim = (++row)+1;
-	for (int col=0;col<colLim;col++) mat(row,col) = cmatD[++el];
-      }
-      //
-      fitRes &= mat.SolveChol(rhsD);
+      double *rhsD = &smtRes[id*kMaxSmtDim];
+      fitRes &= SolveSymChol(matSize,cmat[id],rhsD);
       if (!fitRes) {
 	for (int i=kVoxDim;i--;) trial[i]++;
+#ifdef _OPENMP
+#pragma omp critical(AliTPCDcalibResLog)
+#endif
 	AliWarningF("Sector:%2d x=%.3f y/x=%.3f z/x=%.3f (iX:%d iY2X:%d iZ2X:%d)\n"
 		    "neighbours range used %d %d %d (tot: %d) | Steps: %.1f %.1f %.1f\n"
 		    "Solution for smoothing Failed, trying to increase filter bandwidth (trialXFZ: %d %d %d)",
@@ -3783,7 +3954,11 @@ Bool_t AliTPCDcalibRes::GetSmoothEstimate(int isect, float x, float p, float z,
     //
     break; // success
   } // end of loop over allowed trials
-  
+  //
+#ifdef _OPENMP
+  if (!omp_in_parallel())
+#endif
+  memcpy(fLastSmoothingRes,smtRes,kResDim*kMaxSmtDim*sizeof(double));
   return kTRUE;
 
 }
@@ -7,6 +7,7 @@
 #include <TFile.h>
 #include <TVectorF.h>
 #include <TVectorD.h>
+#include <TArrayS.h>
 #include <TString.h>
 #include <TMath.h>
 #include <TGeoGlobalMagField.h>
@@ -47,7 +48,8 @@ class AliTPCDcalibRes: public TNamed
   enum {kUseTRDonly,kUseTOFonly,kUseITSonly,kUseTRDorTOF,kNExtDetComb}; // which points to use
   enum {kSmtLinDim=4, kMaxSmtDim=7}; // max size of matrix for smoothing, for pol1 and pol2 options
   enum {kCtrITS,kCtrTRD,kCtrTOF,kCtrBC0,kCtrNtr,kCtrNbr}; // control branches for test stat
-  enum {kLargeTimeDiff=1000*3600,kMaxOnStack=10000};  // misc consts
+  enum {kLargeTimeDiff=1000*3600,kMaxOnStack=10000,kMaxPntSect=30000000};  // misc consts
+  enum {kStgLoad,kStgFit,kStgSmooth,kStgDisp,kNProcStages}; // sector processing stages for timing
 
   // the voxels are defined in following space
   enum {kVoxZ,   // Z/X sector coordinates
@@ -135,6 +137,23 @@ class AliTPCDcalibRes: public TNamed
     dcTst_t() {memset(this,0,sizeof(dcTst_t));}
   };
 
+  struct vres_t {  // compressed residuals of one voxel
+    TArrayS data;     // dy,dz,tgSlp triplets, dy,dz in units of kMaxResid/0x7fff, tgSlp of kMaxTgSlp/0x7fff
+    Int_t   n;        // stored points
+    Int_t   nSeen;    // offered points, exceeds n once the reservoir is full
+    //
+    vres_t() : data(),n(0),nSeen(0) {}
+  };
+
+  struct sres_t {  // residuals of a sector grouped by geometric voxel, replaces the local tree
+    vres_t   *vox;    // [nvox] residuals per voxel
+    Int_t     nvox;   // number of voxels
+    Int_t     n;      // total stored points
+    ULong64_t seed;   // state of the reservoir sampling generator
+    //
+    sres_t() {memset(this,0,sizeof(sres_t));}
+  };
+
  public:
 
   AliTPCDcalibRes(int run=0,Long64_t tmin=0,Long64_t tmax=9999999999,const char* resList=0);
@@ -173,6 +192,10 @@ class AliTPCDcalibRes: public TNamed
   void ReProcessResiduals();
   void ProcessDispersions();
   void ProcessSectorResiduals(int is);
+  Int_t  LoadSectorResiduals(int is, sres_t &res);
+  void   InitSectorResiduals(sres_t &res);
+  Bool_t AddSectorResidual(sres_t &res, float dy, float dz, float tgSlp, UShort_t gbin);
+  void   ResetSectorResiduals(sres_t &res);
   void ReProcessSectorResiduals(int is);
   void ProcessSectorDispersions(int is);
   void ProcessVoxelResiduals(int np, float* tg, float *dy, float *dz, bres_t& voxRes);
@@ -214,10 +237,11 @@ class AliTPCDcalibRes: public TNamed
   static float   RoFunc(int np, const float* x, const float* y, float b, float &aa);
   static Float_t SelKthMin(int k, int np, float* arr);
   static void    medFit(int np, const float* x, const float* y, float &a, float &b, float *err=0, float delI=0.f);
-  static Int_t*  LTMUnbinnedSig(int np, const float *arr, TVectorF &params , Float_t sigTgt, Float_t minFrac=0.7, Bool_t sorted=kFALSE);
+  static Int_t*  LTMUnbinnedSig(int np, const float *arr, TVectorF &params , Float_t sigTgt, Float_t minFrac=0.7, Bool_t sorted=kFALSE, Int_t *index=0);
   static Float_t MAD2Sigma(int np, float* y);
   static Bool_t  FitPoly2(const float* x,const float* y, const float* w, int np, float *res, float *err=0);
   static Bool_t  FitPoly1(const float* x,const float* y, const float* w, int np, float *res, float *err=0);
+  static Bool_t  SolveSymChol(int n, double* mat, double* rhs);
   static Bool_t  GetTruncNormMuSig(double a, double b, double &mean, double &sig);
   static void    TruncNormMod(double a, double b, double mu0, double sig0, double &muCf, double &sigCf);
   static Double_t GetLogL(TH1F* histo, int bin0, int bin1, double &mu, double &sig, double &logL0);
@@ -231,6 +255,7 @@ class AliTPCDcalibRes: public TNamed
   
 
   Int_t   Smooth0(int isect);
+  void    PrintProcTiming(int nThreads, double realTime) const;
   void    BringToActiveBoundary(int sect36, float xyz[3]) const;
   Bool_t  GetSmoothEstimate(int isect, float x, float p, float z, int which, float *res, float *deriv=0);
   Bool_t  GradValSmooth(int sect36, float x, float y, float z,float val[AliTPCDcalibRes::kResDim],
@@ -320,6 +345,15 @@ class AliTPCDcalibRes: public TNamed
   void     SetMaxRMSLong(float v=0.8)            {fMaxRMSLong = v;}
   void     SetMaxRejFrac(float v=0.15)           {fMaxRejFrac = v;}
   void     SetFilterOutliers(Bool_t v=kTRUE)     {fFilterOutliers = v;}
+  // Streaming keeps the binned residuals of all sectors in memory until they are processed,
+  // 6 bytes per point, up to kMaxPntSect points per sector (~13 GB for 72 full sectors,
+  // up to twice that with the growth reserve of the voxel buffers). With the default
+  // SetMaxPointsVoxel(0) all points are kept: for large inputs bound the memory by a
+  // per-voxel reservoir, e.g. SetMaxPointsVoxel(500). ProcessDispersions needs the
+  // local sector trees and is not available in this mode
+  void     SetStreamResiduals(Bool_t v=kTRUE)    {fStreamResiduals = v;}
+  void     SetMaxPointsVoxel(int n=0)            {fMaxPointsVoxel = n;}
+  void     SetNThreads(int n=1)                  {fNThreads = n;}
 
   void     SetMaxFitYErr2(float v=1.0)           {fMaxFitYErr2 = v;}
   void     SetMaxFitXErr2(float v=9.0)           {fMaxFitXErr2 = v;}
@@ -381,6 +415,10 @@ class AliTPCDcalibRes: public TNamed
   Float_t  GetMaxRMSLong()                  const {return fMaxRMSLong;}
   Float_t  GetMaxRejFrac()                  const {return fMaxRejFrac;}
   Bool_t   GetFilterOutliers()              const {return fFilterOutliers;}
+  Bool_t   GetStreamResiduals()             const {return fStreamResiduals;}
+  Int_t    GetMaxPointsVoxel()              const {return fMaxPointsVoxel;}
+  Int_t    GetNThreads()                    const {return fNThreads;}
+  Float_t  GetProcTiming(int sect, int stg) const {return fProcTiming[sect][stg];}
   Int_t    GetExternalDetectors()           const {return fExtDet;}
   void     SetExternalDetectors(int det=kUseTRDonly);
 
@@ -449,6 +487,9 @@ class AliTPCDcalibRes: public TNamed
   Int_t    fLearnSize;     // event to learn for the cache
   Float_t  fBz;            // B field
   Bool_t   fDeleteSectorTrees; // delete residuals trees once statistics tree is done
+  Bool_t   fStreamResiduals;   // keep the binned residuals in memory instead of the local per-sector trees
+  Int_t    fMaxPointsVoxel;    // max residuals per voxel used for the fits (reservoir sampling), 0: all
+  Int_t    fNThreads;          // threads for concurrent sector processing, 0: all available
   TString  fResidualList;  // text file with list of residuals tree
   TObjArray* fInputChunks;  // list of input files used
   TString  fOCDBPath;      // ocdb path
@@ -532,6 +573,7 @@ class AliTPCDcalibRes: public TNamed
   TH2F*    fHVDTimeCorr;     // histo used for vdrift time correction fit
   Float_t  fValidFracXBin[kNSect2][kNPadRows]; // fraction of voxels valid per padrow
   Int_t    fNSmoothingFailedBins[kNSect2];     // number of failed bins/sector, should be 0 to produce parameterization
+  Float_t  fProcTiming[kNSect2][kNProcStages]; // real time (s) of the sector processing stages
   TBits    fXBinIgnore[kNSect2];    // flag to ignore Xbin
   Float_t  fLumiCOG;                // COG lumi for timebin
   TGraph*  fLumiCTPGraph;           // lumi graph from CTP
@@ -544,6 +586,8 @@ class AliTPCDcalibRes: public TNamed
   TTree* fStatTree;                      //! tree with voxels statistics
   TTree* fTmpTree[kNSect2];              //! IO tree per sector
   TFile* fTmpFile[kNSect2];              //! file for fTmpTree
+  sres_t fSectRes[kNSect2];              //! binned residuals per sector in the streaming mode
+  Bool_t fResInMemory;                   //! fSectRes filled by CollectData, to be used instead of the local trees
   THnF*  fStatHist[kNSect2];             //! histos for statistics bins
   TNDArrayT<float> *fArrNDStat[kNSect2]; //! alias arrays for fast access to fStatHist
   //
@@ -602,11 +646,12 @@ class AliTPCDcalibRes: public TNamed
   static const char* kResName[];
   static const char* kModeName[];
   static const char* kExtDetName[];
+  static const char* kStgName[];
   
   static const Float_t kTPCRowX[]; // X of the pad-row
   static const Float_t kTPCRowDX[]; // pitch in X
 
-  ClassDef(AliTPCDcalibRes,17);
+  ClassDef(AliTPCDcalibRes,19);
 };
 
 //________________________________________________________________
@@ -0,0 +1,527 @@
+/**************************************************************************
+ * Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved. *
+ *                                                                        *
+ * Author: The ALICE Off-line Project.                                    *
+ * Contributors are mentioned in the code where appropriate.              *
+ *                                                                        *
+ * Permission to use, copy, modify and distribute this software and its   *
+ * documentation strictly for non-commercial purposes is hereby granted   *
+ * without fee, provided that the above copyright notice appears in all   *
+ * copies and that both the copyright notice and this permission notice   *
+ * appear in the supporting documentation. The authors make no claims     *
+ * about the suitability of this software for any purpose. It is          *
+ * provided "as is" without express or implied warranty.                  *
+ **************************************************************************/
+
+/* $Id$ */
+
+/// \class AliTPCSparseAccumulator
+///
+///   Sparse N-dimensional accumulator replacing a dense THn during the filling
+///
+///   The bins are addressed by the packed global bin of THn: bin 0 and
+///   nbins+1 of every axis are the under- and overflow, the last dimension
+///   runs fastest, so the global bins computed for the THn array can be
+///   used directly. Only the filled bins are stored, as sorted global bins
+///   and float contents (12 bytes per filled bin instead of 4 bytes per bin
+///   of the full grid), in blocks of at most fBlockSize bins.
+///
+///   The fills are appended to a buffer, which is sorted, summed per bin and
+///   merged into the filled bins when full or on Flush. The buffer grows
+///   with the number of filled bins (at least fBufferSize, at most a quarter
+///   of the filled bins), to keep the cost of the merge proportional to the
+///   number of fills. A merge rewrites one block at a time, a block which
+///   grows beyond fBlockSize is split, so the merge needs only the memory of
+///   one block in addition.
+///
+///   Merging of accumulators (Add, Merge used by hadd) is a linear merge of
+///   the sorted bins. The dense THn is meant to be created with FillTHn or
+///   CreateTHn once, after the filling and the merging of the outputs.
+///
+/// ~~~{.cpp}
+/// AliTPCSparseAccumulator acc(*his);  // binning of THn *his
+/// acc.AddBinContent(globalBin,weight);
+/// acc.Fill(x,weight);
+/// acc.FillTHn(his);
+/// ~~~
+
+#include "TError.h"
+#include "TMath.h"
+#include "TAxis.h"
+#include "TCollection.h"
+#include "THn.h"
+#include "AliTPCSparseAccumulator.h"
+#include <algorithm>
+
+
+/// \cond CLASSIMP
+ClassImp(AliTPCSparseAccumulatorBlock)
+ClassImp(AliTPCSparseAccumulator)
+/// \endcond
+
+namespace {
+  const Int_t kDefaultBufferSize = 1<<20;
+  const Int_t kDefaultBlockSize = 1<<17;
+  // sort of the buffered fills by global bin only
+  Bool_t LessBin(const std::pair<ULong64_t,Float_t> &a, const std::pair<ULong64_t,Float_t> &b)
+  {
+    return a.first<b.first;
+  }
+}
+
+AliTPCSparseAccumulator::AliTPCSparseAccumulator()
+                        :TNamed(),
+                         fNdim(0),
+                         fNbins(),
+                         fXmin(),
+                         fXmax(),
+                         fStride(),
+                         fAxisNames(),
+                         fBlocks(),
+                         fNFilled(0),
+                         fBlockSize(kDefaultBlockSize),
+                         fBufferSize(kDefaultBufferSize),
+                         fFlushSize(kDefaultBufferSize),
+                         fBuffer()
+{
+  /// default constructor
+
+  fAxisNames.SetOwner(kTRUE);
+  fBlocks.SetOwner(kTRUE);
+}
+
+AliTPCSparseAccumulator::AliTPCSparseAccumulator(const char *name, const char *title, Int_t ndim, const Int_t *nbins,
+                                                 const Double_t *xmin, const Double_t *xmax)
+                        :TNamed(name,title),
+                         fNdim(0),
+                         fNbins(),
+                         fXmin(),
+                         fXmax(),
+                         fStride(),
+                         fAxisNames(),
+                         fBlocks(),
+                         fNFilled(0),
+                         fBlockSize(kDefaultBlockSize),
+                         fBufferSize(kDefaultBufferSize),
+                         fFlushSize(kDefaultBufferSize),
+                         fBuffer()
+{
+  /// accumulator with ndim dimensions of nbins in [xmin,xmax)
+
+  fAxisNames.SetOwner(kTRUE);
+  fBlocks.SetOwner(kTRUE);
+  Init(ndim,nbins,xmin,xmax);
+}
+
+AliTPCSparseAccumulator::AliTPCSparseAccumulator(const THn &his)
+                        :TNamed(his.GetName(),his.GetTitle()),
+                         fNdim(0),
+                         fNbins(),
+                         fXmin(),
+                         fXmax(),
+                         fStride(),
+                         fAxisNames(),
+                         fBlocks(),
+                         fNFilled(0),
+                         fBlockSize(kDefaultBlockSize),
+                         fBufferSize(kDefaultBufferSize),
+                         fFlushSize(kDefaultBufferSize),
+                         fBuffer()
+{
+  /// accumulator with the binning and the axis names of the histogram,
+  /// only fixed bin widths are supported
+
+  fAxisNames.SetOwner(kTRUE);
+  fBlocks.SetOwner(kTRUE);
+  Int_t ndim = his.GetNdimensions();
+  TArrayI nbins(ndim);
+  TArrayD xmin(ndim), xmax(ndim);
+  for (Int_t idim=0; idim<ndim; idim++) {
+    const TAxis *axis = his.GetAxis(idim);
+    if (axis->GetXbins()->GetSize()) ::Warning("AliTPCSparseAccumulator","axis %d of %s has variable bins, fixed bins are used",
+                                              idim,his.GetName());
+    nbins[idim] = axis->GetNbins();
+    xmin[idim] = axis->GetXmin();
+    xmax[idim] = axis->GetXmax();
+  }
+  Init(ndim,nbins.GetArray(),xmin.GetArray(),xmax.GetArray());
+  for (Int_t idim=0; idim<ndim; idim++) SetAxisName(idim,his.GetAxis(idim)->GetName(),his.GetAxis(idim)->GetTitle());
+}
+
+AliTPCSparseAccumulator::AliTPCSparseAccumulator(const AliTPCSparseAccumulator &acc)
+                        :TNamed(acc),
+                         fNdim(acc.fNdim),
+                         fNbins(acc.fNbins),
+                         fXmin(acc.fXmin),
+                         fXmax(acc.fXmax),
+                         fStride(acc.fStride),
+                         fAxisNames(),
+                         fBlocks(),
+                         fNFilled(acc.fNFilled),
+                         fBlockSize(acc.fBlockSize),
+                         fBufferSize(acc.fBufferSize),
+                         fFlushSize(acc.fFlushSize),
+                         fBuffer(acc.fBuffer)
+{
+  /// copy constructor
+
+  fAxisNames.SetOwner(kTRUE);
+  fBlocks.SetOwner(kTRUE);
+  for (Int_t idim=0; idim<acc.fAxisNames.GetEntriesFast(); idim++)
+    fAxisNames.AddAtAndExpand(acc.fAxisNames.UncheckedAt(idim) ? acc.fAxisNames.UncheckedAt(idim)->Clone() : 0, idim);
+  CopyBlocks(acc.fBlocks);
+}
+
+AliTPCSparseAccumulator &AliTPCSparseAccumulator::operator=(const AliTPCSparseAccumulator &acc)
+{
+  /// assignment operator
+
+  if (this==&acc) return *this;
+  TNamed::operator=(acc);
+  fNdim = acc.fNdim;
+  fNbins = acc.fNbins;
+  fXmin = acc.fXmin;
+  fXmax = acc.fXmax;
+  fStride = acc.fStride;
+  fAxisNames.Clear();
+  for (Int_t idim=0; idim<acc.fAxisNames.GetEntriesFast(); idim++)
+    fAxisNames.AddAtAndExpand(acc.fAxisNames.UncheckedAt(idim) ? acc.fAxisNames.UncheckedAt(idim)->Clone() : 0, idim);
+  CopyBlocks(acc.fBlocks);
+  fNFilled = acc.fNFilled;
+  fBlockSize = acc.fBlockSize;
+  fBufferSize = acc.fBufferSize;
+  fFlushSize = acc.fFlushSize;
+  fBuffer = acc.fBuffer;
+  return *this;
+}
+
+void AliTPCSparseAccumulator::CopyBlocks(const TObjArray &blocks)
+{
+  /// replace the blocks by copies of blocks
+
+  fBlocks.Delete();
+  for (Int_t ib=0; ib<blocks.GetEntriesFast(); ib++)
+    fBlocks.AddLast(new AliTPCSparseAccumulatorBlock(*(const AliTPCSparseAccumulatorBlock*)blocks.UncheckedAt(ib)));
+}
+
+void AliTPCSparseAccumulator::Init(Int_t ndim, const Int_t *nbins, const Double_t *xmin, const Double_t *xmax)
+{
+  /// set binning, the global bin steps are the THn ones (+2 for under/overflow)
+
+  fNdim = ndim;
+  fNbins.Set(ndim,nbins);
+  fXmin.Set(ndim,xmin);
+  fXmax.Set(ndim,xmax);
+  fStride.Set(ndim);
+  if (ndim<=0) return;
+  fStride.fArray[ndim-1] = 1;
+  for (Int_t idim=ndim-1; idim--;) fStride.fArray[idim] = fStride.fArray[idim+1]*(fNbins.fArray[idim+1]+2);
+  Double_t nTotal = 1.;
+  for (Int_t idim=0; idim<ndim; idim++) nTotal *= fNbins.fArray[idim]+2.;
+  if (nTotal>=TMath::Power(2.,63)) ::Error("AliTPCSparseAccumulator::Init","%g bins exceed the packed global bin",nTotal);
+}
+
+void AliTPCSparseAccumulator::SetAxisName(Int_t dim, const char *name, const char *title)
+{
+  /// name and title of the axis dim, used by CreateTHn
+
+  if (dim<0 || dim>=fNdim) return;
+  delete fAxisNames.RemoveAt(dim);
+  fAxisNames.AddAtAndExpand(new TNamed(name,title ? title : name),dim);
+}
+
+ULong64_t AliTPCSparseAccumulator::GetBin(const Double_t *x) const
+{
+  /// packed global bin of the point x
+
+  ULong64_t bin = 0;
+  for (Int_t idim=0; idim<fNdim; idim++) {
+    Int_t ib;
+    if (x[idim]<fXmin.fArray[idim]) ib = 0; // underflow
+    else if (x[idim]<fXmax.fArray[idim]) {
+      ib = 1+Int_t((x[idim]-fXmin.fArray[idim])*fNbins.fArray[idim]/(fXmax.fArray[idim]-fXmin.fArray[idim]));
+      if (ib>fNbins.fArray[idim]) ib = fNbins.fArray[idim];
+    }
+    else ib = fNbins.fArray[idim]+1; // overflow
+    bin += ib*fStride.fArray[idim];
+  }
+  return bin;
+}
+
+ULong64_t AliTPCSparseAccumulator::GetBin(const Int_t *idx) const
+{
+  /// packed global bin of the axis bins idx (0 - underflow)
+
+  ULong64_t bin = 0;
+  for (Int_t idim=0; idim<fNdim; idim++) bin += idx[idim]*fStride.fArray[idim];
+  return bin;
+}
+
+void AliTPCSparseAccumulator::GetBinIndex(ULong64_t bin, Int_t *idx) const
+{
+  /// axis bins of the packed global bin
+
+  for (Int_t idim=0; idim<fNdim; idim++) {
+    idx[idim] = Int_t(bin/fStride.fArray[idim]);
+    bin -= idx[idim]*fStride.fArray[idim];
+  }
+}
+
+void AliTPCSparseAccumulator::Flush()
+{
+  /// sort the buffered fills, sum them per bin and merge them into the
+  /// filled bins
+
+  Long64_t nBuf = fBuffer.size();
+  if (nBuf) {
+    std::sort(fBuffer.begin(),fBuffer.end(),LessBin);
+    Long64_t nUnique = 0;
+    for (Long64_t i=1; i<nBuf; i++) {
+      if (fBuffer[i].first==fBuffer[nUnique].first) fBuffer[nUnique].second += fBuffer[i].second;
+      else fBuffer[++nUnique] = fBuffer[i];
+    }
+    nUnique++;
+    TArrayL64 bins(nUnique);
+    TArrayF contents(nUnique);
+    for (Long64_t i=0; i<nUnique; i++) {
+      bins.fArray[i] = fBuffer[i].first;
+      contents.fArray[i] = fBuffer[i].second;
+    }
+    fBuffer.clear();
+    MergeSorted(nUnique,bins.fArray,contents.fArray);
+  }
+  fFlushSize = TMath::Max(Long64_t(fBufferSize),fNFilled/4);
+  if (Long64_t(fBuffer.capacity())>2*fFlushSize) std::vector<std::pair<ULong64_t,Float_t> >().swap(fBuffer);
+}
+
+void AliTPCSparseAccumulator::MergeSorted(Long64_t n, const Long64_t *bins, const Float_t *contents)
+{
+  /// add n sorted unique bins with contents to the filled bins. Each block is
+  /// merged with the new bins below the first bin of the next block (the last
+  /// block with the rest) into blocks of at most fBlockSize bins, which
+  /// replace it
+
+  if (n<=0) return;
+  TObjArray blocks(fBlocks.GetEntriesFast()+Int_t(n/fBlockSize)+1);
+  Int_t nOldBlocks = fBlocks.GetEntriesFast();
+  Long64_t j = 0;
+  for (Int_t ib=0; ib<nOldBlocks || (ib==0 && j<n); ib++) {
+    AliTPCSparseAccumulatorBlock *block = ib<nOldBlocks ? (AliTPCSparseAccumulatorBlock*)fBlocks.UncheckedAt(ib) : 0;
+    Long64_t jEnd = n;
+    if (ib+1<nOldBlocks) {
+      Long64_t nextFirst = ((AliTPCSparseAccumulatorBlock*)fBlocks.UncheckedAt(ib+1))->GetFirstBin();
+      jEnd = (j<n && bins[j]<nextFirst) ? std::lower_bound(bins+j,bins+n,nextFirst)-bins : j;
+    }
+    if (jEnd==j) {
+      blocks.AddLast(block);
+      continue;
+    }
+    // size of the merged block
+    Long64_t nOld = block ? block->GetN() : 0;
+    const Long64_t *oldBins = block ? block->fBins.fArray : 0;
+    const Float_t *oldContents = block ? block->fContents.fArray : 0;
+    Long64_t nMerged = nOld+jEnd-j;
+    for (Long64_t i=0, jj=j; i<nOld && jj<jEnd;) {
+      if (oldBins[i]<bins[jj]) i++;
+      else if (bins[jj]<oldBins[i]) jj++;
+      else {
+        nMerged--;
+        i++;
+        jj++;
+      }
+    }
+    fNFilled += nMerged-nOld;
+    // merge into nPieces blocks of equal size
+    Long64_t nPieces = (nMerged+fBlockSize-1)/fBlockSize;
+    Long64_t pieceSize = (nMerged+nPieces-1)/nPieces;
+    Long64_t i = 0;
+    for (Long64_t iPiece=0; iPiece<nPieces; iPiece++) {
+      Int_t size = Int_t(TMath::Min(pieceSize,nMerged-iPiece*pieceSize));
+      AliTPCSparseAccumulatorBlock *piece = new AliTPCSparseAccumulatorBlock(size);
+      Long64_t *newBins = piece->fBins.fArray;
+      Float_t *newContents = piece->fContents.fArray;
+      for (Int_t k=0; k<size; k++) {
+        if (j<jEnd && (i>=nOld || bins[j]<oldBins[i])) {
+          newBins[k] = bins[j];
+          newContents[k] = contents[j++];
+        }
+        else if (j>=jEnd || oldBins[i]<bins[j]) {
+          newBins[k] = oldBins[i];
+          newContents[k] = oldContents[i++];
+        }
+        else {
+          newBins[k] = oldBins[i];
+          newContents[k] = oldContents[i++]+contents[j++];
+        }
+      }
+      blocks.AddLast(piece);
+    }
+    delete block;
+  }
+  // the old blocks are either kept in blocks or deleted
+  fBlocks.SetOwner(kFALSE);
+  fBlocks.Clear();
+  fBlocks.SetOwner(kTRUE);
+  for (Int_t ib=0; ib<blocks.GetEntriesFast(); ib++) fBlocks.AddLast(blocks.UncheckedAt(ib));
+}
+
+Float_t AliTPCSparseAccumulator::GetBinContent(ULong64_t bin) const
+{
+  /// content of the packed global bin including the buffered fills
+
+  Float_t content = 0;
+  // last block starting at or below bin
+  Int_t low = 0, high = fBlocks.GetEntriesFast();
+  while (high-low>1) {
+    Int_t mid = (low+high)/2;
+    if (GetBlock(mid)->GetFirstBin()<=Long64_t(bin)) low = mid;
+    else high = mid;
+  }
+  if (low<fBlocks.GetEntriesFast()) {
+    const AliTPCSparseAccumulatorBlock *block = GetBlock(low);
+    const Long64_t *pos = std::lower_bound(block->GetBins(),block->GetBins()+block->GetN(),Long64_t(bin));
+    if (pos<block->GetBins()+block->GetN() && *pos==Long64_t(bin)) content = block->GetContents()[pos-block->GetBins()];
+  }
+  for (size_t i=0; i<fBuffer.size(); i++) if (fBuffer[i].first==bin) content += fBuffer[i].second;
+  return content;
+}
+
+Long64_t AliTPCSparseAccumulator::GetMemorySize() const
+{
+  /// return size of object in bytes including the buffer
+
+  return sizeof(*this)+fBlocks.GetEntriesFast()*sizeof(AliTPCSparseAccumulatorBlock)
+    +fNFilled*(sizeof(Long64_t)+sizeof(Float_t))
+    +fBuffer.capacity()*sizeof(std::pair<ULong64_t,Float_t>);
+}
+
+Bool_t AliTPCSparseAccumulator::IsCompatible(const AliTPCSparseAccumulator &acc) const
+{
+  /// check for the same binning
+
+  if (fNdim!=acc.fNdim) return kFALSE;
+  for (Int_t idim=0; idim<fNdim; idim++) {
+    if (fNbins.fArray[idim]!=acc.fNbins.fArray[idim]) return kFALSE;
+    if (!TMath::AreEqualRel(fXmin.fArray[idim],acc.fXmin.fArray[idim],1e-10) ||
+        !TMath::AreEqualRel(fXmax.fArray[idim],acc.fXmax.fArray[idim],1e-10)) return kFALSE;
+  }
+  return kTRUE;
+}
+
+Bool_t AliTPCSparseAccumulator::IsCompatible(const THn &his) const
+{
+  /// check for the same binning as the histogram
+
+  if (fNdim!=his.GetNdimensions()) return kFALSE;
+  for (Int_t idim=0; idim<fNdim; idim++) {
+    const TAxis *axis = his.GetAxis(idim);
+    if (fNbins.fArray[idim]!=axis->GetNbins()) return kFALSE;
+    if (!TMath::AreEqualRel(fXmin.fArray[idim],axis->GetXmin(),1e-10) ||
+        !TMath::AreEqualRel(fXmax.fArray[idim],axis->GetXmax(),1e-10)) return kFALSE;
+  }
+  return kTRUE;
+}
+
+Bool_t AliTPCSparseAccumulator::Add(const AliTPCSparseAccumulator &acc)
+{
+  /// add contents of accumulator with the same binning, the buffered fills
+  /// of acc are added to the buffer
+
+  if (!IsCompatible(acc)) {
+    ::Error("AliTPCSparseAccumulator::Add","binning of %s differs from %s",acc.GetName(),GetName());
+    return kFALSE;
+  }
+  if (&acc==this) {
+    for (Int_t ib=0; ib<fBlocks.GetEntriesFast(); ib++) {
+      TArrayF &contents = ((AliTPCSparseAccumulatorBlock*)fBlocks.UncheckedAt(ib))->fContents;
+      for (Int_t i=0; i<contents.fN; i++) contents.fArray[i] *= 2;
+    }
+    for (size_t i=0; i<fBuffer.size(); i++) fBuffer[i].second *= 2;
+    return kTRUE;
+  }
+  for (Int_t ib=0; ib<acc.GetNBlocks(); ib++) {
+    const AliTPCSparseAccumulatorBlock *block = acc.GetBlock(ib);
+    MergeSorted(block->GetN(),block->GetBins(),block->GetContents());
+  }
+  fBuffer.insert(fBuffer.end(),acc.fBuffer.begin(),acc.fBuffer.end());
+  if (Long64_t(fBuffer.size())>=fFlushSize) Flush();
+  return kTRUE;
+}
+
+Long64_t AliTPCSparseAccumulator::Merge(TCollection *list)
+{
+  /// merge accumulators of the list
+  /// Returns the number of filled bins, -1 in case of error
+
+  if (!list) return 0;
+  if (list->IsEmpty()) return fNFilled;
+  TIter next(list);
+  TObject *obj;
+  while ((obj=next())) {
+    AliTPCSparseAccumulator *acc = dynamic_cast<AliTPCSparseAccumulator*>(obj);
+    if (!acc) {
+      ::Error("AliTPCSparseAccumulator::Merge","object %s of class %s can not be merged",obj->GetName(),obj->ClassName());
+      return -1;
+    }
+    if (!Add(*acc)) return -1;
+  }
+  Flush();
+  return fNFilled;
+}
+
+Bool_t AliTPCSparseAccumulator::FillTHn(THn *his) const
+{
+  /// add the contents to the histogram of the same binning, the array of
+  /// the histogram is allocated only here
+
+  if (!his || !IsCompatible(*his)) {
+    ::Error("AliTPCSparseAccumulator::FillTHn","histogram %s missing or of different binning",his ? his->GetName():"");
+    return kFALSE;
+  }
+  TNDArray &arr = his->GetArray();
+  for (Int_t ib=0; ib<fBlocks.GetEntriesFast(); ib++) {
+    const AliTPCSparseAccumulatorBlock *block = GetBlock(ib);
+    for (Int_t i=0; i<block->GetN(); i++) arr.AddAt(block->GetBins()[i],block->GetContents()[i]);
+  }
+  for (size_t i=0; i<fBuffer.size(); i++) arr.AddAt(fBuffer[i].first,fBuffer[i].second);
+  return kTRUE;
+}
+
+THnF *AliTPCSparseAccumulator::CreateTHn(const char *name) const
+{
+  /// create THnF with the contents, name of the accumulator by default
+
+  THnF *his = new THnF(name ? name : GetName(),GetTitle(),fNdim,fNbins.fArray,fXmin.fArray,fXmax.fArray);
+  for (Int_t idim=0; idim<fNdim && idim<fAxisNames.GetEntriesFast(); idim++) {
+    const TObject *axisName = fAxisNames.UncheckedAt(idim);
+    if (!axisName) continue;
+    his->GetAxis(idim)->SetName(axisName->GetName());
+    his->GetAxis(idim)->SetTitle(axisName->GetTitle());
+  }
+  FillTHn(his);
+  return his;
+}
+
+void AliTPCSparseAccumulator::Clear(Option_t *)
+{
+  /// remove all contents, the binning is kept
+
+  fBlocks.Delete();
+  fNFilled = 0;
+  std::vector<std::pair<ULong64_t,Float_t> >().swap(fBuffer);
+  fFlushSize = fBufferSize;
+}
+
+void AliTPCSparseAccumulator::Print(Option_t *) const
+{
+  /// print binning and occupancy
+
+  printf("AliTPCSparseAccumulator %s: %d dimensions, %lld filled bins of %lld (%.3g%%) in %d blocks, %lld buffered, %.1f MB (dense THnF %.1f MB)\n",
+         GetName(),fNdim,GetNFilledBins(),GetNbinsTotal(),GetNbinsTotal()>0 ? 100.*fNFilled/GetNbinsTotal():0.,
+         GetNBlocks(),Long64_t(fBuffer.size()),GetMemorySize()/1024./1024.,GetNbinsTotal()*sizeof(Float_t)/1024./1024.);
+  for (Int_t idim=0; idim<fNdim; idim++) {
+    const TObject *axisName = idim<fAxisNames.GetEntriesFast() ? fAxisNames.UncheckedAt(idim) : 0;
+    printf("  %d %-10s %5d bins [%g,%g)\n",idim,axisName ? axisName->GetName():"",
+           fNbins.fArray[idim],fXmin.fArray[idim],fXmax.fArray[idim]);
+  }
+}
@@ -0,0 +1,124 @@
+#ifndef ALITPCSPARSEACCUMULATOR_H
+#define ALITPCSPARSEACCUMULATOR_H
+/* Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved. *
+ * See cxx source for full Copyright notice                               */
+
+/* $Id$ */
+
+/// \class AliTPCSparseAccumulator
+///
+///  Sparse N-dimensional accumulator of weights with the binning of a THn,
+///  only the filled bins are kept as sorted packed global bins and contents,
+///  in blocks of limited size. Converted to THn only when the filling and
+///  the merging are finished.
+
+#include <vector>
+#include <utility>
+#include <TNamed.h>
+#include <TArrayI.h>
+#include <TArrayD.h>
+#include <TArrayF.h>
+#include <TArrayL64.h>
+#include <TObjArray.h>
+
+class TCollection;
+class THn;
+class THnF;
+
+/// \class AliTPCSparseAccumulatorBlock
+///
+///  Block of sorted filled bins of AliTPCSparseAccumulator
+
+class AliTPCSparseAccumulatorBlock : public TObject {
+public:
+  AliTPCSparseAccumulatorBlock(Int_t n=0) : TObject(), fBins(n), fContents(n) {}
+  virtual ~AliTPCSparseAccumulatorBlock() {}
+
+  Long64_t GetN() const {return fBins.fN;}
+  Long64_t GetFirstBin() const {return fBins.fArray[0];}
+  const Long64_t *GetBins() const {return fBins.fArray;}
+  const Float_t  *GetContents() const {return fContents.fArray;}
+
+private:
+  friend class AliTPCSparseAccumulator;
+  TArrayL64 fBins;        ///< sorted global bins with content
+  TArrayF   fContents;    ///< content of the bins in fBins
+
+  /// \cond CLASSIMP
+  ClassDef(AliTPCSparseAccumulatorBlock,1)
+  /// \endcond
+};
+
+class AliTPCSparseAccumulator : public TNamed {
+public:
+  AliTPCSparseAccumulator();
+  AliTPCSparseAccumulator(const char *name, const char *title, Int_t ndim, const Int_t *nbins,
+                          const Double_t *xmin, const Double_t *xmax);
+  AliTPCSparseAccumulator(const THn &his); // binning, names and titles of the histogram
+  AliTPCSparseAccumulator(const AliTPCSparseAccumulator &acc);
+  AliTPCSparseAccumulator &operator=(const AliTPCSparseAccumulator &acc);
+  virtual ~AliTPCSparseAccumulator() {}
+
+  void      SetBufferSize(Int_t size) {fBufferSize = size>0 ? size : 1;}
+  Int_t     GetBufferSize() const {return fBufferSize;}
+  void      SetBlockSize(Int_t size) {fBlockSize = size>1 ? size : 2;}  // filled bins per block, for new blocks
+  Int_t     GetBlockSize() const {return fBlockSize;}
+  void      SetAxisName(Int_t dim, const char *name, const char *title=0);
+
+  Int_t     GetNdimensions() const {return fNdim;}
+  Int_t     GetNbins(Int_t dim) const {return fNbins.fArray[dim];}
+  Double_t  GetXmin(Int_t dim) const {return fXmin.fArray[dim];}
+  Double_t  GetXmax(Int_t dim) const {return fXmax.fArray[dim];}
+  Long64_t  GetStride(Int_t dim) const {return fStride.fArray[dim];} // step of the global bin for one bin in dim
+  Long64_t  GetNbinsTotal() const {return fNdim>0 ? fStride.fArray[0]*(fNbins.fArray[0]+2) : 0;}
+
+  ULong64_t GetBin(const Double_t *x) const;  // packed global bin as in THn, 0 and nbins+1 are under/overflow
+  ULong64_t GetBin(const Int_t *idx) const;   // packed global bin of the axis bins
+  void      GetBinIndex(ULong64_t bin, Int_t *idx) const;
+
+  void      Fill(const Double_t *x, Float_t w=1.) {AddBinContent(GetBin(x),w);}
+  void      AddBinContent(ULong64_t bin, Float_t w=1.) {
+    fBuffer.push_back(std::make_pair(bin,w));
+    if (Long64_t(fBuffer.size())>=fFlushSize) Flush();
+  }
+  void      Flush();      // sort and add the buffered fills to the filled bins
+  Float_t   GetBinContent(ULong64_t bin) const;
+
+  Long64_t  GetNFilledBins() const {return fNFilled;}
+  Int_t     GetNBlocks() const {return fBlocks.GetEntriesFast();}
+  const AliTPCSparseAccumulatorBlock *GetBlock(Int_t i) const {return (const AliTPCSparseAccumulatorBlock*)fBlocks.UncheckedAt(i);}
+  Long64_t  GetMemorySize() const;  // bytes in use including the buffer
+
+  Bool_t    IsCompatible(const AliTPCSparseAccumulator &acc) const;
+  Bool_t    IsCompatible(const THn &his) const;
+  Bool_t    Add(const AliTPCSparseAccumulator &acc);
+  Long64_t  Merge(TCollection *list);
+  Bool_t    FillTHn(THn *his) const;  // add the contents to a histogram of the same binning
+  THnF     *CreateTHn(const char *name=0) const;
+  virtual void Clear(Option_t *option="");
+  virtual void Print(Option_t *option="") const;
+
+private:
+  void      Init(Int_t ndim, const Int_t *nbins, const Double_t *xmin, const Double_t *xmax);
+  void      MergeSorted(Long64_t n, const Long64_t *bins, const Float_t *contents);
+  void      CopyBlocks(const TObjArray &blocks);
+
+  Int_t     fNdim;        ///< number of dimensions
+  TArrayI   fNbins;       ///< number of bins per dimension, without under/overflow
+  TArrayD   fXmin;        ///< lower edge per dimension
+  TArrayD   fXmax;        ///< upper edge per dimension
+  TArrayL64 fStride;      ///< global bin step per dimension, last dimension fastest as in THn
+  TObjArray fAxisNames;   ///< axis names and titles (TNamed)
+  TObjArray fBlocks;      ///< filled bins, AliTPCSparseAccumulatorBlock in ascending order of the bins
+  Long64_t  fNFilled;     ///< number of filled bins
+  Int_t     fBlockSize;   ///< maximal number of filled bins of a block
+  Int_t     fBufferSize;  ///< minimal number of buffered fills before sorting
+  Long64_t  fFlushSize;   //!<! current buffer size triggering Flush, grows with the filled bins
+  std::vector<std::pair<ULong64_t,Float_t> > fBuffer;  //!<! fills not yet sorted
+
+  /// \cond CLASSIMP
+  ClassDef(AliTPCSparseAccumulator,1)
+  /// \endcond
+};
+
+#endif
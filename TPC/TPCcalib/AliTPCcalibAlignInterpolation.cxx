@@ -58,6 +58,7 @@
 #include "AliTPCRecoParam.h"
 #include "AliTPCreco.h"
 #include "AliTPCcalibAlignInterpolation.h"
+#include "AliTPCSparseAccumulator.h"
 #include "AliPID.h"
 #include "AliCDBManager.h"
 #include "AliMagF.h"
@@ -817,14 +818,11 @@ void  AliTPCcalibAlignInterpolation::CreateDistortionMapsFromFile(const char * i
   // Create distortion maps from residual histograms
   // TPC cluster to ITS, ITS-TRD and ITS-TOF track fits
   //
+  // The histograms are taken one after the other, created from the accumulators
+  // if FillHistogramsFromChain wrote only those
+  //
   TFile *fHistos  = TFile::Open(inputFile);
-  
-  THnF *histoITS = (THnF*) fHistos->Get("deltaRPhiTPCITS");
-  THnF *histoITSTRD= (THnF*) fHistos->Get("deltaRPhiTPCITSTRD");
-  THnF *histoITSTOF = (THnF*) fHistos->Get("deltaRPhiTPCITSTOF");
-  THnF *histoITSZ = (THnF*) fHistos->Get("deltaZTPCITS");
-  THnF *histoITSTRDZ= (THnF*) fHistos->Get("deltaZTPCITSTRD");
-  THnF *histoITSTOFZ = (THnF*) fHistos->Get("deltaZTPCITSTOF");
+  const char *hisNames[6]={"deltaRPhiTPCITS","deltaRPhiTPCITSTRD","deltaRPhiTPCITSTOF","deltaZTPCITS","deltaZTPCITSTRD","deltaZTPCITSTOF"};
   
   TTreeSRedirector * pcstream = new TTreeSRedirector(outputFile,"recreate");
   
@@ -835,16 +833,63 @@ void  AliTPCcalibAlignInterpolation::CreateDistortionMapsFromFile(const char * i
   projectionInfo(3,0)=2;  projectionInfo(3,1)=0;  projectionInfo(3,2)=1;
   projectionInfo(4,0)=1;  projectionInfo(4,1)=0;  projectionInfo(4,2)=1;
   
-  TStatToolkit::MakeDistortionMap(4, histoITS,    pcstream, projectionInfo); 
-  TStatToolkit::MakeDistortionMap(4, histoITSTRD, pcstream, projectionInfo); 
-  TStatToolkit::MakeDistortionMap(4, histoITSTOF, pcstream, projectionInfo); 
-  TStatToolkit::MakeDistortionMap(4, histoITSZ,    pcstream, projectionInfo); 
-  TStatToolkit::MakeDistortionMap(4, histoITSTRDZ, pcstream, projectionInfo); 
-  TStatToolkit::MakeDistortionMap(4, histoITSTOFZ, pcstream, projectionInfo); 
+  for (Int_t ihis=0; ihis<6; ihis++){
+    THnF *histo = GetResidualHistogram(fHistos, hisNames[ihis]);
+    if (!histo) continue;
+    TStatToolkit::MakeDistortionMap(4, histo, pcstream, projectionInfo); 
+    delete histo;
+  }
   delete pcstream;
+  delete fHistos;
   //
 }
 
+THnF* AliTPCcalibAlignInterpolation::GetResidualHistogram(TDirectory *dir, const char *name){
+  //
+  // Residual histogram name of the directory. If only the accumulator (<name>Accumulator)
+  // was written by FillHistogramsFromChain, the histogram is created from it; this is
+  // meant to be done once, after the merging of the outputs of the jobs
+  // The histogram is owned by the caller
+  //
+  if (!dir) return 0;
+  TObject *obj = dir->Get(name);
+  THnF *his = dynamic_cast<THnF*>(obj);
+  if (his) return his;
+  delete obj;
+  AliTPCSparseAccumulator *accumulator = dynamic_cast<AliTPCSparseAccumulator*>(dir->Get(TString::Format("%sAccumulator",name).Data()));
+  if (!accumulator) {
+    ::Error("AliTPCcalibAlignInterpolation::GetResidualHistogram","Neither histogram nor accumulator %s in %s",name,dir->GetName());
+    return 0;
+  }
+  accumulator->Print();
+  his = accumulator->CreateTHn(name);
+  delete accumulator;
+  AliSysInfo::AddStamp("GetResidualHistogram",Int_t(his->GetNbins()>>20));
+  return his;
+}
+
+void AliTPCcalibAlignInterpolation::MakeResidualHistograms(const char * inputFile, const char *outputFile){
+  //
+  // Write the residual histograms (THnF) of the (merged) accumulators of inputFile to outputFile,
+  // for the consumers of the dense histograms
+  //
+  TFile *fin = TFile::Open(inputFile);
+  if (!fin) return;
+  TFile *fout = TFile::Open(outputFile,"recreate");
+  const char *hisNames[6]={"deltaRPhiTPCITS","deltaRPhiTPCITSTRD","deltaRPhiTPCITSTOF","deltaZTPCITS","deltaZTPCITSTRD","deltaZTPCITSTOF"};
+  for (Int_t ihis=0; ihis<6; ihis++){
+    if (!fin->GetListOfKeys()->FindObject(hisNames[ihis]) &&
+        !fin->GetListOfKeys()->FindObject(TString::Format("%sAccumulator",hisNames[ihis]).Data())) continue;
+    THnF *his = GetResidualHistogram(fin, hisNames[ihis]);
+    if (!his) continue;
+    fout->cd();
+    his->Write();
+    delete his;
+  }
+  delete fout;
+  delete fin;
+}
+
 void    AliTPCcalibAlignInterpolation::FillHistogramsFromChain(const char * residualList, Double_t dy, Double_t dz, 
 							       Int_t startTime, Int_t stopTime, Int_t maxStat, 
 							       Int_t selHis,const char * residualInfoFile,
@@ -852,7 +897,18 @@ void    AliTPCcalibAlignInterpolation::FillHistogramsFromChain(const char * resi
   /**
    * Trees with point-track residuals to residual histogram
    * @param residualList  text file with tree list
-   * Output - ResidualHistograms.root file with hitogram within AliTPCcalibAlignInterpolation object
+   * Output - ResidualHistograms.root file with the residual accumulators (AliTPCSparseAccumulator, <histogram name>Accumulator),
+   *          merged with hadd and converted to the histograms with GetResidualHistogram/MakeResidualHistograms.
+   *          With the environment variable writeResidualTHn=1 also the histograms are written (memory of the full grid)
+   *
+   * Format change: by default the file contains only the <histogram name>Accumulator objects, not the THnF under
+   * <histogram name> (e.g. deltaRPhiTPCITSTRD). Scripts reading the THnF by name from ResidualHistograms.root
+   * have to be migrated to
+   *   THnF *his = AliTPCcalibAlignInterpolation::GetResidualHistogram(file, "deltaRPhiTPCITSTRD");
+   * which returns the THnF if it is stored and creates it from the accumulator otherwise (the caller owns it),
+   * or convert the (merged) file once to the old layout:
+   *   AliTPCcalibAlignInterpolation::MakeResidualHistograms("ResidualHistograms.root", "ResidualHistogramsTHn.root");
+   * Setting writeResidualTHn=1 restores the old output, the THnF are written next to the accumulators.
    */
   //
   //
@@ -869,6 +925,15 @@ void    AliTPCcalibAlignInterpolation::FillHistogramsFromChain(const char * resi
     cacheLearnEntries = TString(gSystem->Getenv("cacheLearnEntriesProjection")).Atoi();
   }
   Printf("************* cacheSize = %d, autoCache = %d, cacheLearnEntries = %d", cacheSize, (Int_t)autoCache, cacheLearnEntries);
+  // residuals are accumulated in sparse form and written as accumulators, the THn is made after the merging
+  Int_t accumulatorBufferSize = 1<<20;
+  if (gSystem->Getenv("residualAccumulatorBufferSize")) {
+    accumulatorBufferSize = TString(gSystem->Getenv("residualAccumulatorBufferSize")).Atoi();
+  }
+  Bool_t writeTHn = kFALSE; // write also the dense THn, needs the memory of the full grid
+  if (gSystem->Getenv("writeResidualTHn")) {
+    writeTHn = Bool_t(TString(gSystem->Getenv("writeResidualTHn")).Atoi());
+  }
 
   const Int_t kNDim1 = kNDim-1;
   const Double_t kernelSigma2I[4]={1./0.25,1./0.25,1./0.25,1./0.25};  // inverse kernel sigma in bin width units
@@ -990,6 +1055,8 @@ void    AliTPCcalibAlignInterpolation::FillHistogramsFromChain(const char * resi
     if (selHis>=0 && ihis!=selHis) continue;
     Double_t binWidth[4]={0};
     for (Int_t idim=0; idim<4; idim++) binWidth[idim]=hisToFill[ihis]->GetAxis(idim)->GetBinWidth(1);
+    AliTPCSparseAccumulator accumulator(*hisToFill[ihis]); // same global bins as the THn array
+    accumulator.SetBufferSize(accumulatorBufferSize);
     for (Int_t iesd=0; iesd<nesd; iesd++){
       TStopwatch timerFile;
       TString fileNameString(esdArray->At(iesd)->GetName());
@@ -1068,7 +1135,6 @@ void    AliTPCcalibAlignInterpolation::FillHistogramsFromChain(const char * resi
       double bsize[kNDim],bsizeI[kNDim],limMin[kNDim],limMax[kNDim];
       nBProd[kNDim1] = 1;
       THn* curHis = hisToFill[ihis];
-      TNDArrayT<float>& arrND = (TNDArrayT<float>&)curHis->GetArray(); // for direct access
       for (int i=kNDim;i--;) {
 	TAxis* ax = curHis->GetAxis(i);
 	limMin[i] = ax->GetXmin();
@@ -1197,10 +1263,10 @@ void    AliTPCcalibAlignInterpolation::FillHistogramsFromChain(const char * resi
 	    else if (deltaITSUse<limMax[kDelt]) binDeltITS = 1+int((deltaITSUse - limMin[kDelt])*bsizeI[kDelt]); // range
 	    else binDeltITS = nBinDim[kDelt]+1; // oveflow
 	    Long64_t binToFillITS = binToFill + (binDeltITS-binIndex[kDelt])*nBProd[kDelt]; // global bin for ITS
-	    arrND.At(binToFillITS) += kFillGapITS;	    // curHis->Fill(xxx,kFillGapITS);
+	    accumulator.AddBinContent(binToFillITS,kFillGapITS);	    // curHis->Fill(xxx,kFillGapITS);
 	    xxx[kDelt] = deltaRefUse;
 	  }
-	  arrND.At(binToFill) += 1.; // curHis->Fill(xxx,1.);
+	  accumulator.AddBinContent(binToFill,1.); // curHis->Fill(xxx,1.);
 
 	  Double_t dbinCenter[kNDim];	  
 	  for (Int_t idim=kNDim;idim--;) {
@@ -1241,7 +1307,7 @@ void    AliTPCcalibAlignInterpolation::FillHistogramsFromChain(const char * resi
 		// Looping is over, fill histo
 		Double_t weightAll= 2.*(dz2x+dqpt); // 2.*(dz2x+dqpt+dsec+dlocx);
 		weightAll = weightAll>kMaxExpArg ? kFillGap : kFillGap+TMath::Exp(-weightAll);
-		arrND.At(binToFill) += weightAll; // curHis->Fill(...)
+		accumulator.AddBinContent(binToFill,weightAll); // curHis->Fill(...)
 		if (fillCounter==0) printf("Start to Fill\n");
 		fillCounter++;
 	      }
@@ -1257,6 +1323,9 @@ void    AliTPCcalibAlignInterpolation::FillHistogramsFromChain(const char * resi
 	}
       }
       tree->PrintCacheStats();
+      accumulator.Flush();
+      accumulator.Print();
+      AliSysInfo::AddStamp("FillHistogramsFromChain.File",ihis,iesd,Int_t(accumulator.GetMemorySize()>>20));
 
       timerFile.Print();
       delete tree;
@@ -1264,7 +1333,15 @@ void    AliTPCcalibAlignInterpolation::FillHistogramsFromChain(const char * resi
       
     }    
     fout->GetFile()->cd();
-    hisToFill[ihis]->Write();
+    accumulator.Flush();
+    accumulator.Print();
+    AliSysInfo::AddStamp("FillHistogramsFromChain.Accumulator",ihis,Int_t(accumulator.GetNFilledBins()>>20),Int_t(accumulator.GetMemorySize()>>20));
+    accumulator.Write(TString::Format("%sAccumulator",hisToFill[ihis]->GetName()).Data());
+    if (writeTHn) {
+      accumulator.FillTHn(hisToFill[ihis]);
+      AliSysInfo::AddStamp("FillHistogramsFromChain.FillTHn",ihis,Int_t(hisToFill[ihis]->GetNbins()>>20));
+      hisToFill[ihis]->Write();
+    }
   }
   AliSysInfo::AddStamp("FillHistogramsFromChain.END",2,1);
   if (hisTime) hisTime->Write();
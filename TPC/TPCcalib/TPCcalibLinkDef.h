@@ -23,6 +23,8 @@
 
 #pragma link C++ class AliTPCcalibCalib+;          // Re-applying calib on cluster level - refitting of the tracks
 #pragma link C++ class AliTPCcalibAlignInterpolation+; // time dependent TPC space point distortion calibration using external detector interpolation
+#pragma link C++ class AliTPCSparseAccumulator+;  // sparse accumulator of the residual histograms, converted to THn at the end
+#pragma link C++ class AliTPCSparseAccumulatorBlock+; // block of filled bins of AliTPCSparseAccumulator
 #pragma link C++ class AliTPCcalibAlign-;          // (Sector)-alignment calibration 
                                                    //   Histogram cluster to track residuals in order to create later on distortion maps
                                                    // --- update documentation (current documentation is obsolete)
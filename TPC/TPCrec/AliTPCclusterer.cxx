@@ -67,6 +67,7 @@
 #include "AliRawReader.h"
 #include "AliRunLoader.h"
 #include "AliSimDigits.h"
+#include "AliSparseDigits.h"
 #include "AliTPCCalPad.h"
 #include "AliTPCCalROC.h"
 #include "AliTPCClustersRow.h"
@@ -750,7 +751,8 @@ void AliTPCclusterer::Digits2Clusters()
   AliTPCCalPad * gainTPC = AliTPCcalibDB::Instance()->GetPadGainFactor();
   AliTPCCalPad * noiseTPC = AliTPCcalibDB::Instance()->GetPadNoise();
   AliSimDigits digarr, *dummy=&digarr;
-  fRowDig = dummy;
+  AliSparseDigits sparse;  // digits and labels of the row without expanding the buffers
+  fRowDig = &sparse;
   fInput->GetBranch("Segment")->SetAddress(&dummy);
   Stat_t nentries = fInput->GetEntries();
   
@@ -797,12 +799,13 @@ void AliTPCclusterer::Digits2Clusters()
     fNSigBins = 0;
     memset(fBins,0,sizeof(Float_t)*fMaxBin);
     
-    if (digarr.First()) //MI change
+    sparse.Set(digarr);
+    if (sparse.First()) //MI change
       do {
-	Float_t dig=digarr.CurrentDigit();
+	Float_t dig=sparse.CurrentDigit();
 	if (dig<=fParam->GetZeroSup()) continue;
-	Int_t j=digarr.CurrentRow()+3, i=digarr.CurrentColumn()+3;
-        Float_t gain = gainROC->GetValue(row,digarr.CurrentColumn());
+	Int_t j=sparse.CurrentRow()+3, i=sparse.CurrentColumn()+3;
+        Float_t gain = gainROC->GetValue(row,sparse.CurrentColumn());
 	Int_t bin = i*fMaxTime+j;
 	if (gain>0){
 	  fBins[bin]=dig/gain;
@@ -810,8 +813,7 @@ void AliTPCclusterer::Digits2Clusters()
 	  fBins[bin]=0;
 	}
 	fSigBins[fNSigBins++]=bin;
-      } while (digarr.Next());
-    digarr.ExpandTrackBuffer();
+      } while (sparse.Next());
 
     FindClusters(noiseROC);
     FillRow();
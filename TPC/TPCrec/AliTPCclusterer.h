@@ -25,7 +25,7 @@ class AliTPCRecoParam;
 class AliTPCclusterMI;
 class AliTPCClustersRow;
 class AliRawReader;
-class AliSimDigits;
+class AliSparseDigits;
 class TTree;
 class TTreeSRedirector;
 class  AliRawEventHeaderBase;
@@ -101,7 +101,7 @@ private:
   TObjArray *fOutputArray;     //! output TObjArray with pointers arrays of cluster
   TClonesArray *fOutputClonesArray; //! output TClonesArray with clusters
   AliTPCClustersRow * fRowCl;  //! current cluster row
-  AliSimDigits * fRowDig;      //! current digits row
+  AliSparseDigits * fRowDig;   //! current digits row with track labels
   const AliTPCParam * fParam;        //! tpc parameters
   Int_t fNcluster;             // number of clusters - for given row
   Int_t fNclusters;            // tot number of clusters
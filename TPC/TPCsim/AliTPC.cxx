@@ -46,6 +46,7 @@
 #include <TParticle.h>
 #include <TROOT.h>
 #include <TRandom.h>
+#include <TRandom3.h>
 #include <TStopwatch.h>
 #include <TString.h>
 #include <TSystem.h>     
@@ -73,6 +74,7 @@
 #include "AliMC.h"
 #include "AliStack.h"
 #include "AliTPCDigitizer.h"
+#include "AliTPCFastResponse.h"
 #include "AliTPCBuffer.h"
 #include "AliTPCDDLRawData.h"
 #include "AliLog.h"
@@ -92,6 +94,9 @@
 
 // for fast TMatrix operator()
 #include "AliFastContainerAccess.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 ClassImp(AliTPC) 
 //_____________________________________________________________________________
@@ -113,7 +118,11 @@ ClassImp(AliTPC)
                    fGainFactor(1.),
                    fDebugStreamer(0),
                    fLHCclockPhaseSw(0),
-		   fIsGEM(0)
+		   fIsGEM(0),
+		   fNThreads(1),
+		   fDigitizationSeed(0),
+		   fBatchedTransport(kFALSE),
+		   fFastResponse(0)
 
 {
   //
@@ -150,7 +159,11 @@ AliTPC::AliTPC(const char *name, const char *title)
                    fGainFactor(1.),
                    fDebugStreamer(0),
     fLHCclockPhaseSw(0),
-    fIsGEM(0)
+    fIsGEM(0),
+    fNThreads(1),
+    fDigitizationSeed(0),
+    fBatchedTransport(kFALSE),
+    fFastResponse(0)
                   
 {
   //
@@ -235,6 +248,7 @@ AliTPC::~AliTPC()
   delete [] fNoiseTable;
   delete [] fActiveSectors;
   if (fDebugStreamer) delete fDebugStreamer;
+  delete fFastResponse;
 }
 
 //_____________________________________________________________________________
@@ -1628,6 +1642,8 @@ void AliTPC::Hits2Digits(Int_t eventnumber)
     transform->SetCurrentMapFluctStrenght(strFluct);
   }
   //
+  if (fNThreads!=1 && !fDebugStreamer) Hits2DigitsSectors(eventnumber);
+  else
   for(Int_t isec=0;isec<fTPCParam->GetNSector();isec++) 
     if (IsSectorActive(isec)) {
       AliDebug(1,Form("Hits2Digits: Sector %d is active.",isec));
@@ -1730,6 +1746,8 @@ void AliTPC::Hits2SDigits2(Int_t eventnumber)
     transform->SetCurrentMapFluctStrenght(strFluct);
   }
   
+  if (fNThreads!=1 && !fDebugStreamer) Hits2DigitsSectors(eventnumber);
+  else
   for(Int_t isec=0;isec<fTPCParam->GetNSector();isec++) 
     if (IsSectorActive(isec)) {
       Hits2DigitsSector(isec);
@@ -1779,6 +1797,63 @@ void AliTPC::Hits2SDigits()
   }    
 }
 //_____________________________________________________________________________
+void AliTPC::SetFastResponse(AliTPCFastResponse *response)
+{
+  //
+  // parametrized response for MakeFastClusters, owned by the TPC
+  //
+  if (response!=fFastResponse) delete fFastResponse;
+  fFastResponse = response;
+}
+//_____________________________________________________________________________
+AliTPCFastResponse* AliTPC::GetFastResponse()
+{
+  //
+  // parametrized response for MakeFastClusters, the default if not set
+  //
+  if (!fFastResponse) fFastResponse = new AliTPCFastResponse("TPCFastResponse","TPC parametrized response");
+  return fFastResponse;
+}
+//_____________________________________________________________________________
+Bool_t AliTPC::MakeFastClusters()
+{
+  //-----------------------------------------------------------
+  //   clusters directly from the track references with the
+  //   parametrized response, no digitization
+  //-----------------------------------------------------------
+
+  if (!fTPCParam->IsGeoRead()){
+    //
+    // read transformation matrices for gGeoManager
+    //
+    fTPCParam->ReadGeoMatrices();
+  }
+
+  AliRunLoader* runLoader = fLoader->GetRunLoader();
+  if (runLoader->LoadTrackRefs("read")) {
+    AliError("Can not load the track references");
+    return kFALSE;
+  }
+  runLoader->LoadKinematics("read");
+  fLoader->LoadRecPoints("recreate");
+  AliTPCFastResponse *response = GetFastResponse();
+  response->SetParam(fTPCParam);
+
+  for (Int_t iEvent = 0; iEvent < runLoader->GetNumberOfEvents(); iEvent++) {
+    runLoader->GetEvent(iEvent);
+    fLoader->MakeRecPointsContainer();
+    TTree *treeR = fLoader->TreeR();
+    Int_t nclusters = response->MakeClusters(runLoader->TreeTR(),runLoader->Stack(),treeR);
+    AliInfo(Form("Event %d: %d fast clusters",iEvent,nclusters));
+    fLoader->WriteRecPoints("OVERWRITE");
+  }
+
+  fLoader->UnloadRecPoints();
+  runLoader->UnloadTrackRefs();
+  runLoader->UnloadKinematics();
+  return kTRUE;
+}
+//_____________________________________________________________________________
 
 void AliTPC::Hits2DigitsSector(Int_t isec)
 {
@@ -1827,11 +1902,14 @@ void AliTPC::Hits2DigitsSector(Int_t isec)
       AliFatal("Tree not set in fDigitsArray");
     }
 
+    AliTPCRowWorkspace ws;
+    InitRowWorkspace(ws,fCurrentNoise);
+
     for (i=0;i<nrows;i++){
       
       AliDigits * dig = fDigitsArray->CreateRow(isec,i); 
 
-      DigitizeRow(i,isec,row);
+      DigitizeRow(i,isec,row,dig,ws);
 
       fDigitsArray->StoreRow(isec,i);
 
@@ -1845,6 +1923,7 @@ void AliTPC::Hits2DigitsSector(Int_t isec)
 
    
     } // end of the sector digitization
+    fCurrentNoise=ws.fNoise;
 
     for(i=0;i<nrows+2;i++){
       row[i]->Delete();  
@@ -1856,9 +1935,155 @@ void AliTPC::Hits2DigitsSector(Int_t isec)
 
 } // end of Hits2DigitsSector
 
+//_____________________________________________________________________________
+void AliTPC::Hits2DigitsSectors(Int_t eventnumber)
+{
+  //-------------------------------------------------------------------
+  // Conversion of all active sectors on fNThreads threads.
+  // The hits are read and transformed in sequence for a group of
+  // sectors, with one pass over the hit tree per group. The electron
+  // transport and the row digitization of the sectors of a group run
+  // in parallel, each sector with an own random generator and row
+  // buffers. The rows are stored in the order of the sectors.
+  //-------------------------------------------------------------------
+
+  if(fDefaults == 0) SetDefaults();
+
+  TTree *tH = fLoader->TreeH(); // pointer to the hits tree
+  if (tH == 0x0) {
+    AliFatal("Can not find TreeH in folder");
+    return;
+  }
+  if (fDigitsArray->GetTree()==0) {
+    AliFatal("Tree not set in fDigitsArray");
+  }
+
+  Int_t nThreads=1;
+#ifdef _OPENMP
+  nThreads = fNThreads>0 ? fNThreads : omp_get_max_threads();
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,6,0)
+  if (nThreads>1) ROOT::EnableThreadSafety();
+#endif
+#endif
+  UInt_t seed = fDigitizationSeed;
+  if (seed==0) seed = gRandom->Integer(kMaxUInt);
+  AliDebug(1,Form("Hits2Digits: %d threads, seed %u",nThreads,seed));
+
+  std::vector<Int_t> sectors;
+  for(Int_t isec=0;isec<fTPCParam->GetNSector();isec++)
+    if (IsSectorActive(isec)) sectors.push_back(isec);
+
+  TBranch * branch=0;
+  if (fHitType>1) branch = tH->GetBranch("TPC2");
+  else branch = tH->GetBranch("TPC");
+  Stat_t ntracks = tH->GetEntries();
+
+  AliTPCRowWorkspace wsDefault;
+  InitRowWorkspace(wsDefault,0);
+
+  const Int_t groupSize = 2*nThreads;
+  for (Int_t first=0; first<(Int_t)sectors.size(); first+=groupSize) {
+    Int_t nGroup = TMath::Min(groupSize,(Int_t)sectors.size()-first);
+    std::vector<AliTPCSectorSetup> setups(nGroup);
+    std::vector<std::vector<AliTPCSectorHit> > hits(nGroup);
+    std::vector<Int_t> slot(fTPCParam->GetNSector(),-1);
+    for (Int_t i=0;i<nGroup;i++) {
+      SetupSector(sectors[first+i],setups[i]);
+      slot[sectors[first+i]]=i;
+    }
+
+    //
+    // read and transform the hits of the group, no random numbers are
+    // drawn here, the attachment of single electron hits is left to the
+    // sector generators
+    //
+    AliTPCSectorHit hit;
+    for(Int_t track=0;track<ntracks;track++){
+      ResetHits();
+      Bool_t isInGroup=kFALSE;
+      for (Int_t i=0;i<nGroup && !isInGroup;i++) isInGroup=TrackInVolume(setups[i].fSector,track);
+      if (!isInGroup) continue;
+      branch->GetEntry(track);
+      for (AliTPChit *tpcHit=(AliTPChit*)FirstHit(-1); tpcHit; tpcHit=(AliTPChit*)NextHit()) {
+	Int_t sector=tpcHit->fSector;
+	if (sector<0 || sector>=(Int_t)slot.size() || slot[sector]<0) continue;
+	if (!TransformHit(setups[slot[sector]],tpcHit,hit,0)) continue;
+	hits[slot[sector]].push_back(hit);
+      }
+    }
+
+    //
+    // transport and digitization, sector random generators
+    //
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nThreads) schedule(dynamic,1) ordered
+#endif
+    for (Int_t i=0;i<nGroup;i++) {
+      const AliTPCSectorSetup &setup=setups[i];
+      Int_t isec=setup.fSector;
+      Int_t nrows=setup.fNRows;
+      UInt_t sectorSeed=seed^(2654435761U*(UInt_t)(eventnumber*fTPCParam->GetNSector()+isec+1));
+      TRandom3 rnd(sectorSeed==0 ? 1 : sectorSeed); // 0 would be a time based seed
+
+      TObjArray **row=new TObjArray* [nrows+2]; // 2 extra rows for cross talk
+      AliTPCSectorElectrons electrons;
+      OpenElectrons(nrows,row,electrons);
+      for (UInt_t ihit=0;ihit<hits[i].size();ihit++) {
+	const AliTPCSectorHit &sectorHit=hits[i][ihit];
+	if (sectorHit.fQ==1 && rnd.Rndm(0)<sectorHit.fAttProb) continue; // the only electron is lost!
+	AddElectrons(setup,sectorHit,electrons,&rnd,0);
+      }
+      CloseElectrons(nrows,electrons);
+      std::vector<AliTPCSectorHit>().swap(hits[i]);
+
+      AliTPCRowWorkspace ws(wsDefault);
+      ws.fNoise = fNoiseDepth>0 ? rnd.Integer(fNoiseDepth) : 0;
+      std::vector<AliDigits*> digits(nrows);
+      for (Int_t irow=0;irow<nrows;irow++) {
+	digits[irow]=fDigitsArray->NewRow(isec,irow);
+	DigitizeRow(irow,isec,row,digits[irow],ws);
+	fDigitsArray->CompressRow(digits[irow]);
+      }
+      for(Int_t j=0;j<nrows+2;j++){
+	row[j]->Delete();
+	delete row[j];
+      }
+      delete [] row;
+
+#ifdef _OPENMP
+#pragma omp ordered
+#endif
+      {
+	for (Int_t irow=0;irow<nrows;irow++) {
+	  AliDebug(10,
+		   Form("*** Sector, row, compressed digits %d %d %d ***\n",
+			isec,irow,digits[irow]->GetDigitSize()));
+	  fDigitsArray->StoreRow(digits[irow]);
+	}
+      }
+    }
+  }
+} // end of Hits2DigitsSectors
+
 
 //_____________________________________________________________________________
-void AliTPC::DigitizeRow(Int_t irow,Int_t isec,TObjArray **rows)
+void AliTPC::InitRowWorkspace(AliTPCRowWorkspace &ws, Int_t noise) const
+{
+  //
+  // response buffers, noise position and LHC clock phase for DigitizeRow
+  //
+  for (Int_t i=0;i<4;i++) ws.fIndex[i]=0;
+  ws.fNoise=noise;
+  TTree *tree = fDigitsSwitch ? fLoader->TreeS() : fLoader->TreeD();
+  TParameter<float> *ph = (TParameter<float>*)tree->GetUserInfo()->FindObject("lhcphase0");
+  ws.fPhase = ph ? ph->GetVal() : 0.;
+  ws.fResponseBin.resize(3*fTPCParam->GetNResponseMax());
+  ws.fResponseWeight.resize(fTPCParam->GetNResponseMax());
+}
+
+
+//_____________________________________________________________________________
+void AliTPC::DigitizeRow(Int_t irow,Int_t isec,TObjArray **rows,AliDigits *dig,AliTPCRowWorkspace &ws)
 {
   //-----------------------------------------------------------
   // Single row digitization, coupling from the neighbouring
@@ -1877,7 +2102,7 @@ void AliTPC::DigitizeRow(Int_t irow,Int_t isec,TObjArray **rows)
   AliTPCCalROC * noiseROC = noiseTPC->GetCalROC(isec);  // noise per given sector
 
 
-  fCurrentIndex[1]= isec;
+  ws.fIndex[1]= isec;
   
 
   Int_t nofPads = fTPCParam->GetNPads(isec,irow);
@@ -1888,22 +2113,26 @@ void AliTPC::DigitizeRow(Int_t irow,Int_t isec,TObjArray **rows)
 
   //
   //  Integrated signal for this row
-  //  and a single track signal
+  //  and a single track signal, the storage is reused for all rows
   //    
 
-  TMatrixF *m1 = new TMatrixF(0,nofPads,0,nofTbins); // integrated
-  TMatrixF *m2 = new TMatrixF(0,nofPads,0,nofTbins); // single
-  //
-  TMatrixF &total  = *m1;
+  UInt_t matrixSize = (nofPads+1)*(nofTbins+1);
+  ws.fTotal.assign(matrixSize,0.);
+  ws.fSingle.assign(matrixSize,0.);
+  TMatrixF total, single;
+  total.Use(0,nofPads,0,nofTbins,&ws.fTotal[0]); // integrated
+  single.Use(0,nofPads,0,nofTbins,&ws.fSingle[0]); // single
+  TMatrixF *m1 = &total;
+  TMatrixF *m2 = &single;
 
   //  Array of pointers to the label-signal list
 
   Int_t nofDigits = nofPads*nofTbins; // number of digits for this row
-  Float_t  **pList = new Float_t* [nofDigits]; 
+  ws.fList.assign(nofDigits,(Float_t*)0); // set all pointers to NULL
+  Float_t  **pList = &ws.fList[0]; 
 
   Int_t lp;
   Int_t i1;   
-  memset(pList,0,nofDigits*sizeof(Float_t*)); // set all pointers to NULL
   //
   //calculate signal 
   //
@@ -1912,19 +2141,18 @@ void AliTPC::DigitizeRow(Int_t irow,Int_t isec,TObjArray **rows)
   for (Int_t row= row1;row<=row2;row++){
     Int_t nTracks= rows[row]->GetEntries();
     for (i1=0;i1<nTracks;i1++){
-      fCurrentIndex[2]= row;
-      fCurrentIndex[3]=irow+1;
+      ws.fIndex[2]= row;
+      ws.fIndex[3]=irow+1;
       if (row==irow+1){
 	m2->Zero();  // clear single track signal matrix
-	Float_t trackLabel = GetSignal(rows[row],i1,m2,m1,indexRange); 
+	Float_t trackLabel = GetSignal(rows[row],i1,m2,m1,indexRange,ws); 
 	GetList(trackLabel,nofPads,m2,indexRange,pList);
       }
-      else   GetSignal(rows[row],i1,0,m1,indexRange);
+      else   GetSignal(rows[row],i1,0,m1,indexRange,ws);
     }
   }
          
   Int_t tracks[3];
-  AliDigits *dig = fDigitsArray->GetRow(isec,irow);
   Float_t fzerosup = zerosup+0.5;
   for(Int_t ip=0;ip<nofPads;ip++){
     for(Int_t it=0;it<nofTbins;it++){
@@ -1940,7 +2168,7 @@ void AliTPC::DigitizeRow(Int_t irow,Int_t isec,TObjArray **rows)
 
 	//
 	q*=gain;
-	q+=GetNoise()*noisePad;
+	q+=GetNoise(ws.fNoise)*noisePad;
         if(q <=fzerosup) continue; // do not fill zeros
         q = TMath::Nint(q);
         if(q >= fTPCParam->GetADCSat()) q = fTPCParam->GetADCSat() - 1;  // saturation
@@ -1992,18 +2220,13 @@ void AliTPC::DigitizeRow(Int_t irow,Int_t isec,TObjArray **rows)
   for(lp=0;lp<nofDigits;lp++){
     if(pList[lp]) delete [] pList[lp];
   }
-  
-  delete [] pList;
-
-  delete m1;
-  delete m2;
 
 } // end of DigitizeRow
 
 //_____________________________________________________________________________
 
 Float_t AliTPC::GetSignal(TObjArray *p1, Int_t ntr, 
-             TMatrixF *m1, TMatrixF *m2,Int_t *indexRange)
+             TMatrixF *m1, TMatrixF *m2,Int_t *indexRange,AliTPCRowWorkspace &ws)
 {
 
   //---------------------------------------------------------------
@@ -2023,7 +2246,7 @@ Float_t AliTPC::GetSignal(TObjArray *p1, Int_t ntr,
   TVector &v = *tv;
   
   Float_t label = v(0);
-  Int_t centralPad = (fTPCParam->GetNPads(fCurrentIndex[1],fCurrentIndex[3]-1))/2;
+  Int_t centralPad = (fTPCParam->GetNPads(ws.fIndex[1],ws.fIndex[3]-1))/2;
 
   Int_t nElectrons = (tv->GetNrows()-1)/5;
   indexRange[0]=9999; // min pad
@@ -2033,28 +2256,22 @@ Float_t AliTPC::GetSignal(TObjArray *p1, Int_t ntr,
 
   TMatrixF &signal = *m1;
   TMatrixF &total = *m2;
+  AliTPCParamSR *param = (AliTPCParamSR*)fTPCParam;
+  const Float_t totalNormFac = fTPCParam->GetTotalNormFac();
+  const Real_t *electrons = v.GetMatrixArray();
   //
-  // Get LHC clock phase
-  //
-  TParameter<float> *ph;
-  if(fDigitsSwitch){// s-digits
-    ph = (TParameter<float>*)fLoader->TreeS()->GetUserInfo()->FindObject("lhcphase0");  
-  }
-  else{ // normal digits
-    ph = (TParameter<float>*)fLoader->TreeD()->GetUserInfo()->FindObject("lhcphase0");
-  } 
   //  Loop over all electrons
   //
   for(Int_t nel=0; nel<nElectrons; nel++){
-    Int_t idx=nel*5;
-    Float_t aval =  v(idx+4);
-    Float_t eltoadcfac=aval*fTPCParam->GetTotalNormFac(); 
-    Float_t xyz[4]={v(idx+1),v(idx+2),v(idx+3),v(idx+5)};
-    Int_t n = ((AliTPCParamSR*)fTPCParam)->CalcResponseFast(xyz,fCurrentIndex,
-							    fCurrentIndex[3],ph->GetVal());
+    const Real_t *el = electrons+nel*5;
+    Float_t aval =  el[4];
+    Float_t eltoadcfac=aval*totalNormFac; 
+    Float_t xyz[4]={el[1],el[2],el[3],el[5]};
+    Int_t n = param->CalcResponseFast(xyz,ws.fIndex,ws.fIndex[3],ws.fPhase,
+				      &ws.fResponseBin[0],&ws.fResponseWeight[0]);
 
-    Int_t *index = fTPCParam->GetResBin(0);  
-    Float_t *weight = & (fTPCParam->GetResWeight(0));
+    Int_t *index = &ws.fResponseBin[0];  
+    Float_t *weight = &ws.fResponseWeight[0];
 
     if (n > 0)
       for (Int_t i = 0; i < n; i++) {
@@ -2223,6 +2440,69 @@ void AliTPC::MakeSector(Int_t isec,Int_t nrows,TTree *TH,
   // Origin: Marek Kowalski  IFJ, Krakow, Marek.Kowalski@ifj.edu.pl
   // Origin: Marian Ivanov,  marian.ivanov@cern.ch
   //-----------------------------------------------------------------
+  AliTPCSectorSetup setup;
+  SetupSector(isec,setup);
+
+  AliTPChit *tpcHit; // pointer to a sigle TPC hit    
+  //MI change
+  TBranch * branch=0;
+  if (fHitType>1) branch = TH->GetBranch("TPC2");
+  else branch = TH->GetBranch("TPC");
+
+ 
+  //----------------------------------------------
+  // Create TObjArray-s, one for each row,
+  // each TObjArray will store the TVectors
+  // of electrons, one TVectors per each track.
+  //---------------------------------------------- 
+    
+  AliTPCSectorElectrons electrons;
+  OpenElectrons(nrows,row,electrons);
+
+  //--------------------------------------------------------------------
+  //  Loop over tracks, the "track" contains the full history
+  //--------------------------------------------------------------------
+  
+  AliTPCSectorHit hit;
+  for(Int_t track=0;track<ntracks;track++){
+    Bool_t isInSector=kTRUE;
+    ResetHits();
+    isInSector = TrackInVolume(isec,track);
+    if (!isInSector) continue;
+    //MI change
+    branch->GetEntry(track); // get next track
+    
+    //M.I. changes
+
+    tpcHit = (AliTPChit*)FirstHit(-1);
+
+    //--------------------------------------------------------------
+    //  Loop over hits
+    //--------------------------------------------------------------
+
+
+    while(tpcHit){
+      
+      Int_t sector=tpcHit->fSector; // sector number
+      if(sector == isec && TransformHit(setup,tpcHit,hit,gRandom)){
+	AddElectrons(setup,hit,electrons,gRandom,tpcHit);
+      }
+
+      tpcHit = (AliTPChit*)NextHit();
+      
+    } // end of loop over hits
+  } // end of loop over tracks
+
+  CloseElectrons(nrows,electrons);
+
+} // end of MakeSector
+
+//_____________________________________________________________________________
+void AliTPC::SetupSector(Int_t isec, AliTPCSectorSetup &setup)
+{
+  //
+  // calibration and gain of a sector for the electron transport
+  //
   AliTPCcalibDB* const calib=AliTPCcalibDB::Instance();
 
   AliTPCCorrection * correctionDist = calib->GetTPCComposedCorrection();  
@@ -2256,117 +2536,46 @@ void AliTPC::MakeSector(Int_t isec,Int_t nrows,TTree *TH,
       }
     }
   }
-  Float_t gasgain = fTPCParam->GetGasGain();
-  gasgain = gasgain/fGainFactor;
   //  const Int_t timeStamp = 1; //where to get it? runloader->GetHeader()->GetTimeStamp(). https://savannah.cern.ch/bugs/?53025
   const Int_t timeStamp = fLoader->GetRunLoader()->GetHeader()->GetTimeStamp(); //?
   const Double_t correctionHVandPT = calib->GetGainCorrectionHVandPT(timeStamp, calib->GetRun(), isec, 5 ,tpcrecoparam->GetGainCorrectionHVandPTMode());
-  gasgain*=correctionHVandPT;
 
   // get gain in pad regions
-  Float_t gasGainRegions[3]={0.,0.,0.};
-
   for (UInt_t iregion=0; iregion<3; ++iregion) {
-    gasGainRegions[iregion] = fTPCParam->GetRegionGainAbsolute(iregion)*correctionHVandPT/fGainFactor;
+    setup.fGasGainRegions[iregion] = fTPCParam->GetRegionGainAbsolute(iregion)*correctionHVandPT/fGainFactor;
   }
 
-  Int_t i;
-  Float_t xyz[5]={0,0,0,0,0};
-
-  AliTPChit *tpcHit; // pointer to a sigle TPC hit    
-  //MI change
-  TBranch * branch=0;
-  if (fHitType>1) branch = TH->GetBranch("TPC2");
-  else branch = TH->GetBranch("TPC");
-
- 
-  //----------------------------------------------
-  // Create TObjArray-s, one for each row,
-  // each TObjArray will store the TVectors
-  // of electrons, one TVectors per each track.
-  //---------------------------------------------- 
-    
-  Int_t *nofElectrons = new Int_t [nrows+2]; // electron counter for each row
-  TVector **tracks = new TVector* [nrows+2]; //pointers to the track vectors
-
-  for(i=0; i<nrows+2; i++){
-    row[i] = new TObjArray;
-    nofElectrons[i]=0;
-    tracks[i]=0;
-  }
-
- 
-
-  //--------------------------------------------------------------------
-  //  Loop over tracks, the "track" contains the full history
-  //--------------------------------------------------------------------
-  
-  Int_t previousTrack,currentTrack;
-  previousTrack = -1; // nothing to store so far!
-
-  double maxDrift = fTPCParam->GetZLength(isec);
-
-  for(Int_t track=0;track<ntracks;track++){
-    Bool_t isInSector=kTRUE;
-    ResetHits();
-    isInSector = TrackInVolume(isec,track);
-    if (!isInSector) continue;
-    //MI change
-    branch->GetEntry(track); // get next track
-    
-    //M.I. changes
-
-    tpcHit = (AliTPChit*)FirstHit(-1);
-
-    //--------------------------------------------------------------
-    //  Loop over hits
-    //--------------------------------------------------------------
-
+  setup.fSector = isec;
+  setup.fNRows = fTPCParam->GetNRow(isec);
+  setup.fMaxDrift = fTPCParam->GetZLength(isec);
+  setup.fCalib = calib;
+  setup.fRecoParam = tpcrecoparam;
+  setup.fTransform = transform;
+  setup.fCorrection = correctionDist;
+}
 
-    while(tpcHit){
-      
-      Int_t sector=tpcHit->fSector; // sector number
-      if(sector != isec){
-	tpcHit = (AliTPChit*) NextHit();
-	continue; 
-      }
+//_____________________________________________________________________________
+Bool_t AliTPC::TransformHit(const AliTPCSectorSetup &setup, AliTPChit *tpcHit, AliTPCSectorHit &hit, TRandom *rnd)
+{
+  //
+  // Gate, attachment of single electron hits and the deterministic
+  // transformations which all electrons of the hit share.
+  // The attachment of single electron hits is drawn from rnd, with rnd=0
+  // it is left to the caller.
+  // Returns kFALSE if the hit does not contribute.
+  //
+  Int_t isec = setup.fSector;
+  AliTPCcalibDB* const calib = setup.fCalib;
+  AliTPCRecoParam *tpcrecoparam = setup.fRecoParam;
 
       // Remove hits which arrive before the TPC opening gate signal
       if(((fTPCParam->GetZLength(isec)-TMath::Abs(tpcHit->Z()))
 	  /fTPCParam->GetDriftV()+tpcHit->Time())<fTPCParam->GetGateDelay()) {
-	tpcHit = (AliTPChit*) NextHit();
-	continue;
+	return kFALSE;
       }
 
-      currentTrack = tpcHit->Track(); // track number
-
-      if(currentTrack != previousTrack){
-                          
-	// store already filled fTrack
-              
-	for(i=0;i<nrows+2;i++){
-	  if(previousTrack != -1){
-	    if(nofElectrons[i]>0){
-	      TVector &v = *tracks[i];
-	      v(0) = previousTrack;
-	      tracks[i]->ResizeTo(5*nofElectrons[i]+1); // shrink if necessary
-	      row[i]->Add(tracks[i]);                     
-	    }
-	    else {
-	      delete tracks[i]; // delete empty TVector
-	      tracks[i]=0;
-	    }
-	  }
-
-	  nofElectrons[i]=0;
-	  tracks[i] = new TVector(601); // TVectors for the next fTrack
-
-	} // end of loop over rows
-	       
-	previousTrack=currentTrack; // update track label 
-      }
-	   
-      Int_t qI = (Int_t) (tpcHit->fQ); // energy loss (number of electrons)
+      hit.fTrack = tpcHit->Track(); // track number
+      hit.fQ = (Int_t) (tpcHit->fQ); // energy loss (number of electrons)
 
       //---------------------------------------------------
       //  Calculate the electron attachment probability
@@ -2374,23 +2583,27 @@ void AliTPC::MakeSector(Int_t isec,Int_t nrows,TTree *TH,
 
 
       Float_t time = 1.e6*(fTPCParam->GetZLength(isec)-TMath::Abs(tpcHit->Z()))/fTPCParam->GetDriftV();  // in microseconds!	
-      Float_t attProb = fTPCParam->GetAttCoef()*fTPCParam->GetOxyCont()*time; //  fraction! 
+      hit.fAttProb = fTPCParam->GetAttCoef()*fTPCParam->GetOxyCont()*time; //  fraction! 
    
-      if (qI==1 && (gRandom->Rndm(0)<attProb)) {  // the only electron is lost!
-	tpcHit = (AliTPChit*)NextHit();
-	continue;
+      if (rnd && hit.fQ==1 && (rnd->Rndm(0)<hit.fAttProb)) {  // the only electron is lost!
+	return kFALSE;
       }
 
       //RS: all electrons share the same deterministic transformations (of the same hit), up to diffusion
 
-      Int_t indexHit[3]={0},index[3];
+      Int_t *indexHit = hit.fIndex;
+      indexHit[0]=0;
       indexHit[1]=isec;
-      float xyzHit[3] = {tpcHit->X(),tpcHit->Y(),tpcHit->Z()};
+      indexHit[2]=0;
+      Float_t *xyzHit = hit.fXYZ;
+      xyzHit[0]=tpcHit->X();
+      xyzHit[1]=tpcHit->Y();
+      xyzHit[2]=tpcHit->Z();
 
-      double yLab = xyzHit[1]; // for eventual P-gradient accounting
+      hit.fYLab = xyzHit[1]; // for eventual P-gradient accounting
       if (tpcrecoparam->GetUseCorrectionMap()) {
 	double xyzD[3] = {xyzHit[0],xyzHit[1],xyzHit[2]};
-	transform->ApplyDistortionMap(isec,xyzD);
+	setup.fTransform->ApplyDistortionMap(isec,xyzD);
 	for (int idim=3;idim--;) xyzHit[idim] = xyzD[idim];
       }
       else {
@@ -2408,9 +2621,9 @@ void AliTPC::MakeSector(Int_t isec,Int_t nrows,TTree *TH,
 	} 
 	else if (tpcrecoparam->GetUseComposedCorrection()) {
 	  //      Use combined correction/distortion  class AliTPCCorrection
-	  if (correctionDist){
+	  if (setup.fCorrection){
 	    Float_t distPoint[3] = {xyzHit[0],xyzHit[1],xyzHit[2]};
-	    correctionDist->DistortPoint(distPoint, isec);
+	    setup.fCorrection->DistortPoint(distPoint, isec);
 	    for (int idim=3;idim--;) xyzHit[idim] = distPoint[idim];
 	  }      
 	}     
@@ -2429,25 +2642,143 @@ void AliTPC::MakeSector(Int_t isec,Int_t nrows,TTree *TH,
 	// account for A/C sides max drift L deficit to nominal 250 cm
 	xyzHit[2] -=  sideC ? 0.302 : 0.275; // C : A
       }
+      hit.fTime = tpcHit->Time();
+      return kTRUE;
+}
+
+//_____________________________________________________________________________
+void AliTPC::OpenElectrons(Int_t nrows, TObjArray **row, AliTPCSectorElectrons &electrons) const
+{
+  //
+  // create the row arrays and the electron counters
+  //
+  electrons.fRows = row;
+  electrons.fNofElectrons = new Int_t [nrows+2]; // electron counter for each row
+  electrons.fTracks = new TVector* [nrows+2]; //pointers to the track vectors
+  electrons.fPreviousTrack = -1; // nothing to store so far!
+
+  for(Int_t i=0; i<nrows+2; i++){
+    row[i] = new TObjArray;
+    electrons.fNofElectrons[i]=0;
+    electrons.fTracks[i]=0;
+  }
+}
+
+//_____________________________________________________________________________
+void AliTPC::CloseElectrons(Int_t nrows, AliTPCSectorElectrons &electrons) const
+{
+    //
+    //   store remaining track (the last one) if not empty
+    //
+  Int_t *nofElectrons = electrons.fNofElectrons;
+  TVector **tracks = electrons.fTracks;
+  TObjArray **row = electrons.fRows;
+  for(Int_t i=0;i<nrows+2;i++){
+    if(nofElectrons[i]>0){
+      TVector &v = *tracks[i];
+      v(0) = electrons.fPreviousTrack;
+      tracks[i]->ResizeTo(5*nofElectrons[i]+1); // shrink if necessary
+      row[i]->Add(tracks[i]);  
+    }
+    else{
+      delete tracks[i];
+      tracks[i]=0;
+    }  
+  }  
+  
+  delete [] tracks;
+  delete [] nofElectrons;
+  electrons.fTracks=0;
+  electrons.fNofElectrons=0;
+}
+
+//_____________________________________________________________________________
+void AliTPC::AddElectrons(const AliTPCSectorSetup &setup, const AliTPCSectorHit &hit,
+                          AliTPCSectorElectrons &electrons, TRandom *rnd, AliTPChit *tpcHit)
+{
+  //
+  // Electron transport of one hit: attachment, diffusion, gas gain,
+  // time0 and time bin. All random numbers are taken from rnd, tpcHit
+  // is only used for the debug streamer and can be NULL.
+  //
+  Int_t isec = setup.fSector;
+  Int_t nrows = setup.fNRows;
+  AliTPCcalibDB* const calib = setup.fCalib;
+  AliTPCRecoParam *tpcrecoparam = setup.fRecoParam;
+  AliTPCTransform* transform = setup.fTransform;
+  Int_t *nofElectrons = electrons.fNofElectrons;
+  TVector **tracks = electrons.fTracks;
+  TObjArray **row = electrons.fRows;
+  Int_t i;
+  Float_t xyz[5]={0,0,0,0,0};
+
+      Int_t currentTrack = hit.fTrack;
+      Int_t previousTrack = electrons.fPreviousTrack;
+
+      if(currentTrack != previousTrack){
+                          
+	// store already filled fTrack
+              
+	for(i=0;i<nrows+2;i++){
+	  if(previousTrack != -1){
+	    if(nofElectrons[i]>0){
+	      TVector &v = *tracks[i];
+	      v(0) = previousTrack;
+	      tracks[i]->ResizeTo(5*nofElectrons[i]+1); // shrink if necessary
+	      row[i]->Add(tracks[i]);                     
+	    }
+	    else {
+	      delete tracks[i]; // delete empty TVector
+	      tracks[i]=0;
+	    }
+	  }
+
+	  nofElectrons[i]=0;
+	  tracks[i] = new TVector(601); // TVectors for the next fTrack
+
+	} // end of loop over rows
+	       
+	electrons.fPreviousTrack=currentTrack; // update track label 
+      }
+	   
+      Int_t qI = hit.fQ;
+      Float_t attProb = hit.fAttProb;
+      Int_t index[3];
+      const Int_t *indexHit = hit.fIndex;
+      const Float_t *xyzHit = hit.fXYZ;
+      double yLab = hit.fYLab;
+      Bool_t sideC = ((isec/18)&0x1);
+      double maxDrift = setup.fMaxDrift;
       //
+      // batched transport: attachment, diffusion, ExB and the avalanche
+      // random numbers for all electrons of the hit at once
+      AliTPCElectronBatch &batch = electrons.fBatch;
+      Int_t nElectrons = fBatchedTransport ? TransportElectrons(hit,batch,rnd) : qI;
       //-----------------------------------------------
       //  Loop over electrons
       //-----------------------------------------------
-      for(Int_t nel=0;nel<qI;nel++) {
+      for(Int_t nel=0;nel<nElectrons;nel++) {
+	Double_t gain=0;
+	if (fBatchedTransport) {
+	  for (int idim=3;idim--;) {xyz[idim] = batch.fXYZ[idim][nel]; index[idim] = indexHit[idim];}
+	  gain = batch.fGain[nel];
+	}
+	else {
 	// skip if electron lost due to the attachment
 	// RS: check only case of multiple electrons, case of 1 is already checked
-	if(qI>1 && (gRandom->Rndm(0)) < attProb) continue; // electron lost!
+	if(qI>1 && (rnd->Rndm(0)) < attProb) continue; // electron lost!
 	// start from primary electron in vicinity of the readout, simulate diffusion
 	for (int idim=3;idim--;) {xyz[idim] = xyzHit[idim]; index[idim] = indexHit[idim];}
 	//
-	TransportElectron(xyz,index);    
+	TransportElectron(xyz,index,rnd);    
+	}
 	Int_t rowNumber;
 	double driftEl = xyz[2];  // GetPadRow converts Z to timebin in a way incmpatible with real calib, save drift distance
 	Int_t padrow = fTPCParam->GetPadRow(xyz,index); 
 
         // get pad region
         UInt_t padRegion=0;
-        if (tpcHit->fSector >= fTPCParam->GetNInnerSector()) {
+        if (isec >= fTPCParam->GetNInnerSector()) {
           padRegion=1;
           if (padrow >= fTPCParam->GetNRowUp1()) {
             padRegion=2;
@@ -2456,11 +2787,11 @@ void AliTPC::MakeSector(Int_t isec,Int_t nrows,TTree *TH,
 	
 	// protection for the nonphysical avalanche size (10**6 maximum)
 	//
-	Double_t rn=TMath::Max(gRandom->Rndm(0),1.93e-22);
+	if (!fBatchedTransport) gain = -TMath::Log(TMath::Max(rnd->Rndm(0),1.93e-22));
 	
         //         xyz[3]= (Float_t) (-gasgain*TMath::Log(rn));
         // JW: take into account different gain in the pad regions
-        xyz[3]= (Float_t) (-gasGainRegions[padRegion]*TMath::Log(rn));
+        xyz[3]= (Float_t) (setup.fGasGainRegions[padRegion]*gain);
 
         //
 	// Add Time0 correction due unisochronity
@@ -2479,7 +2810,7 @@ void AliTPC::MakeSector(Int_t isec,Int_t nrows,TTree *TH,
 	    if (pad>=npads) pad=npads-1;
 	    correction = calib->GetPadTime0()->GetCalROC(isec)->GetValue(padrow,pad);
 	    //	  printf("%d\t%d\t%d\t%f\n",isec,padrow,pad,correction);
-	    if (fDebugStreamer){
+	    if (fDebugStreamer && tpcHit){
 	      (*fDebugStreamer)<<"Time0"<<
 	        "isec="<<isec<<
 	        "padrow="<<padrow<<
@@ -2516,7 +2847,7 @@ void AliTPC::MakeSector(Int_t isec,Int_t nrows,TTree *TH,
 	  xyz[2] = transform->Z2TimeBin(z,isec, yLab);
 	}
 	// Electron track time (for pileup simulation)
-	xyz[2]+=tpcHit->Time()/fTPCParam->GetTSample(); // adding time of flight
+	xyz[2]+=hit.fTime/fTPCParam->GetTSample(); // adding time of flight
 
 	xyz[4] =0;	  
 	//
@@ -2559,33 +2890,7 @@ void AliTPC::MakeSector(Int_t isec,Int_t nrows,TTree *TH,
 	
       } // end of loop over electrons
 
-      tpcHit = (AliTPChit*)NextHit();
-      
-    } // end of loop over hits
-  } // end of loop over tracks
-
-    //
-    //   store remaining track (the last one) if not empty
-    //
-  
-  for(i=0;i<nrows+2;i++){
-    if(nofElectrons[i]>0){
-      TVector &v = *tracks[i];
-      v(0) = previousTrack;
-      tracks[i]->ResizeTo(5*nofElectrons[i]+1); // shrink if necessary
-      row[i]->Add(tracks[i]);  
-    }
-    else{
-      delete tracks[i];
-      tracks[i]=0;
-    }  
-  }  
-  
-  delete [] tracks;
-  delete [] nofElectrons;
-
-} // end of MakeSector
-
+}
 
 //_____________________________________________________________________________
 void AliTPC::Init()
@@ -2634,7 +2939,89 @@ void AliTPC::SetSide(Float_t side=0.)
 }
 //_____________________________________________________________________________
 
+Int_t AliTPC::TransportElectrons(const AliTPCSectorHit &hit, AliTPCElectronBatch &batch, TRandom *rnd) const
+{
+  //
+  // electron transport of all electrons of a hit, as TransportElectron
+  // but with the random numbers generated in arrays and loops without
+  // branches over the electrons, which the compiler can vectorize:
+  // 1. attachment, only the number of surviving electrons is needed
+  // 2. diffusion, the width depends on the drift length of the hit only
+  // 3. ExB at the wires
+  // 4. -log(rndm) of the avalanche size
+  //
+  // hit must be in system 2, returns the number of electrons in batch
+  //
+  Int_t nel = hit.fQ;
+  if (nel<=0) return 0;
+  if ((Int_t)batch.fRndm.size()<3*nel+1) batch.fRndm.resize(3*nel+1);
+  Double_t *rndm = &batch.fRndm[0];
+
+  Int_t n = nel;
+  if (nel>1) {
+    // single electron hits are checked already before the transport
+    rnd->RndmArray(nel,rndm);
+    n = 0;
+    const Double_t attProb = hit.fAttProb;
+    for (Int_t i=0;i<nel;i++) n += (rndm[i]>=attProb);
+    if (n==0) return 0;
+  }
+  for (Int_t idim=0;idim<3;idim++) batch.fXYZ[idim].resize(n);
+  batch.fGain.resize(n);
+
+  // diffusion, Gaussian random numbers with the Box-Muller method
+  Float_t driftl = hit.fXYZ[2];
+  if (driftl<0.01) driftl=0.01;
+  driftl = TMath::Sqrt(driftl);
+  const Float_t sigma[3] = {driftl*fTPCParam->GetDiffT(),driftl*fTPCParam->GetDiffT(),
+                            driftl*fTPCParam->GetDiffL()};
+  const Int_t npairs = (3*n+1)/2;
+  rnd->RndmArray(2*npairs,rndm);
+  for (Int_t i=0;i<npairs;i++) {
+    const Double_t r = TMath::Sqrt(-2.*TMath::Log(TMath::Max(rndm[2*i],1.e-300)));
+    const Double_t phi = TMath::TwoPi()*rndm[2*i+1];
+    rndm[2*i] = r*TMath::Cos(phi);
+    rndm[2*i+1] = r*TMath::Sin(phi);
+  }
+  for (Int_t idim=0;idim<3;idim++) {
+    Float_t *x = &batch.fXYZ[idim][0];
+    const Double_t *g = rndm+idim*n;
+    const Float_t x0 = hit.fXYZ[idim];
+    const Float_t sig = sigma[idim];
+    for (Int_t i=0;i<n;i++) x[i] = x0+sig*g[i];
+  }
+
+  // ExB
+  if (fTPCParam->GetMWPCReadout()==kTRUE){
+    const Float_t omegaTau = fTPCParam->GetOmegaTau();
+    Float_t xyz[3];
+    Int_t index[3];
+    for (Int_t i=0;i<n;i++) {
+      for (Int_t idim=0;idim<3;idim++) {xyz[idim] = batch.fXYZ[idim][i]; index[idim] = hit.fIndex[idim];}
+      Float_t dx = fTPCParam->Transform2to2NearestWire(xyz,index);
+      batch.fXYZ[0][i] = xyz[0];
+      batch.fXYZ[1][i] += dx*omegaTau;
+    }
+  }
+
+  // avalanche, protection for the nonphysical size (10**6 maximum)
+  rnd->RndmArray(n,rndm);
+  Float_t *gain = &batch.fGain[0];
+  for (Int_t i=0;i<n;i++) gain[i] = -TMath::Log(TMath::Max(rndm[i],1.93e-22));
+  return n;
+}
+//_____________________________________________________________________________
+
 void AliTPC::TransportElectron(Float_t *xyz, Int_t *index)
+{
+  //
+  // electron transport with gRandom
+  //
+  TransportElectron(xyz,index,gRandom);
+}
+//_____________________________________________________________________________
+
+void AliTPC::TransportElectron(Float_t *xyz, Int_t *index, TRandom *rnd)
 {
   //
   // electron transport taking into account:
@@ -2654,9 +3041,9 @@ void AliTPC::TransportElectron(Float_t *xyz, Int_t *index)
   driftl=TMath::Sqrt(driftl);
   Float_t sigT = driftl*(fTPCParam->GetDiffT());
   Float_t sigL = driftl*(fTPCParam->GetDiffL());
-  xyz[0]=gRandom->Gaus(xyz[0],sigT);
-  xyz[1]=gRandom->Gaus(xyz[1],sigT);
-  xyz[2]=gRandom->Gaus(xyz[2],sigL);
+  xyz[0]=rnd->Gaus(xyz[0],sigT);
+  xyz[1]=rnd->Gaus(xyz[1],sigT);
+  xyz[2]=rnd->Gaus(xyz[2],sigL);
 
   // ExB
   
@@ -11,16 +11,25 @@
 
 class TFile;
 class TTree;
+class TRandom;
 #include <Htypes.h>
 #include <TMatrixFfwd.h>
 #include <TVector.h>
+#include <vector>
 
+class AliDigits;
 class AliTPCDigitsArray;
 class AliTPCLoader;
 class AliTPCParam;
 class AliTPCTrackHitsV2; // M.I.
 class AliRawReader;
 class TTreeSRedirector;
+class AliTPChit;
+class AliTPCcalibDB;
+class AliTPCRecoParam;
+class AliTPCTransform;
+class AliTPCCorrection;
+class AliTPCFastResponse;
 
 #include "AliDetector.h"
 #include "AliDigit.h" 
@@ -56,6 +65,7 @@ public:
   virtual Int_t IsVersion() const =0;
   virtual void  Digits2Raw();
   virtual Bool_t Raw2SDigits(AliRawReader* rawReader);
+  virtual Bool_t MakeFastClusters(); // clusters from the track references, see AliTPCFastResponse
   Int_t         GetNsectors() const  {return fNsectors;}
   virtual void  ResetDigits();
   virtual void  SetSens(Int_t sens);
@@ -85,6 +95,8 @@ public:
    void SetDigitsSwitch(Int_t sw){fDigitsSwitch = sw;}
    void SetDefSwitch(Int_t def){fDefaults = def;}
    inline Float_t GetNoise();  //get Current noise
+   inline Float_t GetNoise(Int_t &index) const;  //get noise at index and advance index
+   inline Int_t   SkipNoise(Int_t n);  //reserve n values of the noise table, returns index of the first
   void    GenerNoise(Int_t tablasize, Bool_t normType=kFALSE);  // make noise table
    Bool_t  IsSectorActive(Int_t sec) const;    // check if the sector is active
    void    SetActiveSectors(Int_t * sectors, Int_t n);  //set active sectors
@@ -96,6 +108,21 @@ public:
    Float_t GetGainFactor()const {return fGainFactor;}//gas gain scaling factor
    // LHC clock phase switch 0 - no phase, 1 - random, 2 - from the OCDB
    void SetLHCclockPhase(Int_t sw){fLHCclockPhaseSw = sw;}
+   // hits to digits: 1 - sectors in sequence with gRandom (default),
+   // n - sectors on n threads, 0 - all available threads.
+   // With n!=1 each sector has an own random generator, seeded from the
+   // digitization seed, event and sector; the digits do not depend on the
+   // number of threads
+   void SetNThreads(Int_t n){fNThreads = n;}
+   Int_t GetNThreads() const {return fNThreads;}
+   void SetDigitizationSeed(UInt_t seed){fDigitizationSeed = seed;} // 0 - taken from gRandom
+   // transport the electrons of a hit as one batch (TransportElectrons),
+   // statistically equivalent to the default electron by electron transport
+   void SetBatchedTransport(Bool_t flag=kTRUE){fBatchedTransport = flag;}
+   Bool_t GetBatchedTransport() const {return fBatchedTransport;}
+   // parametrized response of MakeFastClusters, created with the defaults if not set
+   void SetFastResponse(AliTPCFastResponse *response);
+   AliTPCFastResponse* GetFastResponse();
 // static functions
    static AliTPCParam* LoadTPCParam(TFile *file); 
 protected:
@@ -120,14 +147,72 @@ protected:
   AliTPC(const AliTPC& t);
   AliTPC &operator = (const AliTPC & param);
   //
+  // sector constants for the electron transport, see MakeSector
+  struct AliTPCSectorSetup {
+    Int_t              fSector;            // sector number
+    Int_t              fNRows;             // pad rows of the sector
+    Double_t           fMaxDrift;          // drift length
+    Float_t            fGasGainRegions[3]; // gas gain in the pad regions
+    AliTPCcalibDB*     fCalib;             // calibration
+    AliTPCRecoParam*   fRecoParam;         // reconstruction parameters
+    AliTPCTransform*   fTransform;         // transformation with correction maps
+    AliTPCCorrection*  fCorrection;        // composed correction
+  };
+  // hit after the deterministic transformations, the electrons are
+  // created from it in AddElectrons
+  struct AliTPCSectorHit {
+    Int_t    fTrack;     // track label
+    Int_t    fQ;         // number of electrons
+    Int_t    fIndex[3];  // coordinate system, sector, row
+    Float_t  fXYZ[3];    // position in the sector frame
+    Float_t  fTime;      // time of flight
+    Float_t  fAttProb;   // attachment probability
+    Double_t fYLab;      // y in the lab frame
+  };
+  // electrons of one hit after diffusion and ExB, see TransportElectrons
+  struct AliTPCElectronBatch {
+    std::vector<Float_t>  fXYZ[3];  // position in the sector frame
+    std::vector<Float_t>  fGain;    // -log(rndm), times gas gain is the avalanche
+    std::vector<Double_t> fRndm;    // uniform random numbers
+  };
+  // electrons of a sector, one TVector per row and track
+  struct AliTPCSectorElectrons {
+    TObjArray **fRows;          // row[i] array of track vectors
+    Int_t      *fNofElectrons;  // electrons in the current track vector
+    TVector   **fTracks;        // current track vector of each row
+    Int_t       fPreviousTrack; // label of the current track vectors
+    AliTPCElectronBatch fBatch; // buffers of the batched transport
+  };
+  // buffers of the row digitization, one per thread
+  struct AliTPCRowWorkspace {
+    Int_t                 fIndex[4];       // as fCurrentIndex
+    Int_t                 fNoise;          // position in the noise table
+    Float_t               fPhase;          // LHC clock phase
+    std::vector<Int_t>    fResponseBin;    // response of one electron
+    std::vector<Float_t>  fResponseWeight; //
+    std::vector<Float_t>  fTotal;          // storage of the row signal
+    std::vector<Float_t>  fSingle;         // storage of the single track signal
+    std::vector<Float_t*> fList;           // track labels per digit
+  };
+
   void SetDefaults();
-  void DigitizeRow(Int_t irow,Int_t isec,TObjArray **rowTriplet);
+  void SetupSector(Int_t isec, AliTPCSectorSetup &setup);
+  Bool_t TransformHit(const AliTPCSectorSetup &setup, AliTPChit *tpcHit, AliTPCSectorHit &hit, TRandom *rnd);
+  void OpenElectrons(Int_t nrows, TObjArray **row, AliTPCSectorElectrons &electrons) const;
+  void CloseElectrons(Int_t nrows, AliTPCSectorElectrons &electrons) const;
+  void AddElectrons(const AliTPCSectorSetup &setup, const AliTPCSectorHit &hit,
+                    AliTPCSectorElectrons &electrons, TRandom *rnd, AliTPChit *tpcHit);
+  void InitRowWorkspace(AliTPCRowWorkspace &ws, Int_t noise) const;
+  void DigitizeRow(Int_t irow,Int_t isec,TObjArray **rowTriplet,AliDigits *dig,AliTPCRowWorkspace &ws);
   Float_t GetSignal(TObjArray *p1, Int_t ntr, TMatrixF *m1, 
-                   TMatrixF *m2,Int_t *IndexRange);
+                   TMatrixF *m2,Int_t *IndexRange,AliTPCRowWorkspace &ws);
   void GetList (Float_t label,Int_t np,TMatrixF *m,Int_t *IndexRange,
                 Float_t **pList);
   void MakeSector(Int_t isec,Int_t nrows,TTree *TH,Stat_t ntracks,TObjArray **row);
+  void Hits2DigitsSectors(Int_t eventnumber);
   void TransportElectron(Float_t *xyz, Int_t *index);
+  void TransportElectron(Float_t *xyz, Int_t *index, TRandom *rnd);
+  Int_t TransportElectrons(const AliTPCSectorHit &hit, AliTPCElectronBatch &batch, TRandom *rnd) const;
   Int_t fCurrentIndex[4];// index[0] indicates coordinate system, 
                          // index[1] sector number, 
                          // index[2] pad row number  
@@ -140,7 +225,11 @@ protected:
   TTreeSRedirector *fDebugStreamer;     //!debug streamer
   Int_t fLHCclockPhaseSw; //! lhc clock phase switch
   Int_t fIsGEM;        // flag isGEM readout
-  ClassDef(AliTPC,15)  // Time Projection Chamber class
+  Int_t fNThreads;     // threads for the hits to digits conversion
+  UInt_t fDigitizationSeed; // seed of the sector random generators
+  Bool_t fBatchedTransport; // electrons of a hit are transported as one batch
+  AliTPCFastResponse *fFastResponse; //! parametrized response for the fast clusters
+  ClassDef(AliTPC,17)  // Time Projection Chamber class
 };
 
 // inline implementations
@@ -154,6 +243,25 @@ inline Float_t AliTPC::GetNoise()
   //gRandom->Gaus(0, fTPCParam->GetNoise()*fTPCParam->GetNoiseNormFac());
 }
 
+inline Float_t AliTPC::GetNoise(Int_t &index) const
+{
+  // get noise from table at position index and advance
+  if (index>=fNoiseDepth) index=0;
+  return fNoiseTable[index++];
+}
+
+inline Int_t AliTPC::SkipNoise(Int_t n)
+{
+  // the table is advanced as by n calls of GetNoise(), the values are
+  // taken with GetNoise(index) starting from the returned index
+  Int_t index = fCurrentNoise;
+  if (n>0 && fNoiseDepth>0) {
+    if (fCurrentNoise>=fNoiseDepth) fCurrentNoise=0;
+    fCurrentNoise = (fCurrentNoise+n-1)%fNoiseDepth+1;
+  }
+  return index;
+}
+
 
 
 
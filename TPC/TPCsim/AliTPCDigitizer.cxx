@@ -58,10 +58,16 @@
 #include "TTreeStream.h"
 #include "AliTPCReconstructor.h"
 #include <TGraphErrors.h>
+#include <TStopwatch.h>
+#include <TVectorD.h>
 #include "AliTPCSAMPAEmulator.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 AliTPCSAMPAEmulator *  AliTPCDigitizer::fgSAMPAEmulator=0;
+Bool_t AliTPCDigitizer::fgFastDigitization=kFALSE;
 
 using std::cout;
 using std::cerr;
@@ -110,8 +116,8 @@ Bool_t AliTPCDigitizer::Init()
 //------------------------------------------------------------------------
 void AliTPCDigitizer::Digitize(Option_t* option)
 {
-  //DigitizeFast(option);  
-  DigitizeWithTailAndCrossTalk(option);
+  if (fgFastDigitization && !fgSAMPAEmulator) DigitizeFast(option);
+  else DigitizeWithTailAndCrossTalk(option);
   
 }
 //------------------------------------------------------------------------
@@ -147,7 +153,6 @@ void AliTPCDigitizer::DigitizeFast(Option_t* option)
    }
   AliTPC *pTPC  = (AliTPC *) gAlice->GetModule("TPC");
   AliTPCParam * param = pTPC->GetParam();
-  const Bool_t useGlitchFilter=param->GetUseGlitchFilter();
 
   //sprintf(s,param->GetTitle());
   snprintf(s,100,"%s",param->GetTitle());
@@ -173,9 +178,6 @@ void AliTPCDigitizer::DigitizeFast(Option_t* option)
   Int_t * masks = new Int_t[nInputs];
   for (Int_t i=0; i<nInputs;i++)
     masks[i]= fDigInput->GetMask(i);
-  Short_t **pdig= new Short_t*[nInputs];   //pointers to the expanded digits array
-  Int_t **ptr=  new Int_t*[nInputs];       //pointers to the expanded tracks array
-  Bool_t *active=  new Bool_t[nInputs];    //flag for active input segments
   Char_t phname[100];
   
   //create digits array for given sectors
@@ -213,10 +215,7 @@ void AliTPCDigitizer::DigitizeFast(Option_t* option)
           if(digarr[i2])  delete digarr[i2];
 	}
         delete [] digarr;
-        delete [] active;
         delete []masks;
-        delete []pdig;
-        delete []ptr;
         return;
        }
 
@@ -231,10 +230,7 @@ void AliTPCDigitizer::DigitizeFast(Option_t* option)
           if(digarr[i2])  delete digarr[i2];
 	}
         delete [] digarr;
-        delete [] active;
         delete []masks;
-        delete []pdig;
-        delete []ptr;
         return;
       }
       tree->GetUserInfo()->Add(new TParameter<float>(phname,ph->GetVal()));
@@ -250,13 +246,124 @@ void AliTPCDigitizer::DigitizeFast(Option_t* option)
   //
 
 
-  Int_t zerosup = param->GetZeroSup(); 
   AliTPCCalPad * gainTPC = AliTPCcalibDB::Instance()->GetDedxGainFactor(); 
   AliTPCCalPad * noiseTPC = AliTPCcalibDB::Instance()->GetPadNoise(); 
   //
+  // The input segments of a group of sectors are read in sequence and kept
+  // compressed, the segments are merged in parallel and stored in the order
+  // of the segment ID. The position in the noise table is reserved when a
+  // segment is read, the digits do not depend on the number of threads.
+  //
+  Int_t nThreads = 1;
+#ifdef _OPENMP
+  nThreads = pTPC->GetNThreads();
+  if (nThreads<=0) nThreads = omp_get_max_threads();
+#endif
+  const Int_t nSectorsGroup = (nThreads>1) ? 2*nThreads : 1;
+  const Int_t nSegmentsTotal = param->GetNRowsTotal();
+  AliSimDigits * digrowDefault = digrow;
+  TVectorD sectorTime(param->GetNSector()); // real time of the merging per sector
+  TStopwatch timerRead, timerMerge, timerStore;
+  timerRead.Reset();
+  timerMerge.Reset();
+  timerStore.Reset();
+  //
   //Loop over segments of the TPC
     
-  for (Int_t segmentID=0; segmentID<param->GetNRowsTotal(); segmentID++) 
+  Int_t firstSegment = 0;
+  while (firstSegment<nSegmentsTotal) {
+    //
+    // read the input segments of nSectorsGroup sectors
+    //
+    timerRead.Start(kFALSE);
+    std::vector<AliTPCMergeSegment> segments;
+    firstSegment = ReadSegments(segments,firstSegment,nSectorsGroup,digarr,pTPC,param,kTRUE);
+    timerRead.Stop();
+    //
+    // merge and digitize
+    //
+    timerMerge.Start(kFALSE);
+    const Int_t nSegments = segments.size();
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nThreads)
+#endif
+    {
+      std::vector<Float_t> signal;
+      std::vector<UChar_t> nTracks;
+      std::vector<UChar_t> mark;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic,1)
+#endif
+      for (Int_t iseg=0; iseg<nSegments; iseg++) {
+        TStopwatch timer;
+        MergeSegment(segments[iseg],pTPC,param,gainTPC,noiseTPC,masks,signal,nTracks,mark);
+        segments[iseg].fTime = timer.RealTime();
+      }
+    }
+    timerMerge.Stop();
+    //
+    // store in the order of the segment ID
+    //
+    timerStore.Start(kFALSE);
+    for (Int_t iseg=0; iseg<nSegments; iseg++) {
+      AliTPCMergeSegment &segment = segments[iseg];
+      sectorTime[segment.fSector] += segment.fTime;
+      digrow = segment.fOutput;
+      tree->Fill();
+      if (fDebug>0) cerr<<segment.fSector<<"\t"<<segment.fPadRow<<"\n";  
+      delete segment.fOutput;
+      for (Int_t i=0;i<nInputs; i++) delete segment.fInputs[i];
+    }
+    digrow = digrowDefault;
+    timerStore.Stop();
+  } // end of loop over sector groups
+
+  AliInfo(Form("%d inputs, %d threads: read %.2f s, merge %.2f s (sum over sectors %.2f s), store %.2f s",
+               nInputs, nThreads, timerRead.RealTime(), timerMerge.RealTime(), sectorTime.Sum(),
+               timerStore.RealTime()));
+  for (Int_t isec=0; isec<sectorTime.GetNrows(); isec++) {
+    AliDebug(1,Form("sector %d: merge %.3f s", isec, sectorTime[isec]));
+    if (fDebugStreamer) {
+      Double_t time = sectorTime[isec];
+      (*fDebugStreamer)<<"mergeTime"<<
+        "sector="<<isec<<
+        "nInputs="<<nInputs<<
+        "nThreads="<<nThreads<<
+        "time="<<time<<
+        "\n";
+    }
+  }
+
+  orl = AliRunLoader::GetRunLoader(fDigInput->GetOutputFolderName());
+  ogime = orl->GetLoader("TPCLoader");
+  ogime->WriteDigits("OVERWRITE");
+  
+  //fDigInput->GetTreeDTPC()->Write(0,TObject::kOverwrite);
+  
+  delete digrow;     
+  for (Int_t i1=0;i1<nInputs; i1++) delete digarr[i1];
+  delete []masks;
+  delete []digarr;  
+}
+
+//------------------------------------------------------------------------
+Int_t AliTPCDigitizer::ReadSegments(std::vector<AliTPCMergeSegment> &segments, Int_t firstSegment,
+                                    Int_t nSectorsGroup, AliSimDigits **digarr, AliTPC *pTPC,
+                                    AliTPCParam *param, Bool_t reserveNoise)
+{
+  //
+  // read the input segments of the nSectorsGroup sectors starting at
+  // firstSegment, the copies of the inputs stay compressed. With
+  // reserveNoise the position in the noise table is reserved for each
+  // segment in the order of the segment ID, as the sequential merging
+  // would take it. Returns the first segment of the next group.
+  //
+  Int_t nInputs = fDigInput->GetNinputs();
+  Int_t nSegmentsTotal = param->GetNRowsTotal();
+  Int_t nSectors = 0;
+  Int_t lastSector = -1;
+  Int_t segmentID = firstSegment;
+  for (; segmentID<nSegmentsTotal; segmentID++) 
    {
     Int_t sector, padRow;
     if (!param->AdjustSectorRow(segmentID,sector,padRow)) 
@@ -264,9 +371,19 @@ void AliTPCDigitizer::DigitizeFast(Option_t* option)
       cerr<<"AliTPC warning: invalid segment ID ! "<<segmentID<<endl;
       continue;
      }
-    AliTPCCalROC * gainROC = gainTPC->GetCalROC(sector);  // pad gains per given sector
-    AliTPCCalROC * noiseROC = noiseTPC->GetCalROC(sector);  // noise per given sector
-    digrow->SetID(segmentID);
+    if (sector!=lastSector) {
+      if (nSectors==nSectorsGroup) break;
+      nSectors++;
+      lastSector = sector;
+    }
+    AliTPCMergeSegment segment;
+    segment.fSegmentID = segmentID;
+    segment.fSector = sector;
+    segment.fPadRow = padRow;
+    segment.fNoise = 0;
+    segment.fTime = 0;
+    segment.fOutput = 0;
+    segment.fInputs.assign(nInputs,(AliSimDigits*)0);
 
     Int_t nTimeBins = 0;
     Int_t nPads = 0;
@@ -275,117 +392,97 @@ void AliTPCDigitizer::DigitizeFast(Option_t* option)
     for (Int_t i=0;i<nInputs; i++) 
      { 
 
-      rl = AliRunLoader::GetRunLoader(fDigInput->GetInputFolderName(i));
-      gime = rl->GetLoader("TPCLoader");
-      
+      AliRunLoader *rl = AliRunLoader::GetRunLoader(fDigInput->GetInputFolderName(i));
+      AliLoader *gime = rl->GetLoader("TPCLoader");
+    
       if (gime->TreeS()->GetEntryWithIndex(segmentID,segmentID) >= 0) {
-	digarr[i]->ExpandBuffer();
-	digarr[i]->ExpandTrackBuffer();
+        segment.fInputs[i] = new AliSimDigits(*digarr[i]);  // stays compressed
         nTimeBins = digarr[i]->GetNRows();
         nPads = digarr[i]->GetNCols();
-	active[i] = kTRUE;
-	if (!GetRegionOfInterest() || (i == 0)) digitize = kTRUE;
-      } else {
-	active[i] = kFALSE;
+        if (!GetRegionOfInterest() || (i == 0)) digitize = kTRUE;
       }
       if (GetRegionOfInterest() && !digitize) break;
      }   
-    if (!digitize) continue;
-
-    digrow->Allocate(nTimeBins,nPads);
-    digrow->AllocateTrack(3);
+    if (!digitize) {
+      for (Int_t i=0;i<nInputs; i++) delete segment.fInputs[i];
+      continue;
+    }
+    if (reserveNoise) segment.fNoise = pTPC->SkipNoise(nTimeBins*nPads);
+    segments.push_back(segment);
+   }
+  return segmentID;
+}
 
-    Float_t q=0;
-    Int_t label[1000]; //stack for 300 events 
-    Int_t labptr = 0;
+//------------------------------------------------------------------------
+void AliTPCDigitizer::MergeSegment(AliTPCMergeSegment &segment, AliTPC *pTPC, AliTPCParam *param,
+                                   AliTPCCalPad *gainTPC, AliTPCCalPad *noiseTPC, const Int_t *masks,
+                                   std::vector<Float_t> &signal, std::vector<UChar_t> &nTracks,
+                                   std::vector<UChar_t> &mark) const
+{
+  //
+  // merge the input segments of one pad row and digitize it: the inputs
+  // are added without expanding them, then gain, noise, zero suppression
+  // and the first three track labels of the digits above threshold.
+  // The work arrays are given by the caller, one set per thread.
+  //
+  Int_t zerosup = param->GetZeroSup(); 
+  Int_t nInputs = segment.fInputs.size();
+  Int_t nTimeBins = 0;
+  Int_t nPads = 0;
+  for (Int_t i=0;i<nInputs; i++) if (segment.fInputs[i]) {
+    nTimeBins = segment.fInputs[i]->GetNRows();
+    nPads = segment.fInputs[i]->GetNCols();
+  }
+  Int_t nElems = nTimeBins*nPads;
+  signal.assign(nElems,0.);
+  nTracks.assign(nElems,0);
+  mark.assign(nElems,0);
+
+  AliSimDigits *digrow = new AliSimDigits;
+  digrow->SetID(segment.fSegmentID);
+  digrow->Allocate(nTimeBins,nPads);
+  digrow->AllocateTrack(3);
+  Short_t *pdig1= digrow->GetDigits();
+  Int_t   *ptr1= digrow->GetTracks() ;
+  if (nElems>0) {
+    for (Int_t i=0;i<nInputs; i++) if (segment.fInputs[i]) {
+      segment.fInputs[i]->MergeTo(&signal[0],ptr1,3,&nTracks[0],&mark[0],zerosup,masks[i]);
+    }
+  }
 
-    Int_t nElems = nTimeBins*nPads;     
- 
-    for (Int_t i=0;i<nInputs; i++)
-     if (active[i]) { 
-       pdig[i] = digarr[i]->GetDigits();
-       ptr[i]  = digarr[i]->GetTracks();
+  Int_t padRow = segment.fPadRow;
+  AliTPCCalROC * gainROC = gainTPC->GetCalROC(segment.fSector);  // pad gains per given sector
+  AliTPCCalROC * noiseROC = noiseTPC->GetCalROC(segment.fSector);  // noise per given sector
+  Int_t noiseIndex = segment.fNoise;
+  for (Int_t elem=0;elem<nElems; elem++)
+   {    
+     Float_t q = signal[elem];
+     q/=16.;  //conversion factor
+     Float_t gain = gainROC->GetValue(padRow,elem/nTimeBins);  // get gain for given - pad-row pad
+     q*= gain;
+     Float_t noisePad = noiseROC->GetValue(padRow,elem/nTimeBins);
+     Float_t noise  = pTPC->GetNoise(noiseIndex);
+     q+=noise*noisePad;
+     q=TMath::Nint(q);
+     if (q > zerosup)
+      { 
+       if(q >= param->GetADCSat()) q = (Short_t)(param->GetADCSat() - 1);
+       pdig1[elem] =Short_t(q);
       }
-     
-    Short_t *pdig1= digrow->GetDigits();
-    Int_t   *ptr1= digrow->GetTracks() ;
-
-    
-
-    for (Int_t elem=0;elem<nElems; elem++)
-     {    
-
-       q=0;
-       labptr=0;
-       // looop over digits 
-        for (Int_t i=0;i<nInputs; i++) if (active[i]) 
-         { 
-          //          q  += digarr[i]->GetDigitFast(rows,col);
-            q  += *(pdig[i]);
-         
-           for (Int_t tr=0;tr<3;tr++) 
-            {
-             //             Int_t lab = digarr[i]->GetTrackIDFast(rows,col,tr);
-             Int_t lab = ptr[i][tr*nElems];
-             if ( (lab > 1) && *(pdig[i])>zerosup) 
-              {
-                label[labptr]=lab+masks[i];
-                labptr++;
-              }          
-            }
-           pdig[i]++;
-           ptr[i]++;
-         }
-        q/=16.;  //conversion factor
-	Float_t gain = gainROC->GetValue(padRow,elem/nTimeBins);  // get gain for given - pad-row pad
-	//if (gain<0.5){
-	  //printf("problem\n");
-	//}
-	q*= gain;
-	Float_t noisePad = noiseROC->GetValue(padRow,elem/nTimeBins);
-        //       Float_t noise  = gRandom->Gaus(0,param->GetNoise()*param->GetNoiseNormFac());  
-        Float_t noise  = pTPC->GetNoise();
-        q+=noise*noisePad;
-        q=TMath::Nint(q);
-        if (q > zerosup)
-         { 
-          if(q >= param->GetADCSat()) q = (Short_t)(param->GetADCSat() - 1);
-          //digrow->SetDigitFast((Short_t)q,rows,col);  
-          *pdig1 =Short_t(q);
-          for (Int_t tr=0;tr<3;tr++)
-           {
-            if (tr<labptr) 
-             ptr1[tr*nElems] = label[tr];
-           }
-          }
-        pdig1++;
-        ptr1++;
-     }
-    //
-    //  glitch filter
-    //
-    if (useGlitchFilter) digrow->GlitchFilter();
-    //
-    digrow->CompresBuffer(1,zerosup);
-    digrow->CompresTrackBuffer(1);
-    tree->Fill();
-    if (fDebug>0) cerr<<sector<<"\t"<<padRow<<"\n";  
-   } //for (Int_t n=0; n<param->GetNRowsTotal(); n++) 
-  
-
-  orl = AliRunLoader::GetRunLoader(fDigInput->GetOutputFolderName());
-  ogime = orl->GetLoader("TPCLoader");
-  ogime->WriteDigits("OVERWRITE");
-  
-  //fDigInput->GetTreeDTPC()->Write(0,TObject::kOverwrite);
-  
-  delete digrow;     
-  for (Int_t i1=0;i1<nInputs; i1++) delete digarr[i1];
-  delete []masks;
-  delete []pdig;
-  delete []ptr;
-  delete []active;
-  delete []digarr;  
+     else if (nTracks[elem]>0)
+      {
+       // labels only for digits above threshold
+       for (Int_t tr=0;tr<3;tr++) ptr1[tr*nElems+elem] = 0;
+      }
+   }
+  //
+  //  glitch filter
+  //
+  if (param->GetUseGlitchFilter()) digrow->GlitchFilter();
+  //
+  digrow->CompresBuffer(1,zerosup);
+  digrow->CompresTrackBuffer(1);
+  segment.fOutput = digrow;
 }
 
 
@@ -661,7 +758,6 @@ void AliTPCDigitizer::DigitizeWithTailAndCrossTalk(Option_t* option)
   }
   AliTPC *pTPC  = (AliTPC *) gAlice->GetModule("TPC");
   AliTPCParam * param = pTPC->GetParam();
-  const Bool_t useGlitchFilter=param->GetUseGlitchFilter();
 
   //sprintf(s,param->GetTitle());
   snprintf(s,100,"%s",param->GetTitle());
@@ -686,9 +782,6 @@ void AliTPCDigitizer::DigitizeWithTailAndCrossTalk(Option_t* option)
   Int_t * masks = new Int_t[nInputs];
   for (Int_t i=0; i<nInputs;i++)
     masks[i]= fDigInput->GetMask(i);
-  Short_t **pdig= new Short_t*[nInputs];   //pointers to the expanded digits array
-  Int_t **ptr=  new Int_t*[nInputs];       //pointers to the expanded tracks array
-  Bool_t *active=  new Bool_t[nInputs];    //flag for active input segments
   Char_t phname[100];
 
   //create digits array for given sectors
@@ -726,10 +819,7 @@ void AliTPCDigitizer::DigitizeWithTailAndCrossTalk(Option_t* option)
         if(digarr[i2])  delete digarr[i2];
       }
       delete [] digarr;
-      delete [] active;
       delete []masks;
-      delete []pdig;
-      delete []ptr;
       return;
     }
 
@@ -745,10 +835,7 @@ void AliTPCDigitizer::DigitizeWithTailAndCrossTalk(Option_t* option)
         if(digarr[i2])  delete digarr[i2];
       }
       delete [] digarr;
-      delete [] active;
       delete []masks;
-      delete []pdig;
-      delete []ptr;
       return;
     }
     tree->GetUserInfo()->Add(new TParameter<float>(phname,ph->GetVal()));
@@ -762,8 +849,7 @@ void AliTPCDigitizer::DigitizeWithTailAndCrossTalk(Option_t* option)
 
 
   //
-  // zero supp, take gain and noise map of TPC from OCDB 
-  Int_t zerosup = param->GetZeroSup(); 
+  // take gain and noise map of TPC from OCDB 
   AliTPCCalPad * gainTPC = AliTPCcalibDB::Instance()->GetDedxGainFactor(); 
   AliTPCCalPad * noiseTPC = AliTPCcalibDB::Instance()->GetPadNoise(); 
 
@@ -798,16 +884,36 @@ void AliTPCDigitizer::DigitizeWithTailAndCrossTalk(Option_t* option)
     nIonTailBins = graphRes[3]->GetN();
   }
 
+  //
+  // The input segments of a group of sectors are read in sequence and kept
+  // compressed, the sectors are processed in parallel with
+  // AliTPC::SetNThreads: the crosstalk and the ion tail only couple pads
+  // of one sector. The position in the noise table is reserved when a
+  // segment is read, the digits do not depend on the number of threads.
+  // The per pad debug stream is written by one thread.
+  //
+  Int_t nThreads = 1;
+#ifdef _OPENMP
+  nThreads = pTPC->GetNThreads();
+  if (nThreads<=0) nThreads = omp_get_max_threads();
+  if ((AliTPCReconstructor::StreamLevel()&kStreamSignal)>0) nThreads = 1;
+#endif
+  const Int_t nSectorsGroup = (nThreads>1) ? 2*nThreads : 1;
+  const Int_t nSegmentsTotal = param->GetNRowsTotal();
+  TStopwatch timerRead, timerCrossTalk, timerDigitize, timerStore;
+  timerRead.Reset();
+  timerCrossTalk.Reset();
+  timerDigitize.Reset();
+  timerStore.Reset();
+
   //
   // 1.) Make first loop to calculate mean amplitude per pad per segment for cross talk 
   //
   
   TObjArray   crossTalkSignalArray(nROCs);  // for 36 sectors 
-  TVectorD  * qTotSector  = new TVectorD(nROCs);
-  TVectorD  * nTotSector  = new TVectorD(nROCs);
-  Float_t qTotTPC = 0.;
-  Float_t qTotPerSector = 0.;
-  Float_t nTotPerSector = 0.;
+  crossTalkSignalArray.SetOwner(kTRUE);
+  TVectorD  qTotSector(nROCs);
+  TVectorD  nTotSector(nROCs);
   Int_t nTimeBinsAll = 1100;
   Int_t nWireSegments=11;
   // 1.a) crorstalk matrix initialization
@@ -820,69 +926,34 @@ void AliTPCDigitizer::DigitizeWithTailAndCrossTalk(Option_t* option)
     crossTalkSignalArray.AddAt(pcrossTalkSignal,sector);
   }
   //  
-  // main loop over rows of whole TPC
-  for (Int_t globalRowID=0; globalRowID<param->GetNRowsTotal(); globalRowID++) {
-    Int_t sector, padRow;
-    if (!param->AdjustSectorRow(globalRowID,sector,padRow)) {
-      cerr<<"AliTPC warning: invalid segment ID ! "<<globalRowID<<endl;
-      continue;
-    }
-    // Calculate number of pads in a anode wire segment for normalization
-    Int_t wireSegmentID    = param->GetWireSegment(sector,padRow);
-    Float_t nPadsPerSegment = (Float_t)(param->GetNPadsPerSegment(wireSegmentID));
-    // structure with mean signal per pad to be filled for each timebin in first loop (11 anodeWireSegment and 1100 timebin)
-    TMatrixD &crossTalkSignal =  *((TMatrixD*)crossTalkSignalArray.At(sector));
-    AliTPCCalROC * gainROC = gainTPC->GetCalROC(sector);  // pad gains per given sector
-    //  digrow->SetID(globalRowID);
-    Int_t nTimeBins = 0;
-    Int_t nPads = 0;
-    Bool_t digitize = kFALSE;
-    for (Int_t i=0;i<nInputs; i++){   //here we can have more than one input  - merging of separate events, signal1+signal2+background 
-      rl = AliRunLoader::GetRunLoader(fDigInput->GetInputFolderName(i));
-      gime = rl->GetLoader("TPCLoader");
-      if (gime->TreeS()->GetEntryWithIndex(globalRowID,globalRowID) >= 0) {
-        digarr[i]->ExpandBuffer();
-        digarr[i]->ExpandTrackBuffer();
-        nTimeBins = digarr[i]->GetNRows();
-        nPads = digarr[i]->GetNCols();
-        active[i] = kTRUE;
-        if (!GetRegionOfInterest() || (i == 0)) digitize = kTRUE;
-      } else {
-        active[i] = kFALSE;
+  // main loop over rows of whole TPC, the rows of one sector in one thread
+  Int_t firstSegment = 0;
+  while (firstSegment<nSegmentsTotal) {
+    timerRead.Start(kFALSE);
+    std::vector<AliTPCMergeSegment> segments;
+    firstSegment = ReadSegments(segments,firstSegment,nSectorsGroup,digarr,pTPC,param,kFALSE);
+    timerRead.Stop();
+    timerCrossTalk.Start(kFALSE);
+    std::vector<Int_t> sectorStart;  // first segment of each sector of the group
+    for (UInt_t iseg=0; iseg<segments.size(); iseg++)
+      if (iseg==0 || segments[iseg].fSector!=segments[iseg-1].fSector) sectorStart.push_back(iseg);
+    const Int_t nSectors = sectorStart.size();
+    sectorStart.push_back(segments.size());
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nThreads) schedule(dynamic,1)
+#endif
+    for (Int_t isec=0; isec<nSectors; isec++) {
+      for (Int_t iseg=sectorStart[isec]; iseg<sectorStart[isec+1]; iseg++) {
+        AliTPCMergeSegment &segment = segments[iseg];
+        Int_t sector = segment.fSector;
+        CrossTalkSegment(segment,param,gainTPC,*((TMatrixD*)crossTalkSignalArray.At(sector)),
+                         qTotSector[sector],nTotSector[sector]);
+        for (Int_t i=0;i<nInputs; i++) delete segment.fInputs[i];
       }
-      if (GetRegionOfInterest() && !digitize) break;
-    }   
-    if (!digitize) continue;
-    //digrow->Allocate(nTimeBins,nPads);
-    Float_t q    = 0;
-    Int_t labptr = 0;
-    Int_t nElems = nTimeBins*nPads; // element is a unit of a given row's pad-timebin space        
-    for (Int_t i=0;i<nInputs; i++)
-      if (active[i]) { 
-        pdig[i] = digarr[i]->GetDigits();
-      }
-    //    
-    // loop over elements i.e pad-timebin space of a row, "padNumber=elem/nTimeBins", "timeBin=elem%nTimeBins"
-    // 
-    for (Int_t elem=0;elem<nElems; elem++) {    
-      q=0;
-      labptr=0;
-      // looop over digits 
-      for (Int_t i=0;i<nInputs; i++) if (active[i])       { 
-        q  += *(pdig[i]);
-        pdig[i]++;
-      }
-      if (q<=0) continue;   
-      Int_t padNumber = elem/nTimeBins;
-      Int_t timeBin   = elem%nTimeBins;      
-      Float_t gain = gainROC->GetValue(padRow,padNumber);  // get gain for given - pad-row pad
-      q*= gain;
-      crossTalkSignal[wireSegmentID][timeBin]+= q/nPadsPerSegment;        // Qtot per segment for a given timebin
-      qTotSector -> GetMatrixArray()[sector] += q;                      // Qtot for each sector
-      nTotSector -> GetMatrixArray()[sector] += 1;                      // Ntot digit counter for each sector
-      qTotTPC += q;                                                        // Qtot for whole TPC       
-    } // end of q loop
+    }
+    timerCrossTalk.Stop();
   } // end of global row loop
+  const Float_t qTotTPC = qTotSector.Sum();  // Qtot for whole TPC
 
   //
   // 1.b) Dump the content of the crossTalk signal to the debug stremer - to be corealted later with the same crosstalk correction
@@ -922,229 +993,49 @@ void AliTPCDigitizer::DigitizeWithTailAndCrossTalk(Option_t* option)
   // 2.) Loop over segments (padrows) of the TPC 
   //  
   // 
+  AliSimDigits * digrowDefault = digrow;
   TTree * treeStreamer=0;
-  for (Int_t globalRowID=0; globalRowID<param->GetNRowsTotal(); globalRowID++) {
-    Int_t sector, padRow;
-    if (!param->AdjustSectorRow(globalRowID,sector,padRow)) {
-      cerr<<"AliTPC warning: invalid segment ID ! "<<globalRowID<<endl;
-      continue;
+  firstSegment = 0;
+  while (firstSegment<nSegmentsTotal) {
+    timerRead.Start(kFALSE);
+    std::vector<AliTPCMergeSegment> segments;
+    firstSegment = ReadSegments(segments,firstSegment,nSectorsGroup,digarr,pTPC,param,kTRUE);
+    timerRead.Stop();
+    timerDigitize.Start(kFALSE);
+    const Int_t nSegments = segments.size();
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nThreads) schedule(dynamic,1)
+#endif
+    for (Int_t iseg=0; iseg<nSegments; iseg++) {
+      DigitizeSegmentWithTailAndCrossTalk(segments[iseg],pTPC,param,recoParam,gainTPC,noiseTPC,masks,
+                                          crossTalkSignalArray,qTotSector,nTotSector,qTotTPC,
+                                          timeResFunc,nIonTailBins,treeStreamer);
+      for (Int_t i=0;i<nInputs; i++) delete segments[iseg].fInputs[i];
     }
-    TObjArray *arrTRF = (TObjArray*)timeResFunc.At(sector);  
-    //    TGraphErrors  *graphTRF = (TGraphErrors*)arrTRF->At(1);
-    Int_t wireSegmentID    = param->GetWireSegment(sector,padRow);
-    Float_t nPadsPerSegment = (Float_t)(param->GetNPadsPerSegment(wireSegmentID));
-    //    const Float_t ampfactor = (sector<36)?factorIROC:factorOROC;      // factor for the iontail which is ROC type dependent
-    AliTPCCalROC * gainROC  = gainTPC->GetCalROC(sector);  // pad gains per given sector
-    AliTPCCalROC * noiseROC = noiseTPC->GetCalROC(sector);  // noise per given sector
-    digrow->SetID(globalRowID);
-    Int_t nTimeBins = 0;
-    Int_t nPads = 0;
-    Bool_t digitize = kFALSE;
-    for (Int_t i=0;i<nInputs; i++) {   //here we can have more than one input  - merging of separate events, signal1+signal2+background
-      rl = AliRunLoader::GetRunLoader(fDigInput->GetInputFolderName(i));
-      gime = rl->GetLoader("TPCLoader");
-      if (gime->TreeS()->GetEntryWithIndex(globalRowID,globalRowID) >= 0) {
-        digarr[i]->ExpandBuffer();
-        digarr[i]->ExpandTrackBuffer();
-        nTimeBins = digarr[i]->GetNRows();
-        nPads = digarr[i]->GetNCols();
-        active[i] = kTRUE;
-        if (!GetRegionOfInterest() || (i == 0)) digitize = kTRUE;
-      } else {
-        active[i] = kFALSE;
-      }
-      if (GetRegionOfInterest() && !digitize) break;
-    }   
-    if (!digitize) continue;
-    
-    digrow->Allocate(nTimeBins,nPads);
-    digrow->AllocateTrack(3);
-    
-    Int_t localPad = 0;
-    Float_t q    = 0.;
-    Float_t qXtalk   = 0.;
-    Float_t qIonTail = 0.;
-    Float_t qOrig = 0.;
-    Int_t label[1000]; //stack for 300 events 
-    Int_t labptr = 0;
-    Int_t nElems = nTimeBins*nPads; // element is a unit of a given row's pad-timebin space    
-    for (Int_t i=0;i<nInputs; i++)
-      if (active[i]) { 
-        pdig[i] = digarr[i]->GetDigits();
-        ptr[i]  = digarr[i]->GetTracks();
-      }
-    Short_t *pdig1= digrow->GetDigits();
-    Int_t   *ptr1= digrow->GetTracks() ;
-    // loop over elements i.e pad-timebin space of a row
-    for (Int_t elem=0;elem<nElems; elem++)     {     
-      q=0; 
-      labptr=0;
-      // looop over digits 
-      for (Int_t i=0;i<nInputs; i++) if (active[i]){ 
-        q  += *(pdig[i]);
-        for (Int_t tr=0;tr<3;tr++)         {
-          Int_t lab = ptr[i][tr*nElems];
-          if ( (lab > 1) && *(pdig[i])>zerosup) {
-            label[labptr]=lab+masks[i];
-            labptr++;
-          }          
-        }
-        pdig[i]++;
-        ptr[i]++;
-      }
-      Int_t padNumber = elem/nTimeBins;
-      Int_t timeBin   = elem%nTimeBins;
-      localPad = padNumber-nPads/2;
-      
-      Float_t gain = gainROC->GetValue(padRow,padNumber);  // get gain for given - pad-row pad
-      //if (gain<0.5){
-      //printf("problem\n");
-      //}
-      q*= gain;
-      qOrig = q;
-      Float_t noisePad = noiseROC->GetValue(padRow,padNumber);
-      Float_t noise  = pTPC->GetNoise()*noisePad;
-      if ( (q/16.+noise)> zerosup  || ((AliTPCReconstructor::StreamLevel()&kStreamSignalAll)>0)){
-	// Crosstalk correction 
-	qXtalk = (*(TMatrixD*)crossTalkSignalArray.At(sector))[wireSegmentID][timeBin];
-	qTotPerSector = qTotSector -> GetMatrixArray()[sector];    
-	nTotPerSector = nTotSector -> GetMatrixArray()[sector];    
-	
-	// Ion tail correction: being elem=padNumber*nTimeBins+timeBin;
-	Int_t lowerElem=elem-nIonTailBins;    
-	Int_t zeroElem =(elem/nTimeBins)*nTimeBins;
-	if (zeroElem<0) zeroElem=0;
-	if (lowerElem<zeroElem) lowerElem=zeroElem;
-	// 
-	qIonTail=0;
-	if (q>0 && recoParam->GetUseIonTailCorrection()){
-	  for (Int_t i=0;i<nInputs; i++) if (active[i]){ 
-	    Short_t *pdigC= digarr[i]->GetDigits();
-	    if (padNumber==0) continue;
-	    if (padNumber>=nPads-1) continue;
-	    for (Int_t dpad=-1; dpad<=1; dpad++){          // calculate iontail due signals from neigborhood pads
-	      for (Int_t celem=elem-1; celem>lowerElem; celem--){
-		Int_t celemPad=celem+dpad*nTimeBins;
-		Double_t qCElem=pdigC[celemPad];
-		if ( qCElem<=0) continue;
-		//here we substract ion tail	
-		Double_t COG=0;
-		if (celemPad-nTimeBins>nTimeBins && celemPad+nTimeBins<nElems){   // COG calculation in respect to current pad in pad units
-		  Double_t sumAmp=pdigC[celemPad-nTimeBins]+pdigC[celemPad]+pdigC[celemPad+nTimeBins];
-		  COG=(-1.0*pdigC[celemPad-nTimeBins]+pdigC[celemPad+nTimeBins])/sumAmp;
-		}
-		Int_t indexTRFPRF = (TMath::Nint(TMath::Abs(COG*10.))%20);
-		TGraphErrors  *graphTRFPRF = (TGraphErrors*)arrTRF->At(indexTRFPRF);
-		if (graphTRFPRF==NULL) continue;
-		// here we should get index and point of TRF corresponding to given COG position
-		if (graphTRFPRF->GetY()[elem-celem]<0)qIonTail+=qCElem*graphTRFPRF->GetY()[elem-celem];
-	      }
-	    }
-	  }
-	}
-      }
-      //
-      q -= qXtalk*recoParam->GetCrosstalkCorrection();
-      q+=qIonTail;
-      q/=16.;                                              //conversion factor
-      q+=noise;	
-      q=TMath::Nint(q);  // round to the nearest integer
-      
-      
-      // fill info for degugging
-      if ( ((AliTPCReconstructor::StreamLevel()&kStreamSignal)>0) && ((qOrig > zerosup)||((AliTPCReconstructor::StreamLevel()&kStreamSignalAll)>0) )) {
-	TTreeSRedirector &cstream = *fDebugStreamer;
-	UInt_t uid = AliTPCROC::GetTPCUniqueID(sector, padRow, padNumber);
-	qXtalk = (*(TMatrixD*)crossTalkSignalArray.At(sector))[wireSegmentID][timeBin];
-	//
-	if (treeStreamer==0){
-	  cstream <<"ionTailXtalk"<<
-	    "uid="<<uid<<                        // globla unique identifier
-	    "sector="<< sector<<   
-	    "globalRowID="<<globalRowID<<
-	    "padRow="<< padRow<<                 //pad row
-	    "wireSegmentID="<< wireSegmentID<<   //wire segment 0-11, 0-3 in IROC 4-10 in OROC 
-	    "localPad="<<localPad<<              // pad number -npads/2 .. npads/2
-	    "padNumber="<<padNumber<<            // pad number 0..npads 
-	    "timeBin="<< timeBin<<               // time bin 
-	    "nPadsPerSegment="<<nPadsPerSegment<<// number of pads per wire segment	  
-	    "qTotPerSector="<<qTotPerSector<<    // total charge in sector 
-	    "nTotPerSector="<<nTotPerSector<<    // total number of digit (above threshold) in sector 
-	    //
-	    "noise="<<noise<<                    // electornic noise contribution
-	    "qTotTPC="<<qTotTPC<<                // acumulated charge without crosstalk and ion tail in full TPC
-	    "qOrig="<< qOrig<<                   // charge in given pad-row,pad,time-bin
-	    "q="<<q<<                            // q=qOrig-qXtalk-qIonTail - to check sign of the effects
-	    "qXtalk="<<qXtalk<<                  // crosstal contribtion at given position
-	    "qIonTail="<<qIonTail<<              // ion tail cotribution from past signal
-	    "\n";
-	  treeStreamer=(cstream <<"ionTailXtalk").GetTree();
-	}else{
-	  treeStreamer->Fill();
-	} // dump the results to the debug streamer if in debug mode
-      }
-      if (q > zerosup || fgSAMPAEmulator!=NULL){ 
-        if(q >= param->GetADCSat()) q = (Short_t)(param->GetADCSat() - 1);
-        //digrow->SetDigitFast((Short_t)q,rows,col);  
-        *pdig1 =Short_t(q);
-        for (Int_t tr=0;tr<3;tr++)
-	  {
-	    if (tr<labptr) 
-	      ptr1[tr*nElems] = label[tr];
-	  }
-      }
-      if (fgSAMPAEmulator && (timeBin==nTimeBins-1)) {  // pocess Emulator for given pad
-	//
-	TVectorD vecSAMPAIn(nTimeBins); // allocate workin array for SAMPA emulator processing (if set)
-	TVectorD vecSAMPAOut(nTimeBins); // allocate workin array for SAMPA emulator processing (if set)
-	Double_t baseline=0;
-        for (Int_t itime=0; itime<nTimeBins;itime++) vecSAMPAIn[itime]=pdig1[1+itime-nTimeBins];  // set workin array for SAMPA emulator 
-        for (Int_t itime=0; itime<nTimeBins;itime++) vecSAMPAOut[itime]=pdig1[1+itime-nTimeBins];  // set workin array for SAMPA emulator 
-	fgSAMPAEmulator->DigitalFilterFloat(nTimeBins, vecSAMPAOut.GetMatrixArray(), baseline);
-	//
-	if ( ((AliTPCReconstructor::StreamLevel()&kStreamSignal)>0)){	  
-	  (*fDebugStreamer)<<"sampaEmulator"<<
-	    "sector="<< sector<<   
-	    "globalRowID="<<globalRowID<<
-	    "padRow="<< padRow<<                 //pad row
-	    "wireSegmentID="<< wireSegmentID<<   //wire segment 0-11, 0-3 in IROC 4-10 in OROC 
-	    "localPad="<<localPad<<              // pad number -npads/2 .. npads/2
-	    "padNumber="<<padNumber<<            // pad number 0..npads 
-	    "timeBin="<< timeBin<<               // time bin 
-	    "nPadsPerSegment="<<nPadsPerSegment<<// number of pads per wire segment	  
-	    "qTotPerSector="<<qTotPerSector<<    // total charge in sector 
-	    "nTotPerSector="<<nTotPerSector<<    // total number of digit (above threshold) in sector 
-	    "vSAMPAin.="<<&vecSAMPAIn<<          // input  data
-	    "vSAMPAout.="<<&vecSAMPAOut<<        // ouptut data
-	    "\n";
-	}
-	for (Int_t itime=0; itime<nTimeBins;itime++) {
-	  if ( TMath::Nint(vecSAMPAOut[itime]) <  zerosup) pdig1[1+itime-nTimeBins]=0;
-	  else{
-	    pdig1[1+itime-nTimeBins]=TMath::Nint(vecSAMPAOut[itime]);
-	  }
-	}
-      }
-      pdig1++;
-      ptr1++;
-    }
-    
+    timerDigitize.Stop();
     //
-    //  glitch filter
+    // store in the order of the segment ID
     //
-    if (useGlitchFilter) digrow->GlitchFilter();
-    //
-    digrow->CompresBuffer(1,zerosup);
-    digrow->CompresTrackBuffer(1);
-    tree->Fill();
-    if (fDebug>0) cerr<<sector<<"\t"<<padRow<<"\n"; 
-    if (padRow==0 && fDebugStreamer) {
-      ((*fDebugStreamer)<<"ionTailXtalk").GetTree()->FlushBaskets();
-      ((*fDebugStreamer)<<"ionTailXtalk").GetTree()->Write();
-      (fDebugStreamer->GetFile())->Flush();
+    timerStore.Start(kFALSE);
+    for (Int_t iseg=0; iseg<nSegments; iseg++) {
+      AliTPCMergeSegment &segment = segments[iseg];
+      digrow = segment.fOutput;
+      tree->Fill();
+      if (fDebug>0) cerr<<segment.fSector<<"\t"<<segment.fPadRow<<"\n"; 
+      if (segment.fPadRow==0 && fDebugStreamer) {
+        ((*fDebugStreamer)<<"ionTailXtalk").GetTree()->FlushBaskets();
+        ((*fDebugStreamer)<<"ionTailXtalk").GetTree()->Write();
+        (fDebugStreamer->GetFile())->Flush();
+      }
+      delete segment.fOutput;
     }
+    digrow = digrowDefault;
+    timerStore.Stop();
   } //for (Int_t n=0; n<param->GetNRowsTotal(); n++) 
 
+  AliInfo(Form("%d inputs, %d threads: read %.2f s, crosstalk %.2f s, digitize %.2f s, store %.2f s",
+               nInputs, nThreads, timerRead.RealTime(), timerCrossTalk.RealTime(), timerDigitize.RealTime(),
+               timerStore.RealTime()));
 
   orl = AliRunLoader::GetRunLoader(fDigInput->GetOutputFolderName());
   ogime = orl->GetLoader("TPCLoader");
@@ -1155,8 +1046,277 @@ void AliTPCDigitizer::DigitizeWithTailAndCrossTalk(Option_t* option)
   delete digrow;     
   for (Int_t i1=0;i1<nInputs; i1++) delete digarr[i1];
   delete []masks;
-  delete []pdig;
-  delete []ptr;
-  delete []active;
   delete []digarr;  
 }
+
+//------------------------------------------------------------------------
+void AliTPCDigitizer::CrossTalkSegment(AliTPCMergeSegment &segment, AliTPCParam *param, AliTPCCalPad *gainTPC,
+                                       TMatrixD &crossTalkSignal, Double_t &qTotSector, Double_t &nTotSector) const
+{
+  //
+  // add the gain corrected signal of one pad row to the mean signal per
+  // pad of its anode wire segment (crosstalk matrix of the sector) and to
+  // the total charge and number of digits of the sector
+  //
+  Int_t sector = segment.fSector;
+  Int_t padRow = segment.fPadRow;
+  Int_t nInputs = segment.fInputs.size();
+  // Calculate number of pads in a anode wire segment for normalization
+  Int_t wireSegmentID    = param->GetWireSegment(sector,padRow);
+  Float_t nPadsPerSegment = (Float_t)(param->GetNPadsPerSegment(wireSegmentID));
+  AliTPCCalROC * gainROC = gainTPC->GetCalROC(sector);  // pad gains per given sector
+  Int_t nTimeBins = 0;
+  Int_t nPads = 0;
+  std::vector<Short_t*> pdig(nInputs,(Short_t*)0);  //pointers to the expanded digits array
+  for (Int_t i=0;i<nInputs; i++) if (segment.fInputs[i]) {
+    segment.fInputs[i]->ExpandBuffer();
+    nTimeBins = segment.fInputs[i]->GetNRows();
+    nPads = segment.fInputs[i]->GetNCols();
+    pdig[i] = segment.fInputs[i]->GetDigits();
+  }
+  Float_t q    = 0;
+  Int_t nElems = nTimeBins*nPads; // element is a unit of a given row's pad-timebin space        
+  //    
+  // loop over elements i.e pad-timebin space of a row, "padNumber=elem/nTimeBins", "timeBin=elem%nTimeBins"
+  // 
+  for (Int_t elem=0;elem<nElems; elem++) {    
+    q=0;
+    // looop over digits 
+    for (Int_t i=0;i<nInputs; i++) if (pdig[i])       { 
+      q  += *(pdig[i]);
+      pdig[i]++;
+    }
+    if (q<=0) continue;   
+    Int_t padNumber = elem/nTimeBins;
+    Int_t timeBin   = elem%nTimeBins;      
+    Float_t gain = gainROC->GetValue(padRow,padNumber);  // get gain for given - pad-row pad
+    q*= gain;
+    crossTalkSignal[wireSegmentID][timeBin]+= q/nPadsPerSegment;        // Qtot per segment for a given timebin
+    qTotSector += q;                                                     // Qtot for each sector
+    nTotSector += 1;                                                     // Ntot digit counter for each sector
+  } // end of q loop
+}
+
+//------------------------------------------------------------------------
+void AliTPCDigitizer::DigitizeSegmentWithTailAndCrossTalk(AliTPCMergeSegment &segment, AliTPC *pTPC, AliTPCParam *param,
+                                                          const AliTPCRecoParam *recoParam, AliTPCCalPad *gainTPC,
+                                                          AliTPCCalPad *noiseTPC, const Int_t *masks,
+                                                          const TObjArray &crossTalkSignalArray,
+                                                          const TVectorD &qTotSector, const TVectorD &nTotSector,
+                                                          Float_t qTotTPC, const TObjArray &timeResFunc,
+                                                          Int_t nIonTailBins, TTree *&treeStreamer) const
+{
+  //
+  // digitize one pad row with the crosstalk and the ion tail: sum of the
+  // inputs, gain, crosstalk of the wire segment, ion tail of the signals
+  // of the same and the neighbouring pads, noise, SAMPA emulator, zero
+  // suppression and glitch filter. Only the inputs of the row and the
+  // crosstalk matrix of its sector are used, the rows can be digitized
+  // in parallel; the debug stream requires a single thread.
+  //
+  Int_t zerosup = param->GetZeroSup(); 
+  const Bool_t useGlitchFilter=param->GetUseGlitchFilter();
+  Int_t globalRowID = segment.fSegmentID;
+  Int_t sector = segment.fSector;
+  Int_t padRow = segment.fPadRow;
+  Int_t nInputs = segment.fInputs.size();
+  TObjArray *arrTRF = (TObjArray*)timeResFunc.At(sector);  
+  //    TGraphErrors  *graphTRF = (TGraphErrors*)arrTRF->At(1);
+  Int_t wireSegmentID    = param->GetWireSegment(sector,padRow);
+  Float_t nPadsPerSegment = (Float_t)(param->GetNPadsPerSegment(wireSegmentID));
+  //    const Float_t ampfactor = (sector<36)?factorIROC:factorOROC;      // factor for the iontail which is ROC type dependent
+  AliTPCCalROC * gainROC  = gainTPC->GetCalROC(sector);  // pad gains per given sector
+  AliTPCCalROC * noiseROC = noiseTPC->GetCalROC(sector);  // noise per given sector
+  const TMatrixD &crossTalkSignal = *((TMatrixD*)crossTalkSignalArray.At(sector));
+  Int_t nTimeBins = 0;
+  Int_t nPads = 0;
+  std::vector<Short_t*> pdig(nInputs,(Short_t*)0);  //pointers to the expanded digits array
+  std::vector<Int_t*> ptr(nInputs,(Int_t*)0);       //pointers to the expanded tracks array
+  for (Int_t i=0;i<nInputs; i++) if (segment.fInputs[i]) {
+    segment.fInputs[i]->ExpandBuffer();
+    segment.fInputs[i]->ExpandTrackBuffer();
+    nTimeBins = segment.fInputs[i]->GetNRows();
+    nPads = segment.fInputs[i]->GetNCols();
+    pdig[i] = segment.fInputs[i]->GetDigits();
+    ptr[i]  = segment.fInputs[i]->GetTracks();
+  }
+
+  AliSimDigits *digrow = new AliSimDigits;
+  digrow->SetID(globalRowID);
+  digrow->Allocate(nTimeBins,nPads);
+  digrow->AllocateTrack(3);
+  
+  Int_t localPad = 0;
+  Float_t q    = 0.;
+  Float_t qXtalk   = 0.;
+  Float_t qIonTail = 0.;
+  Float_t qOrig = 0.;
+  Float_t qTotPerSector = qTotSector[sector];
+  Float_t nTotPerSector = nTotSector[sector];
+  Int_t label[1000]; //stack for 300 events 
+  Int_t labptr = 0;
+  Int_t nElems = nTimeBins*nPads; // element is a unit of a given row's pad-timebin space    
+  Int_t noiseIndex = segment.fNoise;
+  Short_t *pdig1= digrow->GetDigits();
+  Int_t   *ptr1= digrow->GetTracks() ;
+  // loop over elements i.e pad-timebin space of a row
+  for (Int_t elem=0;elem<nElems; elem++)     {     
+    q=0; 
+    labptr=0;
+    // looop over digits 
+    for (Int_t i=0;i<nInputs; i++) if (pdig[i]){ 
+      q  += *(pdig[i]);
+      for (Int_t tr=0;tr<3;tr++)         {
+        Int_t lab = ptr[i][tr*nElems];
+        if ( (lab > 1) && *(pdig[i])>zerosup) {
+          label[labptr]=lab+masks[i];
+          labptr++;
+        }          
+      }
+      pdig[i]++;
+      ptr[i]++;
+    }
+    Int_t padNumber = elem/nTimeBins;
+    Int_t timeBin   = elem%nTimeBins;
+    localPad = padNumber-nPads/2;
+    
+    Float_t gain = gainROC->GetValue(padRow,padNumber);  // get gain for given - pad-row pad
+    //if (gain<0.5){
+    //printf("problem\n");
+    //}
+    q*= gain;
+    qOrig = q;
+    Float_t noisePad = noiseROC->GetValue(padRow,padNumber);
+    Float_t noise  = pTPC->GetNoise(noiseIndex)*noisePad;
+    if ( (q/16.+noise)> zerosup  || ((AliTPCReconstructor::StreamLevel()&kStreamSignalAll)>0)){
+      // Crosstalk correction 
+      qXtalk = crossTalkSignal[wireSegmentID][timeBin];
+      
+      // Ion tail correction: being elem=padNumber*nTimeBins+timeBin;
+      Int_t lowerElem=elem-nIonTailBins;    
+      Int_t zeroElem =(elem/nTimeBins)*nTimeBins;
+      if (zeroElem<0) zeroElem=0;
+      if (lowerElem<zeroElem) lowerElem=zeroElem;
+      // 
+      qIonTail=0;
+      if (q>0 && recoParam->GetUseIonTailCorrection()){
+        for (Int_t i=0;i<nInputs; i++) if (segment.fInputs[i]){ 
+          Short_t *pdigC= segment.fInputs[i]->GetDigits();
+          if (padNumber==0) continue;
+          if (padNumber>=nPads-1) continue;
+          for (Int_t dpad=-1; dpad<=1; dpad++){          // calculate iontail due signals from neigborhood pads
+            for (Int_t celem=elem-1; celem>lowerElem; celem--){
+              Int_t celemPad=celem+dpad*nTimeBins;
+              Double_t qCElem=pdigC[celemPad];
+              if ( qCElem<=0) continue;
+              //here we substract ion tail	
+              Double_t COG=0;
+              if (celemPad-nTimeBins>nTimeBins && celemPad+nTimeBins<nElems){   // COG calculation in respect to current pad in pad units
+                Double_t sumAmp=pdigC[celemPad-nTimeBins]+pdigC[celemPad]+pdigC[celemPad+nTimeBins];
+                COG=(-1.0*pdigC[celemPad-nTimeBins]+pdigC[celemPad+nTimeBins])/sumAmp;
+              }
+              Int_t indexTRFPRF = (TMath::Nint(TMath::Abs(COG*10.))%20);
+              TGraphErrors  *graphTRFPRF = (TGraphErrors*)arrTRF->At(indexTRFPRF);
+              if (graphTRFPRF==NULL) continue;
+              // here we should get index and point of TRF corresponding to given COG position
+              if (graphTRFPRF->GetY()[elem-celem]<0)qIonTail+=qCElem*graphTRFPRF->GetY()[elem-celem];
+            }
+          }
+        }
+      }
+    }
+    //
+    q -= qXtalk*recoParam->GetCrosstalkCorrection();
+    q+=qIonTail;
+    q/=16.;                                              //conversion factor
+    q+=noise;	
+    q=TMath::Nint(q);  // round to the nearest integer
+    
+    
+    // fill info for degugging
+    if ( ((AliTPCReconstructor::StreamLevel()&kStreamSignal)>0) && ((qOrig > zerosup)||((AliTPCReconstructor::StreamLevel()&kStreamSignalAll)>0) )) {
+      TTreeSRedirector &cstream = *fDebugStreamer;
+      UInt_t uid = AliTPCROC::GetTPCUniqueID(sector, padRow, padNumber);
+      qXtalk = crossTalkSignal[wireSegmentID][timeBin];
+      //
+      if (treeStreamer==0){
+        cstream <<"ionTailXtalk"<<
+          "uid="<<uid<<                        // globla unique identifier
+          "sector="<< sector<<   
+          "globalRowID="<<globalRowID<<
+          "padRow="<< padRow<<                 //pad row
+          "wireSegmentID="<< wireSegmentID<<   //wire segment 0-11, 0-3 in IROC 4-10 in OROC 
+          "localPad="<<localPad<<              // pad number -npads/2 .. npads/2
+          "padNumber="<<padNumber<<            // pad number 0..npads 
+          "timeBin="<< timeBin<<               // time bin 
+          "nPadsPerSegment="<<nPadsPerSegment<<// number of pads per wire segment	  
+          "qTotPerSector="<<qTotPerSector<<    // total charge in sector 
+          "nTotPerSector="<<nTotPerSector<<    // total number of digit (above threshold) in sector 
+          //
+          "noise="<<noise<<                    // electornic noise contribution
+          "qTotTPC="<<qTotTPC<<                // acumulated charge without crosstalk and ion tail in full TPC
+          "qOrig="<< qOrig<<                   // charge in given pad-row,pad,time-bin
+          "q="<<q<<                            // q=qOrig-qXtalk-qIonTail - to check sign of the effects
+          "qXtalk="<<qXtalk<<                  // crosstal contribtion at given position
+          "qIonTail="<<qIonTail<<              // ion tail cotribution from past signal
+          "\n";
+        treeStreamer=(cstream <<"ionTailXtalk").GetTree();
+      }else{
+        treeStreamer->Fill();
+      } // dump the results to the debug streamer if in debug mode
+    }
+    if (q > zerosup || fgSAMPAEmulator!=NULL){ 
+      if(q >= param->GetADCSat()) q = (Short_t)(param->GetADCSat() - 1);
+      //digrow->SetDigitFast((Short_t)q,rows,col);  
+      *pdig1 =Short_t(q);
+      for (Int_t tr=0;tr<3;tr++)
+        {
+          if (tr<labptr) 
+            ptr1[tr*nElems] = label[tr];
+        }
+    }
+    if (fgSAMPAEmulator && (timeBin==nTimeBins-1)) {  // pocess Emulator for given pad
+      //
+      TVectorD vecSAMPAIn(nTimeBins); // allocate workin array for SAMPA emulator processing (if set)
+      TVectorD vecSAMPAOut(nTimeBins); // allocate workin array for SAMPA emulator processing (if set)
+      Double_t baseline=0;
+      for (Int_t itime=0; itime<nTimeBins;itime++) vecSAMPAIn[itime]=pdig1[1+itime-nTimeBins];  // set workin array for SAMPA emulator 
+      for (Int_t itime=0; itime<nTimeBins;itime++) vecSAMPAOut[itime]=pdig1[1+itime-nTimeBins];  // set workin array for SAMPA emulator 
+      fgSAMPAEmulator->DigitalFilterFloat(nTimeBins, vecSAMPAOut.GetMatrixArray(), baseline);
+      //
+      if ( ((AliTPCReconstructor::StreamLevel()&kStreamSignal)>0)){	  
+        (*fDebugStreamer)<<"sampaEmulator"<<
+          "sector="<< sector<<   
+          "globalRowID="<<globalRowID<<
+          "padRow="<< padRow<<                 //pad row
+          "wireSegmentID="<< wireSegmentID<<   //wire segment 0-11, 0-3 in IROC 4-10 in OROC 
+          "localPad="<<localPad<<              // pad number -npads/2 .. npads/2
+          "padNumber="<<padNumber<<            // pad number 0..npads 
+          "timeBin="<< timeBin<<               // time bin 
+          "nPadsPerSegment="<<nPadsPerSegment<<// number of pads per wire segment	  
+          "qTotPerSector="<<qTotPerSector<<    // total charge in sector 
+          "nTotPerSector="<<nTotPerSector<<    // total number of digit (above threshold) in sector 
+          "vSAMPAin.="<<&vecSAMPAIn<<          // input  data
+          "vSAMPAout.="<<&vecSAMPAOut<<        // ouptut data
+          "\n";
+      }
+      for (Int_t itime=0; itime<nTimeBins;itime++) {
+        if ( TMath::Nint(vecSAMPAOut[itime]) <  zerosup) pdig1[1+itime-nTimeBins]=0;
+        else{
+          pdig1[1+itime-nTimeBins]=TMath::Nint(vecSAMPAOut[itime]);
+        }
+      }
+    }
+    pdig1++;
+    ptr1++;
+  }
+  
+  //
+  //  glitch filter
+  //
+  if (useGlitchFilter) digrow->GlitchFilter();
+  //
+  digrow->CompresBuffer(1,zerosup);
+  digrow->CompresTrackBuffer(1);
+  segment.fOutput = digrow;
+}
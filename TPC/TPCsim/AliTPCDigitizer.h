@@ -6,10 +6,20 @@
 /* $Id$ */
 
 #include "AliDigitizer.h"
+#include <vector>
+#include "TMatrixDfwd.h"
+#include "TVectorDfwd.h"
 class TTreeSRedirector;
+class TObjArray;
+class TTree;
 
 class AliDigitizationInput;
 class AliTPCSAMPAEmulator;
+class AliTPC;
+class AliTPCParam;
+class AliTPCCalPad;
+class AliTPCRecoParam;
+class AliSimDigits;
 
 class AliTPCDigitizer : public AliDigitizer {
  public:    
@@ -29,13 +39,44 @@ class AliTPCDigitizer : public AliDigitizer {
     void SetDebug(Int_t level){fDebug = level;}   // set debug level     
   static AliTPCSAMPAEmulator *GetEmulator(){return fgSAMPAEmulator;}
   static void SetEmulator( AliTPCSAMPAEmulator *emulator){fgSAMPAEmulator=emulator;}
+  // merging without ion tail and crosstalk (DigitizeFast); both the
+  // default and the fast digitization run the sectors in parallel with
+  // AliTPC::SetNThreads
+  static Bool_t GetFastDigitization(){return fgFastDigitization;}
+  static void SetFastDigitization(Bool_t flag=kTRUE){fgFastDigitization=flag;}
  private: 
+    // input and output of the merging of one segment (pad row)
+    struct AliTPCMergeSegment {
+      Int_t fSegmentID;                    // segment ID
+      Int_t fSector;                       // sector
+      Int_t fPadRow;                       // pad row
+      Int_t fNoise;                        // first index in the noise table
+      Double_t fTime;                      // real time of the merging
+      std::vector<AliSimDigits*> fInputs;  // copies of the input segments, NULL if not active
+      AliSimDigits *fOutput;               // merged digits
+    };
     void DigitizeFast(Option_t* option=0); //digitize - using row pointers
     void DigitizeSave(Option_t* option=0); // digitize using controlled arrays   
     void DigitizeWithTailAndCrossTalk(Option_t* option=0); 
+    Int_t ReadSegments(std::vector<AliTPCMergeSegment> &segments, Int_t firstSegment, Int_t nSectorsGroup,
+                       AliSimDigits **digarr, AliTPC *pTPC, AliTPCParam *param, Bool_t reserveNoise);
+    void CrossTalkSegment(AliTPCMergeSegment &segment, AliTPCParam *param, AliTPCCalPad *gainTPC,
+                          TMatrixD &crossTalkSignal, Double_t &qTotSector, Double_t &nTotSector) const;
+    void DigitizeSegmentWithTailAndCrossTalk(AliTPCMergeSegment &segment, AliTPC *pTPC, AliTPCParam *param,
+                                             const AliTPCRecoParam *recoParam, AliTPCCalPad *gainTPC,
+                                             AliTPCCalPad *noiseTPC, const Int_t *masks,
+                                             const TObjArray &crossTalkSignalArray,
+                                             const TVectorD &qTotSector, const TVectorD &nTotSector,
+                                             Float_t qTotTPC, const TObjArray &timeResFunc,
+                                             Int_t nIonTailBins, TTree *&treeStreamer) const;
+    void MergeSegment(AliTPCMergeSegment &segment, AliTPC *pTPC, AliTPCParam *param,
+                      AliTPCCalPad *gainTPC, AliTPCCalPad *noiseTPC, const Int_t *masks,
+                      std::vector<Float_t> &signal, std::vector<UChar_t> &nTracks,
+                      std::vector<UChar_t> &mark) const;
     Int_t fDebug;                         //
     TTreeSRedirector *fDebugStreamer;     //!debug streamer
   static AliTPCSAMPAEmulator *fgSAMPAEmulator; 
+  static Bool_t fgFastDigitization;     // use DigitizeFast
  private:
     AliTPCDigitizer& operator=(const AliTPCDigitizer&);
     AliTPCDigitizer(const AliTPCDigitizer&);
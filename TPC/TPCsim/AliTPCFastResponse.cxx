@@ -0,0 +1,401 @@
+/**************************************************************************
+ * Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved. *
+ *                                                                        *
+ * Author: The ALICE Off-line Project.                                    *
+ * Contributors are mentioned in the code where appropriate.              *
+ *                                                                        *
+ * Permission to use, copy, modify and distribute this software and its   *
+ * documentation strictly for non-commercial purposes is hereby granted   *
+ * without fee, provided that the above copyright notice appears in all   *
+ * copies and that both the copyright notice and this permission notice   *
+ * appear in the supporting documentation. The authors make no claims     *
+ * about the suitability of this software for any purpose. It is          *
+ * provided "as is" without express or implied warranty.                  *
+ **************************************************************************/
+
+/* $Id$ */
+
+/// \class AliTPCFastResponse
+///
+///   Fast parametrized response of the TPC
+///
+///   The AliTPCclusterMI clusters are produced directly from the TPC track
+///   references, the hits are neither digitized nor clustered. The track
+///   references of one track are connected by propagating the track between
+///   them (AliExternalTrackParam in the sector frames) to the pad rows; at
+///   every crossed pad row the cluster
+///   - is kept with the efficiency given by a map in pad row and drift
+///     length (or a constant, 1 by default),
+///   - is displaced by the distortion (AliTPCCorrection::DistortPoint, by
+///     default the composed correction of the calibDB),
+///   - is smeared with the resolution and gets the shape of the cluster
+///     parametrization fitted from the full simulation (AliTPCClusterParam
+///     of the calibDB). Without it a diffusion based parametrization is used.
+///
+///   The pad and time bin of the clusters are the inverse of the ideal
+///   AliTPCTransform, so the tracker transformation recovers the positions.
+///   The clusters are written to the TreeR in the format of AliTPCclusterer.
+///
+///   The efficiency map is not part of the calibDB, it has to be supplied
+///   with SetEfficiencyMap. TPC/macros/CompareFastClusters.C measures it
+///   from a full simulation and reconstruction (the TH2F "efficiencyMap" of
+///   its output). The resolution is taken from the AliTPCClusterParam of the
+///   calibDB; the residuals to the full clusters are checked by the same
+///   macro.
+///
+/// ~~~{.cpp}
+/// AliTPCFastResponse response;
+/// response.SetEfficiency(0.95);
+/// response.MakeClusters(runLoader->TreeTR(), runLoader->Stack(), treeR);
+/// ~~~
+
+#include <TClonesArray.h>
+#include <TGeoGlobalMagField.h>
+#include <TH2.h>
+#include <TMath.h>
+#include <TObjArray.h>
+#include <TParticle.h>
+#include <TParticlePDG.h>
+#include <TRandom.h>
+#include <TTree.h>
+
+#include "AliExternalTrackParam.h"
+#include "AliLog.h"
+#include "AliMagF.h"
+#include "AliStack.h"
+#include "AliTPCClusterParam.h"
+#include "AliTPCClustersRow.h"
+#include "AliTPCCorrection.h"
+#include "AliTPCFastResponse.h"
+#include "AliTPCParam.h"
+#include "AliTPCcalibDB.h"
+#include "AliTPCclusterMI.h"
+#include "AliTrackReference.h"
+
+/// \cond CLASSIMP
+ClassImp(AliTPCFastResponse)
+/// \endcond
+
+AliTPCFastResponse::AliTPCFastResponse()
+                   :TNamed(),
+                    fParam(0),
+                    fClusterParam(0),
+                    fDistortion(0),
+                    fUseDistortion(kTRUE),
+                    fEfficiencyMap(0),
+                    fEfficiency(1.),
+                    fChargeScale(50.),
+                    fBz(0.),
+                    fFieldBz(0.),
+                    fRows(0),
+                    fNClusters(0)
+{
+  /// default constructor
+
+  fSigma0[0] = 0.05;
+  fSigma0[1] = 0.06;
+  fSigmaDrift[0] = fSigmaDrift[1] = 0.004;
+}
+
+AliTPCFastResponse::AliTPCFastResponse(const char *name, const char *title)
+                   :TNamed(name,title),
+                    fParam(0),
+                    fClusterParam(0),
+                    fDistortion(0),
+                    fUseDistortion(kTRUE),
+                    fEfficiencyMap(0),
+                    fEfficiency(1.),
+                    fChargeScale(50.),
+                    fBz(0.),
+                    fFieldBz(0.),
+                    fRows(0),
+                    fNClusters(0)
+{
+  /// constructor
+
+  fSigma0[0] = 0.05;
+  fSigma0[1] = 0.06;
+  fSigmaDrift[0] = fSigmaDrift[1] = 0.004;
+}
+
+AliTPCFastResponse::~AliTPCFastResponse()
+{
+  /// destructor, the parametrizations are not owned
+
+  delete fRows;
+}
+
+void AliTPCFastResponse::SetResolution(Int_t dim, Float_t sigma0, Float_t sigmaDrift)
+{
+  /// resolution in y (dim 0) or z (dim 1) without cluster parametrization:
+  /// sigma^2 = sigma0^2 + sigmaDrift^2 * drift length
+
+  if (dim<0 || dim>1) return;
+  fSigma0[dim] = sigma0;
+  fSigmaDrift[dim] = sigmaDrift;
+}
+
+void AliTPCFastResponse::Init()
+{
+  /// take the parameters not set by the user from the calibDB and the field
+
+  AliTPCcalibDB *calib = AliTPCcalibDB::Instance();
+  if (!fParam) fParam = calib->GetParameters();
+  if (!fClusterParam) fClusterParam = calib->GetClusterParam();
+  if (fUseDistortion && !fDistortion) fDistortion = calib->GetTPCComposedCorrection();
+  fFieldBz = fBz;
+  if (fFieldBz==0) {
+    AliMagF *field = (AliMagF*)TGeoGlobalMagField::Instance()->GetField();
+    Double_t xyz[3] = {0,0,0};
+    if (field) fFieldBz = field->GetBz(xyz);
+  }
+  if (!fRows) {
+    fRows = new TObjArray(fParam->GetNRowsTotal());
+    fRows->SetOwner(kTRUE);
+  }
+}
+
+Int_t AliTPCFastResponse::MakeClusters(TTree *treeTR, AliStack *stack, TTree *treeR)
+{
+  /// clusters of all track references of the event to the TreeR
+  /// Returns the number of clusters
+
+  if (!treeTR || !treeR) return 0;
+  TBranch *branch = treeTR->GetBranch("TrackReferences");
+  if (!branch) {
+    AliError("No track references");
+    return 0;
+  }
+  Init();
+  ClearClusters();
+  TClonesArray *refs = new TClonesArray("AliTrackReference",100);
+  branch->SetAddress(&refs);
+  for (Int_t i=0; i<treeTR->GetEntries(); i++) {
+    branch->GetEntry(i);
+    TrackReferences2Clusters(*refs,stack);
+  }
+  treeTR->ResetBranchAddress(branch);
+  delete refs;
+  Int_t nclusters = fNClusters;
+  WriteClusters(treeR);
+  AliDebug(1,Form("%d clusters",nclusters));
+  return nclusters;
+}
+
+Int_t AliTPCFastResponse::TrackReferences2Clusters(const TClonesArray &refs, AliStack *stack)
+{
+  /// clusters between the consecutive TPC track references of the same track
+  /// Returns the number of new clusters
+
+  if (!fRows) Init();
+  Int_t nclusters = fNClusters;
+  const AliTrackReference *last = 0;
+  Int_t label = -1;
+  Short_t charge = 0;
+  Double_t mass = 0;
+  for (Int_t i=0; i<refs.GetEntriesFast(); i++) {
+    const AliTrackReference *ref = (const AliTrackReference*)refs.UncheckedAt(i);
+    if (ref->DetectorId()!=AliTrackReference::kTPC) continue;
+    if (ref->Label()!=label) {
+      label = ref->Label();
+      last = 0;
+      charge = 0;
+      TParticle *particle = stack ? stack->Particle(TMath::Abs(label)) : 0;
+      if (particle && particle->GetPDG()) {
+        Double_t q = particle->GetPDG()->Charge();
+        charge = (q>0) ? 1 : (q<0) ? -1 : 0;
+        mass = particle->GetMass();
+      }
+    }
+    if (charge==0) continue; // no ionisation
+    if (last) Interpolate(*last,*ref,charge,mass);
+    last = ref;
+  }
+  return fNClusters-nclusters;
+}
+
+Int_t AliTPCFastResponse::Interpolate(const AliTrackReference &ref, const AliTrackReference &next,
+                                      Short_t charge, Double_t mass)
+{
+  /// clusters on the pad rows between two track references, the pad row at
+  /// the first reference belongs to the previous interval
+  /// Returns the number of clusters
+
+  const Double_t kMinP = 1e-3;
+  const Double_t kSectorAngle = TMath::Pi()/9.;
+  if (ref.P()<kMinP || next.P()<kMinP) return 0;
+
+  Double_t xyz[3] = {ref.X(),ref.Y(),ref.Z()};
+  Double_t pxpypz[3] = {ref.Px(),ref.Py(),ref.Pz()};
+  Double_t cv[21] = {0};
+  AliExternalTrackParam track(xyz,pxpypz,cv,charge);
+  Double_t phi = TMath::ATan2(xyz[1],xyz[0]);
+  if (phi<0) phi += TMath::TwoPi();
+  Int_t isec = Int_t(phi/kSectorAngle)%18;
+  Double_t alpha = (isec+0.5)*kSectorAngle;
+  if (!track.Rotate(alpha)) return 0;
+
+  Double_t x0 = track.GetX();
+  Double_t x1 = next.X()*TMath::Cos(alpha)+next.Y()*TMath::Sin(alpha);
+  Bool_t outward = x1>x0;
+  const Int_t nLow = fParam->GetNRowLow();
+  const Int_t nRows = nLow+fParam->GetNRowUp();
+  Int_t nclusters = 0;
+  for (Int_t i=0; i<nRows; i++) {
+    Int_t irow = outward ? i : nRows-1-i;
+    Bool_t inner = irow<nLow;
+    Int_t row = inner ? irow : irow-nLow;
+    Double_t x = inner ? fParam->GetPadRowRadiiLow(row) : fParam->GetPadRowRadiiUp(row);
+    if (outward ? x<=x0 : x>=x0) continue;
+    if (outward ? x>x1 : x<x1) break;
+    if (!track.PropagateTo(x,fFieldBz)) break;
+    if (TMath::Abs(track.GetY())>x*TMath::Tan(0.5*kSectorAngle)) { // sector boundary
+      isec = (isec+(track.GetY()>0 ? 1 : 17))%18;
+      if (!track.Rotate((isec+0.5)*kSectorAngle)) break;
+      if (!track.PropagateTo(x,fFieldBz)) break;
+    }
+    Int_t sector = isec+(track.GetZ()<0 ? 18 : 0)+(inner ? 0 : fParam->GetNInnerSector());
+    if (MakeCluster(track,sector,row,ref.Label(),mass)) nclusters++;
+  }
+  return nclusters;
+}
+
+Bool_t AliTPCFastResponse::MakeCluster(const AliExternalTrackParam &track, Int_t sector, Int_t row,
+                                       Int_t label, Double_t mass)
+{
+  /// cluster of the track at the pad row, kTRUE if it was accepted
+
+  const Bool_t sideC = (sector/18)&1;
+  const Double_t zLength = fParam->GetZLength(sector);
+  Float_t drift = zLength-TMath::Abs(track.GetZ());
+  if (drift<0) return kFALSE;
+  Int_t globalRow = (sector<fParam->GetNInnerSector()) ? row : row+fParam->GetNRowLow();
+  if (gRandom->Rndm()>GetEfficiency(globalRow,drift)) return kFALSE;
+
+  Double_t x = track.GetX(), y = track.GetY(), z = track.GetZ();
+  if (fUseDistortion && fDistortion) {
+    // the cluster stays on the pad row, only y and z are distorted
+    Double_t cs = TMath::Cos(track.GetAlpha()), sn = TMath::Sin(track.GetAlpha());
+    Float_t xyz[3] = {Float_t(x*cs-y*sn),Float_t(x*sn+y*cs),Float_t(z)};
+    fDistortion->DistortPoint(xyz,sector);
+    y = -xyz[0]*sn+xyz[1]*cs;
+    z = xyz[2];
+  }
+  Double_t snp = track.GetSnp(), tgl = track.GetTgl();
+  Float_t sigma[2], rms[2];
+  GetResolution(sector,row,drift,snp,tgl,sigma,rms);
+  y += gRandom->Gaus(0,sigma[0]);
+  z += gRandom->Gaus(0,sigma[1]);
+
+  // pad and time bin, inverse of the ideal AliTPCTransform::Local2RotatedGlobal
+  // and AliTPCTransform::TimeBin2Z
+  Int_t maxPad = fParam->GetNPads(sector,row);
+  Float_t pad = (sideC ? -y : y)/fParam->GetPadPitchWidth(sector)+0.5*maxPad;
+  if (pad<0 || pad>maxPad) return kFALSE;
+  Float_t timeBin = (zLength-(sideC ? -z : z)+3.*fParam->GetZSigma())/fParam->GetZWidth();
+  if (timeBin<0) return kFALSE;
+
+  // charge from the Bethe-Bloch of the default parametrization (1 for a MIP)
+  // along the path over the pad, Landau fluctuations
+  Double_t bg = (mass>0) ? track.GetP()/mass : 1000.;
+  Double_t path = TMath::Sqrt((1.+tgl*tgl)/((1.-snp)*(1.+snp)));
+  Double_t landau = TMath::Min(TMath::Max(gRandom->Landau(1.,0.1),0.5),5.);
+  Float_t q = fChargeScale*AliExternalTrackParam::BetheBlochAleph(bg)*path*landau;
+
+  AliTPCclusterMI cl;
+  cl.SetDetector(sector);
+  cl.SetRow(row);
+  cl.SetPad(pad);
+  cl.SetTimeBin(timeBin);
+  cl.SetX(x);
+  cl.SetY(y);
+  cl.SetZ(z);
+  cl.SetSigmaY2(rms[0]*rms[0]);
+  cl.SetSigmaZ2(rms[1]*rms[1]);
+  cl.SetQ(TMath::Min(q,65535.f));
+  cl.SetMax((UShort_t)TMath::Min(0.3f*q,1023.f));
+  cl.SetType(0);
+  cl.SetLabel(label,0);
+  cl.SetLabel(-1,1);
+  cl.SetLabel(-1,2);
+
+  Int_t id = fParam->GetIndex(sector,row);
+  AliTPCClustersRow *clrow = (AliTPCClustersRow*)fRows->At(id);
+  if (!clrow) {
+    clrow = new AliTPCClustersRow("AliTPCclusterMI");
+    clrow->SetID(id);
+    fRows->AddAt(clrow,id);
+  }
+  clrow->InsertCluster(&cl);
+  fNClusters++;
+  return kTRUE;
+}
+
+Float_t AliTPCFastResponse::GetEfficiency(Int_t row, Float_t drift) const
+{
+  /// cluster efficiency at the pad row (0-158) and drift length
+
+  if (!fEfficiencyMap) return fEfficiency;
+  return fEfficiencyMap->GetBinContent(fEfficiencyMap->FindFixBin(row,drift));
+}
+
+void AliTPCFastResponse::GetResolution(Int_t sector, Int_t row, Float_t drift, Double_t snp, Double_t tgl,
+                                       Float_t sigma[2], Float_t rms[2]) const
+{
+  /// resolution and RMS of the cluster shape in y and z (cm)
+  /// pad types and angles as in AliTPCtracker::ErrY2Z2
+
+  Int_t globalRow = (sector<fParam->GetNInnerSector()) ? row : row+fParam->GetNRowLow();
+  Int_t type = (globalRow<63) ? 0 : (globalRow>126) ? 1 : 2;
+  Double_t snp2 = TMath::Min(snp*snp,1.-1e-6);
+  Double_t tgp2 = snp2/(1.-snp2);
+  Float_t tgp = TMath::Sqrt(tgp2);
+  Float_t tglm = TMath::Sqrt(tgl*tgl*(1.+tgp2));
+  if (fClusterParam) {
+    sigma[0] = fClusterParam->GetError0Par(0,type,drift,tgp);
+    sigma[1] = fClusterParam->GetError0Par(1,type,drift,tglm);
+    rms[0] = fClusterParam->GetRMS0(0,type,drift,tgp);
+    rms[1] = fClusterParam->GetRMS0(1,type,drift,tglm);
+    return;
+  }
+  for (Int_t dim=0; dim<2; dim++) {
+    sigma[dim] = TMath::Sqrt(fSigma0[dim]*fSigma0[dim]+fSigmaDrift[dim]*fSigmaDrift[dim]*drift);
+  }
+  Float_t padWidth = fParam->GetPadPitchWidth(sector);
+  Float_t padLength = fParam->GetPadPitchLength(sector,row);
+  Float_t zWidth = fParam->GetZWidth();
+  rms[0] = TMath::Sqrt((padWidth*padWidth+tgp2*padLength*padLength)/12.
+                       +fParam->GetDiffT()*fParam->GetDiffT()*drift);
+  rms[1] = TMath::Sqrt((zWidth*zWidth+tglm*tglm*padLength*padLength)/12.
+                       +fParam->GetDiffL()*fParam->GetDiffL()*drift);
+}
+
+Int_t AliTPCFastResponse::WriteClusters(TTree *treeR)
+{
+  /// write the nonempty pad rows to the branch "Segment" of the TreeR and
+  /// clear them. Returns the number of written pad rows
+
+  AliTPCClustersRow empty("AliTPCclusterMI");
+  AliTPCClustersRow *clrow = &empty;
+  if (!treeR->GetBranch("Segment")) treeR->Branch("Segment","AliTPCClustersRow",&clrow,32000,99);
+  TBranch *branch = treeR->GetBranch("Segment");
+  Int_t nrows = 0;
+  for (Int_t id=0; fRows && id<fRows->GetSize(); id++) {
+    clrow = (AliTPCClustersRow*)fRows->UncheckedAt(id);
+    if (!clrow) continue;
+    branch->SetAddress(&clrow);
+    treeR->Fill();
+    nrows++;
+  }
+  treeR->ResetBranchAddress(branch);
+  ClearClusters();
+  return nrows;
+}
+
+void AliTPCFastResponse::ClearClusters()
+{
+  /// delete the clusters of the current event
+
+  if (fRows) fRows->Delete();
+  fNClusters = 0;
+}
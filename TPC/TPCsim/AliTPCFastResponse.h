@@ -0,0 +1,80 @@
+#ifndef ALITPCFASTRESPONSE_H
+#define ALITPCFASTRESPONSE_H
+/* Copyright(c) 1998-1999, ALICE Experiment at CERN, All rights reserved. *
+ * See cxx source for full Copyright notice                               */
+
+/* $Id$ */
+
+/// \class AliTPCFastResponse
+/// \brief Parametrized TPC response: clusters directly from the track references
+///
+/// The tracks are propagated between their TPC track references to the pad
+/// rows, the cluster positions are distorted, smeared with the parametrized
+/// resolution and kept with the parametrized efficiency.
+
+#include <TNamed.h>
+
+class TTree;
+class TH2;
+class TClonesArray;
+class TObjArray;
+class AliStack;
+class AliTrackReference;
+class AliExternalTrackParam;
+class AliTPCParam;
+class AliTPCClusterParam;
+class AliTPCCorrection;
+
+class AliTPCFastResponse : public TNamed {
+public:
+  AliTPCFastResponse();
+  AliTPCFastResponse(const char *name, const char *title);
+  virtual ~AliTPCFastResponse();
+
+  void  SetParam(AliTPCParam *param) {fParam = param;}
+  void  SetClusterParam(AliTPCClusterParam *param) {fClusterParam = param;} // resolution and shape, default from the calibDB
+  void  SetDistortion(AliTPCCorrection *correction) {fDistortion = correction;} // default composed correction of the calibDB
+  void  SetUseDistortion(Bool_t flag=kTRUE) {fUseDistortion = flag;}
+  void  SetEfficiencyMap(TH2 *map) {fEfficiencyMap = map;} // efficiency vs pad row (0-158) and drift length, see CompareFastClusters.C
+  void  SetEfficiency(Float_t eff) {fEfficiency = eff;} // used without map
+  void  SetResolution(Int_t dim, Float_t sigma0, Float_t sigmaDrift); // used without cluster parametrization
+  void  SetChargeScale(Float_t scale) {fChargeScale = scale;} // cluster charge of a MIP
+  void  SetBz(Double_t bz) {fBz = bz;} // kG, 0 - from the field map
+
+  Int_t MakeClusters(TTree *treeTR, AliStack *stack, TTree *treeR); // clusters of one event
+  Int_t TrackReferences2Clusters(const TClonesArray &refs, AliStack *stack);
+  Int_t WriteClusters(TTree *treeR);
+  void  ClearClusters();
+  Int_t GetNClusters() const {return fNClusters;}
+
+private:
+  AliTPCFastResponse(const AliTPCFastResponse &response);
+  AliTPCFastResponse &operator=(const AliTPCFastResponse &response);
+
+  void    Init();
+  Int_t   Interpolate(const AliTrackReference &ref, const AliTrackReference &next, Short_t charge, Double_t mass);
+  Bool_t  MakeCluster(const AliExternalTrackParam &track, Int_t sector, Int_t row, Int_t label, Double_t mass);
+  Float_t GetEfficiency(Int_t row, Float_t drift) const;
+  void    GetResolution(Int_t sector, Int_t row, Float_t drift, Double_t snp, Double_t tgl,
+                        Float_t sigma[2], Float_t rms[2]) const;
+
+  AliTPCParam        *fParam;          //!<! TPC parameters
+  AliTPCClusterParam *fClusterParam;   //!<! resolution and shape parametrization
+  AliTPCCorrection   *fDistortion;     //!<! distortion of the cluster positions
+  Bool_t              fUseDistortion;  ///< apply the distortions
+  TH2                *fEfficiencyMap;  ///< cluster efficiency vs pad row and drift length
+  Float_t             fEfficiency;     ///< cluster efficiency without map
+  Float_t             fSigma0[2];      ///< resolution in y and z at zero drift without cluster parametrization
+  Float_t             fSigmaDrift[2];  ///< resolution per sqrt(cm) of drift without cluster parametrization
+  Float_t             fChargeScale;    ///< cluster charge of a MIP
+  Double_t            fBz;             ///< magnetic field (kG), 0 - from the field map
+  Double_t            fFieldBz;        //!<! magnetic field of the current event
+  TObjArray          *fRows;           //!<! clusters of the current event by segment ID
+  Int_t               fNClusters;      //!<! clusters in fRows
+
+  /// \cond CLASSIMP
+  ClassDef(AliTPCFastResponse,1)
+  /// \endcond
+};
+
+#endif
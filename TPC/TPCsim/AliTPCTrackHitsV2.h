@@ -193,6 +193,7 @@ public:
   TClonesArray * GetArray(){return fArray;}
   Int_t  GetEntriesFast() const { return fSize;}
   void SetHitPrecision(Double_t prec) {fPrecision=prec;}
+  Double_t GetHitPrecision() const {return fPrecision;}
   void SetStepPrecision(Double_t prec) {fStep=prec;}
   void SetMaxDistance(UInt_t distance) {fMaxDistance = distance;}
   Bool_t  FlushHitStack(Bool_t force=kTRUE);    //
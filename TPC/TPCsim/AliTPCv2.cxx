@@ -2304,7 +2304,7 @@ void AliTPCv2::StepManager()
   const Float_t kbig = 1.e10;
 
   Int_t id,copy;
-  Float_t hits[5];
+  Float_t hits[6];
   Int_t vol[2];  
   TLorentzVector p;
   
@@ -2400,7 +2400,7 @@ void AliTPCv2::StepManager()
         // Get also the track time for pileup simulation
         hits[4]=mc->TrackTime();
 
-        AddHit(gAlice->GetMCApp()->GetCurrentTrackNumber(), vol,hits);  
+        StoreHit(vol,hits);  
       }
     //
 
@@ -2412,7 +2412,7 @@ void AliTPCv2::StepManager()
        // Get also the track time for pileup simulation
        hits[4]=mc->TrackTime();
 
-       AddHit(gAlice->GetMCApp()->GetCurrentTrackNumber(), vol,hits);  
+       StoreHit(vol,hits);  
     
     }
     else return;
@@ -2484,7 +2484,7 @@ void AliTPCv2::StepManager()
     // Get also the track time for pileup simulation
     hits[4]=mc->TrackTime();
  
-    AddHit(gAlice->GetMCApp()->GetCurrentTrackNumber(), vol,hits);
+    StoreHit(vol,hits);
     if (fDebugStreamer){   
       // You can dump here what you need
       // function  CreateDebugStremer() to be called in the Config.C  macro
@@ -2510,4 +2510,28 @@ void AliTPCv2::StepManager()
   } //within sector's limits
 }
 
+//_____________________________________________________________________________
+void AliTPCv2::StoreHit(Int_t *vol, Float_t *hits)
+{
+  //
+  // Add the hit or store it in the hit buffer together with the
+  // current hit precision of the track hits
+  //
+  Int_t track = gAlice->GetMCApp()->GetCurrentTrackNumber();
+  if (!IsHitBufferOn()) {
+    AddHit(track,vol,hits);
+    return;
+  }
+  hits[5] = fTrackHits ? fTrackHits->GetHitPrecision() : 0.;
+  BufferHit(track,vol,hits);
+}
 
+//_____________________________________________________________________________
+void AliTPCv2::AddBufferedHit(Int_t track, Int_t *vol, Float_t *hits)
+{
+  //
+  // Add a hit from the hit buffer with the precision of the step
+  //
+  if (fTrackHits) fTrackHits->SetHitPrecision(hits[5]);
+  AddHit(track,vol,hits);
+}
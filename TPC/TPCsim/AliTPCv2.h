@@ -39,8 +39,12 @@ public:
   virtual void  Init();
   virtual Int_t IsVersion() const {return 2;}
   virtual void  StepManager();
+  void          SetHitBuffering(Bool_t on=kTRUE) {SetHitBuffer(on ? 2 : 0, on ? 6 : 0, 10000);}
 
 protected:
+  void          StoreHit(Int_t *vol, Float_t *hits);
+  virtual void  AddBufferedHit(Int_t track, Int_t *vol, Float_t *hits);
+
   Int_t fIdSens;    // sensitive strip
   Int_t fIDrift;    // drift gas
   Int_t fSecOld;    // indicate the previous sector - for reference points    
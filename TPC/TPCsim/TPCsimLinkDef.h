@@ -37,6 +37,7 @@
 
 #pragma link C++ class AliTPCDigitizer;   // Create Digits out of SDigits and partially SDigits from Hits
                                           // --- Update Documentation
+#pragma link C++ class AliTPCFastResponse+; // Parametrized response: clusters from the track references
 
 #pragma link C++ class AliTPCBuffer+;     // Used to to write digit in raw format
                                           // --- Update Documentation